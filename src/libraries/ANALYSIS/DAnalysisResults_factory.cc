@@ -9,6 +9,8 @@
 #include "vt_user.h"
 #endif
 
+#include <mutex>
+
 #include "DAnalysisResults_factory.h"
 
 //------------------
@@ -80,6 +82,27 @@ jerror_t DAnalysisResults_factory::brun(JEventLoop *locEventLoop, int32_t runnum
 	gPARMS->SetDefaultParameter("KINFIT:DEBUG_LEVEL", dKinFitDebugLevel);
 	dKinFitter->Set_DebugLevel(dKinFitDebugLevel);
 
+	gPARMS->SetDefaultParameter("KINFIT:DENSE_MATRICES", dKinFitDenseMatricesFlag, "Use the full (dense) matrices in the kinematic fit instead of the per-particle covariance blocks (for validation)");
+	dKinFitter->Set_UseDenseMatricesFlag(dKinFitDenseMatricesFlag);
+
+	//PARALLEL KINFIT: spread the fits of the combos of one event over several threads
+	gPARMS->SetDefaultParameter("ANALYSIS:PARALLEL_KINFIT_THREADS", dKinFitParallelThreads, "Number of extra threads each event processing thread may use to kinfit the combos of a single event (0=fit all combos in the event processing thread)");
+	gPARMS->SetDefaultParameter("ANALYSIS:PARALLEL_KINFIT_MIN_COMBOS", dKinFitParallelMinCombos, "Minimum number of combos for a DReaction in an event for their kinfits to be spread over threads when ANALYSIS:PARALLEL_KINFIT_THREADS>0");
+	gPARMS->SetDefaultParameter("ANALYSIS:PARALLEL_KINFIT_CHECK", dKinFitParallelCheckFlag, "If true, each kinfit done on several threads is redone in the event processing thread, and the chi-square, NDF, and VXi are compared (for validation: slow)");
+	if((dKinFitParallelThreads > 0) && (dKinFitDebugLevel > 0))
+	{
+		//the debug output of fits on different threads would be interleaved
+		static once_flag locDebugWarnFlag;
+		call_once(locDebugWarnFlag, [](){jout << "KINFIT:DEBUG_LEVEL > 0: ANALYSIS:PARALLEL_KINFIT_THREADS ignored, combos are fit serially." << endl;});
+		dKinFitParallelThreads = 0;
+	}
+	if(dKinFitParallelThreads > 0)
+	{
+		if(dKinFitTaskPool == nullptr)
+			dKinFitTaskPool = new DTrackFitTaskPool(dKinFitParallelThreads);
+		Make_HelperKinFitters(locEventLoop);
+	}
+
 	//CREATE COMBOERS
 	dSourceComboer = new DSourceComboer(locEventLoop);
 	dParticleComboCreator = dSourceComboer->Get_ParticleComboCreator();
@@ -87,6 +110,32 @@ jerror_t DAnalysisResults_factory::brun(JEventLoop *locEventLoop, int32_t runnum
 	return NOERROR;
 }
 
+void DAnalysisResults_factory::Make_HelperKinFitters(JEventLoop* locEventLoop)
+{
+	//Each helper thread of the task pool gets its own fitter & utils: they hold the state of the fit in progress
+	Delete_HelperKinFitters();
+	for(unsigned int loc_i = 1; loc_i < dKinFitTaskPool->GetNworkers(); ++loc_i)
+	{
+		auto locKinFitUtils = new DKinFitUtils_GlueX(locEventLoop);
+		auto locKinFitter = new DKinFitter(locKinFitUtils);
+		locKinFitter->Set_DebugLevel(dKinFitDebugLevel);
+		locKinFitter->Set_UseDenseMatricesFlag(dKinFitDenseMatricesFlag);
+
+		dHelperKinFitUtils.push_back(locKinFitUtils);
+		dHelperKinFitters.push_back(locKinFitter);
+	}
+}
+
+void DAnalysisResults_factory::Delete_HelperKinFitters(void)
+{
+	for(auto& locKinFitter : dHelperKinFitters)
+		delete locKinFitter;
+	for(auto& locKinFitUtils : dHelperKinFitUtils)
+		delete locKinFitUtils;
+	dHelperKinFitters.clear();
+	dHelperKinFitUtils.clear();
+}
+
 void DAnalysisResults_factory::Check_ReactionNames(vector<const DReaction*>& locReactions) const
 {
 	set<string> locReactionNames;
@@ -259,6 +308,8 @@ jerror_t DAnalysisResults_factory::evnt(JEventLoop* locEventLoop, uint64_t event
 	dSourceComboer->Reset_NewEvent(locEventLoop);
 	dKinFitUtils->Reset_NewEvent();
 	dKinFitter->Reset_NewEvent();
+	for(auto& locKinFitter : dHelperKinFitters)
+		locKinFitter->Reset_NewEvent(); //also resets its utils
 	dConstraintResultsMap.clear();
 	dPreToPostKinFitComboMap.clear();
 	dResourcePool_KinFitResults.Recycle(dCreatedKinFitResults);
@@ -310,26 +361,65 @@ jerror_t DAnalysisResults_factory::evnt(JEventLoop* locEventLoop, uint64_t event
 			auto locNumActionsForHist = locIsKinFit ? locActions.size() + 2 : locActions.size() + 1;
 			vector<size_t> locNumCombosSurvived(locNumActionsForHist, 0);
 			locNumCombosSurvived[0] = locCombos.size(); //first cut is "is there a combo"
-			for(auto& locCombo : locCombos)
+			auto locParallelKinFitFlag = locIsKinFit && (dKinFitTaskPool != nullptr) && (locCombos.size() >= dKinFitParallelMinCombos);
+			if(locParallelKinFitFlag)
 			{
+				//Each action still sees the combos in the same order, and the survival counts are sums: same results as the serial loop below
+
 				//EXECUTE PRE-KINFIT ACTIONS
-				size_t locActionIndex = 0;
-				if(!Execute_Actions(locEventLoop, locIsKinFit, locCombo, locTrueParticleCombo, true, locActions, locActionIndex, locNumCombosSurvived, locLastActionTrueComboSurvives))
-					continue; //failed: go to the next combo
-
-				//KINFIT IF REQUESTED
-				auto locPostKinFitCombo = Handle_ComboFit(locReactionVertexInfo, locCombo, locReaction);
-				if(locPostKinFitCombo == nullptr)
-					continue; //failed to converge
-				if(locIsKinFit)
+				vector<const DParticleCombo*> locPreKinFitCombos;
+				vector<size_t> locActionIndices; //of the first post-kinfit action, for each of locPreKinFitCombos
+				for(auto& locCombo : locCombos)
+				{
+					size_t locActionIndex = 0;
+					if(!Execute_Actions(locEventLoop, locIsKinFit, locCombo, locTrueParticleCombo, true, locActions, locActionIndex, locNumCombosSurvived, locLastActionTrueComboSurvives))
+						continue; //failed: go to the next combo
+					locPreKinFitCombos.push_back(locCombo);
+					locActionIndices.push_back(locActionIndex);
+				}
+
+				//KINFIT
+				auto locPostKinFitCombos = Handle_ComboFits_Parallel(locReactionVertexInfo, locPreKinFitCombos, locReaction);
+
+				for(size_t loc_j = 0; loc_j < locPostKinFitCombos.size(); ++loc_j)
+				{
+					auto locPostKinFitCombo = locPostKinFitCombos[loc_j];
+					if(locPostKinFitCombo == nullptr)
+						continue; //failed to converge
+					auto locActionIndex = locActionIndices[loc_j];
 					++(locNumCombosSurvived[locActionIndex + 1]);
 
-				//EXECUTE POST-KINFIT ACTIONS
-				if(!Execute_Actions(locEventLoop, locIsKinFit, locPostKinFitCombo, locTrueParticleCombo, false, locActions, locActionIndex, locNumCombosSurvived, locLastActionTrueComboSurvives))
-					continue; //failed: go to the next combo
+					//EXECUTE POST-KINFIT ACTIONS
+					if(!Execute_Actions(locEventLoop, locIsKinFit, locPostKinFitCombo, locTrueParticleCombo, false, locActions, locActionIndex, locNumCombosSurvived, locLastActionTrueComboSurvives))
+						continue; //failed: go to the next combo
 
-				//SAVE COMBO
-				locAnalysisResults->Add_PassedParticleCombo(locPostKinFitCombo);
+					//SAVE COMBO
+					locAnalysisResults->Add_PassedParticleCombo(locPostKinFitCombo);
+				}
+			}
+			else
+			{
+				for(auto& locCombo : locCombos)
+				{
+					//EXECUTE PRE-KINFIT ACTIONS
+					size_t locActionIndex = 0;
+					if(!Execute_Actions(locEventLoop, locIsKinFit, locCombo, locTrueParticleCombo, true, locActions, locActionIndex, locNumCombosSurvived, locLastActionTrueComboSurvives))
+						continue; //failed: go to the next combo
+
+					//KINFIT IF REQUESTED
+					auto locPostKinFitCombo = Handle_ComboFit(locReactionVertexInfo, locCombo, locReaction);
+					if(locPostKinFitCombo == nullptr)
+						continue; //failed to converge
+					if(locIsKinFit)
+						++(locNumCombosSurvived[locActionIndex + 1]);
+
+					//EXECUTE POST-KINFIT ACTIONS
+					if(!Execute_Actions(locEventLoop, locIsKinFit, locPostKinFitCombo, locTrueParticleCombo, false, locActions, locActionIndex, locNumCombosSurvived, locLastActionTrueComboSurvives))
+						continue; //failed: go to the next combo
+
+					//SAVE COMBO
+					locAnalysisResults->Add_PassedParticleCombo(locPostKinFitCombo);
+				}
 			}
 
 			if(dDebugLevel > 0)
@@ -434,6 +524,178 @@ const DParticleCombo* DAnalysisResults_factory::Handle_ComboFit(const DReactionV
 	return locNewParticleCombo;
 }
 
+vector<const DParticleCombo*> DAnalysisResults_factory::Handle_ComboFits_Parallel(const DReactionVertexInfo* locReactionVertexInfo, const vector<const DParticleCombo*>& locParticleCombos, const DReaction* locReaction)
+{
+	//Only the fits themselves are done on the task pool.
+	//Everything that uses the shared maps, the combo creator, or creates input kinfit particles is done here, in combo order.
+	//That way the results don't depend on which thread did which fit.
+	auto locKinFitType = locReaction->Get_KinFitType();
+	auto locUpdateCovMatricesFlag = locReaction->Get_KinFitUpdateCovarianceMatricesFlag();
+	auto locNoConstrainMassSteps = DAnalysis::Get_NoConstrainMassSteps(locReaction);
+
+	/****************************************************** MAKE CONSTRAINTS, FIND THE FITS TO DO *****************************************************/
+
+	vector<const DParticleCombo*> locPostKinFitCombos(locParticleCombos.size(), nullptr);
+	vector<shared_ptr<const DKinFitChain>> locKinFitChains(locParticleCombos.size(), nullptr); //nullptr if the combo is already done
+	vector<pair<set<shared_ptr<DKinFitConstraint>>, bool>> locResultPairs(locParticleCombos.size());
+	set<pair<set<shared_ptr<DKinFitConstraint>>, bool>> locTaskResultPairs;
+	vector<DKinFitTask> locKinFitTasks;
+	for(size_t loc_i = 0; loc_i < locParticleCombos.size(); ++loc_i)
+	{
+		auto locParticleCombo = locParticleCombos[loc_i];
+
+		//Check if same fit with this combo already done. If so, use it.
+		auto locComboIterator = dPreToPostKinFitComboMap.find(std::make_tuple(locParticleCombo, locKinFitType, locUpdateCovMatricesFlag, locNoConstrainMassSteps));
+		if(locComboIterator != dPreToPostKinFitComboMap.end())
+		{
+			locPostKinFitCombos[loc_i] = locComboIterator->second;
+			continue;
+		}
+
+		auto locKinFitChain = dKinFitUtils->Make_KinFitChain(locReactionVertexInfo, locReaction, locParticleCombo, locKinFitType);
+		vector<shared_ptr<DKinFitConstraint_Vertex>> locSortedVertexConstraints;
+		auto locConstraints = dKinFitUtils->Create_Constraints(locReactionVertexInfo, locReaction, locParticleCombo, locKinFitChain, locKinFitType, locSortedVertexConstraints);
+		if(locConstraints.empty())
+		{
+			locPostKinFitCombos[loc_i] = (dRequireKinFitConvergence ? nullptr : locParticleCombo); //Nothing to fit!
+			continue;
+		}
+
+		locKinFitChains[loc_i] = locKinFitChain;
+		locResultPairs[loc_i] = std::make_pair(locConstraints, locUpdateCovMatricesFlag);
+
+		//see if constraints (particles) are identical to a previous kinfit, or to one already queued
+		if(dConstraintResultsMap.find(locResultPairs[loc_i]) != dConstraintResultsMap.end())
+			continue;
+		if(!locTaskResultPairs.insert(locResultPairs[loc_i]).second)
+			continue;
+
+		//the results are taken from the pool here: it isn't thread-safe
+		locKinFitTasks.emplace_back();
+		locKinFitTasks.back().dResultPair = locResultPairs[loc_i];
+		locKinFitTasks.back().dKinFitResults = dResourcePool_KinFitResults.Get_Resource();
+		locKinFitTasks.back().dKinFitResults->Reset();
+	}
+
+	/********************************************************************** FIT *********************************************************************/
+
+	if(dDebugLevel >= 10)
+		cout << "Do " << locKinFitTasks.size() << " kinfits on " << dKinFitTaskPool->GetNworkers() << " threads" << endl;
+	dKinFitTaskPool->Run(locKinFitTasks.size(), [&](unsigned int locTaskIndex, unsigned int locWorkerIndex)
+	{
+		auto& locKinFitTask = locKinFitTasks[locTaskIndex];
+		auto locKinFitter = (locWorkerIndex == 0) ? dKinFitter : dHelperKinFitters[locWorkerIndex - 1];
+		auto locKinFitUtils = (locWorkerIndex == 0) ? dKinFitUtils : dHelperKinFitUtils[locWorkerIndex - 1];
+
+		//The input constraints & particles are only read: the fitter clones them first
+		locKinFitUtils->Set_UpdateCovarianceMatricesFlag(locUpdateCovMatricesFlag);
+		locKinFitter->Reset_NewFit();
+		locKinFitter->Add_Constraints(locKinFitTask.dResultPair.first);
+		locKinFitTask.dFitStatus = locKinFitter->Fit_Reaction();
+		locKinFitTask.dKinFitUtils = locKinFitUtils;
+
+		if(locKinFitTask.dFitStatus) //success
+			Fill_KinFitResults(locKinFitTask.dKinFitResults, locKinFitter, locKinFitUtils, locKinFitType);
+		else
+			locKinFitter->Recycle_LastFitMemory(); //RESET MEMORY FROM LAST KINFIT!! //results no longer needed
+	});
+
+	if(dKinFitParallelCheckFlag)
+		Check_ParallelKinFits(locKinFitTasks, locUpdateCovMatricesFlag);
+
+	/******************************************************************** MERGE *********************************************************************/
+
+	//Register the results, in the order the fits were queued
+	for(auto& locKinFitTask : locKinFitTasks)
+	{
+		DKinFitResults* locKinFitResults = nullptr;
+		if(locKinFitTask.dFitStatus)
+		{
+			locKinFitResults = locKinFitTask.dKinFitResults;
+			dCreatedKinFitResults.push_back(locKinFitResults);
+
+			//so that the output chains can be built (here and for later combos) with dKinFitUtils
+			if(locKinFitTask.dKinFitUtils != dKinFitUtils)
+				dKinFitUtils->Copy_OutputToInputMapping(locKinFitTask.dKinFitUtils, locKinFitResults->Get_OutputKinFitParticles());
+		}
+		else
+			dResourcePool_KinFitResults.Recycle(locKinFitTask.dKinFitResults);
+		dConstraintResultsMap.emplace(locKinFitTask.dResultPair, locKinFitResults);
+	}
+
+	//Create the new combos, in combo order
+	for(size_t loc_i = 0; loc_i < locParticleCombos.size(); ++loc_i)
+	{
+		if(locKinFitChains[loc_i] == nullptr)
+			continue; //already done
+
+		auto locParticleCombo = locParticleCombos[loc_i];
+		auto locKinFitResults = dConstraintResultsMap[locResultPairs[loc_i]];
+		if(locKinFitResults == nullptr)
+		{
+			locPostKinFitCombos[loc_i] = (dRequireKinFitConvergence ? nullptr : locParticleCombo); //fit failed
+			continue;
+		}
+
+		auto locOutputKinFitParticles = locKinFitResults->Get_OutputKinFitParticles();
+		auto locOutputKinFitChain = dKinFitUtils->Build_OutputKinFitChain(locKinFitChains[loc_i], locOutputKinFitParticles);
+		auto locNewParticleCombo = dParticleComboCreator->Create_KinFitCombo_NewCombo(locParticleCombo, locReaction, locKinFitResults, locOutputKinFitChain);
+		dPreToPostKinFitComboMap.emplace(std::make_tuple(locParticleCombo, locKinFitType, locUpdateCovMatricesFlag, locNoConstrainMassSteps), locNewParticleCombo);
+		locPostKinFitCombos[loc_i] = locNewParticleCombo;
+	}
+
+	return locPostKinFitCombos;
+}
+
+void DAnalysisResults_factory::Check_ParallelKinFits(const vector<DKinFitTask>& locKinFitTasks, bool locUpdateCovMatricesFlag)
+{
+	//Redo each fit serially with dKinFitter: the fit status, chi-square, NDF, and VXi must be the same as from the task pool
+	//The fit status decides which combos survive the kinfit, and everything after the fits is done in combo order either way
+	for(auto& locKinFitTask : locKinFitTasks)
+	{
+		dKinFitUtils->Set_UpdateCovarianceMatricesFlag(locUpdateCovMatricesFlag);
+		dKinFitter->Reset_NewFit();
+		dKinFitter->Add_Constraints(locKinFitTask.dResultPair.first);
+		bool locFitStatus = dKinFitter->Fit_Reaction();
+		++dNumParallelKinFitsChecked;
+
+		bool locMatchFlag = (locFitStatus == locKinFitTask.dFitStatus);
+		double locMaxVXiDiff = 0.0;
+		if(locMatchFlag && locFitStatus)
+		{
+			auto locKinFitResults = locKinFitTask.dKinFitResults;
+			locMatchFlag = (dKinFitter->Get_NDF() == locKinFitResults->Get_NDF()) && (dKinFitter->Get_ChiSq() == locKinFitResults->Get_ChiSq());
+
+			const TMatrixDSym& locVXi = dKinFitter->Get_VXi();
+			const TMatrixDSym& locVXi_Parallel = locKinFitResults->Get_VXi();
+			if(locVXi.GetNrows() != locVXi_Parallel.GetNrows())
+				locMatchFlag = false;
+			else
+			{
+				for(int loc_i = 0; loc_i < locVXi.GetNrows(); ++loc_i)
+				{
+					for(int loc_j = 0; loc_j <= loc_i; ++loc_j)
+						locMaxVXiDiff = std::max(locMaxVXiDiff, fabs(locVXi(loc_i, loc_j) - locVXi_Parallel(loc_i, loc_j)));
+				}
+				if(locMaxVXiDiff > 0.0)
+					locMatchFlag = false;
+			}
+		}
+		dKinFitter->Recycle_LastFitMemory(); //results not kept
+
+		if(locMatchFlag)
+			continue;
+		++dNumParallelKinFitMismatches;
+		jout << "PARALLEL KINFIT MISMATCH: serial/parallel status = " << locFitStatus << "/" << locKinFitTask.dFitStatus;
+		if(locFitStatus && locKinFitTask.dFitStatus)
+		{
+			jout << ", chisq = " << dKinFitter->Get_ChiSq() << "/" << locKinFitTask.dKinFitResults->Get_ChiSq() << ", ndf = " << dKinFitter->Get_NDF()
+				<< "/" << locKinFitTask.dKinFitResults->Get_NDF() << ", max |VXi diff| = " << locMaxVXiDiff;
+		}
+		jout << endl;
+	}
+}
+
 pair<shared_ptr<const DKinFitChain>, const DKinFitResults*> DAnalysisResults_factory::Fit_Kinematics(const DReactionVertexInfo* locReactionVertexInfo, const DReaction* locReaction, const DParticleCombo* locParticleCombo, DKinFitType locKinFitType, bool locUpdateCovMatricesFlag)
 {
 	//Make DKinFitChain
@@ -490,23 +752,31 @@ pair<shared_ptr<const DKinFitChain>, const DKinFitResults*> DAnalysisResults_fac
 DKinFitResults* DAnalysisResults_factory::Build_KinFitResults(const DParticleCombo* locParticleCombo, DKinFitType locKinFitType, const shared_ptr<const DKinFitChain>& locKinFitChain)
 {
 	auto locKinFitResults = Get_KinFitResultsResource();
+	Fill_KinFitResults(locKinFitResults, dKinFitter, dKinFitUtils, locKinFitType);
+	return locKinFitResults;
+}
+
+void DAnalysisResults_factory::Fill_KinFitResults(DKinFitResults* locKinFitResults, DKinFitter* locKinFitter, const DKinFitUtils* locKinFitUtils, DKinFitType locKinFitType) const
+{
+	//locKinFitter & locKinFitUtils: the ones used for the fit (may be a helper thread's)
+	//dKinFitUtils is only read (input -> source mapping), so this can be called from any worker of the task pool
 	locKinFitResults->Set_KinFitType(locKinFitType);
 
-	locKinFitResults->Set_ConfidenceLevel(dKinFitter->Get_ConfidenceLevel());
-	locKinFitResults->Set_ChiSq(dKinFitter->Get_ChiSq());
-	locKinFitResults->Set_NDF(dKinFitter->Get_NDF());
+	locKinFitResults->Set_ConfidenceLevel(locKinFitter->Get_ConfidenceLevel());
+	locKinFitResults->Set_ChiSq(locKinFitter->Get_ChiSq());
+	locKinFitResults->Set_NDF(locKinFitter->Get_NDF());
 
-	//locKinFitResults->Set_VEta(dKinFitter->Get_VEta());
-	locKinFitResults->Set_VXi(dKinFitter->Get_VXi());
-	//locKinFitResults->Set_V(dKinFitter->Get_V());
+	//locKinFitResults->Set_VEta(locKinFitter->Get_VEta());
+	locKinFitResults->Set_VXi(locKinFitter->Get_VXi());
+	//locKinFitResults->Set_V(locKinFitter->Get_V());
 
-	locKinFitResults->Set_NumConstraints(dKinFitter->Get_NumConstraintEquations());
-	locKinFitResults->Set_NumUnknowns(dKinFitter->Get_NumUnknowns());
+	locKinFitResults->Set_NumConstraints(locKinFitter->Get_NumConstraintEquations());
+	locKinFitResults->Set_NumUnknowns(locKinFitter->Get_NumUnknowns());
 
 	//Output particles and constraints
-	auto locOutputKinFitParticles = dKinFitter->Get_KinFitParticles();
+	auto locOutputKinFitParticles = locKinFitter->Get_KinFitParticles();
 	locKinFitResults->Add_OutputKinFitParticles(locOutputKinFitParticles);
-	locKinFitResults->Add_KinFitConstraints(dKinFitter->Get_KinFitConstraints());
+	locKinFitResults->Add_KinFitConstraints(locKinFitter->Get_KinFitConstraints());
 
 	//Pulls
 
@@ -515,14 +785,14 @@ DKinFitResults* DAnalysisResults_factory::Build_KinFitResults(const DParticleCom
 
 	//From this:
 	map<shared_ptr<DKinFitParticle>, map<DKinFitPullType, double> > locPulls_KinFitParticle;
-	dKinFitter->Get_Pulls(locPulls_KinFitParticle);
+	locKinFitter->Get_Pulls(locPulls_KinFitParticle);
 
 	//By looping over the pulls:
 	auto locMapIterator = locPulls_KinFitParticle.begin();
 	for(; locMapIterator != locPulls_KinFitParticle.end(); ++locMapIterator)
 	{
 		auto locOutputKinFitParticle = locMapIterator->first;
-		auto locInputKinFitParticle = dKinFitUtils->Get_InputKinFitParticle(locOutputKinFitParticle);
+		auto locInputKinFitParticle = locKinFitUtils->Get_InputKinFitParticle(locOutputKinFitParticle);
 		auto locSourceJObject = dKinFitUtils->Get_SourceJObject(locInputKinFitParticle);
 
 		locPulls_JObject[locSourceJObject] = locMapIterator->second;
@@ -543,7 +813,7 @@ DKinFitResults* DAnalysisResults_factory::Build_KinFitResults(const DParticleCom
 			continue; //*locParticleIterator was an input object //not directly used in the fit
 		}
 
-		auto locInputKinFitParticle = dKinFitUtils->Get_InputKinFitParticle(locKinFitParticle);
+		auto locInputKinFitParticle = locKinFitUtils->Get_InputKinFitParticle(locKinFitParticle);
 		if(locInputKinFitParticle != NULL)
 		{
 			locSourceJObject = dKinFitUtils->Get_SourceJObject(locInputKinFitParticle);
@@ -551,6 +821,4 @@ DKinFitResults* DAnalysisResults_factory::Build_KinFitResults(const DParticleCom
 				locKinFitResults->Add_ParticleMapping_SourceToOutput(locSourceJObject, locKinFitParticle);
 		}
 	}
-
-	return locKinFitResults;
 }
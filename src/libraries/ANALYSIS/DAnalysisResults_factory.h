@@ -23,6 +23,7 @@
 
 #include "TRACKING/DMCThrown.h"
 #include "TRIGGER/DTrigger.h"
+#include "TRACKING/DTrackFitTaskPool.h"
 
 #include "KINFITTER/DKinFitter.h"
 #include "ANALYSIS/DKinFitResults.h"
@@ -45,7 +46,14 @@ using namespace std;
 class DAnalysisResults_factory : public jana::JFactory<DAnalysisResults>
 {
 	public:
-		~DAnalysisResults_factory(void){delete dSourceComboer;}
+		~DAnalysisResults_factory(void)
+		{
+			delete dSourceComboer;
+			delete dKinFitTaskPool; //joins the helper threads
+			Delete_HelperKinFitters();
+			if(dKinFitParallelCheckFlag && (dNumParallelKinFitsChecked > 0))
+				jout << "PARALLEL KINFIT CHECK: " << dNumParallelKinFitMismatches << " of " << dNumParallelKinFitsChecked << " kinfits differ from the serial fit." << endl;
+		}
 
 	private:
 		jerror_t init(void);						///< Called once at program start.
@@ -61,6 +69,12 @@ class DAnalysisResults_factory : public jana::JFactory<DAnalysisResults>
 		const DParticleCombo* Handle_ComboFit(const DReactionVertexInfo* locReactionVertexInfo, const DParticleCombo* locParticleCombo, const DReaction* locReaction);
 		pair<shared_ptr<const DKinFitChain>, const DKinFitResults*> Fit_Kinematics(const DReactionVertexInfo* locReactionVertexInfo, const DReaction* locReaction, const DParticleCombo* locParticleCombo, DKinFitType locKinFitType, bool locUpdateCovMatricesFlag);
 		DKinFitResults* Build_KinFitResults(const DParticleCombo* locParticleCombo, DKinFitType locKinFitType, const shared_ptr<const DKinFitChain>& locKinFitChain);
+		void Fill_KinFitResults(DKinFitResults* locKinFitResults, DKinFitter* locKinFitter, const DKinFitUtils* locKinFitUtils, DKinFitType locKinFitType) const;
+
+		//PARALLEL KINFIT: same results as calling Handle_ComboFit() for each combo in order, but the fits are spread over the task pool
+		vector<const DParticleCombo*> Handle_ComboFits_Parallel(const DReactionVertexInfo* locReactionVertexInfo, const vector<const DParticleCombo*>& locParticleCombos, const DReaction* locReaction);
+		void Make_HelperKinFitters(JEventLoop* locEventLoop);
+		void Delete_HelperKinFitters(void);
 
 		unsigned int dDebugLevel = 0;
 		DApplication* dApplication;
@@ -71,11 +85,32 @@ class DAnalysisResults_factory : public jana::JFactory<DAnalysisResults>
 
 		bool dRequireKinFitConvergence = true;
 		unsigned int dKinFitDebugLevel = 0;
+		bool dKinFitDenseMatricesFlag = false;
 		DKinFitter* dKinFitter;
 		DKinFitUtils_GlueX* dKinFitUtils;
 		map<pair<set<shared_ptr<DKinFitConstraint>>, bool>, DKinFitResults*> dConstraintResultsMap; //used for determining if kinfit results will be identical //bool: update cov matrix flag
 		map<tuple<const DParticleCombo*, DKinFitType, bool, set<size_t>>, const DParticleCombo*> dPreToPostKinFitComboMap; //set: no-mass-constrain steps //bool: update cov matrix flag
 
+		//PARALLEL KINFIT
+		class DKinFitTask
+		{
+			public:
+				pair<set<shared_ptr<DKinFitConstraint>>, bool> dResultPair; //same key as dConstraintResultsMap
+				DKinFitResults* dKinFitResults = nullptr; //not registered in dCreatedKinFitResults until merged
+				const DKinFitUtils* dKinFitUtils = nullptr; //the one used for the fit: has the output -> input mapping
+				bool dFitStatus = false;
+		};
+		void Check_ParallelKinFits(const vector<DKinFitTask>& locKinFitTasks, bool locUpdateCovMatricesFlag);
+
+		unsigned int dKinFitParallelThreads = 0; //# helper threads: 0 to fit all combos in the event processing thread
+		unsigned int dKinFitParallelMinCombos = 20;
+		bool dKinFitParallelCheckFlag = false; //redo the parallel fits serially and compare
+		size_t dNumParallelKinFitsChecked = 0;
+		size_t dNumParallelKinFitMismatches = 0;
+		DTrackFitTaskPool* dKinFitTaskPool = nullptr;
+		vector<DKinFitUtils_GlueX*> dHelperKinFitUtils; //one per helper thread (worker 0 uses dKinFitUtils)
+		vector<DKinFitter*> dHelperKinFitters; //one per helper thread (worker 0 uses dKinFitter)
+
 		DResourcePool<DKinFitResults> dResourcePool_KinFitResults;
 		vector<DKinFitResults*> dCreatedKinFitResults;
 		DKinFitResults* Get_KinFitResultsResource(void)
@@ -1,3 +1,5 @@
+#include <JANA/JParameterManager.h>
+
 #include "DTreeInterface.h"
 
 /************************************************* STATIC-VARIABLE-ACCESSING PRIVATE MEMBER FUNCTIONS *************************************************/
@@ -25,6 +27,13 @@ map<string, size_t>& DTreeInterface::Get_FundamentalArraySizeMap(TTree* locTree)
 	return locTreeSpecificMap;
 }
 
+mutex& DTreeInterface::Get_FillDataMutex(void)
+{
+	//Not a japp lock: DTreeFillData's may be thread_local, and so may be deleted very late
+	static mutex locFillDataMutex;
+	return locFillDataMutex;
+}
+
 /********************************************************************* INITIALIZE *********************************************************************/
 
 DTreeInterface* DTreeInterface::Create_DTreeInterface(string locTreeName, string locFileName)
@@ -53,11 +62,27 @@ dTreeIndex_MajorBranchName("0"), dTreeIndex_MinorBranchName("0")
 	japp->RootUnLock();
 
 	GetOrCreate_FileAndTree(locTreeName);
+	dFundamentalArraySizeMap = &Get_FundamentalArraySizeMap(dTree);
+
+	gPARMS->SetDefaultParameter("ANALYSIS:TREE_FILL_BATCH_SIZE", dFillBatchSize, "Number of entries each thread buffers before writing them to the tree (1: write each entry when filled)");
+	if(dFillBatchSize == 0)
+		dFillBatchSize = 1;
 }
 
 //Destructor
 DTreeInterface::~DTreeInterface(void)
 {
+	//Write the entries still buffered in the fill data objects
+	{
+		lock_guard<mutex> locFillDataLock(Get_FillDataMutex());
+		for(auto& locTreeFillData : dRegisteredFillData)
+		{
+			Flush(*locTreeFillData);
+			locTreeFillData->dTreeInterface = nullptr;
+		}
+		dRegisteredFillData.clear();
+	}
+
 	japp->RootWriteLock();
 	{
 		map<string, int>& locNumWritersByFileMap = Get_NumWritersByFileMap();
@@ -127,8 +152,8 @@ bool DTreeInterface::Create_Branches(const DTreeBranchRegister& locTreeBranchReg
 	//return value: true if created, false if previously created (nothing done here)
 		//if false, user can safely delete memory in the branch register UserInfo TList
 
-	//MUST CARRY AROUND A REFERENCE TO THIS.  ONLY READ/MODIFY THE MAP WITHIN A FILE LOCK. 
-	map<string, size_t>& locFundamentalArraySizeMap = Get_FundamentalArraySizeMap(dTree);
+	//ONLY READ/MODIFY THE MAP WITHIN A FILE LOCK. 
+	map<string, size_t>& locFundamentalArraySizeMap = *dFundamentalArraySizeMap;
 
 	japp->WriteLock(dFileName); //LOCK FILE
 	{
@@ -240,145 +265,155 @@ void DTreeInterface::Create_Branch(string locBranchName, type_index locTypeIndex
 
 void DTreeInterface::Fill(DTreeFillData& locTreeFillData)
 {
-	//MUST CARRY AROUND A REFERENCE TO THIS.  ONLY READ/MODIFY THE MAP WITHIN A FILE LOCK. 
-	map<string, size_t>& locFundamentalArraySizeMap = Get_FundamentalArraySizeMap(dTree);
+	//Find the branches for the fill data on the first fill, and again if branches have been added to it since
+	if((locTreeFillData.dTreeInterface != this) || (locTreeFillData.dNumCompiledBranches != locTreeFillData.dFillData.size()))
+		Compile_FillSlots(locTreeFillData);
+
+	//Copy the entry to the buffer: No lock needed, the fill data is only used by this thread
+	vector<char>& locBuffer = locTreeFillData.dBuffer;
+	for(auto& locFillSlot : locTreeFillData.dFillSlots)
+	{
+		//check if is array. if not, copy
+		if(locFillSlot.dLargestIndexFilled == nullptr)
+		{
+			locFillSlot.dFillObject->Copy_ToBuffer(1, locBuffer);
+			continue;
+		}
+
+		//is array, store how many, then copy
+		UInt_t locNumValues = *locFillSlot.dLargestIndexFilled + 1;
+		size_t locOffset = locBuffer.size();
+		locBuffer.resize(locOffset + sizeof(UInt_t));
+		memcpy(locBuffer.data() + locOffset, &locNumValues, sizeof(UInt_t));
+		locFillSlot.dFillObject->Copy_ToBuffer(locNumValues, locBuffer);
+
+		//reset DTreeFillData for next event!
+		*locFillSlot.dLargestIndexFilled = -1;
+	}
+	++locTreeFillData.dNumBufferedEntries;
+
+	//Write the batch to the tree once it is full
+	if(locTreeFillData.dNumBufferedEntries >= dFillBatchSize)
+		Flush(locTreeFillData);
+
+	//Reset fill vectors if too large!!
+	for(auto& locBranchPair : locTreeFillData.dFillData)
+		locBranchPair.second.second->Check_Capacity();
+}
+
+void DTreeInterface::Flush(DTreeFillData& locTreeFillData)
+{
+	if((locTreeFillData.dTreeInterface != this) || (locTreeFillData.dNumBufferedEntries == 0))
+		return;
+
 	japp->WriteLock(dFileName); //LOCK FILE
 	{
-		//loop over branches
-		for(auto locBranchPair : locTreeFillData.dFillData)
+		//for each entry: copy the values to the branch memory, then fill the tree
+		const char* locBuffer = locTreeFillData.dBuffer.data();
+		for(size_t loc_i = 0; loc_i < locTreeFillData.dNumBufferedEntries; ++loc_i)
 		{
-			//type
-			auto locBranchName = locBranchPair.first;
-			auto locTypeIndex = locBranchPair.second.first;
-			auto locFillBaseClass = locBranchPair.second.second;
+			for(auto& locFillSlot : locTreeFillData.dFillSlots)
+				(*locFillSlot.dFlushFunction)(locFillSlot, locBuffer);
+			dTree->Fill();
+		}
+	}
+	japp->Unlock(dFileName); //UNLOCK FILE
 
-			if(dTree->GetBranch(locBranchName.c_str()) == NULL)
+	locTreeFillData.dBuffer.clear();
+	locTreeFillData.dNumBufferedEntries = 0;
+}
+
+void DTreeInterface::Compile_FillSlots(DTreeFillData& locTreeFillData)
+{
+	//The buffered entries (if any) were made with the old slots: write them first
+	Release_FillData(&locTreeFillData);
+	locTreeFillData.dFillSlots.clear();
+
+	japp->WriteLock(dFileName); //LOCK FILE
+	{
+		//loop over branches
+		for(auto& locBranchPair : locTreeFillData.dFillData)
+		{
+			const string& locBranchName = locBranchPair.first;
+			TBranch* locBranch = dTree->GetBranch(locBranchName.c_str());
+			if(locBranch == NULL)
 			{
 				cout << "WARNING, CANNOT FILL DATA, BRANCH " << locBranchName << " DOES NOT EXIST." << endl;
 				continue;
 			}
 
-			//check if is array. if not, fill
+			DTreeFillSlot locFillSlot;
+			locFillSlot.dFillObject = locBranchPair.second.second;
+			locFillSlot.dBranch = locBranch;
+			locFillSlot.dFlushFunction = Get_FlushFunction(locBranchPair.second.first);
+
+			//check if is array
 			auto locLargestIndexFilledIterator = locTreeFillData.dArrayLargestIndexFilledMap.find(locBranchName);
 			bool locIsArrayFlag = (locLargestIndexFilledIterator != locTreeFillData.dArrayLargestIndexFilledMap.end());
-			if(!locIsArrayFlag)
-			{
-				Fill(locBranchName, locTypeIndex, locFillBaseClass->Get(0), false);
-				continue;
-			}
-
-			//is array, get how many to fill
-			auto& locLargestIndexFilled = locLargestIndexFilledIterator->second;
-
-			//increase array size if necessary, or decrease if too large from last event
-			auto locFundamentalArraySizeIterator = locFundamentalArraySizeMap.find(locBranchName);
-			if(locFundamentalArraySizeIterator != locFundamentalArraySizeMap.end())
-			{
-				size_t locCurrentArraySize = locFundamentalArraySizeMap[locBranchName]; //may not be in map! (tobj)
-				if((locLargestIndexFilled + 1) > int(locCurrentArraySize))
-				{
-					Change_ArraySize(locBranchName, locTypeIndex, locLargestIndexFilled + 1);
-					locFundamentalArraySizeMap[locBranchName] = locLargestIndexFilled + 1;
-				}
-/*				else if(locCurrentArraySize > dMaxArraySize)
-				{
-					Change_ArraySize(locBranchName, locTypeIndex, dMaxArraySize);
-					locFundamentalArraySizeMap[locBranchName] = dMaxArraySize;
-				} */
-			}
-			else //is clones array: clear it
-			{
-				auto locClonesArray = Get_Pointer_TClonesArray(locBranchName);
-				locClonesArray->Clear(); //empties array
-//				if(size_t(locClonesArray->GetEntriesFast()) > dMaxArraySize)
-//					locClonesArray->Expand(dMaxArraySize);
-			}
+			locFillSlot.dLargestIndexFilled = locIsArrayFlag ? &(locLargestIndexFilledIterator->second) : nullptr;
 
-			//fill array
-			for(int locArrayIndex = 0; locArrayIndex <= locLargestIndexFilled; ++locArrayIndex)
-				Fill(locBranchName, locTypeIndex, locFillBaseClass->Get(locArrayIndex), true, locArrayIndex);
+			//not in map if clones array
+			auto locFundamentalArraySizeIterator = dFundamentalArraySizeMap->find(locBranchName);
+			bool locIsFundamentalArrayFlag = (locFundamentalArraySizeIterator != dFundamentalArraySizeMap->end());
+			locFillSlot.dArraySize = locIsFundamentalArrayFlag ? &(locFundamentalArraySizeIterator->second) : nullptr;
 
-			//reset DTreeFillData for next event!
-			locLargestIndexFilled = -1;
+			locTreeFillData.dFillSlots.push_back(locFillSlot);
 		}
-
-		//fill tree
-		dTree->Fill();
 	}
 	japp->Unlock(dFileName); //UNLOCK FILE
 
-	//Reset fill vectors if too large!!
-	for(auto locBranchPair : locTreeFillData.dFillData)
-		locBranchPair.second.second->Check_Capacity();
+	locTreeFillData.dNumCompiledBranches = locTreeFillData.dFillData.size();
+
+	lock_guard<mutex> locFillDataLock(Get_FillDataMutex());
+	locTreeFillData.dTreeInterface = this;
+	dRegisteredFillData.insert(&locTreeFillData);
 }
 
-void DTreeInterface::Change_ArraySize(string locBranchName, type_index locTypeIndex, size_t locNewArraySize)
+void DTreeInterface::Release_FillData(DTreeFillData* locTreeFillData)
 {
-	//Fundamental types
-	if(locTypeIndex == type_index(typeid(Char_t)))
-		Change_ArraySize<Char_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(UChar_t)))
-		Change_ArraySize<UChar_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Short_t)))
-		Change_ArraySize<Short_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(UShort_t)))
-		Change_ArraySize<UShort_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Int_t)))
-		Change_ArraySize<Int_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(UInt_t)))
-		Change_ArraySize<UInt_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Float_t)))
-		Change_ArraySize<Float_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Double_t)))
-		Change_ArraySize<Double_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Long64_t)))
-		Change_ArraySize<Long64_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(ULong64_t)))
-		Change_ArraySize<ULong64_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Bool_t)))
-		Change_ArraySize<Bool_t>(locBranchName, locNewArraySize);
+	//Write the buffered entries, and forget the fill data: Called when it is deleted, or filled to a new layout
+	lock_guard<mutex> locFillDataLock(Get_FillDataMutex());
+
+	DTreeInterface* locTreeInterface = locTreeFillData->dTreeInterface;
+	if(locTreeInterface == nullptr)
+		return;
+
+	locTreeInterface->Flush(*locTreeFillData);
+	locTreeInterface->dRegisteredFillData.erase(locTreeFillData);
+	locTreeFillData->dTreeInterface = nullptr;
 }
 
-void DTreeInterface::Fill(string locBranchName, type_index locTypeIndex, void* locVoidPointer, bool locIsArrayFlag, size_t locArrayIndex)
+DTreeInterface::DFlushFunction DTreeInterface::Get_FlushFunction(type_index locTypeIndex) const
 {
 	//Fundamental types
 	if(locTypeIndex == type_index(typeid(Char_t)))
-		Get_Pointer_Fundamental<Char_t>(locBranchName)[locArrayIndex] = *(static_cast<Char_t*>(locVoidPointer));
+		return &Flush_Slot<Char_t>;
 	else if(locTypeIndex == type_index(typeid(UChar_t)))
-		Get_Pointer_Fundamental<UChar_t>(locBranchName)[locArrayIndex] = *(static_cast<UChar_t*>(locVoidPointer));
+		return &Flush_Slot<UChar_t>;
 	else if(locTypeIndex == type_index(typeid(Short_t)))
-		Get_Pointer_Fundamental<Short_t>(locBranchName)[locArrayIndex] = *(static_cast<Short_t*>(locVoidPointer));
+		return &Flush_Slot<Short_t>;
 	else if(locTypeIndex == type_index(typeid(UShort_t)))
-		Get_Pointer_Fundamental<UShort_t>(locBranchName)[locArrayIndex] = *(static_cast<UShort_t*>(locVoidPointer));
+		return &Flush_Slot<UShort_t>;
 	else if(locTypeIndex == type_index(typeid(Int_t)))
-		Get_Pointer_Fundamental<Int_t>(locBranchName)[locArrayIndex] = *(static_cast<Int_t*>(locVoidPointer));
+		return &Flush_Slot<Int_t>;
 	else if(locTypeIndex == type_index(typeid(UInt_t)))
-		Get_Pointer_Fundamental<UInt_t>(locBranchName)[locArrayIndex] = *(static_cast<UInt_t*>(locVoidPointer));
+		return &Flush_Slot<UInt_t>;
 	else if(locTypeIndex == type_index(typeid(Float_t)))
-		Get_Pointer_Fundamental<Float_t>(locBranchName)[locArrayIndex] = *(static_cast<Float_t*>(locVoidPointer));
+		return &Flush_Slot<Float_t>;
 	else if(locTypeIndex == type_index(typeid(Double_t)))
-		Get_Pointer_Fundamental<Double_t>(locBranchName)[locArrayIndex] = *(static_cast<Double_t*>(locVoidPointer));
+		return &Flush_Slot<Double_t>;
 	else if(locTypeIndex == type_index(typeid(Long64_t)))
-		Get_Pointer_Fundamental<Long64_t>(locBranchName)[locArrayIndex] = *(static_cast<Long64_t*>(locVoidPointer));
+		return &Flush_Slot<Long64_t>;
 	else if(locTypeIndex == type_index(typeid(ULong64_t)))
-		Get_Pointer_Fundamental<ULong64_t>(locBranchName)[locArrayIndex] = *(static_cast<ULong64_t*>(locVoidPointer));
+		return &Flush_Slot<ULong64_t>;
 	else if(locTypeIndex == type_index(typeid(Bool_t)))
-		Get_Pointer_Fundamental<Bool_t>(locBranchName)[locArrayIndex] = *(static_cast<Bool_t*>(locVoidPointer));
+		return &Flush_Slot<Bool_t>;
 
 	//TObject
-	else if(locTypeIndex == type_index(typeid(TVector3)))
-	{
-		TVector3& locObject = *(static_cast<TVector3*>(locVoidPointer));
-		Fill_TObject<TVector3>(locBranchName, locObject, locIsArrayFlag, locArrayIndex);
-	}
 	else if(locTypeIndex == type_index(typeid(TVector2)))
-	{
-		TVector2& locObject = *(static_cast<TVector2*>(locVoidPointer));
-		Fill_TObject<TVector2>(locBranchName, locObject, locIsArrayFlag, locArrayIndex);
-	}
-	else if(locTypeIndex == type_index(typeid(TLorentzVector)))
-	{
-		TLorentzVector& locObject = *(static_cast<TLorentzVector*>(locVoidPointer));
-		Fill_TObject<TLorentzVector>(locBranchName, locObject, locIsArrayFlag, locArrayIndex);
-	}
+		return &Flush_Slot<TVector2>;
+	else if(locTypeIndex == type_index(typeid(TVector3)))
+		return &Flush_Slot<TVector3>;
+	else //TLorentzVector: type is checked by DTreeTypeChecker when filled
+		return &Flush_Slot<TLorentzVector>;
 }
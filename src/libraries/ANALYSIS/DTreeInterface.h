@@ -2,6 +2,8 @@
 #define DTreeInterface_h
 
 #include <map>
+#include <set>
+#include <mutex>
 #include <typeindex>
 #include <typeinfo>
 #include <type_traits>
@@ -41,6 +43,12 @@ class DTreeInterface
 	//ASSUME: Tree only stores: Fundamental type objects (not const char*!!), Fundamental type arrays, TObject's, TClonesArray's
 	//ASSUME: TObject's are of type TVector3 & TLorentzVector: Need to expand template type calls if more are used
 
+	//Fill() does not write to the tree right away: the entry is copied into a buffer in the DTreeFillData (one per thread)
+		//Once ANALYSIS:TREE_FILL_BATCH_SIZE entries are buffered, they are all written to the tree within a single file lock
+		//Anything left is written when either the DTreeFillData or the DTreeInterface is deleted, or when Flush() is called
+
+	friend class DTreeFillData;
+
 	public:
 
 		/**************************************************************** INITIALIZE ****************************************************************/
@@ -66,6 +74,7 @@ class DTreeInterface
 		/******************************************************************* FILL *******************************************************************/
 
 		void Fill(DTreeFillData& locTreeFillData); //not const: needs to reset arrays
+		void Flush(DTreeFillData& locTreeFillData); //write the buffered entries to the tree now
 
 	private:
 
@@ -104,16 +113,19 @@ class DTreeInterface
 
 		/******************************************************************* FILL *******************************************************************/
 
-		void Change_ArraySize(string locBranchName, type_index locTypeIndex, size_t locNewArraySize);
-		template <typename DType> void Change_ArraySize(string locBranchName, int locNewArraySize);
-		void Fill(string locBranchName, type_index locTypeIndex, void* locVoidPointer, bool locIsArrayFlag, size_t locArrayIndex = 0);
-		template <typename DType> void Fill_TObject(string locBranchName, DType& locObject, bool locIsArrayFlag, size_t locArrayIndex);
+		void Compile_FillSlots(DTreeFillData& locTreeFillData);
+		static void Release_FillData(DTreeFillData* locTreeFillData);
 
-		/*************************************************************** GET POINTERS ***************************************************************/
+		typedef void (*DFlushFunction)(const DTreeFillSlot& locFillSlot, const char*& locBuffer);
+		DFlushFunction Get_FlushFunction(type_index locTypeIndex) const;
 
-		template <typename DType> DType* Get_Pointer_Fundamental(string locBranchName) const;
-		template <typename DType> DType* Get_Pointer_TObject(string locBranchName) const;
-		TClonesArray* Get_Pointer_TClonesArray(string locBranchName);
+		//Enable this version if type inherits from TObject //void: is return type
+		template <typename DType> static typename enable_if<std::is_base_of<TObject, DType>::value, void>::type
+				Flush_Slot(const DTreeFillSlot& locFillSlot, const char*& locBuffer);
+
+		//Enable this version if type does NOT inherit from TObject //void: is return type
+		template <typename DType> static typename enable_if<!std::is_base_of<TObject, DType>::value, void>::type
+				Flush_Slot(const DTreeFillSlot& locFillSlot, const char*& locBuffer);
 
 		/******************************************** STATIC-VARIABLE-ACCESSING PRIVATE MEMBER FUNCTIONS ********************************************/
 
@@ -137,6 +149,7 @@ class DTreeInterface
 
 		map<string, int>& Get_NumWritersByFileMap(void) const;
 		map<string, size_t>& Get_FundamentalArraySizeMap(TTree* locTree) const;
+		static mutex& Get_FillDataMutex(void); //for DTreeFillData::dTreeInterface & dRegisteredFillData
 
 		/************************************************************** MEMBER VARIABLES ************************************************************/
 
@@ -144,6 +157,8 @@ class DTreeInterface
 		string dFileName;
 		string dTreeIndex_MajorBranchName;
 		string dTreeIndex_MinorBranchName;
+		map<string, size_t>* dFundamentalArraySizeMap; //ONLY READ/MODIFY THE MAP WITHIN A FILE LOCK
+		set<DTreeFillData*> dRegisteredFillData; //fill data with slots for this interface: may have entries buffered
 
 		/******************************************************** BRANCH MEMORY AND TYPE MAPPING ****************************************************/
 
@@ -152,31 +167,11 @@ class DTreeInterface
 			//However, for fundamental objects/arrays: memory stored in the branches themselves: don't need to hold onto them
 		size_t dMaxArraySize = 1000;
 		Long64_t dAutoFlush = -5000000; //if 200 trees at once, and want them to take at most 1GB of RAM before flush, then flush every 5MB: -5000000 //default every 30MB
+		unsigned int dFillBatchSize = 32; //ANALYSIS:TREE_FILL_BATCH_SIZE
 		map<string, TClonesArray*> dMemoryMap_ClonesArray;
 		map<string, TObject*> dMemoryMap_TObject;
 };
 
-/******************************************************************** GET POINTERS ********************************************************************/
-
-//GET POINTERS
-template <typename DType> inline DType* DTreeInterface::Get_Pointer_Fundamental(string locBranchName) const
-{
-	TBranch* locBranch = dTree->GetBranch(locBranchName.c_str());
-	return ((locBranch != NULL) ? (DType*)locBranch->GetAddress() : NULL);
-}
-
-template <typename DType> inline DType* DTreeInterface::Get_Pointer_TObject(string locBranchName) const
-{
-	TBranch* locBranch = dTree->GetBranch(locBranchName.c_str());
-	return ((locBranch != NULL) ? *(DType**)locBranch->GetAddress() : NULL);
-}
-
-inline TClonesArray* DTreeInterface::Get_Pointer_TClonesArray(string locBranchName)
-{
-	TBranch* locBranch = dTree->GetBranch(locBranchName.c_str());
-	return ((locBranch != NULL) ? *(TClonesArray**)locBranch->GetAddress() : NULL);
-}
-
 /******************************************************************* CREATE BRANCHES ******************************************************************/
 
 template <typename DType> inline typename enable_if<std::is_base_of<TObject, DType>::value, void>::type
@@ -258,25 +253,69 @@ inline void DTreeInterface::Set_TreeIndexBranchNames(string locTreeIndex_MajorBr
 	dTreeIndex_MinorBranchName = locTreeIndex_MinorBranchName;
 }
 
-//INCREASE ARRAY SIZE
-template <typename DType> inline void DTreeInterface::Change_ArraySize(string locBranchName, int locNewArraySize)
+/******************************************************************** FLUSH SLOTS *********************************************************************/
+
+template <typename DType> inline typename enable_if<std::is_base_of<TObject, DType>::value, void>::type
+DTreeInterface::Flush_Slot(const DTreeFillSlot& locFillSlot, const char*& locBuffer)
 {
-	//create a new, larger array if the current one is too small
-		//DOES NOT copy the old results!  In other words, only call BETWEEN entries, not DURING an entry
-	DType* locOldBranchAddress = Get_Pointer_Fundamental<DType>(locBranchName);
-	dTree->SetBranchAddress(locBranchName.c_str(), new DType[locNewArraySize]);
-	delete[] locOldBranchAddress;
+	if(locFillSlot.dLargestIndexFilled == nullptr)
+	{
+		DTreeBufferTraits<DType>::Unpack(locBuffer, **(DType**)locFillSlot.dBranch->GetAddress());
+		locBuffer += DTreeBufferTraits<DType>::dSize;
+		return;
+	}
+
+	//is clones array: clear it, then fill
+	UInt_t locNumValues;
+	memcpy(&locNumValues, locBuffer, sizeof(UInt_t));
+	locBuffer += sizeof(UInt_t);
+
+	TClonesArray* locClonesArray = *(TClonesArray**)locFillSlot.dBranch->GetAddress();
+	locClonesArray->Clear(); //empties array
+	for(UInt_t loc_i = 0; loc_i < locNumValues; ++loc_i, locBuffer += DTreeBufferTraits<DType>::dSize)
+		DTreeBufferTraits<DType>::Unpack(locBuffer, *(DType*)locClonesArray->ConstructedAt(loc_i));
 }
 
-template <typename DType> inline void DTreeInterface::Fill_TObject(string locBranchName, DType& locObject, bool locIsArrayFlag, size_t locArrayIndex)
+template <typename DType> inline typename enable_if<!std::is_base_of<TObject, DType>::value, void>::type
+DTreeInterface::Flush_Slot(const DTreeFillSlot& locFillSlot, const char*& locBuffer)
 {
-	if(locIsArrayFlag)
+	if(locFillSlot.dLargestIndexFilled == nullptr)
 	{
-		TClonesArray* locClonesArray = Get_Pointer_TClonesArray(locBranchName);
-		*(DType*)locClonesArray->ConstructedAt(locArrayIndex) = locObject;
+		memcpy(locFillSlot.dBranch->GetAddress(), locBuffer, sizeof(DType));
+		locBuffer += sizeof(DType);
+		return;
 	}
-	else
-		*Get_Pointer_TObject<DType>(locBranchName) = locObject;
+
+	//is fundamental array
+	UInt_t locNumValues;
+	memcpy(&locNumValues, locBuffer, sizeof(UInt_t));
+	locBuffer += sizeof(UInt_t);
+
+	//create a new, larger array if the current one is too small
+		//DOES NOT copy the old results!  Only done BETWEEN entries
+	if(locNumValues > *locFillSlot.dArraySize)
+	{
+		DType* locOldBranchAddress = (DType*)locFillSlot.dBranch->GetAddress();
+		locFillSlot.dBranch->GetTree()->SetBranchAddress(locFillSlot.dBranch->GetName(), new DType[locNumValues]);
+		delete[] locOldBranchAddress;
+		*locFillSlot.dArraySize = locNumValues;
+	}
+
+	memcpy(locFillSlot.dBranch->GetAddress(), locBuffer, locNumValues*sizeof(DType));
+	locBuffer += locNumValues*sizeof(DType);
+}
+
+/************************************************************* DTreeFillData: DESTRUCTOR **************************************************************/
+
+inline DTreeFillData::~DTreeFillData(void)
+{
+	//write any buffered entries to the tree
+	DTreeInterface::Release_FillData(this);
+
+	//delete all memory (void*'s)
+	//loop over branches
+	for(auto& locBranchPair : dFillData)
+		delete locBranchPair.second.second;
 }
 
 #endif //DTreeInterface_h
@@ -7,6 +7,7 @@
 #include <string>
 #include <deque>
 #include <vector>
+#include <cstring>
 
 #include "TVector2.h"
 #include "TVector3.h"
@@ -15,6 +16,7 @@
 using namespace std;
 
 class DTreeInterface;
+class TBranch;
 
 /***************************************************************** DTreeTypeChecker *******************************************************************/
 
@@ -105,6 +107,65 @@ template <typename DType> inline void DTreeBranchRegister::Register_ClonesArray(
 	dInitialArraySizeMap[locBranchName] = locInitialArraySize;
 }
 
+/***************************************************************** DTreeBufferTraits ******************************************************************/
+
+//How a value is stored in the DTreeFillData buffer of entries waiting to be written to the tree
+	//Fundamental types are copied as-is, TObject's are stored as their components
+template <typename DType> struct DTreeBufferTraits
+{
+	static const size_t dSize = sizeof(DType);
+	static void Pack(const DType& locData, char* locBuffer){memcpy(locBuffer, &locData, sizeof(DType));}
+	static void Unpack(const char* locBuffer, DType& locData){memcpy(&locData, locBuffer, sizeof(DType));}
+};
+
+template <> struct DTreeBufferTraits<TVector2>
+{
+	static const size_t dSize = 2*sizeof(Double_t);
+	static void Pack(const TVector2& locData, char* locBuffer)
+	{
+		Double_t locValues[2] = {locData.X(), locData.Y()};
+		memcpy(locBuffer, locValues, dSize);
+	}
+	static void Unpack(const char* locBuffer, TVector2& locData)
+	{
+		Double_t locValues[2];
+		memcpy(locValues, locBuffer, dSize);
+		locData.Set(locValues[0], locValues[1]);
+	}
+};
+
+template <> struct DTreeBufferTraits<TVector3>
+{
+	static const size_t dSize = 3*sizeof(Double_t);
+	static void Pack(const TVector3& locData, char* locBuffer)
+	{
+		Double_t locValues[3] = {locData.X(), locData.Y(), locData.Z()};
+		memcpy(locBuffer, locValues, dSize);
+	}
+	static void Unpack(const char* locBuffer, TVector3& locData)
+	{
+		Double_t locValues[3];
+		memcpy(locValues, locBuffer, dSize);
+		locData.SetXYZ(locValues[0], locValues[1], locValues[2]);
+	}
+};
+
+template <> struct DTreeBufferTraits<TLorentzVector>
+{
+	static const size_t dSize = 4*sizeof(Double_t);
+	static void Pack(const TLorentzVector& locData, char* locBuffer)
+	{
+		Double_t locValues[4] = {locData.X(), locData.Y(), locData.Z(), locData.T()};
+		memcpy(locBuffer, locValues, dSize);
+	}
+	static void Unpack(const char* locBuffer, TLorentzVector& locData)
+	{
+		Double_t locValues[4];
+		memcpy(locValues, locBuffer, dSize);
+		locData.SetXYZT(locValues[0], locValues[1], locValues[2], locValues[3]);
+	}
+};
+
 /******************************************************************* DTreeFillData ********************************************************************/
 
 //Want to abstract the fill type so we can hold them in a container without dynamically allocating void*'s
@@ -114,6 +175,7 @@ class DFillBaseClass
 		virtual ~DFillBaseClass(){};
 		virtual void* Get(size_t locArrayIndex) = 0;
 		virtual void Check_Capacity(void) = 0;
+		virtual void Copy_ToBuffer(size_t locNumValues, vector<char>& locBuffer) const = 0; //appends the first locNumValues values
 };
 
 template <typename DType>
@@ -126,6 +188,7 @@ class DFillClass : public DFillBaseClass
 
 		void* Get(size_t locArrayIndex){return static_cast<void*>(&(dFillData[locArrayIndex]));}
 		void Check_Capacity(void);
+		void Copy_ToBuffer(size_t locNumValues, vector<char>& locBuffer) const;
 
 	private:
 		size_t dMaxFillVectorSize = 1000; //if exceeds this, will drop down on next event
@@ -138,6 +201,27 @@ template <typename DType> inline void DFillClass<DType>::Check_Capacity(void)
 	dFillData.resize(dMaxFillVectorSize);
 }
 
+template <typename DType> inline void DFillClass<DType>::Copy_ToBuffer(size_t locNumValues, vector<char>& locBuffer) const
+{
+	size_t locOffset = locBuffer.size();
+	locBuffer.resize(locOffset + locNumValues*DTreeBufferTraits<DType>::dSize);
+	char* locDestination = locBuffer.data() + locOffset;
+	for(size_t loc_i = 0; loc_i < locNumValues; ++loc_i, locDestination += DTreeBufferTraits<DType>::dSize)
+		DTreeBufferTraits<DType>::Pack(dFillData[loc_i], locDestination);
+}
+
+//One per branch filled by a DTreeFillData: made by DTreeInterface the first time the DTreeFillData is filled to it
+	//Replaces the look-ups by branch name with pointers, so that each fill is just a copy into the DTreeFillData buffer
+class DTreeFillSlot
+{
+	public:
+		DFillBaseClass* dFillObject; //in DTreeFillData::dFillData
+		int* dLargestIndexFilled; //in DTreeFillData::dArrayLargestIndexFilledMap: nullptr if not an array
+		TBranch* dBranch;
+		size_t* dArraySize; //current size of the branch memory if fundamental array (shared by all interfaces to the tree): else nullptr
+		void (*dFlushFunction)(const DTreeFillSlot& locFillSlot, const char*& locBuffer); //copies the values from the buffer to the branch
+};
+
 //Need one per thread:
 	//If this is created within the scope of a single object that is shared amongst all threads (e.g. plugin processor): static thread-local variable
 		//Data stored as void*: Requires new on creation and delete on destruction: Try to re-use object
@@ -154,6 +238,16 @@ class DTreeFillData
 	private:
 		map<string, pair<type_index, DFillBaseClass*> > dFillData;
 		map<string, int> dArrayLargestIndexFilledMap; //can be less than the size //reset by DTreeInterface after fill
+
+		//Layout, made by DTreeInterface on the first fill, and again whenever new branches are added to dFillData
+		DTreeInterface* dTreeInterface = nullptr; //the layout and the buffered entries belong to this interface
+		size_t dNumCompiledBranches = 0;
+		vector<DTreeFillSlot> dFillSlots;
+
+		//Entries not yet written to the tree: the values of every slot, in slot order
+			//For arrays, the number of values (UInt_t) is stored before the values
+		vector<char> dBuffer;
+		size_t dNumBufferedEntries = 0;
 };
 
 /*********************************************************** DTreeFillData: FILL BRANCHES *************************************************************/
@@ -223,14 +317,6 @@ template <typename DType> typename enable_if<std::is_base_of<TObject, DType>::va
 template <typename DType> typename enable_if<!std::is_base_of<TObject, DType>::value, void>::type
 		Create_Branch(string locBranchName, size_t locArraySize, string locArraySizeName);
 */
-/************************************************************* DTreeFillData: DESTRUCTOR **************************************************************/
-
-inline DTreeFillData::~DTreeFillData(void)
-{
-	//delete all memory (void*'s)
-	//loop over branches
-	for(auto& locBranchPair : dFillData)
-		delete locBranchPair.second.second;
-}
+//DTreeFillData destructor: defined in DTreeInterface.h (must write any buffered entries to the tree first)
 
 #endif //DTreeInterfaceObjects
@@ -24,17 +24,13 @@ using namespace std::chrono;
 //---------------------------------
 DEVIOWorkerThread::DEVIOWorkerThread(
 	 JEventSource_EVIOpp  *event_source
-	 ,list<DParsedEvent*> &parsed_events
+	 ,DParsedEventRing    &parsed_events
 	 ,uint32_t            &MAX_PARSED_EVENTS
-	 ,mutex               &PARSED_EVENTS_MUTEX
-	 ,condition_variable  &PARSED_EVENTS_CV
 	 ,set<uint32_t>       &ROCIDS_TO_PARSE
 	 ):
 	 event_source(event_source)
 	,parsed_events(parsed_events)
 	,MAX_PARSED_EVENTS(MAX_PARSED_EVENTS)
-	,PARSED_EVENTS_MUTEX(PARSED_EVENTS_MUTEX)
-	,PARSED_EVENTS_CV(PARSED_EVENTS_CV)
 	,ROCIDS_TO_PARSE(ROCIDS_TO_PARSE)
 	,done(false)
 	,thd(&DEVIOWorkerThread::Run,this)
@@ -59,6 +55,7 @@ DEVIOWorkerThread::DEVIOWorkerThread(
 
 	buff_len            = 100;   // this will grow as needed
 	buff                = new uint32_t[buff_len];
+	mapped_event        = NULL;  // Set in JEventSource_EVIOpp::Dispatcher() when reading via mmap
 
 	PARSE_F250          = true;
 	PARSE_F125          = true;
@@ -104,13 +101,19 @@ void DEVIOWorkerThread::Run(void)
 
 		try {
 
-			if( jobtype & JOB_SWAP       ) swap_bank(buff, buff, swap32(buff[0])+1 );
+			if( jobtype & JOB_SWAP       ){
+				if( mapped_event ){
+					// Mapped memory is read-only so swap while copying into buff
+					swap_bank(buff, mapped_event, swap32(mapped_event[0])+1 );
+					mapped_event = NULL;
+				}else{
+					swap_bank(buff, buff, swap32(buff[0])+1 );
+				}
+			}
 
 			if( jobtype & JOB_FULL_PARSE ) MakeEvents();
 			
 			if( jobtype & JOB_ASSOCIATE  ) LinkAllAssociations();
-			
-			if( !current_parsed_events.empty() ) PublishEvents();
             
 		} catch( JExceptionDataFormat &e ){
 			for(auto pe : parsed_event_pool) delete pe; // delete all parsed events any any objects they hold
@@ -129,7 +132,12 @@ void DEVIOWorkerThread::Run(void)
 			japp->Quit(-1);
 		}
 		
+		// Always publish, even if no events were made, so the
+		// consumer does not wait forever on this istreamorder
+		PublishEvents();
+		
 		// Reset and mark us as available for use
+		mapped_event = NULL;
 		jobtype = JOB_NONE;
 		in_use  = false;
 
@@ -206,7 +214,7 @@ void DEVIOWorkerThread::MakeEvents(void)
 	
 	if(!current_parsed_events.empty()) throw JException("Attempting call to DEVIOWorkerThread::MakeEvents when current_parsed_events not empty!!", __FILE__, __LINE__);
 	
-	uint32_t *iptr = buff;
+	uint32_t *iptr = mapped_event ? mapped_event:buff;
 	
 	uint32_t M = 1;
 	uint64_t event_num = 0;
@@ -283,37 +291,46 @@ void DEVIOWorkerThread::MakeEvents(void)
 //---------------------------------
 void DEVIOWorkerThread::PublishEvents(void)
 {	
-	/// Copy our "current_parsed_events" pointers into the global "parsed_events"
-	/// list making them available for consumption. 
-	
-	// Lock mutex so other threads can't modify parsed_events
-	unique_lock<mutex> lck(PARSED_EVENTS_MUTEX);
-	
-	// Make sure we don't exceed the maximum number of simultaneous
-	// parsed events. If the done flag is set, go ahead and add
-	// this regardless
-	while( ((current_parsed_events.size()+parsed_events.size())>=MAX_PARSED_EVENTS) && !done ){
-		event_source->NPARSER_STALLED++;
-		PARSED_EVENTS_CV.wait_for(lck, std::chrono::milliseconds(1));
-	}
+	/// Move our "current_parsed_events" pointers into the parsed_events
+	/// ring making them available for consumption. All events made from
+	/// this EVIO event go in with a single atomic store into the slot
+	/// for our istreamorder. This is called for every job, even if
+	/// current_parsed_events is empty, since the consumer takes slots
+	/// strictly in istreamorder.
+	///
+	/// We stall here if the ring slot is still in use or if adding
+	/// these would make the ring hold more than MAX_PARSED_EVENTS.
+	/// The latter is not enforced if we hold the very next event the
+	/// consumer needs (otherwise everyone could end up waiting on us)
+	/// or if the done flag is set.
 	
-	// Loop over all elements of parsed_events and insert
-	// these based on istreamorder so that the front element
-	// is the most recent.
-	bool inserted = false;
-	for(auto it = parsed_events.begin(); it!=parsed_events.end(); it++){
-		if( istreamorder < (*it)->istreamorder ){
-			parsed_events.insert(it, current_parsed_events.begin(), current_parsed_events.end());
-			inserted = true;
+	uint32_t Nspins = 0;
+	while( true ){
+
+		bool too_many = (parsed_events.GetNevents()+current_parsed_events.size()) >= MAX_PARSED_EVENTS;
+		if( too_many && !done && (istreamorder != parsed_events.GetHead()) ){
+			// (fall through to stall below)
+		}else if( parsed_events.TryPush(istreamorder, current_parsed_events) ){
+			break;
+		}
+		
+		// If the event source is being destroyed then no one will
+		// ever consume these so just return them to the pool.
+		if( event_source->DONE ){
+			for(auto pe : current_parsed_events) pe->in_use = false;
 			break;
 		}
-	}
-	
-	// In case this should go at end of list
-	if(!inserted) parsed_events.insert(parsed_events.end(), current_parsed_events.begin(), current_parsed_events.end());
 
-	lck.unlock();
-	PARSED_EVENTS_CV.notify_all();
+		// Spin briefly before sleeping to keep latency low. Stalls
+		// are counted in units of 1ms sleeps as before.
+		if( ++Nspins < 1000 ){
+			this_thread::yield();
+		}else{
+			event_source->NPARSER_STALLED++;
+			this_thread::sleep_for(std::chrono::milliseconds(1));
+			Nspins = 0;
+		}
+	}
 	
 	// Any events should now be published
 	current_parsed_events.clear();
@@ -324,8 +341,9 @@ void DEVIOWorkerThread::PublishEvents(void)
 //---------------------------------
 void DEVIOWorkerThread::ParseBank(void)
 {
-	uint32_t *iptr = buff;
-	uint32_t *iend = &buff[buff[0]+1];
+	uint32_t *ibuff = mapped_event ? mapped_event:buff;
+	uint32_t *iptr = ibuff;
+	uint32_t *iend = &ibuff[ibuff[0]+1];
 
 	while(iptr < iend){
 		uint32_t event_len  = iptr[0];
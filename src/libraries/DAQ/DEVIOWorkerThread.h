@@ -21,6 +21,7 @@ using namespace std;
 #include <JANA/jerror.h>
 #include <DAQ/HDEVIO.h>
 #include <DAQ/DParsedEvent.h>
+#include <DAQ/DParsedEventRing.h>
 #include <DAQ/DModuleType.h>
 
 class JEventSource_EVIOpp;
@@ -39,20 +40,16 @@ class DEVIOWorkerThread{
 
 		DEVIOWorkerThread(
 			JEventSource_EVIOpp  *event_source
-	 		,list<DParsedEvent*> &parsed_events
+	 		,DParsedEventRing    &parsed_events
 	 		,uint32_t            &MAX_PARSED_EVENTS
-	 		,mutex               &PARSED_EVENTS_MUTEX
-	 		,condition_variable  &PARSED_EVENTS_CV
 			,set<uint32_t>       &ROCIDS_TO_PARSE );
 		virtual ~DEVIOWorkerThread();
 
 		// These are owned by JEventSource and
 		// are set in the constructor
 		JEventSource_EVIOpp *event_source;
-		list<DParsedEvent*> &parsed_events;
+		DParsedEventRing    &parsed_events;
 		uint32_t            &MAX_PARSED_EVENTS;
-		mutex               &PARSED_EVENTS_MUTEX;
-		condition_variable  &PARSED_EVENTS_CV;
 		set<uint32_t>       &ROCIDS_TO_PARSE;
 		
 		// Pool of parsed events
@@ -78,6 +75,7 @@ class DEVIOWorkerThread{
 		
 		uint32_t buff_len;
 		uint32_t *buff;
+		uint32_t *mapped_event; // if not NULL, event is in HDEVIO's read-only memory map instead of buff
 		streampos pos;
 
 		bool  PARSE_F250;
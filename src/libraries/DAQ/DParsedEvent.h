@@ -63,6 +63,7 @@ using namespace jana;
 #include <DAQ/DDIRCTDCHit.h>
 #include <DAQ/DDIRCADCHit.h>
 #include <DAQ/DBORptrs.h>
+#include <DAQ/DParsedObjectArena.h>
 #include <PID/DVertex.h>
 #include <PID/DEventRFBunch.h>
 
@@ -117,18 +118,6 @@ using namespace jana;
 		X(DVertex) \
 		X(DEventRFBunch)
 
-// It turns out that since we use object pools and in-place constructors, a
-// memory leak occurs for things like the samples vector in the Window Raw
-// data classes. This is because the in-place constructor re-initializes
-// the samples vector's underlying data pointer to NULL without freeing
-// the memory it points to. The easiest way around this is to just not use
-// a pool for these data types so the destructor is properly called. This
-// means a slight drop in efficiency, but only for data containing WRD which
-// is going to be slow anyway.
-#define MyNoPoolTypes(X) \
-		X(Df250WindowRawData) \
-		X(Df125WindowRawData)
-
 class DParsedEvent{
 	public:		
 		
@@ -157,55 +146,47 @@ class DParsedEvent{
 		MyBORTypes(makevector)
 		MyDerivedTypes(makevector)
 		
-		// DParsedEvent objects are recycled to save malloc/delete cycles. Do the
-		// same for the objects they provide by creating a pool vector for each
-		// object type. No need for locks here since this will only ever be accessed
-		// by the same worker thread.
-		#define makepoolvector(A) vector<A*>  v##A##_pool;
-		MyTypes(makepoolvector)
-		MyDerivedTypes(makepoolvector)
+		// DParsedEvent objects are recycled to save malloc/delete cycles. The
+		// objects they provide are kept in an arena for each object type so
+		// all objects of a type for this event are contiguous in memory (see
+		// DParsedObjectArena.h). No need for locks here since this will only
+		// ever be accessed by the same worker thread.
+		#define makearena(A) DParsedObjectArena<A>  arena_##A;
+		MyTypes(makearena)
+		MyDerivedTypes(makearena)
 
-		// Method to return all objects in vectors to their respective pools and 
-		// clear the vectors to set up for processing the next event. Vectors
-		// with BOR types are just cleared.
+		// Method to clear the vectors and rewind the arenas to set up for
+		// processing the next event. Vectors with BOR types are just cleared.
 		// This is called from DEVIOWorkerThread::MakeEvents
-		#define returntopool(A) if(!v##A.empty()){ v##A##_pool.insert(v##A##_pool.end(), v##A.begin(), v##A.end()); }
 		#define clearvectors(A)     v##A.clear();
-		#define deletepool(A)       for(auto p : v##A##_pool) delete p;
-		#define clearpoolvectors(A) v##A##_pool.clear();
+		#define resetarena(A)       arena_##A.Reset();
+		#define releasearena(A)     arena_##A.Release();
+		#define trimarena(A)        arena_##A.Trim();
 		void Clear(void){ 
-			MyTypes(returntopool)
 			MyTypes(clearvectors)
+			MyTypes(resetarena)
 			MyBORTypes(clearvectors)
-      MyDerivedTypes(returntopool)
 			MyDerivedTypes(clearvectors)
-			MyNoPoolTypes(deletepool)
-			MyNoPoolTypes(clearpoolvectors)
+			MyDerivedTypes(resetarena)
 		}
 
-		// Method to delete all objects in all vectors and all pools. This should
-		// usually only be called from the DParsedEvent destructor
-		#define deletevector(A)     for(auto p : v##A       ) delete p;
+		// Method to delete all objects in all arenas. This should usually
+		// only be called from the DParsedEvent destructor
 		void Delete(void){
-			MyTypes(deletevector)
-			MyTypes(deletepool)
 			MyTypes(clearvectors)
-			MyTypes(clearpoolvectors)
-			MyDerivedTypes(deletevector)
-			MyDerivedTypes(deletepool)
+			MyTypes(releasearena)
 			MyDerivedTypes(clearvectors)
-			MyDerivedTypes(clearpoolvectors)
+			MyDerivedTypes(releasearena)
 			MyBORTypes(clearvectors)
 		}
 		
-		// This is used to occasionally delete extra pool objects to reduce the
-		// average memory use. It is called from DEVIOWorkerThread::MakeEvents
-		// every MAX_RECYCLES events processed by this DParsedEvent object.
+		// This is used to occasionally delete objects left over from earlier
+		// (larger) events to reduce the average memory use. It is called from
+		// DEVIOWorkerThread::MakeEvents every MAX_RECYCLES events processed by
+		// this DParsedEvent object.
 		void Prune(void){
-			MyTypes(deletepool)
-			MyTypes(clearpoolvectors)
-			MyDerivedTypes(deletepool)
-			MyDerivedTypes(clearpoolvectors)
+			MyTypes(trimarena)
+			MyDerivedTypes(trimarena)
 		}
 		
 		// Define a class that has pointers to factories for each data type.
@@ -301,12 +282,9 @@ class DParsedEvent{
 		// set of arguments and we don't want to have to encode all of that
 		// here.
 		//
-		// For each data type, a method called NEW_XXX is defined that looks
-		// to see if an object already exists in the corresponding pool vector.
-		// If so, it returns a pointer to it after doing an in-place constructor
-		// call with the given arguments. If no objects are available in the
-		// pool, then a new one is created in the normal way with the given
-		// arguments.
+		// For each data type, a method called NEW_XXX is defined that
+		// constructs the object in the next free slot of the corresponding
+		// arena with the given arguments.
 		//
 		// This will also automatically add the created/recycled object to
 		// the appropriate vXXX vector as part of the current event. It
@@ -322,15 +300,7 @@ class DParsedEvent{
 		//
 		#define makeallocator(A) template<typename... Args> \
 		A* NEW_##A(Args&&... args){ \
-			A* t = NULL; \
-			if(v##A##_pool.empty()){ \
-				t = new A(std::forward<Args>(args)...); \
-			}else{ \
-				t = v##A##_pool.back(); \
-				v##A##_pool.pop_back(); \
-				t->ClearAssociatedObjects(); \
-				new(t) A(std::forward<Args>(args)...); \
-			} \
+			A* t = arena_##A.New(std::forward<Args>(args)...); \
 			v##A.push_back(t); \
 			return t; \
 		}
@@ -340,7 +310,7 @@ class DParsedEvent{
 		// Constructor and destructor
 		DParsedEvent(uint64_t MAX_OBJECT_RECYCLES=1000):in_use(false),Nrecycled(0),MAX_RECYCLES(MAX_OBJECT_RECYCLES),borptrs(NULL){}
 		#define printcounts(A) if(!v##A.empty()) cout << v##A.size() << " : " << #A << endl;
-		#define printpoolcounts(A) if(!v##A##_pool.empty()) cout << v##A##_pool.size() << " : " << #A << "_pool" << endl;
+		#define printpoolcounts(A) if(arena_##A.GetNconstructed()) cout << arena_##A.GetNconstructed() << " : " << #A << "_arena" << endl;
 		virtual ~DParsedEvent(){
 //			cout << "----- DParsedEvent (" << this << ") -------" << endl;
 //			MyTypes(printcounts);
@@ -359,12 +329,11 @@ class DParsedEvent{
 #undef MyTypes
 #undef MyDerivedTypes
 #undef makevector
-#undef makepoolvector
-#undef returntopool
+#undef makearena
 #undef clearvectors
-#undef deletevector
-#undef deletepool
-#undef clearpoolvectors
+#undef resetarena
+#undef releasearena
+#undef trimarena
 #undef makefactoryptr
 #undef copyfactoryptr
 #undef copytofactory
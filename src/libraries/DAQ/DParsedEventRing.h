@@ -0,0 +1,107 @@
+// $Id$
+//
+//    File: DParsedEventRing.h
+// Created: Sun Oct 18 09:12:31 EDT 2026
+//
+
+// This is used to pass DParsedEvent objects from the DEVIOWorkerThread
+// objects to JEventSource_EVIOpp::GetEvent without taking a lock.
+//
+// The ring has a fixed number of slots. Each slot holds all of the
+// DParsedEvent objects made from a single EVIO event (i.e. one block
+// of L1 events) and is addressed by the istreamorder value the
+// dispatcher assigned to that EVIO event. Workers may publish in any
+// order, but the single consumer always takes slots in istreamorder
+// sequence so events come out in the same order they were read in.
+//
+// This only works if EVERY istreamorder value handed out by the
+// dispatcher is eventually pushed, even if there were no events
+// made from it (pushing an empty list is fine).
+//
+// TryPush may be called from any number of threads. TryPop must
+// only be called from a single thread.
+
+#ifndef _DParsedEventRing_
+#define _DParsedEventRing_
+
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <memory>
+using namespace std;
+
+class DParsedEvent;
+
+class DParsedEventRing{
+	public:
+		DParsedEventRing(uint32_t min_slots){
+			// Round up to power of 2 so we can use a mask
+			size = 2;
+			while(size < min_slots) size <<= 1;
+			mask  = size - 1;
+			slots.reset(new Slot[size]);
+			head  = 0;
+			Nevents = 0;
+		}
+		virtual ~DParsedEventRing(){}
+
+		//----------------
+		// TryPush
+		//----------------
+		bool TryPush(uint64_t istreamorder, list<DParsedEvent*> &events){
+			/// Move all events into the slot for istreamorder. Returns
+			/// false (leaving events untouched) if that slot is still
+			/// too far ahead of the consumer.
+			if( istreamorder - head.load(memory_order_acquire) >= size ) return false;
+			Slot &slot = slots[istreamorder & mask];
+			if( slot.full.load(memory_order_acquire) ) return false;
+			slot.events.swap(events);
+			Nevents += slot.events.size();
+			slot.full.store(true, memory_order_release);
+			return true;
+		}
+
+		//----------------
+		// TryPop
+		//----------------
+		bool TryPop(list<DParsedEvent*> &events){
+			/// Append the events from the next slot in istreamorder
+			/// sequence to events. Returns false if that slot has
+			/// not been filled yet. Note that this may return true
+			/// without adding anything if the slot held no events.
+			uint64_t myhead = head.load(memory_order_relaxed);
+			Slot &slot = slots[myhead & mask];
+			if( !slot.full.load(memory_order_acquire) ) return false;
+			Nevents -= slot.events.size();
+			events.splice(events.end(), slot.events);
+			slot.full.store(false, memory_order_release);
+			head.store(myhead+1, memory_order_release);
+			return true;
+		}
+
+		uint64_t GetHead(void) const { return head.load(memory_order_acquire); }
+		uint64_t GetNevents(void) const { return Nevents.load(memory_order_relaxed); }
+		uint64_t GetNslots(void) const { return size; }
+
+	protected:
+
+		// Each slot is padded to a cache line so workers publishing
+		// neighboring events don't invalidate one another
+		struct Slot{
+			Slot():full(false){}
+			atomic<bool> full;
+			list<DParsedEvent*> events;
+			char pad[64 - sizeof(uint64_t) - sizeof(list<DParsedEvent*>)];
+		};
+
+		uint64_t size;
+		uint64_t mask;
+		unique_ptr<Slot[]> slots;
+		char pad1[64];
+		atomic<uint64_t> head;     // istreamorder of next slot consumer will take
+		char pad2[64];
+		atomic<uint64_t> Nevents;  // number of DParsedEvent objects currently in ring
+		char pad3[64];
+};
+
+#endif // _DParsedEventRing_
@@ -0,0 +1,130 @@
+// $Id$
+//
+//    File: DParsedObjectArena.h
+// Created: Sun Oct 18 14:21:09 EDT 2026
+//
+
+// Storage for the hit objects of a single type held by a DParsedEvent.
+//
+// Objects are constructed in place in a small number of contiguous
+// slabs so that all objects of a type made for an event sit next to
+// one another in memory. Slabs are never moved so pointers handed out
+// stay valid until the arena is Reset(). Slab sizes double from 16
+// objects up to a maximum of 1024 objects each.
+//
+// Reset() just rewinds the arena to the start and so costs the same
+// no matter how many objects were made. Objects left over from the
+// previous event are destroyed only when their slot is reused (or by
+// Trim/Release) so members that own heap memory (e.g. the samples
+// vector in Df250WindowRawData) are always freed properly.
+//
+// An arena is only ever accessed by the DEVIOWorkerThread that owns
+// the DParsedEvent so there is no locking.
+
+#ifndef _DParsedObjectArena_
+#define _DParsedObjectArena_
+
+#include <stdint.h>
+#include <new>
+#include <vector>
+#include <utility>
+
+template<class T>
+class DParsedObjectArena{
+	public:
+		DParsedObjectArena():Nused(0),Nconstructed(0),islab(0),ioff(0){}
+		~DParsedObjectArena(){ Release(); }
+
+		//----------------
+		// New
+		//----------------
+		template<typename... Args>
+		T* New(Args&&... args){
+			/// Construct a new object with the given arguments and
+			/// return a pointer to it.
+			if(islab<slabs.size() && ioff>=slabs[islab].size){ islab++; ioff=0; }
+			if(islab>=slabs.size()) AddSlab();
+			T *t = &slabs[islab].objs[ioff++];
+			if(Nused < Nconstructed) t->~T(); // left over from previous event
+			new(t) T(std::forward<Args>(args)...);
+			if(++Nused > Nconstructed) Nconstructed = Nused;
+			return t;
+		}
+
+		//----------------
+		// Reset
+		//----------------
+		void Reset(void){
+			/// Forget all objects so their slots get reused. This
+			/// does not touch the objects themselves.
+			Nused = 0;
+			islab = 0;
+			ioff  = 0;
+		}
+
+		//----------------
+		// Trim
+		//----------------
+		void Trim(void){
+			/// Destroy all objects beyond those currently in use and
+			/// free any slabs no longer needed. This is used to limit
+			/// memory held after an unusually large event.
+			uint64_t idx = 0;
+			uint32_t Nslabs_needed = 0;
+			for(uint32_t i=0; i<slabs.size(); i++){
+				Slab &slab = slabs[i];
+				for(uint32_t j=0; j<slab.size; j++, idx++){
+					if(idx>=Nused && idx<Nconstructed) slab.objs[j].~T();
+				}
+				if( (idx-slab.size) < Nused ) Nslabs_needed = i+1;
+			}
+			for(uint32_t i=Nslabs_needed; i<slabs.size(); i++) ::operator delete(slabs[i].objs);
+			slabs.resize(Nslabs_needed);
+			Nconstructed = Nused;
+		}
+
+		//----------------
+		// Release
+		//----------------
+		void Release(void){
+			/// Destroy all objects and free all memory.
+			Nused = 0;
+			Trim();
+			islab = 0;
+			ioff  = 0;
+		}
+
+		uint64_t GetNused(void) const { return Nused; }
+		uint64_t GetNconstructed(void) const { return Nconstructed; }
+
+	protected:
+
+		struct Slab{
+			T *objs;
+			uint32_t size;
+		};
+
+		void AddSlab(void){
+			uint32_t size = slabs.empty() ? 16:slabs.back().size*2;
+			if(size > 1024) size = 1024;
+			Slab slab;
+			slab.objs = (T*)::operator new(size*sizeof(T));
+			slab.size = size;
+			slabs.push_back(slab);
+			islab = slabs.size()-1;
+			ioff  = 0;
+		}
+
+		std::vector<Slab> slabs;
+		uint64_t Nused;         // objects handed out since last Reset
+		uint64_t Nconstructed;  // slots (from start) holding a live object
+		uint32_t islab;         // slab for next object
+		uint32_t ioff;          // index in slab for next object
+
+	private:
+		// Pointers into the slabs are held elsewhere so don't allow copies
+		DParsedObjectArena(const DParsedObjectArena&);
+		DParsedObjectArena& operator=(const DParsedObjectArena&);
+};
+
+#endif // _DParsedObjectArena_
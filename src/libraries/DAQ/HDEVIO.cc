@@ -9,7 +9,13 @@
 #include <string.h>
 #include <libgen.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <cinttypes>
+#include <algorithm>
+#include <thread>
+#include <chrono>
 using namespace std;
 
 #include "HDEVIO.h"
@@ -26,6 +32,13 @@ HDEVIO::HDEVIO(string filename, bool read_map_file, int verbose):filename(filena
 	buff  = NULL;
 
 	is_open = false;
+	is_mmapped = false;
+	mmap_fd = -1;
+	mmap_base = NULL;
+	mmap_next = NULL;
+	mmap_block_end = NULL;
+	mmap_advised_end = 0;
+	MMAP_READAHEAD = 64<<20; // 64MB
 	ifs.open(filename.c_str());
 	if(!ifs.is_open()){
 		ClearErrorMessage();
@@ -57,18 +70,25 @@ HDEVIO::HDEVIO(string filename, bool read_map_file, int verbose):filename(filena
 	
 	event_type_mask = 0xFFFF; // default to accepting all types
 	is_mapped = false;
+	mapped_bytes = 0;
+	selection_active = false;
+	selected_idx = 0;
 	
 	NB_next_pos = 0;
 	
-	if(read_map_file) ReadFileMap(); // check if a map file exists and read it if it does
-	
 	IGNORE_EMPTY_BOR   = false;
 	SKIP_EVENT_MAPPING = false;
+	AUTO_SAVE_INDEX    = false;
+	MAP_NTHREADS       = thread::hardware_concurrency();
+	if(MAP_NTHREADS > 8) MAP_NTHREADS = 8;
 	
+	// n.b. ReadFileMap needs the file size to validate binary maps
 	ifs.seekg(0, ios_base::end);
 	total_size_bytes = ifs.tellg();
 	ifs.seekg(0, ios_base::beg);
 	
+	if(read_map_file) ReadFileMap(); // check if a map file exists and read it if it does
+	
 	is_open = true;
 }
 
@@ -77,6 +97,7 @@ HDEVIO::HDEVIO(string filename, bool read_map_file, int verbose):filename(filena
 //---------------------------------
 HDEVIO::~HDEVIO()
 {
+	CloseMemoryMap();
 	if(ifs.is_open()) ifs.close();
 	if(buff ) delete[] buff;
 	if(fbuff) delete[] fbuff;
@@ -377,80 +398,97 @@ bool HDEVIO::readSparse(uint32_t *user_buff, uint32_t user_buff_len, bool allow_
 	// Make sure we've mapped this file
 	if(!is_mapped) MapBlocks();
 	
-	// Loop over all events of all blocks looking for the next
-	// event matching the currently set type mask. 
-	for(; sparse_block_iter!=evio_blocks.end(); sparse_block_iter++, sparse_event_idx = 0){
+	if(selection_active){
+		// Events were selected using SelectEvents. Just take the
+		// next one from the list.
+		if(selected_idx >= selected_events.size()){
+			SetErrorMessage("No more events");
+			err_code = HDEVIO_EOF;
+			return false;
+		}
+		sparse_block_iter = evio_blocks.begin() + selected_events[selected_idx].first;
+		sparse_event_idx  = selected_events[selected_idx].second;
+	}else{
+		// Loop over all events of all blocks looking for the next
+		// event matching the currently set type mask. 
+		for(; sparse_block_iter!=evio_blocks.end(); sparse_block_iter++, sparse_event_idx = 0){
 
-		// Filter out blocks of the wrong type
-		EVIOBlockRecord &br = *sparse_block_iter;
-		//		uint32_t type = (1 << br.block_type);
+			// Filter out blocks of the wrong type
+			EVIOBlockRecord &br = *sparse_block_iter;
+			//		uint32_t type = (1 << br.block_type);
 
-		for(; sparse_event_idx < br.evio_events.size(); sparse_event_idx++){
-			EVIOEventRecord &er = sparse_block_iter->evio_events[sparse_event_idx];
+			for(; sparse_event_idx < br.evio_events.size(); sparse_event_idx++){
+				EVIOEventRecord &er = sparse_block_iter->evio_events[sparse_event_idx];
 
-			uint32_t etype = (1 << er.event_type);
-			if( etype & event_type_mask ) break;
+				uint32_t etype = (1 << er.event_type);
+				if( etype & event_type_mask ) break;
+			}
+			if(sparse_event_idx < br.evio_events.size()) break;
 		}
-		if(sparse_event_idx >= br.evio_events.size()) continue;
 		
-		EVIOEventRecord &er = sparse_block_iter->evio_events[sparse_event_idx];
-
-		uint32_t event_len = er.event_len;
-		last_event_len = event_len;
-	
-		// Check if user buffer is big enough to hold block
-		if( event_len > user_buff_len ){
-			ClearErrorMessage();
-			err_mess << "user buffer too small for event (" << user_buff_len << " < " << event_len << ")";
-			err_code = HDEVIO_USER_BUFFER_TOO_SMALL;
-			return false;
+		// If we got here without finding an event of interest
+		// then report that there are no more events in the file.
+		if(sparse_block_iter == evio_blocks.end()){
+			SetErrorMessage("No more events");
+			err_code = HDEVIO_EOF;
+			return false; // isgood=false
 		}
+	}
 
-		// At this point we're committed to reading this event so go
-		// ahead and increment pointer to next event so no matter
-		// what happens below, we don't try reading it again.
-		sparse_event_idx++;
+	EVIOBlockRecord &br = *sparse_block_iter;
+	EVIOEventRecord &er = br.evio_events[sparse_event_idx];
 
-		// Set file pointer to start of EVIO event (NOT block header!)
-		last_event_pos = er.pos;
-		ifs.seekg(last_event_pos, ios_base::beg);
-		
-		// Read data directly into user buffer
-		ifs.read((char*)user_buff, event_len*sizeof(uint32_t));
-
-		// Swap entire bank if needed
-		swap_needed = br.swap_needed; // set flag in HDEVIO
-		bool isgood = true;
-		if(br.swap_needed && allow_swap){
-			uint32_t Nswapped = swap_bank(user_buff, user_buff, event_len);
-			isgood = (Nswapped == event_len);
-		}
-		
-		// Double check that event length matches EVIO block header
-		// but only if we either don't need to swap or need to and
-		// were allowed to (otherwise, the test will almost certainly
-		// fail!)
-		if( (!br.swap_needed) || (br.swap_needed && allow_swap) ){
-			if( (user_buff[0]+1) != event_len ){
-				ClearErrorMessage();
-				err_mess << "WARNING: EVIO bank indicates a different size than block header (" << event_len << " != " << (user_buff[0]+1) << ")";
-				err_code = HDEVIO_EVENT_BIGGER_THAN_BLOCK;
-				Nerrors++;
-				Nbad_blocks++;
-				return false;
-			}
-		}
+	uint32_t event_len = er.event_len;
+	last_event_len = event_len;
 
-		if(isgood) Nevents++;
+	// Check if user buffer is big enough to hold block
+	if( event_len > user_buff_len ){
+		ClearErrorMessage();
+		err_mess << "user buffer too small for event (" << user_buff_len << " < " << event_len << ")";
+		err_code = HDEVIO_USER_BUFFER_TOO_SMALL;
+		return false;
+	}
+
+	// At this point we're committed to reading this event so go
+	// ahead and increment pointer to next event so no matter
+	// what happens below, we don't try reading it again.
+	sparse_event_idx++;
+	if(selection_active) selected_idx++;
 
-		return isgood;
+	// Set file pointer to start of EVIO event (NOT block header!)
+	last_event_pos = er.pos;
+	ifs.clear();
+	ifs.seekg(last_event_pos, ios_base::beg);
+	
+	// Read data directly into user buffer
+	ifs.read((char*)user_buff, event_len*sizeof(uint32_t));
+
+	// Swap entire bank if needed
+	swap_needed = br.swap_needed; // set flag in HDEVIO
+	bool isgood = true;
+	if(br.swap_needed && allow_swap){
+		uint32_t Nswapped = swap_bank(user_buff, user_buff, event_len);
+		isgood = (Nswapped == event_len);
+	}
+	
+	// Double check that event length matches EVIO block header
+	// but only if we either don't need to swap or need to and
+	// were allowed to (otherwise, the test will almost certainly
+	// fail!)
+	if( (!br.swap_needed) || (br.swap_needed && allow_swap) ){
+		if( (user_buff[0]+1) != event_len ){
+			ClearErrorMessage();
+			err_mess << "WARNING: EVIO bank indicates a different size than block header (" << event_len << " != " << (user_buff[0]+1) << ")";
+			err_code = HDEVIO_EVENT_BIGGER_THAN_BLOCK;
+			Nerrors++;
+			Nbad_blocks++;
+			return false;
+		}
 	}
 
-	// If we got here then we did not find an event of interest
-	// above. Report that there are no more events in the file.
-	SetErrorMessage("No more events");
-	err_code = HDEVIO_EOF;
-	return false; // isgood=false
+	if(isgood) Nevents++;
+
+	return isgood;
 }
 
 //---------------------------------
@@ -609,6 +647,243 @@ bool HDEVIO::readNoFileBuff(uint32_t *user_buff, uint32_t user_buff_len, bool al
 	return isgood;
 }
 
+//---------------------------------
+// OpenMemoryMap
+//---------------------------------
+bool HDEVIO::OpenMemoryMap(void)
+{
+	/// Map the entire input file read-only into memory so that
+	/// readMapped() can be used. Returns true if successful.
+	/// On failure, err_mess is set and the regular ifstream
+	/// based readers can still be used.
+
+	if(is_mmapped) return true;
+	if(!is_open){
+		SetErrorMessage("File is not open");
+		err_code = HDEVIO_FILE_NOT_OPEN;
+		return false;
+	}
+	if(total_size_bytes == 0){
+		SetErrorMessage("Cannot memory map empty file");
+		return false;
+	}
+
+	mmap_fd = open(filename.c_str(), O_RDONLY);
+	if(mmap_fd < 0){
+		ClearErrorMessage();
+		err_mess << "Unable to open " << filename << " for memory mapping";
+		return false;
+	}
+
+	void *addr = mmap(NULL, total_size_bytes, PROT_READ, MAP_PRIVATE, mmap_fd, 0);
+	if(addr == MAP_FAILED){
+		ClearErrorMessage();
+		err_mess << "mmap failed for " << filename << " (" << total_size_bytes << " bytes)";
+		close(mmap_fd);
+		mmap_fd = -1;
+		return false;
+	}
+	mmap_base = (uint8_t*)addr;
+	madvise(mmap_base, total_size_bytes, MADV_SEQUENTIAL);
+
+	mmap_next        = NULL;
+	mmap_block_end   = NULL;
+	mmap_advised_end = 0;
+	NB_next_pos      = 0;
+	is_mmapped       = true;
+	
+	if(VERBOSE>0) cout << "Memory mapped EVIO file: " << filename << " (" << (total_size_bytes>>20) << " MB)" << endl;
+
+	return true;
+}
+
+//---------------------------------
+// CloseMemoryMap
+//---------------------------------
+void HDEVIO::CloseMemoryMap(void)
+{
+	/// Unmap the file. Any pointers previously returned by
+	/// readMapped() become invalid after this is called.
+
+	if(mmap_base) munmap(mmap_base, total_size_bytes);
+	if(mmap_fd >= 0) close(mmap_fd);
+	mmap_base  = NULL;
+	mmap_fd    = -1;
+	mmap_next  = NULL;
+	mmap_block_end = NULL;
+	is_mmapped = false;
+}
+
+//---------------------------------
+// AdviseAhead
+//---------------------------------
+void HDEVIO::AdviseAhead(uint64_t pos)
+{
+	/// Tell the kernel which part of the mapping will be needed
+	/// soon. This is only done once we have advanced past the
+	/// previously advised region so the system call is made only
+	/// every MMAP_READAHEAD bytes or so. If a block map is available
+	/// (e.g. from ReadFileMap) then the region is extended to end
+	/// on a block boundary so whole blocks are paged in together.
+
+	if(!mmap_base || MMAP_READAHEAD==0) return;
+	if(pos + (MMAP_READAHEAD>>1) < mmap_advised_end) return;
+
+	uint64_t start = max(pos, mmap_advised_end);
+	uint64_t end   = pos + MMAP_READAHEAD;
+
+	if(is_mapped && !evio_blocks.empty()){
+		// Find first block starting at or after end of region
+		auto it = upper_bound(evio_blocks.begin(), evio_blocks.end(), end,
+			[](uint64_t p, const EVIOBlockRecord &br){ return p < (uint64_t)br.pos; });
+		if(it != evio_blocks.end()) end = (uint64_t)it->pos;
+		else end = total_size_bytes;
+	}
+	if(end > total_size_bytes) end = total_size_bytes;
+	if(end <= start) return;
+
+	// madvise requires a page aligned address
+	uint64_t pagesize = (uint64_t)sysconf(_SC_PAGESIZE);
+	uint64_t astart = start - (start%pagesize);
+	madvise(&mmap_base[astart], end-astart, MADV_WILLNEED);
+	
+	mmap_advised_end = end;
+}
+
+//---------------------------------
+// readMapped
+//---------------------------------
+bool HDEVIO::readMapped(uint32_t* &event_ptr, uint32_t &event_len)
+{
+	/// This is an alternative to readNoFileBuff that requires
+	/// OpenMemoryMap() to have been called successfully. Rather
+	/// than copying the event into a user buffer, event_ptr is
+	/// set to point directly at the start of the EVIO event in the
+	/// read-only mapping and event_len to its length in words
+	/// (including the length word). No swapping is done here. If
+	/// swap_needed is set upon return, the caller must swap the event
+	/// into its own buffer (e.g. swap_bank(mybuff, event_ptr, event_len))
+	/// since the mapping itself cannot be written to. The returned
+	/// pointer remains valid until CloseMemoryMap() is called or this
+	/// object is destroyed.
+
+	err_code = HDEVIO_OK;
+	ClearErrorMessage();
+	event_ptr = NULL;
+	event_len = 0;
+
+	if(!is_mmapped){
+		SetErrorMessage("File is not memory mapped");
+		err_code = HDEVIO_FILE_NOT_OPEN;
+		return false;
+	}
+
+	while(true){
+
+		// Read in next block header if needed
+		if(mmap_next==NULL || mmap_next>=mmap_block_end){
+
+			// Check if we are at end of file
+			uint64_t pos = (uint64_t)NB_next_pos;
+			uint64_t words_left_in_file = (total_size_bytes-pos)/4;
+			if( words_left_in_file == 8 ){ // (if <8 then report HDEVIO_FILE_TRUNCATED below)
+				SetErrorMessage("No more events");
+				err_code = HDEVIO_EOF;
+				return false;
+			}
+			if( words_left_in_file < 8 ){
+				ClearErrorMessage();
+				err_mess << "Error reading EVIO block header (truncated?)"<<endl;
+				err_mess << "words_left_in_file: " << words_left_in_file;
+				err_code = HDEVIO_FILE_TRUNCATED;
+				return false;
+			}
+
+			uint32_t *bh = (uint32_t*)&mmap_base[pos];
+
+			// Check if we need to byte swap and simultaneously
+			// verify header is good by checking magic word
+			if(bh[7]==0x0001dac0){
+				swap_needed = true;
+			}else if(bh[7]==0xc0da0100){
+				swap_needed = false;
+			}else{
+				ClearErrorMessage();
+				err_mess << "Bad magic word: " << HexStr(bh[7]);
+				err_code = HDEVIO_BAD_BLOCK_HEADER;
+				Nerrors++;
+				Nbad_blocks++;
+				return false;
+			}
+
+			uint32_t block_len = swap_needed ? swap32(bh[0]):bh[0];
+			uint32_t eventcnt  = swap_needed ? swap32(bh[3]):bh[3];
+			if( block_len < 8 ){
+				SetErrorMessage("EVIO block length less than header size");
+				err_code = HDEVIO_BAD_BLOCK_HEADER;
+				Nerrors++;
+				Nbad_blocks++;
+				return false;
+			}
+			if( pos + ((uint64_t)block_len<<2) > total_size_bytes ){
+				SetErrorMessage("EVIO block extends past end of file!");
+				err_code = HDEVIO_FILE_TRUNCATED;
+				return false;
+			}
+			if( eventcnt==0 && block_len==8 ){
+				// Trailer block
+				SetErrorMessage("No more events");
+				err_code = HDEVIO_EOF;
+				return false;
+			}
+
+			Nblocks++;
+			mmap_next      = &bh[8];
+			mmap_block_end = &bh[block_len];
+			NB_next_pos    = (streampos)(pos + ((uint64_t)block_len<<2));
+			
+			AdviseAhead((uint64_t)NB_next_pos);
+			continue;
+		}
+
+		uint32_t len = swap_needed ? swap32(mmap_next[0]):mmap_next[0];
+		len++; // include length word for EVIO bank
+
+		if( &mmap_next[len] > mmap_block_end ){
+			ClearErrorMessage();
+			err_mess << "WARNING: EVIO bank indicates a bigger size than block header (" << len << " > " << (uint64_t)(mmap_block_end-mmap_next) << ")";
+			mmap_next = mmap_block_end; // setup so subsequent call will go to next block
+			err_code = HDEVIO_EVENT_BIGGER_THAN_BLOCK;
+			Nerrors++;
+			Nbad_blocks++;
+			return false;
+		}
+		
+		if( len < 3 ){
+			// Same as in MapEvents: skip empty banks, except for an
+			// empty BOR bank when IGNORE_EMPTY_BOR is set, which is
+			// returned so both read paths see the same events.
+			Nbad_events++;
+			Nerrors++;
+			uint32_t header = 0;
+			if(len == 2) header = swap_needed ? swap32(mmap_next[1]):mmap_next[1];
+			if( !(IGNORE_EMPTY_BOR && len==2 && (header&0xFFFF00FF)==0x00700001) ){
+				mmap_next = &mmap_next[len];
+				continue;
+			}
+		}
+
+		event_ptr = mmap_next;
+		event_len = len;
+		last_event_len = len;
+		last_event_pos = (streampos)((uint8_t*)mmap_next - mmap_base);
+		mmap_next = &mmap_next[len];
+		
+		Nevents++;
+		return true;
+	}
+}
+
 //------------------------
 // rewind
 //------------------------
@@ -627,10 +902,15 @@ void HDEVIO::rewind(void)
 	
 	sparse_block_iter = evio_blocks.begin();
 	sparse_event_idx  = 0;
+	selected_idx      = 0;
 	
 	NB_block_record.evio_events.clear();
 	NB_next_pos = 0;
 	
+	mmap_next = NULL;
+	mmap_block_end = NULL;
+	mmap_advised_end = 0;
+	
 	ClearErrorMessage();
 	err_code = HDEVIO_OK;
 }
@@ -687,29 +967,385 @@ vector<HDEVIO::EVIOBlockRecord>& HDEVIO::GetEVIOBlockRecords(void)
 	return evio_blocks;
 }
 
+//------------------------
+// SeekToEVIOEvent
+//------------------------
+bool HDEVIO::SeekToEVIOEvent(uint64_t ievent)
+{
+	/// Position the file so the next call to readSparse will return
+	/// the ievent-th EVIO event in the file (counting from 0 and
+	/// regardless of type). This uses the block map so the file
+	/// does not need to be read through. Returns false if the
+	/// file has fewer events than that.
+
+	if(!is_mapped) MapBlocks();
+
+	for(sparse_block_iter=evio_blocks.begin(); sparse_block_iter!=evio_blocks.end(); sparse_block_iter++){
+		uint64_t N = sparse_block_iter->evio_events.size();
+		if(ievent < N){
+			sparse_event_idx = ievent;
+			return true;
+		}
+		ievent -= N;
+	}
+	
+	sparse_event_idx = 0;
+	return false;
+}
+
+//------------------------
+// SeekToEvent
+//------------------------
+bool HDEVIO::SeekToEvent(uint64_t event_number)
+{
+	/// Position the file so the next call to readSparse will return
+	/// the EVIO event containing the given physics event number.
+	/// Returns false if no EVIO event in the file contains the event.
+
+	if(!is_mapped) MapBlocks();
+
+	sparse_event_idx = 0;
+	if(FindEventRecord(event_number, sparse_block_iter, sparse_event_idx)) return true;
+	
+	sparse_block_iter = evio_blocks.end();
+	sparse_event_idx = 0;
+	return false;
+}
+
+//------------------------
+// FindEventRecord
+//------------------------
+bool HDEVIO::FindEventRecord(uint64_t event_number, vector<EVIOBlockRecord>::iterator &bit, uint32_t &ievent)
+{
+	/// Find the EVIO event containing the given physics event
+	/// number. Blocks are binary searched using the event ranges in
+	/// the block map. Non-physics blocks (which have no event
+	/// numbers) are skipped over. On success, bit and ievent are set
+	/// to the block and index of the event within it. Otherwise, false
+	/// is returned with bit set to the first physics block containing
+	/// events after event_number (or evio_blocks.end()).
+
+	// Find first physics block whose last event is >= event_number
+	auto lower = evio_blocks.begin();
+	auto upper = evio_blocks.end();
+	while(lower < upper){
+		auto mid = lower + (upper-lower)/2;
+		auto it = mid;
+		while(it!=upper && it->block_type!=kBT_PHYSICS) it++;
+		if(it == upper){
+			upper = mid;
+		}else if(it->last_event < event_number){
+			lower = it+1;
+		}else{
+			upper = mid;
+		}
+	}
+	
+	// Check events in that block and any following ones in case
+	// block ranges are not contiguous
+	ievent = 0;
+	for(bit=lower; bit!=evio_blocks.end(); bit++){
+		if(bit->block_type != kBT_PHYSICS) continue;
+		if(bit->first_event > event_number) break;
+		auto &evio_events = bit->evio_events;
+		for(ievent=0; ievent<evio_events.size(); ievent++){
+			EVIOEventRecord &er = evio_events[ievent];
+			if(er.event_type != kBT_PHYSICS) continue;
+			if(er.first_event<=event_number && er.last_event>=event_number) return true;
+		}
+		ievent = 0;
+	}
+	
+	return false;
+}
+
+//------------------------
+// SelectEvents
+//------------------------
+uint64_t HDEVIO::SelectEvents(const vector<pair<uint64_t,uint64_t> > &ranges, uint32_t always_mask)
+{
+	/// Restrict readSparse to only the EVIO events containing physics
+	/// events whose event numbers fall in the given (inclusive) ranges,
+	/// plus any EVIO events whose type is in always_mask (by default
+	/// only BOR events which are needed to interpret the data). The
+	/// start of each range is found by binary searching the block map
+	/// so only the parts of the file containing selected events are
+	/// read. Ranges may be given in any order and may overlap.
+	///
+	/// n.b. if the data were taken with a CODA block size > 1 then
+	/// every EVIO event holds several physics events. All of them are
+	/// returned when any one is selected. It is up to the caller to
+	/// filter those out if needed.
+	///
+	/// Returns the number of EVIO events selected.
+
+	if(!is_mapped) MapBlocks();
+
+	selected_events.clear();
+	selected_idx = 0;
+	selection_active = true;
+
+	// Events of types that should always be read
+	if(always_mask){
+		for(uint32_t iblock=0; iblock<evio_blocks.size(); iblock++){
+			auto &evio_events = evio_blocks[iblock].evio_events;
+			for(uint32_t ievent=0; ievent<evio_events.size(); ievent++){
+				if( (1<<evio_events[ievent].event_type) & always_mask ) selected_events.push_back(make_pair(iblock, ievent));
+			}
+		}
+	}
+	
+	// Physics events
+	for(auto &r : ranges){
+		vector<EVIOBlockRecord>::iterator bit;
+		uint32_t ievent = 0;
+		
+		// Find EVIO event containing first event in range. If it is
+		// not in the file, this will give the next block that is.
+		FindEventRecord(r.first, bit, ievent);
+		
+		for(; bit!=evio_blocks.end(); bit++, ievent=0){
+			if(bit->block_type!=kBT_PHYSICS) continue;
+			if(bit->first_event > r.second) break;
+			auto &evio_events = bit->evio_events;
+			for(; ievent<evio_events.size(); ievent++){
+				EVIOEventRecord &er = evio_events[ievent];
+				if(er.event_type != kBT_PHYSICS) continue;
+				if(er.first_event > r.second) break;
+				if(er.last_event < r.first) continue;
+				selected_events.push_back(make_pair(bit-evio_blocks.begin(), ievent));
+			}
+		}
+	}
+	
+	// Put in file order and remove duplicates
+	sort(selected_events.begin(), selected_events.end());
+	selected_events.erase(unique(selected_events.begin(), selected_events.end()), selected_events.end());
+
+	return selected_events.size();
+}
+
+//------------------------
+// ClearEventSelection
+//------------------------
+void HDEVIO::ClearEventSelection(void)
+{
+	selection_active = false;
+	selected_events.clear();
+	selected_idx = 0;
+}
+
 //------------------------
 // MapBlocks
 //------------------------
 void HDEVIO::MapBlocks(bool print_ticker)
 {
+	/// Map all EVIO blocks (and optionally the events in them) in the
+	/// file. If part of the file has already been mapped (e.g. from a
+	/// binary index written while the file was still growing), then
+	/// mapping resumes from the end of the last known block.
+	///
+	/// For large files the region to be mapped is split into up to
+	/// MAP_NTHREADS pieces by file offset and each is mapped in its
+	/// own thread with its own file handle. Threads other than the
+	/// first must find the first block header in their region by
+	/// searching for the magic word. The pieces are then stitched
+	/// together, checking that each starts exactly where the previous
+	/// ended. If not (e.g. a false match on the magic word) the rest
+	/// of the file is mapped serially from the last good block.
+
 	if(!is_open){
 		err_mess.str("File is not open");
 		err_code = HDEVIO_FILE_NOT_OPEN;
 		return;
 	}
 	
+	uint64_t start = mapped_bytes;
+	uint64_t end   = total_size_bytes;
+	if(start >= end){
+		sparse_block_iter = evio_blocks.begin();
+		sparse_event_idx = 0;
+		is_mapped = true;
+		return;
+	}
+	
+	if(print_ticker){
+		if(start == 0){
+			cout << "Mapping EVIO file ..." << endl;
+		}else{
+			cout << "Resuming mapping of EVIO file at " << (start>>20) << " MB ..." << endl;
+		}
+	}
+
+	// Decide how many threads to use. Don't bother splitting
+	// pieces smaller than 128MB.
+	uint64_t min_piece = 128<<20;
+	uint64_t nthreads = MAP_NTHREADS;
+	if( nthreads*min_piece > (end-start) ) nthreads = (end-start)/min_piece;
+	if( nthreads < 1 ) nthreads = 1;
+	
+	// Boundaries of pieces (on 4 byte boundaries)
+	vector<uint64_t> bounds;
+	for(uint64_t i=0; i<nthreads; i++) bounds.push_back( (start + i*((end-start)/nthreads)) & ~(uint64_t)0x3 );
+	bounds[0] = start;
+	bounds.push_back(end);
+
+	vector< vector<EVIOBlockRecord> > pieces(nthreads);
+	vector<uint64_t> piece_Nbad(nthreads, 0);
+	vector<char> piece_ok(nthreads, true);
+	atomic<uint64_t> bytes_done(0);
+	atomic<uint32_t> Ndone(0);
+	
+	auto mapper = [&](uint64_t i){
+		ifstream myifs(filename.c_str());
+		uint64_t mystart = bounds[i];
+		if( i==0 || FindBlockHeader(myifs, bounds[i], bounds[i+1], mystart) ){
+			piece_ok[i] = MapBlockRange(myifs, mystart, bounds[i+1], pieces[i], piece_Nbad[i], &bytes_done);
+		}
+		Ndone++;
+	};
+
 	// Remember current file pos so we can restore it.
 	streampos start_pos = ifs.tellg();
+
+	if(nthreads == 1){
+		piece_ok[0] = MapBlockRange(ifs, start, end, pieces[0], piece_Nbad[0]);
+	}else{
+		vector<thread> threads;
+		for(uint64_t i=0; i<nthreads; i++) threads.push_back(thread(mapper, i));
+		
+		// Update ticker while waiting for threads to finish
+		for(uint32_t iloop=1; Ndone < nthreads; iloop++){
+			this_thread::sleep_for(chrono::milliseconds(10));
+			if(print_ticker && (iloop%50)==0){
+				uint64_t total_MB = (end-start)>>20;
+				uint64_t read_MB  = bytes_done>>20;
+				if(total_MB==0) total_MB = 1;
+				cout << read_MB << "/" << total_MB << " MB mapped using " << nthreads << " threads (" << (100*read_MB/total_MB) << "%)     \r";
+				cout.flush();
+			}
+		}
+		for(auto &t : threads) t.join();
+	}
 	
-	if(print_ticker) cout << "Mapping EVIO file ..." << endl;
+	// Stitch pieces together
+	for(uint64_t i=0; i<nthreads; i++){
+		vector<EVIOBlockRecord> &blocks = pieces[i];
+		
+		// A single block may span an entire piece
+		if( blocks.empty() && mapped_bytes>=bounds[i+1] ) continue;
+		
+		// Find block in this piece starting exactly where the last
+		// one ended. Anything before that came from a false match
+		// when searching for the first block header.
+		auto it = blocks.begin();
+		while( it!=blocks.end() && (uint64_t)it->pos<mapped_bytes ) it++;
+		bool lined_up = (it!=blocks.end()) && ((uint64_t)it->pos==mapped_bytes);
+		
+		if( !lined_up ){
+			// Piece did not line up with previous one. Map the rest
+			// of the file serially from the end of the previous piece.
+			if(i==0) break; // (nothing mapped at all)
+			if(VERBOSE>1) _DBG_ << "Block boundary mismatch at piece " << i << ". Mapping remainder serially" << endl;
+			blocks.clear();
+			piece_Nbad[i] = 0;
+			piece_ok[i] = MapBlockRange(ifs, mapped_bytes, end, blocks, piece_Nbad[i]);
+			it = blocks.begin();
+			nthreads = i+1; // this is now the last piece
+		}
+		
+		for(; it!=blocks.end(); it++){
+			evio_blocks.push_back(*it);
+			if(it->block_len >= 8) mapped_bytes = (uint64_t)it->pos + ((uint64_t)it->block_len<<2);
+		}
+		Nbad_events += piece_Nbad[i];
+		Nerrors     += piece_Nbad[i];
+		
+		// Bad block header means we stop mapping here (record
+		// for bad block is already in evio_blocks)
+		if(!piece_ok[i]){
+			err_mess.str("Bad magic word");
+			err_code = HDEVIO_BAD_BLOCK_HEADER;
+			break;
+		}
+	}
 	
-	// Rewind to beginning of file and loop over all blocks
-	ifs.seekg(0, ios_base::beg);
+	// Restore file pos
+	ifs.clear();
+	ifs.seekg(start_pos, ios_base::beg);
+	
+	if(print_ticker) cout << endl;
+	
+	// Setup iterators for sparse reading
+	sparse_block_iter = evio_blocks.begin();
+	sparse_event_idx = 0;
+
+	// Set flag that file has been mapped
+	is_mapped = true;
+	
+	if(AUTO_SAVE_INDEX) SaveBinaryFileMap();
+}
+
+//------------------------
+// FindBlockHeader
+//------------------------
+bool HDEVIO::FindBlockHeader(istream &is, uint64_t start, uint64_t end, uint64_t &pos)
+{
+	/// Search the file for the first word position >= start and
+	/// < end that looks like the start of an EVIO block header. A
+	/// candidate must have a valid magic word in the 8th word, a
+	/// header length of 8, and a block length that fits in the file.
+	/// Returns false if none is found.
+
+	const uint64_t Nwords_chunk = 1<<20; // search 4MB at a time
+	vector<uint32_t> words(Nwords_chunk + 8);
+	
+	for(uint64_t chunk_start = start; chunk_start < end; chunk_start += Nwords_chunk*4){
+		is.clear();
+		is.seekg(chunk_start, ios_base::beg);
+		is.read((char*)words.data(), words.size()*sizeof(uint32_t));
+		uint64_t Nread = is.gcount()/sizeof(uint32_t);
+		if(Nread < 8) return false;
+		
+		for(uint64_t i=0; i+7<Nread && i<Nwords_chunk; i++){
+			uint32_t magic = words[i+7];
+			if(magic!=0xc0da0100 && magic!=0x0001dac0) continue;
+			bool swap_needed = (magic==0x0001dac0);
+			uint32_t headerlen = swap_needed ? swap32(words[i+2]):words[i+2];
+			uint32_t length    = swap_needed ? swap32(words[i  ]):words[i  ];
+			if(headerlen != 8) continue;
+			if(length < 8) continue;
+			uint64_t mypos = chunk_start + i*4;
+			if(mypos >= end) return false;
+			if( mypos + ((uint64_t)length<<2) > total_size_bytes ) continue;
+			pos = mypos;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------
+// MapBlockRange
+//------------------------
+bool HDEVIO::MapBlockRange(istream &is, uint64_t start, uint64_t end, vector<EVIOBlockRecord> &blocks, uint64_t &Nbad, atomic<uint64_t> *bytes_done)
+{
+	/// Map all EVIO blocks whose header starts at or after start and
+	/// before end. The block at start must be a valid block header.
+	/// Blocks are appended to the given vector. This may be called
+	/// simultaneously from multiple threads as long as each uses its
+	/// own stream. It only modifies its arguments.
+	/// Returns false if a bad block header was found (a record for it
+	/// with type kBT_UNKNOWN is added as the last block).
+
+	is.clear();
+	is.seekg(start, ios_base::beg);
 	BLOCKHEADER_t bh;
-	uint64_t Nblocks = 0;
-	while(ifs.good()){
-		ifs.read((char*)&bh, sizeof(bh));
-		if(!ifs.good()) break;
+	uint64_t pos = start;
+	while( pos<end && is.good() ){
+		is.read((char*)&bh, sizeof(bh));
+		if(!is.good()) break;
 		
 		// Check if we need to byte swap and simultaneously
 		// verify header is good by checking magic word
@@ -718,22 +1354,20 @@ void HDEVIO::MapBlocks(bool print_ticker)
 			swap_needed = true;
 		}else{
 			if(bh.magic!=0xc0da0100){
-				err_mess.str("Bad magic word");
-				err_code = HDEVIO_BAD_BLOCK_HEADER;
 				EVIOBlockRecord br;
-				br.pos = ifs.tellg() - (streampos)sizeof(bh);
+				br.pos = pos;
+				br.block_len = 0;
+				br.swap_needed = false;
+				br.first_event = 0;
+				br.last_event = 0;
 				br.block_type = kBT_UNKNOWN;
-				evio_blocks.push_back(br);
-				break;
+				blocks.push_back(br);
+				return false;
 			}
 		}
 		
 		if(swap_needed)swap_block((uint32_t*)&bh, sizeof(bh)>>2, (uint32_t*)&bh);
 		
-		Nblocks++;
-		streampos block_len_bytes = (bh.length<<2)-sizeof(bh); // <<2 is for *4
-		streampos pos = ifs.tellg() - (streampos)sizeof(bh);
-		
 		EVIOBlockRecord br;
 		br.pos = pos;
 		br.block_len = bh.length;
@@ -763,58 +1397,61 @@ void HDEVIO::MapBlocks(bool print_ticker)
 				break;
 			default:
 				br.block_type   = kBT_UNKNOWN;
-				_DBG_ << "Uknown tag: " << hex << tag << dec << endl;
+				if(VERBOSE>1) _DBG_ << "Uknown tag: " << hex << tag << dec << endl;
+		}
+		
+		if( bh.length < 8 ){
+			br.block_type = kBT_UNKNOWN;
+			blocks.push_back(br);
+			return false;
 		}
 		
 		// Scan through and map all events within this block
-		if( !SKIP_EVENT_MAPPING ) MapEvents(bh, br);
+		if( !SKIP_EVENT_MAPPING ) MapEvents(is, bh, br, Nbad);
 
 		// Add block to list
-		evio_blocks.push_back(br);
+		blocks.push_back(br);
 		
-		// Update ticker
-		if(print_ticker){
-			if((Nblocks%500) == 0){
-				uint64_t total_MB = total_size_bytes>>20;
-				uint64_t read_MB  = ifs.tellg()>>20;
-				if(Nblocks==0) cout << endl;
-				cout << Nblocks << " blocks scanned (" << read_MB << "/" << total_MB << " MB " << (100*read_MB/total_MB) << "%)     \r";
-				cout.flush();
-			}
-		}
-
 		// Advance file pointer to start of next EVIO block header
-		ifs.seekg(block_len_bytes, ios_base::cur);
+		pos += ((uint64_t)bh.length)<<2;
+		is.seekg(pos, ios_base::beg);
+		
+		if(bytes_done) *bytes_done += ((uint64_t)bh.length)<<2;
 	}
 	
-	if(print_ticker) cout << endl;
-	
-	// Setup iterators for sparse reading
-	sparse_block_iter = evio_blocks.begin();
-	sparse_event_idx = 0;
-
-	// Restore file pos and set flag that file has been mapped
-	ifs.clear();
-	ifs.seekg(start_pos, ios_base::beg);
-	is_mapped = true;
+	return true;
 }
 
 //---------------------------------
 // MapEvents
 //---------------------------------
 void HDEVIO::MapEvents(BLOCKHEADER_t &bh, EVIOBlockRecord &br)
+{
+	uint64_t Nbad = 0;
+	MapEvents(ifs, bh, br, Nbad);
+	Nbad_events += Nbad;
+	Nerrors     += Nbad;
+}
+
+//---------------------------------
+// MapEvents
+//---------------------------------
+void HDEVIO::MapEvents(istream &is, BLOCKHEADER_t &bh, EVIOBlockRecord &br, uint64_t &Nbad)
 {
 	/// This is called if the EVIO  block header indicates that
 	/// it contains more than one top-level event. The position
 	/// and event length of the first top-level event are passed
-	/// in as starting parameters.
+	/// in as starting parameters. The stream is expected to be
+	/// positioned just after the block header (i.e. sizeof(bh)
+	/// bytes past the start of the block). Nbad is incremented
+	/// for each bad event found.
 	
 	// Record stream position upon entry so we can restore it at end
-	streampos start_pos = ifs.tellg();
+	streampos start_pos = is.tellg();
 	
 	// Calculate stream position of EVIO event
 	streampos pos = start_pos -(streampos)sizeof(BLOCKHEADER_t)  + (streampos)(8<<2); // (8<<2) is 8 word EVIO block header times 4bytes/word 
-	ifs.seekg(pos, ios_base::beg);
+	is.seekg(pos, ios_base::beg);
 	
 	EVENTHEADER_t myeh;
 	for(uint32_t i=0; i<bh.eventcnt; i++){
@@ -826,18 +1463,18 @@ void HDEVIO::MapEvents(BLOCKHEADER_t &bh, EVIOBlockRecord &br)
 		if(i!=0){
 			// Read in first few words of event
 			eh = &myeh;
-			ifs.read((char*)eh, sizeof(EVENTHEADER_t));
-			if(!ifs.good()) break;
+			is.read((char*)eh, sizeof(EVENTHEADER_t));
+			if(!is.good()) break;
 			if(br.swap_needed)swap_block((uint32_t*)eh, sizeof(EVENTHEADER_t)>>2, (uint32_t*)eh);
 		}else{
-			ifs.seekg(sizeof(EVENTHEADER_t), ios_base::cur);
+			is.seekg(sizeof(EVENTHEADER_t), ios_base::cur);
 		}
 
 		if (eh->event_len < 2) {
 			// Before disabling this warning (or hiding it behind a VERBOSE flag)
 			// you should ask yourself the question, "Is this something that we
 			// should simply be ignoring, garbage bytes in the input evio file?"
-			std::cout << "HDEVIO::MapEvents warning - " << "Attempt to swap bank with len<2 (len="<<eh->event_len<<" header="<<hex<<eh->header<<dec<<" pos=" << pos << " tellg=" << ifs.tellg() << " i=" << i << ")" << std::endl;
+			std::cout << "HDEVIO::MapEvents warning - " << "Attempt to swap bank with len<2 (len="<<eh->event_len<<" header="<<hex<<eh->header<<dec<<" pos=" << pos << " tellg=" << is.tellg() << " i=" << i << ")" << std::endl;
 			
 			// Reference run 20495: Seems ROL is putting BOR bank header, but
 			// the bank has no data in it. For this case we can go forward, but
@@ -863,12 +1500,11 @@ void HDEVIO::MapEvents(BLOCKHEADER_t &bh, EVIOBlockRecord &br)
 					_DBG_ << "         To avoid stopping, re-run with EVIO:IGNORE_EMPTY_BOR=1 ." << endl;				}
 			}
 			
-			Nbad_events++;
-			Nerrors++;
+			Nbad++;
 			// --i;  // This caused an infinite loop when reading hd_rawdata_020058_000.evio DL
 			streampos delta = (streampos)((eh->event_len+1)<<2) - 
                               (streampos)sizeof(EVENTHEADER_t);
-			ifs.seekg(delta, ios_base::cur);
+			is.seekg(delta, ios_base::cur);
 			pos += (streampos)((eh->event_len+1)<<2);
 			continue;
 		}
@@ -919,12 +1555,12 @@ void HDEVIO::MapEvents(BLOCKHEADER_t &bh, EVIOBlockRecord &br)
 		
 		// Move file position to start of next event
 		streampos delta = (streampos)((eh->event_len+1)<<2) - (streampos)sizeof(EVENTHEADER_t);
-		ifs.seekg(delta, ios_base::cur);
+		is.seekg(delta, ios_base::cur);
 		pos += (streampos)((eh->event_len+1)<<2);
 	}
 
-	ifs.clear();
-	ifs.seekg(start_pos, ios_base::beg);
+	is.clear();
+	is.seekg(start_pos, ios_base::beg);
 }
 
 //---------------------------------
@@ -1321,6 +1957,12 @@ void HDEVIO::PrintFileSummary(void)
 //------------------------
 void HDEVIO::SaveFileMap(string fname)
 {
+	// Binary maps are much faster to read back in
+	if(fname.size()>5 && fname.substr(fname.size()-5)==".bmap"){
+		SaveBinaryFileMap(fname);
+		return;
+	}
+
 	// Make sure file has been mapped
 	if(!is_mapped) MapBlocks();
 	
@@ -1386,13 +2028,15 @@ void HDEVIO::ReadFileMap(string fname, bool warn_if_not_found)
 			bname = filename.substr(pos+1, filename.size()-pos);
 		}
 
+		// Binary maps are checked first since they are faster to
+		// read and can be validated against the file size.
 		vector<string> fnames;
-		fnames.push_back(filename + ".map");
-		fnames.push_back(dname + "/filemaps/" + bname + ".map");
-		fnames.push_back(bname + ".map");
 		fnames.push_back(filename + ".bmap");
 		fnames.push_back(dname + "/filemaps/" + bname + ".bmap");
 		fnames.push_back(bname + ".bmap");
+		fnames.push_back(filename + ".map");
+		fnames.push_back(dname + "/filemaps/" + bname + ".map");
+		fnames.push_back(bname + ".map");
 		
 		// Loop over possible names until we find one that is readable
 		for(string f : fnames){
@@ -1409,6 +2053,11 @@ void HDEVIO::ReadFileMap(string fname, bool warn_if_not_found)
 	
 	if(fname=="") return;
 	
+	if(fname.size()>5 && fname.substr(fname.size()-5)==".bmap"){
+		ReadBinaryFileMap(fname, warn_if_not_found);
+		return;
+	}
+	
 	// Open map file
 	ifstream ifs(fname.c_str());
 	if(!ifs.is_open()){
@@ -1435,10 +2084,12 @@ void HDEVIO::ReadFileMap(string fname, bool warn_if_not_found)
 	ifs.seekg(0);
 	
 	// Loop over header
+	bool map_swap_needed = false;
 	while(getline(ifs, line)){
 		
 		if(line.length() < 5   ) continue;
 		if(line.find("#") == 0 ) continue;
+		if(line.find("swap_needed:") == 0 ) map_swap_needed = atoi(line.substr(12).c_str()) != 0;
 		if(line.find("Start of block data") != string::npos) break;
 	}
 	
@@ -1474,6 +2125,7 @@ void HDEVIO::ReadFileMap(string fname, bool warn_if_not_found)
 				first_block_found = true;
 			}
 			br.evio_events.clear();
+			br.swap_needed = map_swap_needed;
 			uint64_t tmp64;
 			ss << hex;
 			ss >> tmp64; br.pos = tmp64; // operator>> won't stream directly to streampos
@@ -1490,3 +2142,288 @@ void HDEVIO::ReadFileMap(string fname, bool warn_if_not_found)
 	cout << "Read EVIO file map from: " << fname << endl;
 }
 
+// On-disk layout of binary map (.bmap) files. All values are
+// written in native byte order. The file is a FileMapHeader_t
+// followed by Nblocks FileMapBlock_t records, each immediately
+// followed by its Nevents FileMapEvent_t records, and ends with
+// an 8 byte trailer. The trailer is only written after everything
+// else so its absence means the file was not closed cleanly.
+struct FileMapHeader_t{
+	char     magic[8];        // "HDEVIOIX"
+	uint32_t version;
+	uint32_t header_size;     // sizeof(FileMapHeader_t)
+	uint64_t file_size;       // size of EVIO file when map was made
+	int64_t  file_mtime;      // modification time of EVIO file when map was made
+	uint64_t mapped_bytes;    // bytes at start of EVIO file covered by map
+	uint64_t Nblocks;
+	uint64_t Nevents;         // total EVIO event records
+};
+struct FileMapBlock_t{
+	uint64_t pos;
+	uint64_t first_event;
+	uint64_t last_event;
+	uint32_t block_len;
+	uint32_t Nevents;
+	uint32_t block_type;
+	uint32_t swap_needed;
+};
+struct FileMapEvent_t{
+	uint64_t pos;
+	uint64_t first_event;
+	uint64_t last_event;
+	uint32_t event_len;
+	uint32_t event_header;
+	uint32_t event_type;
+	uint32_t reserved;
+};
+static const char     FILEMAP_MAGIC[8]   = {'H','D','E','V','I','O','I','X'};
+static const char     FILEMAP_TRAILER[8] = {'H','D','E','V','I','O','E','N'};
+static const uint32_t FILEMAP_VERSION    = 1;
+
+//------------------------
+// SaveBinaryFileMap
+//------------------------
+bool HDEVIO::SaveBinaryFileMap(string fname)
+{
+	/// Write the block map in binary form. This is read back
+	/// by ReadBinaryFileMap (called automatically by ReadFileMap
+	/// if a file with the same name as the EVIO file plus ".bmap"
+	/// exists). The EVIO file's size and modification time are
+	/// recorded so that a stale map can be detected. If the EVIO
+	/// file has only grown since the map was made (e.g. it is still
+	/// being written) then the existing map is used and MapBlocks
+	/// will only scan the new part of the file.
+	///
+	/// The map is written to a temporary file and then renamed so
+	/// that readers never see a partially written map.
+
+	// Make sure file has been mapped
+	if(!is_mapped) MapBlocks();
+	
+	if(fname=="") fname = filename + ".bmap";
+	string tmpname = fname + ".tmp";
+	
+	struct stat st;
+	if( stat(filename.c_str(), &st) != 0 ){
+		cerr << "Unable to stat \""<<filename<<"\"! Binary map not written." << endl;
+		return false;
+	}
+	
+	FileMapHeader_t hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, FILEMAP_MAGIC, sizeof(hdr.magic));
+	hdr.version      = FILEMAP_VERSION;
+	hdr.header_size  = sizeof(FileMapHeader_t);
+	hdr.file_size    = total_size_bytes;
+	hdr.file_mtime   = st.st_mtime;
+	hdr.mapped_bytes = mapped_bytes;
+	hdr.Nblocks      = evio_blocks.size();
+	for(auto &br : evio_blocks) hdr.Nevents += br.evio_events.size();
+	
+	// Build whole map in memory so it can be written in one go
+	vector<char> obuff(sizeof(hdr) + hdr.Nblocks*sizeof(FileMapBlock_t) + hdr.Nevents*sizeof(FileMapEvent_t) + sizeof(FILEMAP_TRAILER));
+	char *ptr = obuff.data();
+	memcpy(ptr, &hdr, sizeof(hdr)); ptr += sizeof(hdr);
+	for(auto &br : evio_blocks){
+		FileMapBlock_t fb;
+		fb.pos         = (uint64_t)br.pos;
+		fb.first_event = br.first_event;
+		fb.last_event  = br.last_event;
+		fb.block_len   = br.block_len;
+		fb.Nevents     = br.evio_events.size();
+		fb.block_type  = br.block_type;
+		fb.swap_needed = br.swap_needed;
+		memcpy(ptr, &fb, sizeof(fb)); ptr += sizeof(fb);
+		
+		for(auto &er : br.evio_events){
+			FileMapEvent_t fe;
+			fe.pos          = (uint64_t)er.pos;
+			fe.first_event  = er.first_event;
+			fe.last_event   = er.last_event;
+			fe.event_len    = er.event_len;
+			fe.event_header = er.event_header;
+			fe.event_type   = er.event_type;
+			fe.reserved     = 0;
+			memcpy(ptr, &fe, sizeof(fe)); ptr += sizeof(fe);
+		}
+	}
+	memcpy(ptr, FILEMAP_TRAILER, sizeof(FILEMAP_TRAILER));
+	
+	ofstream ofs(tmpname.c_str(), ios::binary | ios::trunc);
+	if(!ofs.is_open()){
+		cerr << "Unable to open \""<<tmpname<<"\" for writing!" << endl;
+		return false;
+	}
+	ofs.write(obuff.data(), obuff.size());
+	ofs.close();
+	if(!ofs || rename(tmpname.c_str(), fname.c_str())!=0){
+		cerr << "Error writing binary EVIO file map to \""<<fname<<"\"!" << endl;
+		unlink(tmpname.c_str());
+		return false;
+	}
+	
+	if(VERBOSE>0) cout << "Wrote binary EVIO file map to: " << fname << " (" << hdr.Nblocks << " blocks, " << hdr.Nevents << " events)" << endl;
+	
+	return true;
+}
+
+//------------------------
+// CheckMappedBlock
+//------------------------
+bool HDEVIO::CheckMappedBlock(const EVIOBlockRecord &br)
+{
+	/// Compare a block record from a map file with the EVIO file
+	/// itself. The block header must have the recorded length and
+	/// byte order and the first event in the block (if any) the
+	/// recorded header word. Returns false if anything differs.
+
+	ifstream evio_ifs(filename.c_str(), ios::binary);
+	uint32_t bh[8];
+	evio_ifs.seekg(br.pos, ios_base::beg);
+	evio_ifs.read((char*)bh, sizeof(bh));
+	if(!evio_ifs.good()) return false;
+	
+	if( bh[7] != (br.swap_needed ? 0x0001dac0:0xc0da0100) ) return false;
+	uint32_t block_len = br.swap_needed ? swap32(bh[0]):bh[0];
+	if( block_len != br.block_len ) return false;
+	
+	if(br.evio_events.empty()) return true;
+	const EVIOEventRecord &er = br.evio_events.front();
+	uint32_t eh[2];
+	evio_ifs.seekg(er.pos, ios_base::beg);
+	evio_ifs.read((char*)eh, sizeof(eh));
+	if(!evio_ifs.good()) return false;
+	uint32_t event_len = br.swap_needed ? swap32(eh[0]):eh[0];
+	uint32_t header    = br.swap_needed ? swap32(eh[1]):eh[1];
+
+	return (event_len+1)==er.event_len && header==er.event_header;
+}
+
+//------------------------
+// ReadBinaryFileMap
+//------------------------
+bool HDEVIO::ReadBinaryFileMap(string fname, bool warn_if_not_found)
+{
+	/// Read a binary map written by SaveBinaryFileMap. Returns true
+	/// if the map was used. If the EVIO file has grown since the map
+	/// was written, the map is used for the part of the file it
+	/// covers and MapBlocks will pick up from there. Since the
+	/// modification time of a growing file changes, the first and
+	/// last mapped block headers are checked against the file in
+	/// that case to catch files that were rewritten rather than
+	/// appended to. Maps that don't match the file in any other way
+	/// are ignored.
+
+	ifstream ifs(fname.c_str(), ios::binary);
+	if(!ifs.is_open()){
+		if(warn_if_not_found) cerr << "Unable to open \""<<fname<<"\" for reading!" << endl;
+		return false;
+	}
+	
+	// Read entire map file into memory
+	ifs.seekg(0, ios_base::end);
+	uint64_t map_size = ifs.tellg();
+	ifs.seekg(0, ios_base::beg);
+	if(map_size < sizeof(FileMapHeader_t) + sizeof(FILEMAP_TRAILER)){
+		cerr << "Binary map file \"" << fname << "\" is too short. Ignoring." << endl;
+		return false;
+	}
+	vector<char> ibuff(map_size);
+	ifs.read(ibuff.data(), map_size);
+	if(!ifs){
+		cerr << "Error reading binary map file \"" << fname << "\". Ignoring." << endl;
+		return false;
+	}
+	ifs.close();
+	
+	FileMapHeader_t hdr;
+	memcpy(&hdr, ibuff.data(), sizeof(hdr));
+	if( memcmp(hdr.magic, FILEMAP_MAGIC, sizeof(hdr.magic)) != 0 ){
+		cerr << "File \"" << fname << "\" is not an HDEVIO binary map. Ignoring." << endl;
+		return false;
+	}
+	if( hdr.version!=FILEMAP_VERSION || hdr.header_size!=sizeof(FileMapHeader_t) ){
+		cerr << "Binary map file \"" << fname << "\" has unsupported version " << hdr.version << ". Ignoring." << endl;
+		return false;
+	}
+	uint64_t expected_size = sizeof(hdr) + hdr.Nblocks*sizeof(FileMapBlock_t) + hdr.Nevents*sizeof(FileMapEvent_t) + sizeof(FILEMAP_TRAILER);
+	if( expected_size!=map_size || memcmp(&ibuff[map_size-sizeof(FILEMAP_TRAILER)], FILEMAP_TRAILER, sizeof(FILEMAP_TRAILER))!=0 ){
+		cerr << "Found binary map file \"" << fname << "\" but it wasn't closed cleanly. Ignoring." << endl;
+		return false;
+	}
+	
+	// Check map against EVIO file
+	struct stat st;
+	if( stat(filename.c_str(), &st) != 0 ) return false;
+	bool complete = (hdr.file_size==total_size_bytes) && (hdr.file_mtime==(int64_t)st.st_mtime);
+	bool partial  = !complete && (total_size_bytes > hdr.file_size);
+	if( !complete && !partial ){
+		cerr << "Binary map file \"" << fname << "\" does not match \"" << filename << "\" (file changed?). Ignoring." << endl;
+		return false;
+	}
+	
+	// Unpack
+	evio_blocks.clear();
+	evio_blocks.reserve(hdr.Nblocks);
+	const char *ptr = &ibuff[sizeof(hdr)];
+	const char *end = &ibuff[map_size-sizeof(FILEMAP_TRAILER)];
+	for(uint64_t iblock=0; iblock<hdr.Nblocks; iblock++){
+		FileMapBlock_t fb;
+		memcpy(&fb, ptr, sizeof(fb)); ptr += sizeof(fb);
+		if( ptr + fb.Nevents*sizeof(FileMapEvent_t) > end ){
+			cerr << "Binary map file \"" << fname << "\" is corrupt. Ignoring." << endl;
+			evio_blocks.clear();
+			return false;
+		}
+		
+		evio_blocks.push_back(EVIOBlockRecord());
+		EVIOBlockRecord &br = evio_blocks.back();
+		br.pos         = fb.pos;
+		br.block_len   = fb.block_len;
+		br.swap_needed = fb.swap_needed;
+		br.first_event = fb.first_event;
+		br.last_event  = fb.last_event;
+		br.block_type  = (BLOCKTYPE)fb.block_type;
+		br.evio_events.resize(fb.Nevents);
+		for(auto &er : br.evio_events){
+			FileMapEvent_t fe;
+			memcpy(&fe, ptr, sizeof(fe)); ptr += sizeof(fe);
+			er.pos          = fe.pos;
+			er.event_len    = fe.event_len;
+			er.event_header = fe.event_header;
+			er.first_event  = fe.first_event;
+			er.last_event   = fe.last_event;
+			er.event_type   = (BLOCKTYPE)fe.event_type;
+		}
+	}
+	
+	mapped_bytes = hdr.mapped_bytes;
+	is_mapped = complete;
+	
+	// If the file was still being written when the map was made then
+	// the last block may have been incomplete. Drop it so it gets
+	// mapped again.
+	if(partial && !evio_blocks.empty()){
+		mapped_bytes = (uint64_t)evio_blocks.back().pos;
+		evio_blocks.pop_back();
+	}
+	if(partial && !evio_blocks.empty()){
+		if( !CheckMappedBlock(evio_blocks.front()) || !CheckMappedBlock(evio_blocks.back()) ){
+			cerr << "Binary map file \"" << fname << "\" does not match \"" << filename << "\" (file rewritten?). Ignoring." << endl;
+			evio_blocks.clear();
+			mapped_bytes = 0;
+			return false;
+		}
+	}
+	sparse_block_iter = evio_blocks.begin();
+	sparse_event_idx = 0;
+	
+	if(VERBOSE>0){
+		cout << "Read binary EVIO file map from: " << fname;
+		if(partial) cout << " (covers " << mapped_bytes << " of " << total_size_bytes << " bytes)";
+		cout << endl;
+	}
+	
+	return true;
+}
+
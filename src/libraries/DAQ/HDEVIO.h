@@ -15,6 +15,7 @@
 
 
 #include <stdint.h>
+#include <atomic>
 #include <vector>
 #include <set>
 #include <string>
@@ -23,6 +24,8 @@
 #include <iostream>
 using namespace std;
 
+#include "swap_block_simd.h"
+
 // ----- Stolen from evio.h -----------
 #define swap64(x) ( (((x) >> 56) & 0x00000000000000FFL) | \
                          (((x) >> 40) & 0x000000000000FF00L) | \
@@ -187,6 +190,11 @@ class HDEVIO{
 		int  VERBOSE;
 		bool IGNORE_EMPTY_BOR;
 		bool SKIP_EVENT_MAPPING;
+		uint32_t MAP_NTHREADS;    // max. threads MapBlocks may use (0 or 1 means map serially)
+		bool AUTO_SAVE_INDEX;     // write binary index (.bmap) next to file after MapBlocks
+		
+		bool is_mmapped;          // true if OpenMemoryMap() succeeded and readMapped() may be used
+		uint64_t MMAP_READAHEAD;  // bytes ahead of current position to madvise(MADV_WILLNEED)
 		
 		stringstream err_mess;  // last error message
 		uint32_t err_code;    // last error code
@@ -201,6 +209,9 @@ class HDEVIO{
 		bool read(uint32_t *user_buff, uint32_t user_buff_len, bool allow_swap=true);
 		bool readSparse(uint32_t *user_buff, uint32_t user_buff_len, bool allow_swap=true);
 		bool readNoFileBuff(uint32_t *user_buff, uint32_t user_buff_len, bool allow_swap=true);
+		bool readMapped(uint32_t* &event_ptr, uint32_t &event_len);
+		bool OpenMemoryMap(void);
+		void CloseMemoryMap(void);
 		void rewind(void);
 		uint64_t GetNWordsLeftInFile(void);
 
@@ -213,12 +224,20 @@ class HDEVIO{
 		void PrintFileSummary(void);
 		void SaveFileMap(string fname="");
 		void ReadFileMap(string fname="", bool warn_if_not_found=false);
+		bool SaveBinaryFileMap(string fname="");
+		bool ReadBinaryFileMap(string fname, bool warn_if_not_found=false);
+		bool CheckMappedBlock(const EVIOBlockRecord &br);
 
 		uint32_t GetEventMask(void) { return event_type_mask; }
 		uint32_t SetEventMask(uint32_t mask);
 		uint32_t SetEventMask(string types_str);
 		uint32_t AddToEventMask(string type_str);
 		vector<EVIOBlockRecord>& GetEVIOBlockRecords(void);
+		bool SeekToEVIOEvent(uint64_t ievent);
+		bool SeekToEvent(uint64_t event_number);
+		uint64_t SelectEvents(const vector<pair<uint64_t,uint64_t> > &ranges, uint32_t always_mask=(1<<kBT_BOR));
+		void ClearEventSelection(void);
+		bool HasEventSelection(void){ return selection_active; }
 		
 	protected:
 	
@@ -226,13 +245,32 @@ class HDEVIO{
 
 		bool is_mapped;
 		uint64_t total_size_bytes;
+		uint64_t mapped_bytes;      // bytes at start of file covered by evio_blocks
 		vector<EVIOBlockRecord> evio_blocks;
 		void MapBlocks(bool print_ticker=true);
+		bool MapBlockRange(istream &is, uint64_t start, uint64_t end, vector<EVIOBlockRecord> &blocks, uint64_t &Nbad, atomic<uint64_t> *bytes_done=NULL);
+		bool FindBlockHeader(istream &is, uint64_t start, uint64_t end, uint64_t &pos);
 		void MapEvents(BLOCKHEADER_t &bh, EVIOBlockRecord &br);
+		void MapEvents(istream &is, BLOCKHEADER_t &bh, EVIOBlockRecord &br, uint64_t &Nbad);
 		vector<EVIOBlockRecord>::iterator sparse_block_iter;
 		uint32_t sparse_event_idx;
+		bool FindEventRecord(uint64_t event_number, vector<EVIOBlockRecord>::iterator &bit, uint32_t &ievent);
+		
+		// Used only if SelectEvents has been called. These are
+		// (block index, event index) pairs in file order.
+		bool selection_active;
+		vector<pair<uint32_t,uint32_t> > selected_events;
+		uint64_t selected_idx;
 		EVIOBlockRecord NB_block_record;
 		streampos NB_next_pos;
+		
+		// Used only in memory mapped mode (see readMapped)
+		int       mmap_fd;
+		uint8_t  *mmap_base;        // start of read-only mapping of entire file
+		uint32_t *mmap_next;        // next EVIO event in current block
+		uint32_t *mmap_block_end;   // word just past end of current block
+		uint64_t  mmap_advised_end; // file offset up to which madvise has been called
+		void AdviseAhead(uint64_t pos);
 
 		void ClearErrorMessage(void){ err_mess.str(""); err_mess.clear();}
 		void SetErrorMessage(string mess){ ClearErrorMessage(); err_mess<<mess;}
@@ -280,8 +318,9 @@ class HDEVIO{
 		//---------------------------------
 		// swap_block
 		//---------------------------------
-		inline void swap_block(uint16_t *inbuff, uint16_t len, uint16_t *outbuff)
+		inline void swap_block(uint16_t *inbuff, uint32_t len, uint16_t *outbuff)
 		{
+			if(len >= SWAP_SIMD_MIN_WORDS){ swap_words16(inbuff, len, outbuff); return; }
 			for(uint32_t i=0; i<len; i++, inbuff++, outbuff++){
 				*outbuff = swap16(*inbuff);
 			}
@@ -292,6 +331,7 @@ class HDEVIO{
 		//---------------------------------
 		inline void swap_block(uint32_t *inbuff, uint32_t len, uint32_t *outbuff)
 		{
+			if(len >= SWAP_SIMD_MIN_WORDS){ swap_words32(inbuff, len, outbuff); return; }
 			for(uint32_t i=0; i<len; i++, inbuff++, outbuff++){
 				*outbuff = swap32(*inbuff);
 			}
@@ -302,6 +342,7 @@ class HDEVIO{
 		//---------------------------------
 		inline void swap_block(uint64_t *inbuff, uint64_t len, uint64_t *outbuff)
 		{
+			if(len >= SWAP_SIMD_MIN_WORDS){ swap_words64(inbuff, len, outbuff); return; }
 			for(uint64_t i=0; i<len; i++, inbuff++, outbuff++){
 				*outbuff = swap64(*inbuff);
 			}
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <time.h>
+#include <ctype.h>
 
 #include <forward_list>
 #include <chrono>
@@ -98,7 +99,12 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 	F250_EMULATION_VERSION = 2;
 	RECORD_CALL_STACK = false;
 	TREAT_TRUNCATED_AS_ERROR = false;
+	USE_MMAP = false;
+	MMAP_READAHEAD_MB = 64;
+	SAVE_INDEX = false;
 	SYSTEMS_TO_PARSE = "";
+	EVENT_RANGE = "";
+	EVENT_LIST = "";
 
 	gPARMS->SetDefaultParameter("EVIO:VERBOSE", VERBOSE, "Set verbosity level for processing and debugging statements while parsing. 0=no debugging messages. 10=all messages");
 	gPARMS->SetDefaultParameter("ET:VERBOSE", VERBOSE_ET, "Set verbosity level for processing and debugging statements while reading from ET. 0=no debugging messages. 10=all messages");
@@ -132,6 +138,9 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 	gPARMS->SetDefaultParameter("EVIO:APPLY_TRANSLATION_TABLE", APPLY_TRANSLATION_TABLE, "Apply the translation table to create DigiHits (you almost always want this on)");
 	gPARMS->SetDefaultParameter("EVIO:IGNORE_EMPTY_BOR", IGNORE_EMPTY_BOR, "Set to non-zero to continue processing data even if an empty BOR event is encountered.");
 	gPARMS->SetDefaultParameter("EVIO:TREAT_TRUNCATED_AS_ERROR", TREAT_TRUNCATED_AS_ERROR, "Set to non-zero to have a truncated EVIO file the JANA return code to non-zero indicating the program errored.");
+	gPARMS->SetDefaultParameter("EVIO:USE_MMAP", USE_MMAP, "Set to non-zero to memory map input files and hand events to the parser threads without copying them (swapped events are still copied). Ignored for ET sources and when EVIO:EVENT_RANGE or EVIO:EVENT_LIST is set.");
+	gPARMS->SetDefaultParameter("EVIO:SAVE_INDEX", SAVE_INDEX, "Set to non-zero to write a binary index (.bmap) of the EVIO file next to it whenever the file has to be mapped (e.g. for EVIO:EVENT_RANGE). It is read back automatically on the next run.");
+	gPARMS->SetDefaultParameter("EVIO:MMAP_READAHEAD_MB", MMAP_READAHEAD_MB, "Size in MB of region ahead of the current read position to request be paged in when EVIO:USE_MMAP is set. Uses the EVIO file map (if present) to align to block boundaries.");
 
 	gPARMS->SetDefaultParameter("EVIO:F250_EMULATION_MODE", F250_EMULATION_MODE, "Set f250 emulation mode. 0=no emulation, 1=always, 2=auto. Default is 2 (auto).");
 	gPARMS->SetDefaultParameter("EVIO:F125_EMULATION_MODE", F125_EMULATION_MODE, "Set f125 emulation mode. 0=no emulation, 1=always, 2=auto. Default is 2 (auto).");
@@ -141,11 +150,36 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 			"Default is empty string which means to parse all. System "
 			"names should be what is returned by DTranslationTable::DetectorName() .");
 
+	gPARMS->SetDefaultParameter("EVIO:EVENT_RANGE", EVENT_RANGE,
+			"Comma separated list of event numbers and/or inclusive ranges "
+			"(e.g. \"1000-2000,5001\") to process. Only physics events in "
+			"the list are returned (BOR events are always read). For files, "
+			"the block map is used to read only the parts of the file containing "
+			"the events. Default is empty string which means process all events.");
+	gPARMS->SetDefaultParameter("EVIO:EVENT_LIST", EVENT_LIST,
+			"Name of file containing event numbers and/or ranges to process. "
+			"Same format as EVIO:EVENT_RANGE, but entries may also be separated "
+			"by whitespace and anything after a \"#\" is ignored. May be combined "
+			"with EVIO:EVENT_RANGE.");
+
 
 	if(gPARMS->Exists("RECORD_CALL_STACK")) gPARMS->GetParameter("RECORD_CALL_STACK", RECORD_CALL_STACK);
 
 	// Set rocids of all systems to parse (if specified)
 	DTranslationTable::SetSystemsToParse(SYSTEMS_TO_PARSE, this);
+	
+	// Set events to process (if specified)
+	if(!EVENT_RANGE.empty()) AddEventRanges(EVENT_RANGE, "EVIO:EVENT_RANGE");
+	if(!EVENT_LIST.empty()){
+		ifstream ifs(EVENT_LIST.c_str());
+		if(!ifs.is_open()) throw JException("Unable to open EVIO:EVENT_LIST file: " + EVENT_LIST, __FILE__, __LINE__);
+		string line;
+		while(getline(ifs, line)){
+			auto pos = line.find('#');
+			if(pos != string::npos) line.erase(pos);
+			AddEventRanges(line, EVENT_LIST);
+		}
+	}
 
 	jobtype = DEVIOWorkerThread::JOB_NONE;
 	if( PARSE ) jobtype |= DEVIOWorkerThread::JOB_FULL_PARSE;
@@ -155,6 +189,7 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 	source_type          = kNoSource;
 	hdevio               = NULL;
 	hdet                 = NULL;
+	parsed_events        = NULL;
 	et_quit_next_timeout = false;
 
 	uint64_t run_number_seed = 0;
@@ -185,18 +220,42 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 		}
 		source_type = kFileSource;
 		hdevio->IGNORE_EMPTY_BOR = IGNORE_EMPTY_BOR;
+		hdevio->MMAP_READAHEAD = ((uint64_t)MMAP_READAHEAD_MB)<<20;
+		hdevio->AUTO_SAVE_INDEX = SAVE_INDEX;
+		if(USE_MMAP && !selected_event_ranges.empty()){
+			// Selected events are read with readSparse, which does not use the mapping
+			static once_flag mmap_warn_flag;
+			call_once(mmap_warn_flag, [](){
+				jout << "EVIO:USE_MMAP is ignored when EVIO:EVENT_RANGE or EVIO:EVENT_LIST is set. Events will be read without memory mapping." << endl;
+			});
+		}else if(USE_MMAP && !hdevio->OpenMemoryMap()){
+			jerr << hdevio->err_mess.str() << endl;
+			jerr << "Unable to memory map EVIO file. Falling back to regular reads." << endl;
+		}
 		
 		run_number_seed = SearchFileForRunNumber(); // try and dig out run number from file
+		
+		// Restrict reading to only EVIO events containing selected events
+		if(!selected_event_ranges.empty()){
+			uint64_t Nselected = hdevio->SelectEvents(selected_event_ranges);
+			jout << "EVIO event selection: reading " << Nselected << " EVIO events from " << this->source_name << endl;
+		}
 	}
 
 	if(VERBOSE>0) evioout << "Success opening event source \"" << this->source_name << "\"!" <<endl;
 	
+	// Create ring used to pass parsed events from workers to GetEvent.
+	// Each slot holds at least one event so MAX_PARSED_EVENTS slots
+	// is enough. Make sure there are always more than the number
+	// of workers.
+	parsed_events = new DParsedEventRing(max(MAX_PARSED_EVENTS, 2*NTHREADS));
+
 	// Create dispatcher thread
 	dispatcher_thread = new thread(&JEventSource_EVIOpp::Dispatcher, this);
 
 	// Create worker threads
 	for(uint32_t i=0; i<NTHREADS; i++){
-		DEVIOWorkerThread *w = new DEVIOWorkerThread(this, parsed_events, MAX_PARSED_EVENTS, PARSED_EVENTS_MUTEX, PARSED_EVENTS_CV, ROCIDS_TO_PARSE);
+		DEVIOWorkerThread *w = new DEVIOWorkerThread(this, *parsed_events, MAX_PARSED_EVENTS, ROCIDS_TO_PARSE);
 		w->VERBOSE             = VERBOSE;
 		w->MAX_EVENT_RECYCLES  = MAX_EVENT_RECYCLES;
 		w->MAX_OBJECT_RECYCLES = MAX_OBJECT_RECYCLES;
@@ -242,7 +301,6 @@ JEventSource_EVIOpp::~JEventSource_EVIOpp()
 	// Set DONE flag to tell dispatcher thread to quit
 	// as well as anyone in a wait state
 	DONE = true;
-	PARSED_EVENTS_CV.notify_all();
 	
 	// Wait for dispatcher to complete
 	if(dispatcher_thread){
@@ -291,6 +349,9 @@ JEventSource_EVIOpp::~JEventSource_EVIOpp()
 	
 	// Delete all BOR objects
 	for(auto p : borptrs_list) delete p;
+	
+	// Delete parsed event ring (events themselves are owned by worker threads)
+	if(parsed_events) delete parsed_events;
 
 	// Delete HDEVIO and print stats
 	if(hdevio){
@@ -313,7 +374,7 @@ void JEventSource_EVIOpp::Dispatcher(void)
 	/// This is run in a dedicated thread created by the constructor.
 	/// It's job is to read in events and dispatch the processing of
 	/// them to worker threads. When a worker thread is done, it adds
-	/// the event to the parsed_events list and clears its own "in_use"
+	/// the event to the parsed_events ring and clears its own "in_use"
 	/// flag thereby, marking itself as available for another job.
 	/// The worker threads will stall if adding the event(s) it produced
 	/// would make parsed_events contain more than MAX_PARSED_EVENTS.
@@ -346,12 +407,20 @@ void JEventSource_EVIOpp::Dispatcher(void)
 		uint32_t  &buff_len = thr->buff_len;
 		
 		bool swap_needed = false;
+		uint32_t mapped_len = 0;
+		thr->mapped_event = NULL;
 
 		if(source_type==kFileSource){
 			// ---- Read From File ----
 //			hdevio->read(buff, buff_len, allow_swap);
 //			hdevio->readSparse(buff, buff_len, allow_swap);
-			hdevio->readNoFileBuff(buff, buff_len, allow_swap);
+			if(hdevio->HasEventSelection()){
+				hdevio->readSparse(buff, buff_len, allow_swap);
+			}else if(hdevio->is_mmapped){
+				hdevio->readMapped(thr->mapped_event, mapped_len);
+			}else{
+				hdevio->readNoFileBuff(buff, buff_len, allow_swap);
+			}
 			thr->pos = hdevio->last_event_pos;
 			if(hdevio->err_code == HDEVIO::HDEVIO_USER_BUFFER_TOO_SMALL){
 				delete[] buff;
@@ -388,6 +457,14 @@ void JEventSource_EVIOpp::Dispatcher(void)
 			}else{
 				// HDEVIO_OK
 				swap_needed = hdevio->swap_needed;
+				
+				// Mapped events needing a swap are copied into buff
+				// by the worker thread so make sure it is big enough
+				if(thr->mapped_event && swap_needed && SWAP && buff_len<mapped_len){
+					delete[] buff;
+					buff_len = mapped_len;
+					buff = new uint32_t[buff_len];
+				}
 			}
 		}else{
 			// ---- Read From ET ----
@@ -472,20 +549,39 @@ void JEventSource_EVIOpp::Dispatcher(void)
 //----------------
 jerror_t JEventSource_EVIOpp::GetEvent(JEvent &event)
 {
-	// Get next event from list, waiting if necessary
-	unique_lock<std::mutex> lck(PARSED_EVENTS_MUTEX);
-	while(parsed_events.empty()){
-		if(DONE) return NO_MORE_EVENTS_IN_SOURCE;
-		NEVENTBUFF_STALLED++;
-		PARSED_EVENTS_CV.wait_for(lck,std::chrono::milliseconds(1));
-	}
+	// Get next event, taking the next block of events from the
+	// ring and waiting if necessary. DONE is checked before trying
+	// the ring since the workers will have published everything
+	// before the dispatcher sets it.
+	DParsedEvent *pe = NULL;
+	while(!pe){
+		uint32_t Nspins = 0;
+		while(current_events.empty()){
+			bool done = DONE;
+			if( parsed_events->TryPop(current_events) ) continue;
+			if( done ) return NO_MORE_EVENTS_IN_SOURCE;
+			if( ++Nspins < 1000 ){
+				this_thread::yield();
+			}else{
+				NEVENTBUFF_STALLED++;
+				this_thread::sleep_for(std::chrono::milliseconds(1));
+				Nspins = 0;
+			}
+		}
 
-	DParsedEvent *pe = parsed_events.front();
-	parsed_events.pop_front();
-	
-	// Release mutex and notify workers they can use it again
-	lck.unlock();
-	PARSED_EVENTS_CV.notify_all();
+		pe = current_events.front();
+		current_events.pop_front();
+		
+		// Drop physics events that were not selected. (Unselected ones
+		// can come along with selected ones in the same EVIO event if
+		// the CODA block size is > 1, or from ET.)
+		if( !selected_event_ranges.empty() && (pe->borptrs==NULL) ){
+			if( (pe->event_status_bits & (1<<kSTATUS_PHYSICS_EVENT)) && !IsEventSelected(pe->event_number) ){
+				pe->in_use = false; // return pe to pool
+				pe = NULL;
+			}
+		}
+	}
 	
 	// If this is a BOR event, then take ownership of
 	// the DBORptrs object. If not, then copy a pointer
@@ -515,6 +611,60 @@ jerror_t JEventSource_EVIOpp::GetEvent(JEvent &event)
 	return NOERROR;
 }
 
+//----------------
+// AddEventRanges
+//----------------
+void JEventSource_EVIOpp::AddEventRanges(string str, string origin)
+{
+	/// Parse a list of event numbers and/or inclusive ranges of event
+	/// numbers (e.g. "1000-2000,5001") and add them to the list of
+	/// events to process. Entries may be separated by commas or
+	/// whitespace. The combined list is kept sorted with overlapping
+	/// ranges merged so IsEventSelected can binary search it.
+
+	replace(str.begin(), str.end(), ',', ' ');
+	stringstream ss(str);
+	string entry;
+	while(ss >> entry){
+		char *end = NULL;
+		uint64_t first = strtoull(entry.c_str(), &end, 10);
+		uint64_t last  = first;
+		if(*end == '-') last = strtoull(end+1, &end, 10);
+		if( *end!=0 || last<first || !isdigit(entry[0]) ){
+			throw JException("Bad event number or range \"" + entry + "\" in " + origin, __FILE__, __LINE__);
+		}
+		selected_event_ranges.push_back(make_pair(first, last));
+	}
+	
+	// Sort and merge overlapping/adjacent ranges
+	sort(selected_event_ranges.begin(), selected_event_ranges.end());
+	vector<pair<uint64_t,uint64_t> > merged;
+	for(auto &r : selected_event_ranges){
+		if( !merged.empty() && r.first <= merged.back().second+1 ){
+			merged.back().second = max(merged.back().second, r.second);
+		}else{
+			merged.push_back(r);
+		}
+	}
+	selected_event_ranges.swap(merged);
+}
+
+//----------------
+// IsEventSelected
+//----------------
+bool JEventSource_EVIOpp::IsEventSelected(uint64_t event_number)
+{
+	/// Returns true if no event selection was specified or if the
+	/// given event number is in it.
+
+	if(selected_event_ranges.empty()) return true;
+	
+	auto it = upper_bound(selected_event_ranges.begin(), selected_event_ranges.end(), make_pair(event_number, UINT64_MAX));
+	if(it == selected_event_ranges.begin()) return false;
+	--it;
+	return event_number <= it->second;
+}
+
 //----------------
 // FreeEvent
 //----------------
@@ -581,9 +731,10 @@ jerror_t JEventSource_EVIOpp::GetObjects(JEvent &event, JFactory_base *factory)
 		// Copy all low-level hits to appropriate factories
 		pe->CopyToFactories(loop);
 
-		// Apply translation tables to create DigiHit objects
+		// Apply translation tables to create DigiHit objects. The hits
+		// are taken directly from the DParsedEvent.
 		for(auto tt : translationTables){
-			tt->ApplyTranslationTable(loop);
+			tt->ApplyTranslationTable(loop, pe);
 		}
 	}
 	
@@ -23,6 +23,7 @@
 #include <DAQ/HDET.h>
 #include <DAQ/DEVIOWorkerThread.h>
 #include <DAQ/DParsedEvent.h>
+#include <DAQ/DParsedEventRing.h>
 #include <DAQ/DBORptrs.h>
 #include <DAQ/Df250EmulatorAlgorithm.h>
 #include <DAQ/Df125EmulatorAlgorithm.h>
@@ -137,6 +138,8 @@ class JEventSource_EVIOpp: public jana::JEventSource{
 		               void AddEmulatedObjectsToCallStack(JEventLoop *loop, string caller, string callee);
 		               void AddROCIDtoParseList(uint32_t rocid){ ROCIDS_TO_PARSE.insert(rocid); }
 		      set<uint32_t> GetROCIDParseList(uint32_t rocid){ return ROCIDS_TO_PARSE; }
+		               void AddEventRanges(string str, string origin);
+		               bool IsEventSelected(uint64_t event_number);
 
 		
 		bool DONE;
@@ -145,9 +148,8 @@ class JEventSource_EVIOpp: public jana::JEventSource{
 		std::chrono::high_resolution_clock::time_point tend;
 
 		uint32_t MAX_PARSED_EVENTS;
-		mutex PARSED_EVENTS_MUTEX;
-		condition_variable PARSED_EVENTS_CV;
-		list<DParsedEvent*> parsed_events;
+		DParsedEventRing *parsed_events;    // filled by worker threads, emptied by GetEvent
+		list<DParsedEvent*> current_events; // only accessed from GetEvent
 
 		std::atomic<uint_fast64_t> NEVENTS_PROCESSED;
 		std::atomic<uint_fast64_t> NDISPATCHER_STALLED;
@@ -175,6 +177,7 @@ class JEventSource_EVIOpp: public jana::JEventSource{
 		
 		bool RECORD_CALL_STACK;
 		set<uint32_t> ROCIDS_TO_PARSE;
+		vector<pair<uint64_t,uint64_t> > selected_event_ranges; // sorted, non-overlapping
 
 		list<DBORptrs*> borptrs_list;
 
@@ -206,7 +209,12 @@ class JEventSource_EVIOpp: public jana::JEventSource{
 		bool     LINK_CONFIG;
 		bool     IGNORE_EMPTY_BOR;
 		bool     TREAT_TRUNCATED_AS_ERROR;
+		bool     USE_MMAP;
+		uint32_t MMAP_READAHEAD_MB;
+		bool     SAVE_INDEX;
 		string   SYSTEMS_TO_PARSE;
+		string   EVENT_RANGE;
+		string   EVENT_LIST;
 		
 		uint32_t jobtype;
 		bool IS_CDAQ_FILE = false;
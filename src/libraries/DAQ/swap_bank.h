@@ -9,6 +9,8 @@
 
 #include <stdint.h>
 
+#include "swap_block_simd.h"
+
 #undef swap64
 #undef swap32
 #undef swap16
@@ -42,8 +44,9 @@ uint32_t swap_segment(uint32_t *outbuff, uint32_t *inbuff, uint32_t len);
 //---------------------------------
 // swap_block
 //---------------------------------
-inline void swap_block(uint16_t *inbuff, uint16_t len, uint16_t *outbuff)
+inline void swap_block(uint16_t *inbuff, uint32_t len, uint16_t *outbuff)
 {
+	if(len >= SWAP_SIMD_MIN_WORDS){ swap_words16(inbuff, len, outbuff); return; }
 	for(uint32_t i=0; i<len; i++, inbuff++, outbuff++){
 		*outbuff = swap16(*inbuff);
 	}
@@ -54,6 +57,7 @@ inline void swap_block(uint16_t *inbuff, uint16_t len, uint16_t *outbuff)
 //---------------------------------
 inline void swap_block(uint32_t *inbuff, uint32_t len, uint32_t *outbuff)
 {
+	if(len >= SWAP_SIMD_MIN_WORDS){ swap_words32(inbuff, len, outbuff); return; }
 	for(uint32_t i=0; i<len; i++, inbuff++, outbuff++){
 		*outbuff = swap32(*inbuff);
 	}
@@ -64,6 +68,7 @@ inline void swap_block(uint32_t *inbuff, uint32_t len, uint32_t *outbuff)
 //---------------------------------
 inline void swap_block(uint64_t *inbuff, uint64_t len, uint64_t *outbuff)
 {
+	if(len >= SWAP_SIMD_MIN_WORDS){ swap_words64(inbuff, len, outbuff); return; }
 	for(uint32_t i=0; i<len; i++, inbuff++, outbuff++){
 		*outbuff = swap64(*inbuff);
 	}
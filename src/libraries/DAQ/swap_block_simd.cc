@@ -0,0 +1,264 @@
+// $Id$
+//
+//    File: swap_block_simd.cc
+// Created: Sun Oct 18 10:02:47 EDT 2026
+//
+
+#include <atomic>
+using namespace std;
+
+#include "swap_block_simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SWAP_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+typedef void (*swap16_func_t)(const uint16_t*, uint64_t, uint16_t*);
+typedef void (*swap32_func_t)(const uint32_t*, uint64_t, uint32_t*);
+typedef void (*swap64_func_t)(const uint64_t*, uint64_t, uint64_t*);
+
+//==============================================================
+// Scalar versions
+//==============================================================
+
+static void swap16_scalar(const uint16_t *in, uint64_t len, uint16_t *out)
+{
+	for(uint64_t i=0; i<len; i++) out[i] = (uint16_t)((in[i]>>8) | (in[i]<<8));
+}
+
+static void swap32_scalar(const uint32_t *in, uint64_t len, uint32_t *out)
+{
+	for(uint64_t i=0; i<len; i++) out[i] = __builtin_bswap32(in[i]);
+}
+
+static void swap64_scalar(const uint64_t *in, uint64_t len, uint64_t *out)
+{
+	for(uint64_t i=0; i<len; i++) out[i] = __builtin_bswap64(in[i]);
+}
+
+#ifdef SWAP_SIMD_X86
+
+//==============================================================
+// SSSE3 versions (pshufb on 128 bit registers)
+//==============================================================
+
+//----------------
+// swap_ssse3
+//----------------
+__attribute__((target("ssse3")))
+static inline void swap_ssse3(const uint8_t *in, uint64_t nbytes, uint8_t *out, __m128i mask)
+{
+	// n.b. nbytes is always a multiple of 16 here
+	uint64_t i=0;
+	for(; i+32<=nbytes; i+=32){
+		__m128i v0 = _mm_loadu_si128((const __m128i*)&in[i]);
+		__m128i v1 = _mm_loadu_si128((const __m128i*)&in[i+16]);
+		_mm_storeu_si128((__m128i*)&out[i   ], _mm_shuffle_epi8(v0, mask));
+		_mm_storeu_si128((__m128i*)&out[i+16], _mm_shuffle_epi8(v1, mask));
+	}
+	for(; i<nbytes; i+=16){
+		__m128i v = _mm_loadu_si128((const __m128i*)&in[i]);
+		_mm_storeu_si128((__m128i*)&out[i], _mm_shuffle_epi8(v, mask));
+	}
+}
+
+__attribute__((target("ssse3")))
+static void swap16_ssse3(const uint16_t *in, uint64_t len, uint16_t *out)
+{
+	const __m128i mask = _mm_set_epi8(14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1);
+	uint64_t nvec = len & ~(uint64_t)7;
+	swap_ssse3((const uint8_t*)in, nvec*2, (uint8_t*)out, mask);
+	swap16_scalar(&in[nvec], len-nvec, &out[nvec]);
+}
+
+__attribute__((target("ssse3")))
+static void swap32_ssse3(const uint32_t *in, uint64_t len, uint32_t *out)
+{
+	const __m128i mask = _mm_set_epi8(12,13,14,15,8,9,10,11,4,5,6,7,0,1,2,3);
+	uint64_t nvec = len & ~(uint64_t)3;
+	swap_ssse3((const uint8_t*)in, nvec*4, (uint8_t*)out, mask);
+	swap32_scalar(&in[nvec], len-nvec, &out[nvec]);
+}
+
+__attribute__((target("ssse3")))
+static void swap64_ssse3(const uint64_t *in, uint64_t len, uint64_t *out)
+{
+	const __m128i mask = _mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+	uint64_t nvec = len & ~(uint64_t)1;
+	swap_ssse3((const uint8_t*)in, nvec*8, (uint8_t*)out, mask);
+	swap64_scalar(&in[nvec], len-nvec, &out[nvec]);
+}
+
+//==============================================================
+// AVX2 versions (vpshufb on 256 bit registers)
+//==============================================================
+
+//----------------
+// swap_avx2
+//----------------
+__attribute__((target("avx2")))
+static inline void swap_avx2(const uint8_t *in, uint64_t nbytes, uint8_t *out, __m256i mask)
+{
+	// n.b. nbytes is always a multiple of 32 here. vpshufb shuffles
+	// within each 128 bit lane so mask is the SSSE3 mask repeated.
+	uint64_t i=0;
+	for(; i+64<=nbytes; i+=64){
+		__m256i v0 = _mm256_loadu_si256((const __m256i*)&in[i]);
+		__m256i v1 = _mm256_loadu_si256((const __m256i*)&in[i+32]);
+		_mm256_storeu_si256((__m256i*)&out[i   ], _mm256_shuffle_epi8(v0, mask));
+		_mm256_storeu_si256((__m256i*)&out[i+32], _mm256_shuffle_epi8(v1, mask));
+	}
+	for(; i<nbytes; i+=32){
+		__m256i v = _mm256_loadu_si256((const __m256i*)&in[i]);
+		_mm256_storeu_si256((__m256i*)&out[i], _mm256_shuffle_epi8(v, mask));
+	}
+}
+
+__attribute__((target("avx2")))
+static void swap16_avx2(const uint16_t *in, uint64_t len, uint16_t *out)
+{
+	const __m256i mask = _mm256_set_epi8(14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1,
+	                                     14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1);
+	uint64_t nvec = len & ~(uint64_t)15;
+	swap_avx2((const uint8_t*)in, nvec*2, (uint8_t*)out, mask);
+	swap16_scalar(&in[nvec], len-nvec, &out[nvec]);
+}
+
+__attribute__((target("avx2")))
+static void swap32_avx2(const uint32_t *in, uint64_t len, uint32_t *out)
+{
+	const __m256i mask = _mm256_set_epi8(12,13,14,15,8,9,10,11,4,5,6,7,0,1,2,3,
+	                                     12,13,14,15,8,9,10,11,4,5,6,7,0,1,2,3);
+	uint64_t nvec = len & ~(uint64_t)7;
+	swap_avx2((const uint8_t*)in, nvec*4, (uint8_t*)out, mask);
+	swap32_scalar(&in[nvec], len-nvec, &out[nvec]);
+}
+
+__attribute__((target("avx2")))
+static void swap64_avx2(const uint64_t *in, uint64_t len, uint64_t *out)
+{
+	const __m256i mask = _mm256_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7,
+	                                     8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+	uint64_t nvec = len & ~(uint64_t)3;
+	swap_avx2((const uint8_t*)in, nvec*8, (uint8_t*)out, mask);
+	swap64_scalar(&in[nvec], len-nvec, &out[nvec]);
+}
+
+#endif // SWAP_SIMD_X86
+
+//==============================================================
+// Run time dispatch
+//==============================================================
+
+static void swap16_resolve(const uint16_t *in, uint64_t len, uint16_t *out);
+static void swap32_resolve(const uint32_t *in, uint64_t len, uint32_t *out);
+static void swap64_resolve(const uint64_t *in, uint64_t len, uint64_t *out);
+
+// These start out pointing to the resolve functions which will
+// select the implementation the first time any of them is called.
+// (They are constant initialized so are safe to use during static
+// initialization of other compilation units.)
+static atomic<swap16_func_t> swap16_impl(swap16_resolve);
+static atomic<swap32_func_t> swap32_impl(swap32_resolve);
+static atomic<swap64_func_t> swap64_impl(swap64_resolve);
+static atomic<int> swap_level(-1);
+
+//----------------
+// GetMaxSwapSIMDLevel
+//----------------
+int GetMaxSwapSIMDLevel(void)
+{
+#ifdef SWAP_SIMD_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2" )) return kSwapAVX2;
+	if(__builtin_cpu_supports("ssse3")) return kSwapSSSE3;
+#endif
+	return kSwapScalar;
+}
+
+//----------------
+// SetSwapSIMDLevel
+//----------------
+int SetSwapSIMDLevel(int level)
+{
+	int max_level = GetMaxSwapSIMDLevel();
+	if(level > max_level) level = max_level;
+	if(level < kSwapScalar) level = kSwapScalar;
+
+	swap16_func_t f16 = swap16_scalar;
+	swap32_func_t f32 = swap32_scalar;
+	swap64_func_t f64 = swap64_scalar;
+#ifdef SWAP_SIMD_X86
+	switch(level){
+		case kSwapAVX2:
+			f16 = swap16_avx2;
+			f32 = swap32_avx2;
+			f64 = swap64_avx2;
+			break;
+		case kSwapSSSE3:
+			f16 = swap16_ssse3;
+			f32 = swap32_ssse3;
+			f64 = swap64_ssse3;
+			break;
+	}
+#endif
+
+	swap16_impl.store(f16, memory_order_relaxed);
+	swap32_impl.store(f32, memory_order_relaxed);
+	swap64_impl.store(f64, memory_order_relaxed);
+	swap_level.store(level, memory_order_relaxed);
+
+	return level;
+}
+
+//----------------
+// GetSwapSIMDLevel
+//----------------
+int GetSwapSIMDLevel(void)
+{
+	int level = swap_level.load(memory_order_relaxed);
+	if(level < 0) level = SetSwapSIMDLevel(GetMaxSwapSIMDLevel());
+	return level;
+}
+
+//----------------
+// GetSwapSIMDName
+//----------------
+const char* GetSwapSIMDName(int level)
+{
+	switch(level){
+		case kSwapScalar: return "scalar";
+		case kSwapSSSE3:  return "SSSE3";
+		case kSwapAVX2:   return "AVX2";
+	}
+	return "unknown";
+}
+
+static void swap16_resolve(const uint16_t *in, uint64_t len, uint16_t *out){ GetSwapSIMDLevel(); swap16_impl.load(memory_order_relaxed)(in, len, out); }
+static void swap32_resolve(const uint32_t *in, uint64_t len, uint32_t *out){ GetSwapSIMDLevel(); swap32_impl.load(memory_order_relaxed)(in, len, out); }
+static void swap64_resolve(const uint64_t *in, uint64_t len, uint64_t *out){ GetSwapSIMDLevel(); swap64_impl.load(memory_order_relaxed)(in, len, out); }
+
+//----------------
+// swap_words16
+//----------------
+void swap_words16(const uint16_t *inbuff, uint64_t len, uint16_t *outbuff)
+{
+	swap16_impl.load(memory_order_relaxed)(inbuff, len, outbuff);
+}
+
+//----------------
+// swap_words32
+//----------------
+void swap_words32(const uint32_t *inbuff, uint64_t len, uint32_t *outbuff)
+{
+	swap32_impl.load(memory_order_relaxed)(inbuff, len, outbuff);
+}
+
+//----------------
+// swap_words64
+//----------------
+void swap_words64(const uint64_t *inbuff, uint64_t len, uint64_t *outbuff)
+{
+	swap64_impl.load(memory_order_relaxed)(inbuff, len, outbuff);
+}
@@ -0,0 +1,41 @@
+// $Id$
+//
+//    File: swap_block_simd.h
+// Created: Sun Oct 18 10:02:47 EDT 2026
+//
+
+// Vectorized byte swapping of contiguous arrays of 16, 32, and 64 bit
+// words. These are used by the swap_block routines in both HDEVIO.h and
+// swap_bank.h for all but the shortest arrays. The implementation is
+// chosen at run time based on what the CPU supports (AVX2, SSSE3, or a
+// plain scalar loop). In-place swapping (inbuff==outbuff) is allowed.
+//
+// SetSwapSIMDLevel can be used to force a lower level for testing or
+// benchmarking. It returns the level actually in use, which will be
+// capped at what the CPU supports.
+
+#ifndef _swap_block_simd_
+#define _swap_block_simd_
+
+#include <stdint.h>
+
+enum SwapSIMDLevel{
+	kSwapScalar = 0,
+	kSwapSSSE3  = 1,
+	kSwapAVX2   = 2
+};
+
+void swap_words16(const uint16_t *inbuff, uint64_t len, uint16_t *outbuff);
+void swap_words32(const uint32_t *inbuff, uint64_t len, uint32_t *outbuff);
+void swap_words64(const uint64_t *inbuff, uint64_t len, uint64_t *outbuff);
+
+int         GetMaxSwapSIMDLevel(void);
+int         GetSwapSIMDLevel(void);
+int         SetSwapSIMDLevel(int level);
+const char* GetSwapSIMDName(int level);
+
+// Arrays shorter than this are swapped inline by the swap_block
+// routines since the call overhead would dominate.
+#define SWAP_SIMD_MIN_WORDS 8
+
+#endif // _swap_block_simd_
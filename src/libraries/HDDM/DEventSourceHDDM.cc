@@ -905,7 +905,10 @@ jerror_t DEventSourceHDDM::Extract_DBCALDigiHit(hddm_s::HDDM *record,
       data.push_back(response);
    }
 
-   // Copy into factory
+   // Copy into factory. These objects are ours to delete. A translation
+   // table run on this event loop for an earlier (EVIO) event marks the
+   // factory as not owning its objects since those live in its arenas.
+   factory->ClearFactoryFlag(JFactory_base::NOT_OBJECT_OWNER);
    factory->CopyTo(data);
 
    return NOERROR;
@@ -1052,7 +1055,10 @@ jerror_t DEventSourceHDDM::Extract_DBCALTDCDigiHit(hddm_s::HDDM *record,
       data.push_back(bcaltdchit);
    }
          
-   // Copy into factory
+   // Copy into factory. These objects are ours to delete. A translation
+   // table run on this event loop for an earlier (EVIO) event marks the
+   // factory as not owning its objects since those live in its arenas.
+   factory->ClearFactoryFlag(JFactory_base::NOT_OBJECT_OWNER);
    factory->CopyTo(data);
 
    return NOERROR;
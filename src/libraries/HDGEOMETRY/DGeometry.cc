@@ -31,6 +31,7 @@ DGeometry::DGeometry(JGeometry *jgeom, DApplication *dapp, int32_t runnumber)
 	this->runnumber = runnumber;
 	this->materialmaps_read = false;
 	this->materials_read = false;
+	this->matindex_Nr = this->matindex_Nz = 0;
 	
 	pthread_mutex_init(&bfield_mutex, NULL);
 	pthread_mutex_init(&materialmap_mutex, NULL);
@@ -165,11 +166,164 @@ void DGeometry::ReadMaterialMaps(void) const
 	//cout<<ansi_up(1)<<string(85, ' ')<<"\r";
 	jout<<"Read in "<<materialmaps.size()<<" material maps for run "<<runnumber<<" containing "<<Npoints_total<<" grid points total"<<endl;
 
+	BuildMaterialMapIndex();
+
 	// Set flag that maps have been read and unlock mutex
 	materialmaps_read = true;
 	pthread_mutex_unlock(&materialmap_mutex);
 }
 
+//---------------------------------
+// BuildMaterialMapIndex
+//---------------------------------
+void DGeometry::BuildMaterialMapIndex(void) const
+{
+	/// Make the (r,z) index used by FindMaterialNode. This is called
+	/// from ReadMaterialMaps with materialmap_mutex already locked.
+	///
+	/// The index covers the union of all maps with 1cm x 1cm cells
+	/// (made larger if needed to keep the index to 256k cells). A map
+	/// is marked as a candidate for every cell that its range overlaps
+	/// after padding it by one cell on each side so rounding near the
+	/// edges can never drop a map that actually contains the point.
+	materialmap_boxes.clear();
+	materialmap_index.clear();
+	matindex_Nr = matindex_Nz = 0;
+	if(materialmaps.empty()) return;
+
+	double rmin=1.0E6, rmax=-1.0E6, zmin=1.0E6, zmax=-1.0E6;
+	for(unsigned int i=0; i<materialmaps.size(); i++){
+		DMaterialMapBox_t box;
+		box.rmin = materialmaps[i]->GetRmin();
+		box.rmax = materialmaps[i]->GetRmax();
+		box.zmin = materialmaps[i]->GetZmin();
+		box.zmax = materialmaps[i]->GetZmax();
+		materialmap_boxes.push_back(box);
+		if(box.rmin<rmin) rmin = box.rmin;
+		if(box.rmax>rmax) rmax = box.rmax;
+		if(box.zmin<zmin) zmin = box.zmin;
+		if(box.zmax>zmax) zmax = box.zmax;
+	}
+	if(materialmaps.size() > 64){
+		jout<<"More than 64 material maps. Not using material map index."<<endl;
+		return;
+	}
+
+	double cell_size = 1.0;
+	while( ((rmax-rmin)/cell_size+1.0)*((zmax-zmin)/cell_size+1.0) > 262144.0 ) cell_size *= 2.0;
+	matindex_rmin = rmin;
+	matindex_zmin = zmin;
+	matindex_one_over_dr = matindex_one_over_dz = 1.0/cell_size;
+	matindex_Nr = (int)ceil((rmax-rmin)/cell_size) + 1;
+	matindex_Nz = (int)ceil((zmax-zmin)/cell_size) + 1;
+	materialmap_index.assign(matindex_Nr*matindex_Nz, 0);
+
+	for(unsigned int i=0; i<materialmap_boxes.size(); i++){
+		const DMaterialMapBox_t &box = materialmap_boxes[i];
+		int ir1 = (int)floor((box.rmin-rmin)/cell_size) - 1;
+		int ir2 = (int)floor((box.rmax-rmin)/cell_size) + 1;
+		int iz1 = (int)floor((box.zmin-zmin)/cell_size) - 1;
+		int iz2 = (int)floor((box.zmax-zmin)/cell_size) + 1;
+		if(ir1<0) ir1 = 0;
+		if(iz1<0) iz1 = 0;
+		if(ir2>=matindex_Nr) ir2 = matindex_Nr-1;
+		if(iz2>=matindex_Nz) iz2 = matindex_Nz-1;
+		for(int ir=ir1; ir<=ir2; ir++){
+			for(int iz=iz1; iz<=iz2; iz++){
+				materialmap_index[ir*matindex_Nz + iz] |= ((uint64_t)1)<<i;
+			}
+		}
+	}
+}
+
+//---------------------------------
+// FindMaterialNode
+//---------------------------------
+const DMaterialMap::MaterialNode* DGeometry::FindMaterialNode(double r, double z, unsigned int &last_index, unsigned int &imap) const
+{
+	/// Find the node for the given point in the first material map at
+	/// or after last_index that contains it. The map index is returned
+	/// in imap and last_index is updated the same way FindMatKalman
+	/// always has (i.e. set to imap unless it is the last map, in which
+	/// case it is reset to 0). Returns NULL if no map has the point.
+	/// Only maps marked in the index for this point are tried so this
+	/// gives the same answer as trying each map in turn.
+	unsigned int Nmaps = materialmaps.size();
+	if(matindex_Nr == 0){
+		for(unsigned int i=last_index; i<Nmaps; i++){
+			const DMaterialMap::MaterialNode *node = materialmaps[i]->FindNode(r, z);
+			if(node){
+				imap = i;
+				last_index = (i==Nmaps-1) ? 0:i;
+				return node;
+			}
+		}
+		return NULL;
+	}
+
+	if(last_index >= Nmaps) return NULL;
+	uint64_t candidates = ~((uint64_t)0);
+	int ir = (int)floor((r-matindex_rmin)*matindex_one_over_dr);
+	int iz = (int)floor((z-matindex_zmin)*matindex_one_over_dz);
+	if(ir>=0 && ir<matindex_Nr && iz>=0 && iz<matindex_Nz) candidates = materialmap_index[ir*matindex_Nz + iz];
+	candidates &= (~((uint64_t)0))<<last_index;
+	if(Nmaps<64) candidates &= (((uint64_t)1)<<Nmaps) - 1;
+
+	while(candidates){
+		unsigned int i = __builtin_ctzll(candidates);
+		const DMaterialMap::MaterialNode *node = materialmaps[i]->FindNode(r, z);
+		if(node){
+			imap = i;
+			last_index = (i==Nmaps-1) ? 0:i;
+			return node;
+		}
+		candidates &= candidates-1;
+	}
+
+	return NULL;
+}
+
+//---------------------------------
+// EstimatedDistanceToBoundary
+//---------------------------------
+double DGeometry::EstimatedDistanceToBoundary(const DVector3 &pos, const DVector3 &mom) const
+{
+	/// Smallest DMaterialMap::EstimatedDistanceToBoundary over all of the
+	/// material maps. The r-z position and direction are calculated just
+	/// once for all maps. A map whose r-z box is further from the point
+	/// than the closest boundary found so far cannot have a closer one
+	/// (the distance along the track to the box is at least that far)
+	/// so it is skipped. The result is the same as checking every map.
+	double s_to_boundary = 1.0E6;
+
+	double pos_x = pos.X();
+	double pos_y = pos.Y();
+	double z = pos.Z();
+	double mom_x = mom.X();
+	double mom_y = mom.Y();
+	double pz = mom.Z();
+	double x_dot_p = pos_x*mom_x + pos_y*mom_y;
+	double r = sqrt(pos_x*pos_x + pos_y*pos_y);
+	double pr = sqrt(mom_x*mom_x + mom_y*mom_y) * (x_dot_p>0 ? +1.0:-1.0);
+	double mod = sqrt(pr*pr + pz*pz);
+	if(mod<1.0E-6) return s_to_boundary; // every map gives 1.0E6 for this
+	double p_hatR = pr/mod;
+	double p_hatZ = pz/mod;
+
+	for(unsigned int j=0; j<materialmaps.size(); j++){
+		const DMaterialMapBox_t &box = materialmap_boxes[j];
+		double dr_box = r<box.rmin ? box.rmin-r:(r>box.rmax ? r-box.rmax:0.0);
+		double dz_box = z<box.zmin ? box.zmin-z:(z>box.zmax ? z-box.zmax:0.0);
+		double d2 = dr_box*dr_box + dz_box*dz_box;
+		if(d2 > s_to_boundary*s_to_boundary*(1.0+1.0E-6)) continue;
+
+		double s = materialmaps[j]->EstimatedDistanceToBoundary(r, z, p_hatR, p_hatZ);
+		if(s<s_to_boundary) s_to_boundary = s;
+	}
+
+	return s_to_boundary;
+}
+
 //---------------------------------
 // FindNodes
 //---------------------------------
@@ -262,37 +416,31 @@ jerror_t DGeometry::FindMatKalman(const DVector3 &pos,const DVector3 &mom,
 {
 //	ReadMaterialMaps();
 
-  //last_index=0;
-  for(unsigned int i=last_index; i<materialmaps.size(); i++){
-    jerror_t err = materialmaps[i]->FindMatKalman(pos,KrhoZ_overA,
-						  rhoZ_overA,LnI,chi2c_factor,
-						  chi2a_factor,chi2a_corr,Z);
-    if(err==NOERROR){
-      if(i==materialmaps.size()-1) last_index=0;
-      else last_index=i;
-      if(s_to_boundary==NULL)return NOERROR;	// User doesn't want distance to boundary
-
-      *s_to_boundary = 1.0E6;
-      // If we are in the main mother volume, search through all the maps for
-      // the nearest boundary
-      if(last_index==0){
-	for(unsigned int j=0; j<materialmaps.size();j++){
-	  double s = materialmaps[j]->EstimatedDistanceToBoundary(pos, mom);
-	  if(s<*s_to_boundary){
-	    *s_to_boundary = s;
-	  }
-	}
-      }
-      else{
-	// otherwise, we found the material map containing this point. 
-	double s = materialmaps[last_index]->EstimatedDistanceToBoundary(pos, mom);
-	if(s<*s_to_boundary)*s_to_boundary = s;
-      }
-      return NOERROR;
-    }
+  unsigned int imap=0;
+  const DMaterialMap::MaterialNode *node=FindMaterialNode(pos.Perp(),pos.Z(),last_index,imap);
+  if(node==NULL) return RESOURCE_UNAVAILABLE;
+
+  Z=node->Z;
+  rhoZ_overA=node->rhoZ_overA;
+  LnI=node->LogI;
+  KrhoZ_overA=node->KrhoZ_overA;
+  chi2a_factor=node->chi2a_factor;
+  chi2a_corr=node->chi2a_corr;
+  chi2c_factor=node->chi2c_factor;
+  if(s_to_boundary==NULL)return NOERROR;	// User doesn't want distance to boundary
+
+  // If we are in the main mother volume, search through all the maps for
+  // the nearest boundary
+  if(last_index==0){
+    *s_to_boundary = EstimatedDistanceToBoundary(pos, mom);
   }
-       
-return RESOURCE_UNAVAILABLE;
+  else{
+    // otherwise, we found the material map containing this point. 
+    *s_to_boundary = 1.0E6;
+    double s = materialmaps[last_index]->EstimatedDistanceToBoundary(pos, mom);
+    if(s<*s_to_boundary)*s_to_boundary = s;
+  }
+  return NOERROR;
 }
 
 //---------------------------------
@@ -305,20 +453,19 @@ jerror_t DGeometry::FindMatKalman(const DVector3 &pos,
 {
 //	ReadMaterialMaps();
 
-  //last_index=0;
-  for(unsigned int i=last_index; i<materialmaps.size(); i++){
-    jerror_t err = materialmaps[i]->FindMatKalman(pos,KrhoZ_overA,
-						  rhoZ_overA,LnI,
-						  chi2c_factor,chi2a_factor,
-						  chi2a_corr,Z);
-    if(err==NOERROR){
-      if(i==materialmaps.size()-1) last_index=0;
-      else last_index=i;
-      return err;
-    }
-  }
-       
-  return RESOURCE_UNAVAILABLE;
+  unsigned int imap=0;
+  const DMaterialMap::MaterialNode *node=FindMaterialNode(pos.Perp(),pos.Z(),last_index,imap);
+  if(node==NULL) return RESOURCE_UNAVAILABLE;
+
+  Z=node->Z;
+  rhoZ_overA=node->rhoZ_overA;
+  LnI=node->LogI;
+  KrhoZ_overA=node->KrhoZ_overA;
+  chi2a_factor=node->chi2a_factor;
+  chi2a_corr=node->chi2a_corr;
+  chi2c_factor=node->chi2c_factor;
+
+  return NOERROR;
 }
 
 //---------------------------------
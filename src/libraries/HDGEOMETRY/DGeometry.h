@@ -9,6 +9,7 @@
 #define _DGeometry_
 
 #include <pthread.h>
+#include <stdint.h>
 #include <map>
 
 #include <JANA/jerror.h>
@@ -177,6 +178,9 @@ class DGeometry{
    protected:
       DGeometry(){}
       void ReadMaterialMaps(void) const;
+      void BuildMaterialMapIndex(void) const;
+      const DMaterialMap::MaterialNode* FindMaterialNode(double r, double z, unsigned int &last_index, unsigned int &imap) const;
+      double EstimatedDistanceToBoundary(const DVector3 &pos, const DVector3 &mom) const;
       void GetMaterials(void) const;
       bool GetCompositeMaterial(const string &name, double &density, double &radlen) const;
 
@@ -190,6 +194,21 @@ class DGeometry{
       mutable bool materialmaps_read;
       mutable bool materials_read;
 
+      // Index over (r,z) used by FindMatKalman to find the material map
+      // containing a point without trying every map. Each cell of the
+      // index has bit i set if materialmaps[i] may hold points in that
+      // cell. Points outside of the index (or all points if there are
+      // more than 64 maps) have every map as a candidate. The r,z limits
+      // of each map are kept alongside for the boundary search.
+      typedef struct{
+         double rmin,rmax,zmin,zmax;
+      }DMaterialMapBox_t;
+      mutable vector<DMaterialMapBox_t> materialmap_boxes;
+      mutable vector<uint64_t> materialmap_index;
+      mutable double matindex_rmin,matindex_zmin;
+      mutable double matindex_one_over_dr,matindex_one_over_dz;
+      mutable int matindex_Nr,matindex_Nz;
+
       mutable pthread_mutex_t bfield_mutex;
       mutable pthread_mutex_t materialmap_mutex;
       mutable pthread_mutex_t materials_mutex;
@@ -44,6 +44,28 @@ class DMagneticFieldMap{
 						 double &dBzdy,
 						 double &dBzdz) const = 0;
 
+		// Batch versions of GetField and GetFieldAndGradient. These take n
+		// points as separate x, y, and z arrays (e.g. all of the steps of
+		// a trajectory) and write the results to separate output arrays
+		// that must each hold n values. The versions here just call the
+		// single point methods for each point. Subclasses may override
+		// them with something faster.
+		virtual void GetFields(unsigned int n, const double *x, const double *y, const double *z,
+				       double *Bx, double *By, double *Bz) const {
+			for(unsigned int i=0; i<n; i++) GetField(x[i], y[i], z[i], Bx[i], By[i], Bz[i]);
+		}
+		virtual void GetFieldsAndGradients(unsigned int n, const double *x, const double *y, const double *z,
+						   double *Bx, double *By, double *Bz,
+						   double *dBxdx, double *dBxdy, double *dBxdz,
+						   double *dBydx, double *dBydy, double *dBydz,
+						   double *dBzdx, double *dBzdy, double *dBzdz) const {
+			for(unsigned int i=0; i<n; i++){
+				GetFieldAndGradient(x[i], y[i], z[i], Bx[i], By[i], Bz[i],
+						    dBxdx[i], dBxdy[i], dBxdz[i],
+						    dBydx[i], dBydy[i], dBydz[i],
+						    dBzdx[i], dBzdy[i], dBzdz[i]);
+			}
+		}
 
 };
 
@@ -3,8 +3,15 @@
 //    File: DMagneticFieldMapFineMesh.cc
 
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
 #include <cmath>
+#include <fstream>
+#include <sstream>
 using namespace std;
 #ifdef HAVE_EVIO
 #include <evioFileChannel.hxx>
@@ -15,9 +22,15 @@ using namespace evio;
 #include "DMagneticFieldMapFineMesh.h"
 
 #include "JANA/JException.h"
+#include "JANA/JParameterManager.h"
 
 #include <DAQ/HDEVIO.h>
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BFIELD_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
 
 //---------------------------------
 // DMagneticFieldMapFineMesh    (Constructor)
@@ -26,9 +39,18 @@ DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JApplication *japp, int32_t
 {
 	jcalib = japp->GetJCalibration(runnumber);
 	jresman = japp->GetJResourceManager(runnumber);
+	NrFine = NzFine = 0;
+	mBfine = NULL;
+	mBfineF = NULL;
+	mmap_addr = NULL;
+	mmap_len = 0;
+	flat_src_size = flat_src_mtime = flat_src_checksum = 0;
+	flat_src_coarse_checksum = 0;
+	batch_simd = BatchSIMDSupported();
 
 	JParameterManager *jparms = japp->GetJParameterManager();
 	jparms->SetDefaultParameter("BFIELD_MAP", namepath);
+	GetFineMeshParameters(jparms);
 	
 	int Npoints = ReadMap(namepath, runnumber); 
 	if(Npoints==0){
@@ -45,6 +67,15 @@ DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JApplication *japp, int32_t
 DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JCalibration *jcalib, string namepath,int32_t runnumber)
 {
 	this->jcalib = jcalib;
+	NrFine = NzFine = 0;
+	mBfine = NULL;
+	mBfineF = NULL;
+	mmap_addr = NULL;
+	mmap_len = 0;
+	flat_src_size = flat_src_mtime = flat_src_checksum = 0;
+	flat_src_coarse_checksum = 0;
+	batch_simd = BatchSIMDSupported();
+	GetFineMeshParameters(gPARMS);
 	GetFineMeshMap(namepath,runnumber);
 }
 
@@ -53,7 +84,22 @@ DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JCalibration *jcalib, strin
 //---------------------------------
 DMagneticFieldMapFineMesh::~DMagneticFieldMapFineMesh()
 {
+	FreeFineMesh();
+}
 
+//---------------------------------
+// GetFineMeshParameters
+//---------------------------------
+void DMagneticFieldMapFineMesh::GetFineMeshParameters(JParameterManager *jparms)
+{
+	finemesh_mmap = false;
+	finemesh_float = false;
+	finemesh_dir = "";
+	if(jparms == NULL) return;
+
+	jparms->SetDefaultParameter("BFIELD_FINEMESH_MMAP", finemesh_mmap, "Memory map the fine-mesh B-field table from a flat file so all processes on a node share one copy. The file is made the first time it is needed, next to the fine-mesh evio file unless BFIELD_FINEMESH_DIR is set.");
+	jparms->SetDefaultParameter("BFIELD_FINEMESH_FLOAT", finemesh_float, "Keep the fine-mesh B-field table in single precision. This halves its size.");
+	jparms->SetDefaultParameter("BFIELD_FINEMESH_DIR", finemesh_dir, "Directory for the flat fine-mesh B-field files. If empty, they go in the same directory as the fine-mesh evio file.");
 }
 
 //---------------------------------
@@ -154,11 +200,8 @@ int DMagneticFieldMapFineMesh::ReadMap(string namepath, int32_t runnumber, strin
   cout<<" Nz="<<Nz;
   cout<<" )  at 0x"<<hex<<(unsigned long)this<<dec<<endl;
   
-  // Create 3D vector so we can index the values by [x][y][z]
-  vector<DBfieldPoint_t> zvec(Nz);
-  vector< vector<DBfieldPoint_t> > yvec;
-  for(int i=0; i<Ny; i++)yvec.push_back(zvec);
-  for(int i=0; i<Nx; i++)Btable.push_back(yvec);
+  // Create flat table so we can index the values by BtableIndex(x,y,z)
+  Btable.assign(Nx*Ny*Nz, DBfieldPoint_t());
 	
   // Distance between map points for r and z
   dx = (xmax-xmin)/(double)(Nx-1);
@@ -174,7 +217,7 @@ int DMagneticFieldMapFineMesh::ReadMap(string namepath, int32_t runnumber, strin
     int xindex = (int)floor((a[0]-xmin+dx/2.0)/dx); // the +dx/2.0 guarantees against round-off errors
     int yindex = (int)(Ny<2 ? 0:floor((a[1]-ymin+dy/2.0)/dy));
     int zindex = (int)floor((a[2]-zmin+dz/2.0)/dz);
-    DBfieldPoint_t *b = &Btable[xindex][yindex][zindex];
+    DBfieldPoint_t *b = &Btable[BtableIndex(xindex,yindex,zindex)];
     b->x = a[0];
     b->y = a[1];
     b->z = a[2];
@@ -214,14 +257,14 @@ int DMagneticFieldMapFineMesh::ReadMap(string namepath, int32_t runnumber, strin
 	double d_index_x=double(index_x1-index_x0);
 	double d_index_z=double(index_z1-index_z0); 
 
-	DBfieldPoint_t *Bx0 = &Btable[index_x0][index_y][index_z];
-	DBfieldPoint_t *Bx1 = &Btable[index_x1][index_y][index_z];
-	//DBfieldPoint_t *By0 = &Btable[index_x][index_y0][index_z];
-	//DBfieldPoint_t *By1 = &Btable[index_x][index_y1][index_z];
-	DBfieldPoint_t *Bz0 = &Btable[index_x][index_y][index_z0];
-	DBfieldPoint_t *Bz1 = &Btable[index_x][index_y][index_z1];
+	DBfieldPoint_t *Bx0 = &Btable[BtableIndex(index_x0,index_y,index_z)];
+	DBfieldPoint_t *Bx1 = &Btable[BtableIndex(index_x1,index_y,index_z)];
+	//DBfieldPoint_t *By0 = &Btable[BtableIndex(index_x,index_y0,index_z)];
+	//DBfieldPoint_t *By1 = &Btable[BtableIndex(index_x,index_y1,index_z)];
+	DBfieldPoint_t *Bz0 = &Btable[BtableIndex(index_x,index_y,index_z0)];
+	DBfieldPoint_t *Bz1 = &Btable[BtableIndex(index_x,index_y,index_z1)];
 	
-	DBfieldPoint_t *g = &Btable[index_x][index_y][index_z];
+	DBfieldPoint_t *g = &Btable[BtableIndex(index_x,index_y,index_z)];
 	g->dBxdx = (Bx1->Bx - Bx0->Bx)/d_index_x;
 	//g->dBxdy = (By1->Bx - By0->Bx)/(double)(index_y1-index_y0);
 	g->dBxdz = (Bz1->Bx - Bz0->Bx)/d_index_z;
@@ -234,10 +277,10 @@ int DMagneticFieldMapFineMesh::ReadMap(string namepath, int32_t runnumber, strin
 	//g->dBzdy = (By1->Bz - By0->Bz)/(double)(index_y1-index_y0);
 	g->dBzdz = (Bz1->Bz - Bz0->Bz)/d_index_z;
 
-	DBfieldPoint_t *B11 = &Btable[index_x1][index_y][index_z1];
-	DBfieldPoint_t *B01 = &Btable[index_x0][index_y][index_z1];	
-	DBfieldPoint_t *B10 = &Btable[index_x1][index_y][index_z0];
-	DBfieldPoint_t *B00 = &Btable[index_x0][index_y][index_z0];
+	DBfieldPoint_t *B11 = &Btable[BtableIndex(index_x1,index_y,index_z1)];
+	DBfieldPoint_t *B01 = &Btable[BtableIndex(index_x0,index_y,index_z1)];	
+	DBfieldPoint_t *B10 = &Btable[BtableIndex(index_x1,index_y,index_z0)];
+	DBfieldPoint_t *B00 = &Btable[BtableIndex(index_x0,index_y,index_z0)];
 	
 	g->dBxdxdz=(B11->Bx - B01->Bx - B10->Bx + B00->Bx)/d_index_x/d_index_z;
 	g->dBzdxdz=(B11->Bz - B01->Bz - B10->Bz + B00->Bz)/d_index_x/d_index_z;
@@ -297,10 +340,10 @@ void DMagneticFieldMapFineMesh::GetFieldBicubic(double x,double y,double z,
     int index_z1 = index_z + (index_z<Nz-1 ? 1:0);
     
     // Pointers to magnetic field structure
-    const DBfieldPoint_t *B00 = &Btable[index_x][index_y][index_z];
-    const DBfieldPoint_t *B01 = &Btable[index_x][index_y][index_z1];
-    const DBfieldPoint_t *B11 = &Btable[index_x1][index_y][index_z1]; 
-    const DBfieldPoint_t *B10 = &Btable[index_x1][index_y][index_z];
+    const DBfieldPoint_t *B00 = &Btable[BtableIndex(index_x,index_y,index_z)];
+    const DBfieldPoint_t *B01 = &Btable[BtableIndex(index_x,index_y,index_z1)];
+    const DBfieldPoint_t *B11 = &Btable[BtableIndex(index_x1,index_y,index_z1)]; 
+    const DBfieldPoint_t *B10 = &Btable[BtableIndex(index_x1,index_y,index_z)];
     
     // First compute the interpolation for Br
     temp[0]=B00->Bx;
@@ -375,9 +418,10 @@ void DMagneticFieldMapFineMesh::GetFieldBicubic(double x,double y,double z,
   else{ // otherwise do a simple lookup in the fine-mesh table
     unsigned int indr=(unsigned int)floor((r-rminFine)*rscale);
     unsigned int indz=(unsigned int)floor((z-zminFine)*zscale);
+    unsigned int cell=(indr*NzFine + indz)*kNfineValues;
     
-    Bz_=mBfine[indr][indz].Bz;
-    Br_=mBfine[indr][indz].Br;
+    Bz_=FineMeshValue(cell,kBz);
+    Br_=FineMeshValue(cell,kBr);
     //	  printf("Bz Br %f %f\n",Bz,Br);
   }
 
@@ -434,10 +478,10 @@ void DMagneticFieldMapFineMesh::InterpolateField(double r,double z,double &Br,
   int index_z1 = index_z + (index_z<Nz-1 ? 1:0);
   
   // Pointers to magnetic field structure
-  const DBfieldPoint_t *B00 = &Btable[index_x][index_y][index_z];
-  const DBfieldPoint_t *B01 = &Btable[index_x][index_y][index_z1];
-  const DBfieldPoint_t *B11 = &Btable[index_x1][index_y][index_z1]; 
-  const DBfieldPoint_t *B10 = &Btable[index_x1][index_y][index_z];
+  const DBfieldPoint_t *B00 = &Btable[BtableIndex(index_x,index_y,index_z)];
+  const DBfieldPoint_t *B01 = &Btable[BtableIndex(index_x,index_y,index_z1)];
+  const DBfieldPoint_t *B11 = &Btable[BtableIndex(index_x1,index_y,index_z1)]; 
+  const DBfieldPoint_t *B10 = &Btable[BtableIndex(index_x1,index_y,index_z)];
     
   // First compute the interpolation for Br
   temp[0]=B00->Bx;
@@ -560,7 +604,7 @@ void DMagneticFieldMapFineMesh::GetFieldAndGradient(double x,double y,double z,
   int index_y = 0;
   
   if(index_x>=0 && index_x<Nx && index_z>=0 && index_z<Nz){
-    const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+    const DBfieldPoint_t *B = &Btable[BtableIndex(index_x,index_y,index_z)];
     
     // Fractional distance between map points.
     double ur = (r - B->x)*one_over_dx;
@@ -576,16 +620,14 @@ void DMagneticFieldMapFineMesh::GetFieldAndGradient(double x,double y,double z,
   }
   }
   else{ // otherwise do a simple lookup in the fine-mesh table
-    unsigned int indr=static_cast<unsigned int>(r*rscale);
-    unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
-    const DBfieldCylindrical_t *field=&mBfine[indr][indz];
-
-    Bz_=field->Bz;
-    Br_=field->Br;
-    dBrdx_=field->dBrdr;
-    dBrdz_=field->dBrdz;
-    dBzdz_=field->dBzdz;
-    dBzdx_=field->dBzdr;
+    unsigned int cell=FineMeshOffset(r,z);
+
+    Bz_=FineMeshValue(cell,kBz);
+    Br_=FineMeshValue(cell,kBr);
+    dBrdx_=FineMeshValue(cell,kdBrdr);
+    dBrdz_=FineMeshValue(cell,kdBrdz);
+    dBzdz_=FineMeshValue(cell,kdBzdz);
+    dBzdx_=FineMeshValue(cell,kdBzdr);
     
     //	  printf("Bz Br %f %f\n",Bz,Br);
   }
@@ -639,7 +681,7 @@ void DMagneticFieldMapFineMesh::GetFieldGradient(double x, double y, double z,
 	
 	int index_y = 0;
 
-	const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+	const DBfieldPoint_t *B = &Btable[BtableIndex(index_x,index_y,index_z)];
 
 	// Convert r back to x,y components
 	double cos_theta = x/r;
@@ -712,7 +754,7 @@ void DMagneticFieldMapFineMesh::GetField(double x, double y, double z, double &B
 	  
 	  int index_y = 0;
 	  
-	  const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+	  const DBfieldPoint_t *B = &Btable[BtableIndex(index_x,index_y,index_z)];
 	  
 	  // Fractional distance between map points.
 	  double ur = (r - B->x)*one_over_dx;
@@ -723,12 +765,10 @@ void DMagneticFieldMapFineMesh::GetField(double x, double y, double z, double &B
 	  Bz = B->Bz+B->dBzdx*ur+B->dBzdz*uz;
 	}
         else{ // otherwise do a simple lookup in the fine-mesh table
-	  unsigned int indr=static_cast<unsigned int>(r*rscale);
-	  unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
-	  const DBfieldCylindrical_t *field=&mBfine[indr][indz];
+	  unsigned int cell=FineMeshOffset(r,z);
 
-	  Bz=field->Bz;
-	  Br=field->Br;
+	  Bz=FineMeshValue(cell,kBz);
+	  Br=FineMeshValue(cell,kBr);
 	  //	  printf("Bz Br %f %f\n",Bz,Br);
 	}
 
@@ -783,7 +823,7 @@ void DMagneticFieldMapFineMesh::GetField(const DVector3 &pos,DVector3 &Bout) con
 	  
 	  int index_y = 0;
 	  
-	  const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+	  const DBfieldPoint_t *B = &Btable[BtableIndex(index_x,index_y,index_z)];
 	  
 	  // Fractional distance between map points.
 	  double ur = (r - B->x)*one_over_dx;
@@ -794,12 +834,10 @@ void DMagneticFieldMapFineMesh::GetField(const DVector3 &pos,DVector3 &Bout) con
 	  Bz = B->Bz+B->dBzdx*ur+B->dBzdz*uz;
 	}
         else{ // otherwise do a simple lookup in the fine-mesh table
-	  unsigned int indr=static_cast<unsigned int>(r*rscale);
-	  unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
-	  const DBfieldCylindrical_t *field=&mBfine[indr][indz];
+	  unsigned int cell=FineMeshOffset(r,z);
 
-	  Bz=field->Bz;
-	  Br=field->Br;
+	  Bz=FineMeshValue(cell,kBz);
+	  Br=FineMeshValue(cell,kBr);
 	  //	  printf("Bz Br %f %f\n",Bz,Br);
 	}
 
@@ -831,7 +869,7 @@ double DMagneticFieldMapFineMesh::GetBz(double x, double y, double z) const{
     
     int index_y = 0;
     
-    const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+    const DBfieldPoint_t *B = &Btable[BtableIndex(index_x,index_y,index_z)];
     
     // Fractional distance between map points.
     double ur = (r - B->x)*one_over_dx;
@@ -842,10 +880,261 @@ double DMagneticFieldMapFineMesh::GetBz(double x, double y, double z) const{
   }
  
   // otherwise do a simple lookup in the fine-mesh table
-  unsigned int indr=static_cast<unsigned int>(r*rscale);
-  unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
-  
-  return mBfine[indr][indz].Bz;
+  return FineMeshValue(FineMeshOffset(r,z),kBz);
+}
+
+//==============================================================
+// Batch field lookups
+//==============================================================
+
+// Everything the SIMD kernels need from the map. This is filled
+// from the map's members so the kernels can be plain functions.
+struct FineMeshSIMDParms_t{
+	const double *table;   // only one of table or tablef is set
+	const float *tablef;
+	double xmax, zmin, zmax;
+	double zminFine, zmaxFine, rmaxFine;
+	double rscale, zscale;
+	int NzFine;
+};
+
+// Order of output arrays passed to the kernels
+enum{kOutBx=0, kOutBy, kOutBz,
+	kOutdBxdx, kOutdBxdy, kOutdBxdz,
+	kOutdBydx, kOutdBydy, kOutdBydz,
+	kOutdBzdx, kOutdBzdy, kOutdBzdz,
+	kNout};
+
+#ifdef BFIELD_SIMD_X86
+
+//----------------
+// FineMeshIndex4_avx2
+//----------------
+__attribute__((target("avx2")))
+static inline __m256d FineMeshIndex4_avx2(const FineMeshSIMDParms_t &p, __m256d x, __m256d y, __m256d z, __m256d &r, __m128i &idx)
+{
+	/// Calculate r and the offset of the fine mesh cell in the table
+	/// (i.e. FineMeshIndex*kNfineValues) for 4 points. The
+	/// returned mask has all bits set for points that are inside the
+	/// fine mesh. The other points must be done with the scalar code.
+	/// This follows the single point routines exactly (including the
+	/// order of operations) so results are bit for bit the same.
+	r = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(x,x), _mm256_mul_pd(y,y)));
+
+	__m256d m = _mm256_cmp_pd(r, _mm256_set1_pd(p.xmax), _CMP_LE_OQ);
+	m = _mm256_and_pd(m, _mm256_cmp_pd(z, _mm256_set1_pd(p.zmax), _CMP_LE_OQ));
+	m = _mm256_and_pd(m, _mm256_cmp_pd(z, _mm256_set1_pd(p.zmin), _CMP_GE_OQ));
+	m = _mm256_and_pd(m, _mm256_cmp_pd(z, _mm256_set1_pd(p.zminFine), _CMP_GE_OQ));
+	m = _mm256_and_pd(m, _mm256_cmp_pd(z, _mm256_set1_pd(p.zmaxFine), _CMP_LT_OQ));
+	m = _mm256_and_pd(m, _mm256_cmp_pd(r, _mm256_set1_pd(p.rmaxFine), _CMP_LT_OQ));
+
+	__m128i indr = _mm256_cvttpd_epi32(_mm256_mul_pd(r, _mm256_set1_pd(p.rscale)));
+	__m128i indz = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_sub_pd(z, _mm256_set1_pd(p.zminFine)), _mm256_set1_pd(p.zscale)));
+	idx = _mm_add_epi32(_mm_mullo_epi32(indr, _mm_set1_epi32(p.NzFine)), indz);
+	idx = _mm_mullo_epi32(idx, _mm_set1_epi32(DMagneticFieldMapFineMesh::kNfineValues));
+
+	return m;
+}
+
+//----------------
+// Gather4_avx2
+//----------------
+__attribute__((target("avx2")))
+static inline __m256d Gather4_avx2(const FineMeshSIMDParms_t &p, int k, __m128i idx, __m256d m)
+{
+	/// Get value k of the fine mesh cells at offsets idx for the points
+	/// set in the mask m. Values in a single precision table are
+	/// converted to double the same way the scalar code does.
+	if(p.tablef){
+		__m256i m32 = _mm256_permutevar8x32_epi32(_mm256_castpd_si256(m), _mm256_setr_epi32(1,3,5,7,0,2,4,6));
+		__m128 mf = _mm_castsi128_ps(_mm256_castsi256_si128(m32));
+		return _mm256_cvtps_pd(_mm_mask_i32gather_ps(_mm_setzero_ps(), &p.tablef[k], idx, mf, 4));
+	}
+	return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), &p.table[k], idx, m, 8);
+}
+
+//----------------
+// CosSin4_avx2
+//----------------
+__attribute__((target("avx2")))
+static inline void CosSin4_avx2(__m256d x, __m256d y, __m256d r, __m256d &c, __m256d &s)
+{
+	__m256d zero  = _mm256_setzero_pd();
+	__m256d rzero = _mm256_cmp_pd(r, zero, _CMP_EQ_OQ);
+	c = _mm256_blendv_pd(_mm256_div_pd(x, r), _mm256_set1_pd(1.0), rzero);
+	s = _mm256_blendv_pd(_mm256_div_pd(y, r), zero, rzero);
+}
+
+//----------------
+// Fields4_avx2
+//----------------
+__attribute__((target("avx2")))
+static unsigned int Fields4_avx2(const FineMeshSIMDParms_t &p, const double *x, const double *y, const double *z, double * const *out, unsigned int i)
+{
+	/// Field at points i to i+3. Returns a bit mask of the points done.
+	__m256d vx = _mm256_loadu_pd(&x[i]);
+	__m256d vy = _mm256_loadu_pd(&y[i]);
+	__m256d vz = _mm256_loadu_pd(&z[i]);
+	__m256d r;
+	__m128i idx;
+	__m256d m = FineMeshIndex4_avx2(p, vx, vy, vz, r, idx);
+	unsigned int mask = _mm256_movemask_pd(m);
+	if(mask == 0) return 0;
+
+	__m256d Br = Gather4_avx2(p, DMagneticFieldMapFineMesh::kBr, idx, m);
+	__m256d Bz = Gather4_avx2(p, DMagneticFieldMapFineMesh::kBz, idx, m);
+
+	__m256d c, s;
+	CosSin4_avx2(vx, vy, r, c, s);
+
+	__m256i mi = _mm256_castpd_si256(m);
+	_mm256_maskstore_pd(&out[kOutBx][i], mi, _mm256_mul_pd(Br, c));
+	_mm256_maskstore_pd(&out[kOutBy][i], mi, _mm256_mul_pd(Br, s));
+	_mm256_maskstore_pd(&out[kOutBz][i], mi, Bz);
+
+	return mask;
+}
+
+//----------------
+// FieldsAndGradients4_avx2
+//----------------
+__attribute__((target("avx2")))
+static unsigned int FieldsAndGradients4_avx2(const FineMeshSIMDParms_t &p, const double *x, const double *y, const double *z, double * const *out, unsigned int i)
+{
+	/// Field and gradient at points i to i+3. Returns a bit mask of
+	/// the points done.
+	__m256d vx = _mm256_loadu_pd(&x[i]);
+	__m256d vy = _mm256_loadu_pd(&y[i]);
+	__m256d vz = _mm256_loadu_pd(&z[i]);
+	__m256d r;
+	__m128i idx;
+	__m256d m = FineMeshIndex4_avx2(p, vx, vy, vz, r, idx);
+	unsigned int mask = _mm256_movemask_pd(m);
+	if(mask == 0) return 0;
+
+	__m256d Br    = Gather4_avx2(p, DMagneticFieldMapFineMesh::kBr,    idx, m);
+	__m256d Bz    = Gather4_avx2(p, DMagneticFieldMapFineMesh::kBz,    idx, m);
+	__m256d dBrdr = Gather4_avx2(p, DMagneticFieldMapFineMesh::kdBrdr, idx, m);
+	__m256d dBrdz = Gather4_avx2(p, DMagneticFieldMapFineMesh::kdBrdz, idx, m);
+	__m256d dBzdr = Gather4_avx2(p, DMagneticFieldMapFineMesh::kdBzdr, idx, m);
+	__m256d dBzdz = Gather4_avx2(p, DMagneticFieldMapFineMesh::kdBzdz, idx, m);
+
+	__m256d c, s;
+	CosSin4_avx2(vx, vy, r, c, s);
+
+	__m256d dBrdr_c = _mm256_mul_pd(dBrdr, c);
+	__m256d dBxdy   = _mm256_mul_pd(dBrdr_c, s);
+	__m256d dBzdx   = _mm256_mul_pd(dBzdr, c);
+
+	__m256i mi = _mm256_castpd_si256(m);
+	_mm256_maskstore_pd(&out[kOutBx   ][i], mi, _mm256_mul_pd(Br, c));
+	_mm256_maskstore_pd(&out[kOutBy   ][i], mi, _mm256_mul_pd(Br, s));
+	_mm256_maskstore_pd(&out[kOutBz   ][i], mi, Bz);
+	_mm256_maskstore_pd(&out[kOutdBxdx][i], mi, _mm256_mul_pd(dBrdr_c, c));
+	_mm256_maskstore_pd(&out[kOutdBxdy][i], mi, dBxdy);
+	_mm256_maskstore_pd(&out[kOutdBxdz][i], mi, _mm256_mul_pd(dBrdz, c));
+	_mm256_maskstore_pd(&out[kOutdBydx][i], mi, dBxdy);
+	_mm256_maskstore_pd(&out[kOutdBydy][i], mi, _mm256_mul_pd(_mm256_mul_pd(dBrdr, s), s));
+	_mm256_maskstore_pd(&out[kOutdBydz][i], mi, _mm256_mul_pd(dBrdz, s));
+	_mm256_maskstore_pd(&out[kOutdBzdx][i], mi, dBzdx);
+	_mm256_maskstore_pd(&out[kOutdBzdy][i], mi, _mm256_mul_pd(dBzdx, s)); // n.b. same as GetFieldAndGradient
+	_mm256_maskstore_pd(&out[kOutdBzdz][i], mi, dBzdz);
+
+	return mask;
+}
+
+#endif // BFIELD_SIMD_X86
+
+//---------------------------------
+// BatchSIMDSupported
+//---------------------------------
+bool DMagneticFieldMapFineMesh::BatchSIMDSupported(void)
+{
+#ifdef BFIELD_SIMD_X86
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+//---------------------------------
+// GetFields
+//---------------------------------
+void DMagneticFieldMapFineMesh::GetFields(unsigned int n, const double *x, const double *y, const double *z,
+					  double *Bx, double *By, double *Bz) const
+{
+	/// Calculate the field at n points. Points are taken 4 at a time
+	/// and those inside the fine mesh are done with SIMD instructions.
+	/// Anything else (points on the coarse mesh, outside the map, or
+	/// the last few points) uses the single point GetField.
+	unsigned int i=0;
+#ifdef BFIELD_SIMD_X86
+	if(batch_simd && (mBfine!=NULL || mBfineF!=NULL)){
+		FineMeshSIMDParms_t p;
+		p.table = mBfine;
+		p.tablef = mBfineF;
+		p.xmax = xmax; p.zmin = zmin; p.zmax = zmax;
+		p.zminFine = zminFine; p.zmaxFine = zmaxFine; p.rmaxFine = rmaxFine;
+		p.rscale = rscale; p.zscale = zscale;
+		p.NzFine = NzFine;
+
+		double *out[kNout] = {Bx, By, Bz};
+		for(; i+4<=n; i+=4){
+			unsigned int done = Fields4_avx2(p, x, y, z, out, i);
+			if(done == 0xF) continue;
+			for(unsigned int j=i; j<i+4; j++){
+				if( (done>>(j-i)) & 0x1 ) continue;
+				DMagneticFieldMapFineMesh::GetField(x[j], y[j], z[j], Bx[j], By[j], Bz[j]);
+			}
+		}
+	}
+#endif // BFIELD_SIMD_X86
+	for(; i<n; i++) DMagneticFieldMapFineMesh::GetField(x[i], y[i], z[i], Bx[i], By[i], Bz[i]);
+}
+
+//---------------------------------
+// GetFieldsAndGradients
+//---------------------------------
+void DMagneticFieldMapFineMesh::GetFieldsAndGradients(unsigned int n, const double *x, const double *y, const double *z,
+						      double *Bx, double *By, double *Bz,
+						      double *dBxdx, double *dBxdy, double *dBxdz,
+						      double *dBydx, double *dBydy, double *dBydz,
+						      double *dBzdx, double *dBzdy, double *dBzdz) const
+{
+	/// Calculate the field and its gradient at n points. See GetFields
+	/// for how points are split between the SIMD and scalar code.
+	unsigned int i=0;
+#ifdef BFIELD_SIMD_X86
+	if(batch_simd && (mBfine!=NULL || mBfineF!=NULL)){
+		FineMeshSIMDParms_t p;
+		p.table = mBfine;
+		p.tablef = mBfineF;
+		p.xmax = xmax; p.zmin = zmin; p.zmax = zmax;
+		p.zminFine = zminFine; p.zmaxFine = zmaxFine; p.rmaxFine = rmaxFine;
+		p.rscale = rscale; p.zscale = zscale;
+		p.NzFine = NzFine;
+
+		double *out[kNout] = {Bx, By, Bz, dBxdx, dBxdy, dBxdz, dBydx, dBydy, dBydz, dBzdx, dBzdy, dBzdz};
+		for(; i+4<=n; i+=4){
+			unsigned int done = FieldsAndGradients4_avx2(p, x, y, z, out, i);
+			if(done == 0xF) continue;
+			for(unsigned int j=i; j<i+4; j++){
+				if( (done>>(j-i)) & 0x1 ) continue;
+				DMagneticFieldMapFineMesh::GetFieldAndGradient(x[j], y[j], z[j], Bx[j], By[j], Bz[j],
+					dBxdx[j], dBxdy[j], dBxdz[j],
+					dBydx[j], dBydy[j], dBydz[j],
+					dBzdx[j], dBzdy[j], dBzdz[j]);
+			}
+		}
+	}
+#endif // BFIELD_SIMD_X86
+	for(; i<n; i++){
+		DMagneticFieldMapFineMesh::GetFieldAndGradient(x[i], y[i], z[i], Bx[i], By[i], Bz[i],
+			dBxdx[i], dBxdy[i], dBxdz[i],
+			dBydx[i], dBydy[i], dBydz[i],
+			dBzdx[i], dBzdy[i], dBzdz[i]);
+	}
 }
 
 // Read a fine-mesh B-field map from an evio file
@@ -875,15 +1164,25 @@ void DMagneticFieldMapFineMesh::GetFineMeshMap(string namepath,int32_t runnumber
         }
     }
 
-    if(evioFileName != "") {
-        ReadEvioFile(evioFileName);
-    } else{
-    cout << "Fine-mesh evio file does not exist." <<endl;
-    cout << "Constructing the fine-mesh B-field map..." << endl;    
-    GenerateFineMesh();
+    // Use the flat copy of the table if there is one already. Otherwise,
+    // get the table from the evio file (or make it) and write the flat
+    // copy for next time.
+    string flatFileName = FlatFileName(evioFileName != "" ? evioFileName:evioFileNameToWrite);
+    if(finemesh_mmap) SetFlatFileSource(evioFileName, namepath);
+    if(!finemesh_mmap || !ReadFlatFile(flatFileName)){
+        if(evioFileName != "") {
+            ReadEvioFile(evioFileName);
+        } else{
+            cout << "Fine-mesh evio file does not exist." <<endl;
+            cout << "Constructing the fine-mesh B-field map..." << endl;    
+            GenerateFineMesh();
 #ifdef HAVE_EVIO
-    WriteEvioFile(evioFileNameToWrite);
+            WriteEvioFile(evioFileNameToWrite);
+            if(finemesh_mmap) SetFlatFileSource(evioFileNameToWrite, namepath);
 #endif
+        }
+        if(finemesh_float) ConvertFineMeshToFloat();
+        if(finemesh_mmap && WriteFlatFile(flatFileName)) ReadFlatFile(flatFileName);
     }
 
   cout << " rmin: " << rminFine << " rmax: " << rmaxFine 
@@ -905,21 +1204,303 @@ void DMagneticFieldMapFineMesh::GenerateFineMesh(void){
   NrFine=(unsigned int)floor((rmaxFine-rminFine)/drFine+0.5);
   NzFine=(unsigned int)floor((zmaxFine-zminFine)/dzFine+0.5);
 
-  vector<DBfieldCylindrical_t>zrow;
+  double *table=AllocateFineMesh();
   for (unsigned int i=0;i<NrFine;i++){
     double x=rminFine+drFine*double(i);
     for (unsigned int j=0;j<NzFine;j++){
       double z=zminFine+dzFine*double(j);
-      DBfieldCylindrical_t temp;
-      InterpolateField(x,z,temp.Br,temp.Bz,temp.dBrdr,temp.dBrdz,temp.dBzdr,
-		       temp.dBzdz);
-      zrow.push_back(temp);
+      double *cell=&table[(i*NzFine+j)*kNfineValues];
+      InterpolateField(x,z,cell[kBr],cell[kBz],cell[kdBrdr],cell[kdBrdz],
+		       cell[kdBzdr],cell[kdBzdz]);
     }
-    mBfine.push_back(zrow);
-    zrow.clear();
   }
 }
 
+//---------------------------------
+// AllocateFineMesh
+//---------------------------------
+double* DMagneticFieldMapFineMesh::AllocateFineMesh(void)
+{
+	/// Allocate the fine mesh buffer for NrFine x NzFine cells and point
+	/// mBfine at the first 64 byte boundary in it. Any existing table
+	/// is freed. The returned pointer is for filling the table.
+	FreeFineMesh();
+	size_t Ncells = (size_t)NrFine*(size_t)NzFine;
+	mBfineBuff.assign(Ncells*kNfineValues + 8, 0.0); // +8 for alignment
+	uintptr_t addr = reinterpret_cast<uintptr_t>(mBfineBuff.data());
+	double *table = reinterpret_cast<double*>((addr + 63) & ~(uintptr_t)63);
+	mBfine = table;
+	return table;
+}
+
+//---------------------------------
+// FreeFineMesh
+//---------------------------------
+void DMagneticFieldMapFineMesh::FreeFineMesh(void)
+{
+	if(mmap_addr) munmap(mmap_addr, mmap_len);
+	mmap_addr = NULL;
+	mmap_len = 0;
+	vector<double>().swap(mBfineBuff);
+	vector<float>().swap(mBfineFBuff);
+	mBfine = NULL;
+	mBfineF = NULL;
+}
+
+//---------------------------------
+// ConvertFineMeshToFloat
+//---------------------------------
+void DMagneticFieldMapFineMesh::ConvertFineMeshToFloat(void)
+{
+	/// Replace the double precision fine mesh table with a single
+	/// precision copy. This does nothing if the table is already
+	/// single precision.
+	if(mBfine == NULL) return;
+	size_t Nvals = (size_t)NrFine*(size_t)NzFine*kNfineValues;
+	vector<float> buff(Nvals + 16); // +16 for alignment
+	uintptr_t addr = reinterpret_cast<uintptr_t>(buff.data());
+	float *table = reinterpret_cast<float*>((addr + 63) & ~(uintptr_t)63);
+	for(size_t k=0; k<Nvals; k++) table[k] = (float)mBfine[k];
+	FreeFineMesh();
+	mBfineFBuff.swap(buff); // does not move the data so table stays valid
+	mBfineF = table;
+}
+
+//---------------------------------
+// Flat fine mesh files
+//---------------------------------
+
+// Header at the start of a flat fine mesh file. The table follows at
+// table_offset (one page in) as NrFine*NzFine cells of kNfineValues
+// values each, in the same layout as the table in memory. The file is
+// written in native byte order. The byte_order word is used to reject
+// files written on a machine with the other one.
+struct FlatFineMeshHeader_t{
+	char magic[8];          // "BFMESH2"
+	uint32_t byte_order;    // 0x01020304
+	uint32_t value_size;    // 8=double 4=float
+	uint32_t Nvalues;       // kNfineValues
+	uint32_t NrFine;
+	uint32_t NzFine;
+	uint32_t reserved;
+	double rminFine, rmaxFine, drFine;
+	double zminFine, zmaxFine, dzFine;
+	uint64_t table_offset;
+	uint64_t table_bytes;
+	uint64_t src_size;         // size of the fine-mesh evio file (0 if none)
+	uint64_t src_mtime;        // modification time of the evio file
+	uint64_t src_checksum;     // FileChecksum of the start of the evio file
+	uint64_t coarse_checksum;  // checksum of the coarse map (Btable)
+	char src_map[256];         // BFIELD_MAP name of the coarse map
+};
+static const char FLAT_FINEMESH_MAGIC[8] = "BFMESH2";
+
+//---------------------------------
+// Checksum
+//---------------------------------
+static uint64_t Checksum(const char *buff, size_t n, uint64_t sum=14695981039346656037ULL)
+{
+	/// 64 bit FNV-1a hash of a buffer. Pass the result back in as sum to
+	/// continue the hash over another buffer.
+	for(size_t i=0; i<n; i++){
+		sum ^= (unsigned char)buff[i];
+		sum *= 1099511628211ULL;
+	}
+	return sum;
+}
+
+//---------------------------------
+// FileChecksum
+//---------------------------------
+static uint64_t FileChecksum(string fname, size_t max_bytes=1<<20)
+{
+	/// Checksum of the first max_bytes of a file (the whole fine-mesh
+	/// file is hundreds of MB). Returns 0 if it can't be read.
+	int fd = open(fname.c_str(), O_RDONLY);
+	if(fd < 0) return 0;
+	vector<char> buff(max_bytes);
+	ssize_t n = pread(fd, buff.data(), buff.size(), 0);
+	close(fd);
+	return n<0 ? 0:Checksum(buff.data(), n);
+}
+static const uint64_t FLAT_FINEMESH_TABLE_OFFSET = 4096;
+
+//---------------------------------
+// FlatFileName
+//---------------------------------
+string DMagneticFieldMapFineMesh::FlatFileName(string evioFileName) const
+{
+	/// Name of the flat fine mesh file for the given evio file. This is
+	/// the evio file name with ".evio" replaced by ".finemesh.double"
+	/// (or ".finemesh.float"), put in BFIELD_FINEMESH_DIR if set.
+	string fname = evioFileName;
+	size_t ipos = fname.rfind(".evio");
+	if(ipos != string::npos && ipos == fname.size()-5) fname = fname.substr(0, ipos);
+	fname += finemesh_float ? ".finemesh.float":".finemesh.double";
+	if(finemesh_dir != ""){
+		size_t islash = fname.rfind("/");
+		if(islash != string::npos) fname = fname.substr(islash+1);
+		fname = finemesh_dir + "/" + fname;
+	}
+	return fname;
+}
+
+//---------------------------------
+// SetFlatFileSource
+//---------------------------------
+void DMagneticFieldMapFineMesh::SetFlatFileSource(string evioFileName, string namepath)
+{
+	/// Record what the fine mesh table is (or will be) made from: the
+	/// fine-mesh evio file and the coarse map. WriteFlatFile stores these
+	/// in the flat file and ReadFlatFile refuses a file whose values
+	/// differ, so the flat file is rebuilt if either source changes
+	/// while its name stays the same. The evio file is identified by its
+	/// size, modification time and a checksum of its first MB so this
+	/// stays cheap compared to reading the file. If the evio file does
+	/// not exist (the table is generated from the coarse map) the file
+	/// values are 0.
+	flat_src_map = namepath;
+	flat_src_size = flat_src_mtime = flat_src_checksum = 0;
+	struct stat st;
+	if(evioFileName!="" && stat(evioFileName.c_str(), &st)==0){
+		flat_src_size = st.st_size;
+		flat_src_mtime = st.st_mtime;
+		flat_src_checksum = FileChecksum(evioFileName);
+	}
+	flat_src_coarse_checksum = Checksum(namepath.c_str(), namepath.size());
+	if(!Btable.empty())
+		flat_src_coarse_checksum = Checksum((const char*)Btable.data(), Btable.size()*sizeof(DBfieldPoint_t), flat_src_coarse_checksum);
+}
+
+//---------------------------------
+// WriteFlatFile
+//---------------------------------
+bool DMagneticFieldMapFineMesh::WriteFlatFile(string fname) const
+{
+	/// Write the fine mesh table to a flat file that ReadFlatFile can
+	/// map. The file is written under a temporary name and then renamed
+	/// so other processes never see a partial file.
+	if(mBfine==NULL && mBfineF==NULL) return false;
+
+	FlatFineMeshHeader_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, FLAT_FINEMESH_MAGIC, sizeof(header.magic));
+	header.byte_order = 0x01020304;
+	header.value_size = mBfineF!=NULL ? sizeof(float):sizeof(double);
+	header.Nvalues = kNfineValues;
+	header.NrFine = NrFine;
+	header.NzFine = NzFine;
+	header.rminFine = rminFine;
+	header.rmaxFine = rmaxFine;
+	header.drFine = drFine;
+	header.zminFine = zminFine;
+	header.zmaxFine = zmaxFine;
+	header.dzFine = dzFine;
+	header.table_offset = FLAT_FINEMESH_TABLE_OFFSET;
+	header.table_bytes = (uint64_t)NrFine*(uint64_t)NzFine*kNfineValues*header.value_size;
+	header.src_size = flat_src_size;
+	header.src_mtime = flat_src_mtime;
+	header.src_checksum = flat_src_checksum;
+	header.coarse_checksum = flat_src_coarse_checksum;
+	strncpy(header.src_map, flat_src_map.c_str(), sizeof(header.src_map)-1);
+
+	stringstream tmpname;
+	tmpname << fname << ".tmp." << getpid();
+	ofstream ofs(tmpname.str().c_str(), ios::binary);
+	if(!ofs.is_open()){
+		jout << "Unable to write flat fine-mesh B-field file " << fname << endl;
+		return false;
+	}
+	vector<char> page(header.table_offset, 0);
+	memcpy(page.data(), &header, sizeof(header));
+	ofs.write(page.data(), page.size());
+	const char *table = mBfineF!=NULL ? (const char*)mBfineF:(const char*)mBfine;
+	ofs.write(table, header.table_bytes);
+	ofs.close();
+	if(!ofs.good() || rename(tmpname.str().c_str(), fname.c_str())!=0){
+		jout << "Unable to write flat fine-mesh B-field file " << fname << endl;
+		unlink(tmpname.str().c_str());
+		return false;
+	}
+	jout << "Wrote flat fine-mesh B-field file " << fname << endl;
+
+	return true;
+}
+
+//---------------------------------
+// ReadFlatFile
+//---------------------------------
+bool DMagneticFieldMapFineMesh::ReadFlatFile(string fname)
+{
+	/// Memory map a flat fine mesh file written by WriteFlatFile and use
+	/// it for the fine mesh table. The mapping is read-only and shared
+	/// so the pages are shared with every other process using the same
+	/// file. The table precision is whatever the file was written
+	/// with. Returns false (leaving the current table alone) if the file
+	/// does not exist, does not match what is expected or was made from
+	/// a different evio file or coarse map (see SetFlatFileSource).
+	int fd = open(fname.c_str(), O_RDONLY);
+	if(fd < 0) return false;
+
+	struct stat st;
+	FlatFineMeshHeader_t header;
+	bool ok = fstat(fd, &st)==0 && (size_t)st.st_size>=sizeof(header);
+	ok = ok && pread(fd, &header, sizeof(header), 0)==(ssize_t)sizeof(header);
+	ok = ok && memcmp(header.magic, FLAT_FINEMESH_MAGIC, sizeof(header.magic))==0;
+	ok = ok && header.byte_order==0x01020304;
+	ok = ok && (header.value_size==sizeof(float) || header.value_size==sizeof(double));
+	ok = ok && header.Nvalues==kNfineValues;
+	ok = ok && header.table_offset==FLAT_FINEMESH_TABLE_OFFSET;
+	ok = ok && header.table_bytes==(uint64_t)header.NrFine*(uint64_t)header.NzFine*kNfineValues*header.value_size;
+	ok = ok && (uint64_t)st.st_size>=header.table_offset+header.table_bytes;
+	if(!ok){
+		jout << "Ignoring bad flat fine-mesh B-field file " << fname << endl;
+		close(fd);
+		return false;
+	}
+	header.src_map[sizeof(header.src_map)-1] = 0;
+	bool same_source = header.src_size==flat_src_size && header.src_mtime==flat_src_mtime;
+	same_source = same_source && header.src_checksum==flat_src_checksum;
+	same_source = same_source && header.coarse_checksum==flat_src_coarse_checksum;
+	same_source = same_source && flat_src_map.compare(0, sizeof(header.src_map)-1, header.src_map)==0;
+	if(!same_source){
+		jout << "Flat fine-mesh B-field file " << fname << " was made from a different field map. It will be rebuilt." << endl;
+		close(fd);
+		return false;
+	}
+
+	size_t len = header.table_offset + header.table_bytes;
+	void *addr = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED){
+		jout << "Unable to map flat fine-mesh B-field file " << fname << endl;
+		return false;
+	}
+
+	FreeFineMesh();
+	mmap_addr = addr;
+	mmap_len = len;
+	const char *table = (const char*)addr + header.table_offset;
+	if(header.value_size == sizeof(float))
+		mBfineF = (const float*)table;
+	else
+		mBfine = (const double*)table;
+
+	rminFine = header.rminFine;
+	rmaxFine = header.rmaxFine;
+	drFine   = header.drFine;
+	zminFine = header.zminFine;
+	zmaxFine = header.zmaxFine;
+	dzFine   = header.dzFine;
+	NrFine   = header.NrFine;
+	NzFine   = header.NzFine;
+	zscale=1./dzFine;
+	rscale=1./drFine;
+	jout << "Mapped flat fine-mesh B-field file " << fname << endl;
+
+	return true;
+}
+
 void DMagneticFieldMapFineMesh::WriteEvioFile(string evioFileName){
   cout << "Writing fine-mesh B-field data to " << evioFileName << "..." <<endl;
 
@@ -930,15 +1511,15 @@ void DMagneticFieldMapFineMesh::WriteEvioFile(string evioFileName){
   vector<float>dBrdz_;  
   vector<float>dBzdr_;
   vector<float>dBzdz_;
-  for (unsigned int i=0;i<NrFine;i++){
-    for (unsigned int j=0;j<NzFine;j++){
-      Br_.push_back(mBfine[i][j].Br);  
-      Bz_.push_back(mBfine[i][j].Bz); 
-      dBrdr_.push_back(mBfine[i][j].dBrdr);   
-      dBrdz_.push_back(mBfine[i][j].dBrdz);  
-      dBzdr_.push_back(mBfine[i][j].dBzdr);
-      dBzdz_.push_back(mBfine[i][j].dBzdz);
-    }
+  unsigned int Ncells=NrFine*NzFine;
+  for (unsigned int k=0;k<Ncells;k++){
+    unsigned int cell=k*kNfineValues;
+    Br_.push_back(FineMeshValue(cell,kBr));
+    Bz_.push_back(FineMeshValue(cell,kBz));
+    dBrdr_.push_back(FineMeshValue(cell,kdBrdr));
+    dBrdz_.push_back(FineMeshValue(cell,kdBrdz));
+    dBzdr_.push_back(FineMeshValue(cell,kdBzdr));
+    dBzdz_.push_back(FineMeshValue(cell,kdBzdz));
   }
 
   // Calculate total buffer size needed (in 32bit words)
@@ -1088,8 +1669,7 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 
 	NrFine=(unsigned int)floor((rmaxFine-rminFine)/drFine+0.5);
 	NzFine=(unsigned int)floor((zmaxFine-zminFine)/dzFine+0.5);
-	mBfine.resize(NrFine);
-	for(auto &m : mBfine) m.resize(NzFine);
+	double *table=AllocateFineMesh();
 
 	// Next 6 banks have tag=3 and num=0-5 and hold
 	// the actual table data
@@ -1098,23 +1678,15 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 		float *fptr = (float*)&iptr[2];
 		uint32_t N = iptr[0] - 1;
 		iptr = &iptr[N+2];
-		if(iptr > iend){
+		if(iptr > iend || mynum>=kNfineValues || N>NrFine*NzFine){
 			jerr << " Bad format of fine mesh B-field file!" << endl;
 			_exit(-1);
 		}
 		
-		for(uint32_t k=0; k<N; k++){
-			uint32_t indr=k/NzFine;
-			uint32_t indz=k%NzFine;
-			switch( mynum ){
-				case 0: mBfine[indr][indz].Br    = *fptr++;  break;  // Br
-				case 1: mBfine[indr][indz].Bz    = *fptr++;  break;  // Bz
-				case 2: mBfine[indr][indz].dBrdr = *fptr++;  break;  // dBrdr
-				case 3: mBfine[indr][indz].dBrdz = *fptr++;  break;  // dBrdz
-				case 4: mBfine[indr][indz].dBzdr = *fptr++;  break;  // dBzdr
-				case 5: mBfine[indr][indz].dBzdz = *fptr++;  break;  // dBzdz
-			}
-		}
+		// Banks num=0-5 are Br, Bz, dBrdr, dBrdz, dBzdr, dBzdz which
+		// is the same order as the values in each cell of mBfine
+		double *val = &table[mynum];
+		for(uint32_t k=0; k<N; k++) val[k*kNfineValues] = fptr[k];
 	}
 	
 	delete[] buff;
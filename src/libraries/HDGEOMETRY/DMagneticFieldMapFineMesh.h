@@ -47,10 +47,37 @@ class DMagneticFieldMapFineMesh:public DMagneticFieldMap{
 			   double &dBydz,
 			   double &dBzdx, double &dBzdy,
 			   double &dBzdz) const;
+
+  // Batch versions of GetField and GetFieldAndGradient (see
+  // DMagneticFieldMap). Points inside the fine mesh are done 4 at a
+  // time using AVX2 gathers when the CPU supports it. Results are
+  // identical to calling the single point versions for each point.
+  void GetFields(unsigned int n, const double *x, const double *y, const double *z,
+		 double *Bx, double *By, double *Bz) const;
+  void GetFieldsAndGradients(unsigned int n, const double *x, const double *y, const double *z,
+			     double *Bx, double *By, double *Bz,
+			     double *dBxdx, double *dBxdy, double *dBxdz,
+			     double *dBydx, double *dBydy, double *dBydz,
+			     double *dBzdx, double *dBzdy, double *dBzdz) const;
+  void SetBatchSIMD(bool use_simd){batch_simd = use_simd && BatchSIMDSupported();}
+  bool GetBatchSIMD(void) const {return batch_simd;}
+  static bool BatchSIMDSupported(void);
+
   void GetFineMeshMap(string namepath,int32_t runnumber);
   void WriteEvioFile(string evioFileName);	
   void ReadEvioFile(string evioFileName);
   void GenerateFineMesh(void);
+
+  // The fine mesh table can also be kept in a flat binary file which is
+  // memory mapped read-only. All processes on a node that use the same
+  // map then share a single copy of it through the page cache. This is
+  // off by default: see the BFIELD_FINEMESH_MMAP, BFIELD_FINEMESH_DIR and
+  // BFIELD_FINEMESH_FLOAT parameters.
+  bool WriteFlatFile(string fname) const;
+  bool ReadFlatFile(string fname);
+  void ConvertFineMeshToFloat(void);
+  bool IsFineMeshFloat(void) const {return mBfineF!=NULL;}
+  bool IsFineMeshMapped(void) const {return mmap_addr!=NULL;}
   
   typedef struct{
     float x,y,z,Bx,By,Bz;
@@ -66,23 +93,80 @@ class DMagneticFieldMapFineMesh:public DMagneticFieldMap{
     double Br,Bz;
     double dBrdr,dBrdz,dBzdr,dBzdz;
   }DBfieldCylindrical_t;
+
+  // Values stored for each cell of the fine mesh table (see mBfine below)
+  enum FineMeshValue_t{kBr=0, kBz, kdBrdr, kdBrdz, kdBzdr, kdBzdz, kNfineValues};
+  const double* GetFineMesh(void) const {return mBfine;}
+  const float* GetFineMeshFloat(void) const {return mBfineF;}
+  void GetFineMeshLimits(double &rmin, double &rmax, double &dr, unsigned int &Nr,
+			 double &zmin, double &zmax, double &dz, unsigned int &Nz) const {
+    rmin=rminFine; rmax=rmaxFine; dr=drFine; Nr=NrFine;
+    zmin=zminFine; zmax=zmaxFine; dz=dzFine; Nz=NzFine;
+  }
   
  protected:
   
   JCalibration *jcalib;
   JResourceManager *jresman;
 
-  vector< vector< vector<DBfieldPoint_t> > > Btable;
+  // Coarse map indexed by BtableIndex(index_x,index_y,index_z)
+  vector<DBfieldPoint_t> Btable;
+  inline unsigned int BtableIndex(int index_x, int index_y, int index_z) const {
+    return (index_x*Ny + index_y)*Nz + index_z;
+  }
   
   float xmin, xmax, ymin, ymax, zmin, zmax;
   int Nx, Ny, Nz;
   double dx, dy,dz;
   double one_over_dx,one_over_dz;
   
-  vector<vector<DBfieldCylindrical_t> >mBfine;
+  // Fine mesh table. This is one contiguous, 64 byte aligned buffer
+  // holding the kNfineValues values for each cell next to one another.
+  // The values for cell (indr,indz) start at mBfine[index*kNfineValues]
+  // where index=FineMeshIndex(r,z)=indr*NzFine+indz. Keeping a cell's
+  // values together means a lookup usually touches a single cache line
+  // (separate arrays for each value were measured to be several times
+  // slower for points along a track). The batch routines gather the
+  // same value from several cells using a stride of kNfineValues.
+  // Only one of mBfine or mBfineF (single precision) is set. Either may
+  // point into a read-only memory mapped flat file (see ReadFlatFile)
+  // so always read values through FineMeshValue.
+  vector<double> mBfineBuff;
+  vector<float> mBfineFBuff;
+  const double *mBfine;
+  const float *mBfineF;
+  void *mmap_addr;
+  size_t mmap_len;
+  bool finemesh_mmap;
+  bool finemesh_float;
+  string finemesh_dir;
+  // What the fine mesh table was made from. These are stored in the
+  // flat file so a stale file is rebuilt rather than used (see
+  // SetFlatFileSource).
+  string flat_src_map;
+  uint64_t flat_src_size, flat_src_mtime, flat_src_checksum;
+  uint64_t flat_src_coarse_checksum;
   double zminFine,rminFine,zmaxFine,rmaxFine,drFine,dzFine;
   unsigned int NrFine,NzFine;  
   double zscale,rscale;
+  bool batch_simd;
+
+  void GetFineMeshParameters(JParameterManager *jparms);
+  double* AllocateFineMesh(void);
+  void FreeFineMesh(void);
+  string FlatFileName(string evioFileName) const;
+  void SetFlatFileSource(string evioFileName, string namepath);
+  inline unsigned int FineMeshIndex(double r, double z) const {
+    unsigned int indr=static_cast<unsigned int>(r*rscale);
+    unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
+    return indr*NzFine + indz;
+  }
+  inline unsigned int FineMeshOffset(double r, double z) const {
+    return FineMeshIndex(r,z)*kNfineValues;
+  }
+  inline double FineMeshValue(unsigned int offset, int k) const {
+    return mBfineF!=NULL ? (double)mBfineF[offset+k] : mBfine[offset+k];
+  }
  
  private:
   void InterpolateField(double r,double z,double &Br,double &Bz,double &dBrdr,
@@ -357,6 +357,34 @@ double DMaterialMap::EstimatedDistanceToBoundary(const DVector3 &pos, const DVec
 	double p_hatZ = pz/mod;
 	//DVector2 p_hat(p_hatR, p_hatZ);
 
+	return EstimatedDistanceToBoundary(r, z, p_hatR, p_hatZ);
+}
+
+//-----------------
+// EstimatedDistanceToBoundary
+//-----------------
+double DMaterialMap::EstimatedDistanceToBoundary(double r, double z, double p_hatR, double p_hatZ)
+{
+	/// Same as above, but for a point and unit direction already in r-z
+	/// space. p_hatR is positive for tracks moving away from the beamline.
+	/// This lets callers checking several maps for the same point and
+	/// momentum (e.g. DGeometry::FindMatKalman) calculate these only once.
+
+	double s_to_boundary = 1.0E6;
+	if(!ENABLE_BOUNDARY_CHECK)return s_to_boundary;
+
+	// Bail if outside the map and headed away from it
+	if(p_hatZ>0.0){
+	  if(z>zmax)return s_to_boundary;
+	} else {
+	  if(z<zmin)return s_to_boundary;
+	}
+	if(p_hatR>0.0){
+	  if(r>rmax)return s_to_boundary;
+	} else {
+	  if(r<rmin)return s_to_boundary;
+	}
+
 	// Get shortest distance to boundary of entire map
 	s_to_boundary = DistanceToBox(r, z, p_hatR, p_hatZ, rmin, rmax, zmin, zmax);
 
@@ -34,6 +34,7 @@ class DMaterialMap{
 		};
 		
 		inline const MaterialNode* FindNode(const DVector3 &pos) const;
+		inline const MaterialNode* FindNode(double r, double z) const;
 		
 		jerror_t FindMat(DVector3 &pos, double &rhoZ_overA, double &rhoZ_overA_logI, double &RadLen) const;
 		jerror_t FindMatALT1(DVector3 &pos,double &KrhoZ_overA,
@@ -48,6 +49,7 @@ class DMaterialMap{
 				       double &Z) const;
 		bool IsInMap(const DVector3 &pos) const;
 		double EstimatedDistanceToBoundary(const DVector3 &pos, const DVector3 &mom);
+		double EstimatedDistanceToBoundary(double r, double z, double p_hatR, double p_hatZ);
 		double EstimatedDistanceToBoundarySearch(double r, double z, double p_hatR, double p_hatZ, double &s_to_boundary);
 		double DistanceToBox(double &x, double &y, double &xdir, double &ydir, double xmin, double xmax, double ymin, double ymax);
 
@@ -96,8 +98,14 @@ inline const DMaterialMap::MaterialNode* DMaterialMap::FindNode(const DVector3 &
 	//double pos_x = pos.X();
 	//double pos_y = pos.Y();
   //double r = sqrt(pos_x*pos_x + pos_y*pos_y);
-  double r=pos.Perp();
-	double z = pos.Z();
+  return FindNode(pos.Perp(), pos.Z());
+}
+
+//-----------------
+// FindNode
+//-----------------
+inline const DMaterialMap::MaterialNode* DMaterialMap::FindNode(double r, double z) const
+{
 	int ir = (int)floor((r-rmin)*one_over_dr);
 	int iz = (int)floor((z-zmin)*one_over_dz);
 	if(ir<0 || ir>=Nr || iz<0 || iz>=Nz)return NULL;
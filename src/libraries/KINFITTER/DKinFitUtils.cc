@@ -44,6 +44,16 @@ void DKinFitUtils::Reset_NewEvent(void)
 	Reset_NewFit();
 }
 
+void DKinFitUtils::Copy_OutputToInputMapping(const DKinFitUtils* locKinFitUtils, const set<shared_ptr<DKinFitParticle>>& locOutputKinFitParticles)
+{
+	for(auto& locOutputKinFitParticle : locOutputKinFitParticles)
+	{
+		auto locInputKinFitParticle = locKinFitUtils->Get_InputKinFitParticle(locOutputKinFitParticle);
+		if(locInputKinFitParticle != nullptr)
+			dParticleMap_OutputToInput[locOutputKinFitParticle] = locInputKinFitParticle;
+	}
+}
+
 shared_ptr<TMatrixFSym> DKinFitUtils::Get_SymMatrixResource(unsigned int locNumMatrixRows)
 {
 	auto locSymMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
@@ -54,6 +54,10 @@ class DKinFitUtils //contains pure-virtual functions: cannot directly instantiat
 		//GET INPUT FROM OUTPUT
 		shared_ptr<DKinFitParticle> Get_InputKinFitParticle(const shared_ptr<DKinFitParticle>& locKinFitParticle) const;
 
+		//COPY OUTPUT -> INPUT MAPPING
+			//For fits done by another DKinFitUtils (e.g. on another thread) on input particles created by this one
+		void Copy_OutputToInputMapping(const DKinFitUtils* locKinFitUtils, const set<shared_ptr<DKinFitParticle>>& locOutputKinFitParticles);
+
 		/************************************************************** CREATE PARTICLES ************************************************************/
 
 		//If multiple constraints, it is EXTREMELY CRITICAL that only one DKinFitParticle be created per particle, so that the particles are correctly linked across constraints!!
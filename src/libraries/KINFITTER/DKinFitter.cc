@@ -63,6 +63,7 @@ DKinFitter::DKinFitter(DKinFitUtils* locKinFitUtils) : dKinFitUtils(locKinFitUti
 	dMaxNumIterations = 20;
 	dConvergenceChiSqDiff = 0.001;
 	dConvergenceChiSqDiff_LastResort = 0.005;
+	dUseDenseMatricesFlag = false;
 
 	dKinFitUtils->dKinFitter = this;
 	Reset_NewEvent();
@@ -430,6 +431,32 @@ void DKinFitter::Resize_Matrices(void)
 	if(dV.GetNrows() != static_cast<int>(dNumEta + dNumXi))
 		dV.ResizeTo(dNumEta + dNumXi, dNumEta + dNumXi);
 
+	//block-diagonal dVY work matrices
+	if((dF_dEta_VY.GetNrows() != static_cast<int>(dNumF)) || (dF_dEta_VY.GetNcols() != static_cast<int>(dNumEta)))
+	{
+		dF_dEta_VY.ResizeTo(dNumF, dNumEta);
+		dS_Inverse_dF_dEta_VY.ResizeTo(dNumF, dNumEta);
+	}
+	if((dS_Inverse_dF_dXi.GetNrows() != static_cast<int>(dNumF)) || (dS_Inverse_dF_dXi.GetNcols() != static_cast<int>(dNumXi)))
+		dS_Inverse_dF_dXi.ResizeTo(dNumF, dNumXi);
+	if((dVY_H.GetNrows() != static_cast<int>(dNumEta)) || (dVY_H.GetNcols() != static_cast<int>(dNumXi)))
+	{
+		dVY_H.ResizeTo(dNumEta, dNumXi);
+		dVY_H_VXi.ResizeTo(dNumEta, dNumXi);
+	}
+	if(dR.GetNrows() != static_cast<int>(dNumF))
+	{
+		dR.ResizeTo(dNumF, 1);
+		dS_Inverse_R.ResizeTo(dNumF, 1);
+		dS_LU.ResizeTo(dNumF, dNumF);
+	}
+	if(dDeltaXi.GetNrows() != static_cast<int>(dNumXi))
+	{
+		dF_dXi_T_S_Inverse_R.ResizeTo(dNumXi, 1);
+		dDeltaXi.ResizeTo(dNumXi, 1);
+		dU_LU.ResizeTo(dNumXi, dNumXi);
+	}
+
 	Zero_Matrices(); //zeroes all class matrices
 }
 
@@ -705,6 +732,8 @@ void DKinFitter::Fill_InputMatrices(void)
 		}
 	}
 
+	Fill_VYBlocks();
+
 	if(dDebugLevel > 20)
 	{
 		cout << "DKinFitter: dEta: " << endl;
@@ -718,6 +747,46 @@ void DKinFitter::Fill_InputMatrices(void)
 	}
 }
 
+void DKinFitter::Fill_VYBlocks(void)
+{
+	//one block per measured particle: its parameters are contiguous in dEta (see Fill_InputMatrices())
+	dVYBlocks.clear();
+	for(auto& locKinFitParticle : dKinFitParticles)
+	{
+		DKinFitParticleType locKinFitParticleType = locKinFitParticle->Get_KinFitParticleType();
+		if((locKinFitParticleType == d_DecayingParticle) || (locKinFitParticleType == d_MissingParticle) || (locKinFitParticleType == d_TargetParticle))
+			continue;
+
+		int locParamIndices[4] = {locKinFitParticle->Get_EParamIndex(), locKinFitParticle->Get_PxParamIndex(), locKinFitParticle->Get_VxParamIndex(), locKinFitParticle->Get_TParamIndex()};
+		int locNumParamsByIndex[4] = {1, 3, 3, 1};
+
+		int locFirstParamIndex = -1;
+		unsigned int locNumParams = 0;
+		for(unsigned int loc_i = 0; loc_i < 4; ++loc_i)
+		{
+			if(locParamIndices[loc_i] < 0)
+				continue;
+			if((locFirstParamIndex < 0) || (locParamIndices[loc_i] < locFirstParamIndex))
+				locFirstParamIndex = locParamIndices[loc_i];
+			locNumParams += locNumParamsByIndex[loc_i];
+		}
+		if(locNumParams == 0)
+			continue; //not measured in this fit
+
+		DKinFitVYBlock locVYBlock;
+		locVYBlock.dFirstParamIndex = locFirstParamIndex;
+		locVYBlock.dNumParams = locNumParams;
+		locVYBlock.dFirstActiveFIndex = 0;
+		locVYBlock.dNumActiveFIndices = 0;
+		for(unsigned int loc_j = 0; loc_j < locNumParams; ++loc_j)
+		{
+			for(unsigned int loc_k = 0; loc_k < locNumParams; ++loc_k)
+				locVYBlock.dVY[loc_j][loc_k] = dVY(locFirstParamIndex + loc_j, locFirstParamIndex + loc_k);
+		}
+		dVYBlocks.push_back(locVYBlock);
+	}
+}
+
 /********************************************************************* PERFORM FIT *********************************************************************/
 
 bool DKinFitter::Fit_Reaction(void)
@@ -740,7 +809,10 @@ bool DKinFitter::Fit_Reaction(void)
 	// Calculate final covariance matrices
 	if(dNumXi > 0)
 		dVXi = dU;
-	Calc_dVdEta();
+	if(dUseDenseMatricesFlag)
+		Calc_dVdEta();
+	else
+		Calc_dVdEta_Blocks();
 
 	// Calculate fit NDF, Confidence level
 	dNDF = dNumF - dNumXi;
@@ -795,44 +867,13 @@ bool DKinFitter::Iterate(void)
 			dKinFitUtils->Print_Matrix(dF_dEta);
 		}
 
-		TMatrixD locR(dF + dF_dEta*(dY - dEta)); //dimensions are dNumF, 1
-
-		if(!Calc_dS())
+		bool locStepFlag = dUseDenseMatricesFlag ? Calc_Step_Dense() : Calc_Step_Blocks();
+		if(!locStepFlag)
 		{
 			dKinFitStatus = d_KinFitFailedInversion;
 			return false; // matrix is not invertible
 		}
 
-		if(dNumXi > 0)
-		{
-			if(!Calc_dU())
-			{
-				dKinFitStatus = d_KinFitFailedInversion;
-				return false; // matrix is not invertible
-			}
-
-			TMatrixD locDeltaXi(-1.0*dU*dF_dXi_T*dS_Inverse*locR); //dimensions are dNumXi, 1
-
-			dXi += locDeltaXi;
-			if(dDebugLevel > 20)
-			{
-				cout << "DKinFitter: locDeltaXi: " << endl;
-				dKinFitUtils->Print_Matrix(locDeltaXi);
-				cout << "DKinFitter: dXi: " << endl;
-				dKinFitUtils->Print_Matrix(dXi);
-			}
-
-			dLambda = dS_Inverse*(locR + dF_dXi*locDeltaXi);
-		}
-		else
-			dLambda = dS_Inverse*locR;
-
-		dLambda_T.Transpose(dLambda);
-		dEta = dY - dVY*dF_dEta_T*dLambda;
-
-		TMatrixDSym locTempMatrix = dS; //similarity (below) destroys the matrix: use a temp to preserve dS
-		dChiSq = (locTempMatrix.SimilarityT(dLambda) + 2.0*dLambda_T*dF)(0, 0);
-
 		Update_ParticleParams(); //input eta & xi info into particle objects
 
 		if(dDebugLevel > 20)
@@ -853,7 +894,45 @@ bool DKinFitter::Iterate(void)
 	return true;
 }
 
-/****************************************************************** CALCULATE MATRICES *****************************************************************/
+/************************************************************** CALCULATE MATRICES: DENSE **************************************************************/
+
+bool DKinFitter::Calc_Step_Dense(void)
+{
+	//update dXi, dLambda, dEta, dChiSq //returns false if a matrix is not invertible
+	TMatrixD locR(dF + dF_dEta*(dY - dEta)); //dimensions are dNumF, 1
+
+	if(!Calc_dS())
+		return false;
+
+	if(dNumXi > 0)
+	{
+		if(!Calc_dU())
+			return false;
+
+		TMatrixD locDeltaXi(-1.0*dU*dF_dXi_T*dS_Inverse*locR); //dimensions are dNumXi, 1
+
+		dXi += locDeltaXi;
+		if(dDebugLevel > 20)
+		{
+			cout << "DKinFitter: locDeltaXi: " << endl;
+			dKinFitUtils->Print_Matrix(locDeltaXi);
+			cout << "DKinFitter: dXi: " << endl;
+			dKinFitUtils->Print_Matrix(dXi);
+		}
+
+		dLambda = dS_Inverse*(locR + dF_dXi*locDeltaXi);
+	}
+	else
+		dLambda = dS_Inverse*locR;
+
+	dLambda_T.Transpose(dLambda);
+	dEta = dY - dVY*dF_dEta_T*dLambda;
+
+	TMatrixDSym locTempMatrix = dS; //similarity (below) destroys the matrix: use a temp to preserve dS
+	dChiSq = (locTempMatrix.SimilarityT(dLambda) + 2.0*dLambda_T*dF)(0, 0);
+
+	return true;
+}
 
 bool DKinFitter::Calc_dS(void)
 {
@@ -996,6 +1075,437 @@ void DKinFitter::Calc_dVdEta(void)
 	}
 }
 
+/************************************************************* CALCULATE MATRICES: BLOCKS *************************************************************/
+
+bool DKinFitter::Calc_Step_Blocks(void)
+{
+	//same as Calc_Step_Dense(), but only multiplies the non-zero blocks of dVY and dF_dEta, and doesn't create temporary matrices
+	//returns false if a matrix is not invertible
+	Calc_dF_dEta_VY();
+
+	//dR = dF + dF_dEta*(dY - dEta)
+	const double* locF = dF.GetMatrixArray();
+	const double* locF_dEta = dF_dEta.GetMatrixArray();
+	const double* locY = dY.GetMatrixArray();
+	double* locEta = dEta.GetMatrixArray();
+	double* locR = dR.GetMatrixArray();
+	for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+		locR[loc_i] = locF[loc_i];
+	for(auto& locVYBlock : dVYBlocks)
+	{
+		const unsigned int* locActiveFIndices = dActiveFIndices.data() + locVYBlock.dFirstActiveFIndex;
+		for(unsigned int loc_i = 0; loc_i < locVYBlock.dNumActiveFIndices; ++loc_i)
+		{
+			unsigned int locFIndex = locActiveFIndices[loc_i];
+			const double* locF_dEta_Row = locF_dEta + locFIndex*dNumEta;
+			for(unsigned int loc_j = locVYBlock.dFirstParamIndex; loc_j < locVYBlock.dFirstParamIndex + locVYBlock.dNumParams; ++loc_j)
+				locR[locFIndex] += locF_dEta_Row[loc_j]*(locY[loc_j] - locEta[loc_j]);
+		}
+	}
+
+	if(!Calc_dS_Blocks())
+		return false;
+
+	//dS_Inverse_R = dS_Inverse*dR
+	const double* locS_Inverse = dS_Inverse.GetMatrixArray();
+	double* locS_Inverse_R = dS_Inverse_R.GetMatrixArray();
+	for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+	{
+		double locSum = 0.0;
+		for(unsigned int loc_j = 0; loc_j < dNumF; ++loc_j)
+			locSum += locS_Inverse[loc_i*dNumF + loc_j]*locR[loc_j];
+		locS_Inverse_R[loc_i] = locSum;
+	}
+
+	double* locLambda = dLambda.GetMatrixArray();
+	for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+		locLambda[loc_i] = locS_Inverse_R[loc_i];
+
+	if(dNumXi > 0)
+	{
+		if(!Calc_dU_Blocks())
+			return false;
+
+		//dDeltaXi = -dU*dF_dXi_T*dS_Inverse*dR
+		const double* locF_dXi = dF_dXi.GetMatrixArray();
+		const double* locU = dU.GetMatrixArray();
+		double* locF_dXi_T_S_Inverse_R = dF_dXi_T_S_Inverse_R.GetMatrixArray();
+		double* locDeltaXi = dDeltaXi.GetMatrixArray();
+		for(unsigned int loc_i = 0; loc_i < dNumXi; ++loc_i)
+		{
+			double locSum = 0.0;
+			for(unsigned int loc_j = 0; loc_j < dNumF; ++loc_j)
+				locSum += locF_dXi[loc_j*dNumXi + loc_i]*locS_Inverse_R[loc_j];
+			locF_dXi_T_S_Inverse_R[loc_i] = locSum;
+		}
+		double* locXi = dXi.GetMatrixArray();
+		for(unsigned int loc_i = 0; loc_i < dNumXi; ++loc_i)
+		{
+			double locSum = 0.0;
+			for(unsigned int loc_j = 0; loc_j < dNumXi; ++loc_j)
+				locSum += locU[loc_i*dNumXi + loc_j]*locF_dXi_T_S_Inverse_R[loc_j];
+			locDeltaXi[loc_i] = -1.0*locSum;
+			locXi[loc_i] += locDeltaXi[loc_i];
+		}
+		if(dDebugLevel > 20)
+		{
+			cout << "DKinFitter: locDeltaXi: " << endl;
+			dKinFitUtils->Print_Matrix(dDeltaXi);
+			cout << "DKinFitter: dXi: " << endl;
+			dKinFitUtils->Print_Matrix(dXi);
+		}
+
+		//dLambda = dS_Inverse*(dR + dF_dXi*dDeltaXi) = dS_Inverse_R + dS_Inverse_dF_dXi*dDeltaXi
+		const double* locS_Inverse_F_dXi = dS_Inverse_dF_dXi.GetMatrixArray();
+		for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+		{
+			for(unsigned int loc_j = 0; loc_j < dNumXi; ++loc_j)
+				locLambda[loc_i] += locS_Inverse_F_dXi[loc_i*dNumXi + loc_j]*locDeltaXi[loc_j];
+		}
+	}
+
+	double* locLambda_T = dLambda_T.GetMatrixArray();
+	for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+		locLambda_T[loc_i] = locLambda[loc_i];
+
+	//dEta = dY - dVY*dF_dEta_T*dLambda = dY - dF_dEta_VY_T*dLambda
+	const double* locF_dEta_VY = dF_dEta_VY.GetMatrixArray();
+	for(auto& locVYBlock : dVYBlocks)
+	{
+		const unsigned int* locActiveFIndices = dActiveFIndices.data() + locVYBlock.dFirstActiveFIndex;
+		for(unsigned int loc_j = locVYBlock.dFirstParamIndex; loc_j < locVYBlock.dFirstParamIndex + locVYBlock.dNumParams; ++loc_j)
+		{
+			double locSum = 0.0;
+			for(unsigned int loc_i = 0; loc_i < locVYBlock.dNumActiveFIndices; ++loc_i)
+				locSum += locF_dEta_VY[locActiveFIndices[loc_i]*dNumEta + loc_j]*locLambda[locActiveFIndices[loc_i]];
+			locEta[loc_j] = locY[loc_j] - locSum;
+		}
+	}
+
+	//dChiSq = dLambda_T*dS*dLambda + 2*dLambda_T*dF
+	const double* locS = dS.GetMatrixArray();
+	dChiSq = 0.0;
+	for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+	{
+		double locSum = 2.0*locF[loc_i];
+		for(unsigned int loc_j = 0; loc_j < dNumF; ++loc_j)
+			locSum += locS[loc_i*dNumF + loc_j]*locLambda[loc_j];
+		dChiSq += locLambda[loc_i]*locSum;
+	}
+
+	return true;
+}
+
+void DKinFitter::Calc_dF_dEta_VY(void)
+{
+	//dF_dEta_VY = dF_dEta*dVY, one dVY block at a time
+	//also find the rows of dF_dEta that are non-zero in each block: each constraint equation only depends on a few particles
+	dF_dEta_VY.Zero();
+	dActiveFIndices.clear();
+
+	const double* locF_dEta = dF_dEta.GetMatrixArray();
+	double* locF_dEta_VY = dF_dEta_VY.GetMatrixArray();
+	for(auto& locVYBlock : dVYBlocks)
+	{
+		unsigned int locNumParams = locVYBlock.dNumParams;
+		locVYBlock.dFirstActiveFIndex = dActiveFIndices.size();
+		for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+		{
+			const double* locF_dEta_Row = locF_dEta + loc_i*dNumEta + locVYBlock.dFirstParamIndex;
+			bool locActiveFlag = false;
+			for(unsigned int loc_k = 0; loc_k < locNumParams; ++loc_k)
+			{
+				if(locF_dEta_Row[loc_k] == 0.0)
+					continue;
+				locActiveFlag = true;
+				break;
+			}
+			if(!locActiveFlag)
+				continue;
+
+			dActiveFIndices.push_back(loc_i);
+			double* locF_dEta_VY_Row = locF_dEta_VY + loc_i*dNumEta + locVYBlock.dFirstParamIndex;
+			for(unsigned int loc_j = 0; loc_j < locNumParams; ++loc_j)
+			{
+				double locSum = 0.0;
+				for(unsigned int loc_k = 0; loc_k < locNumParams; ++loc_k)
+					locSum += locF_dEta_Row[loc_k]*locVYBlock.dVY[loc_k][loc_j];
+				locF_dEta_VY_Row[loc_j] = locSum;
+			}
+		}
+		locVYBlock.dNumActiveFIndices = dActiveFIndices.size() - locVYBlock.dFirstActiveFIndex;
+	}
+}
+
+bool DKinFitter::Calc_dS_Blocks(void)
+{
+	//dS = dF_dEta*dVY*dF_dEta_T = dF_dEta_VY*dF_dEta_T: sum the contributions of each block, for the rows that are non-zero in it
+	dS.Zero();
+	const double* locF_dEta = dF_dEta.GetMatrixArray();
+	const double* locF_dEta_VY = dF_dEta_VY.GetMatrixArray();
+	double* locS = dS.GetMatrixArray();
+	for(auto& locVYBlock : dVYBlocks)
+	{
+		const unsigned int* locActiveFIndices = dActiveFIndices.data() + locVYBlock.dFirstActiveFIndex;
+		for(unsigned int loc_i = 0; loc_i < locVYBlock.dNumActiveFIndices; ++loc_i)
+		{
+			unsigned int locRow = locActiveFIndices[loc_i];
+			const double* locF_dEta_VY_Row = locF_dEta_VY + locRow*dNumEta + locVYBlock.dFirstParamIndex;
+			for(unsigned int loc_j = 0; loc_j <= loc_i; ++loc_j) //active indices are sorted: lower triangle
+			{
+				unsigned int locColumn = locActiveFIndices[loc_j];
+				const double* locF_dEta_Row = locF_dEta + locColumn*dNumEta + locVYBlock.dFirstParamIndex;
+				double locSum = 0.0;
+				for(unsigned int loc_k = 0; loc_k < locVYBlock.dNumParams; ++loc_k)
+					locSum += locF_dEta_VY_Row[loc_k]*locF_dEta_Row[loc_k];
+				locS[locRow*dNumF + locColumn] += locSum;
+			}
+		}
+	}
+	for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+	{
+		for(unsigned int loc_j = 0; loc_j < loc_i; ++loc_j)
+			locS[loc_j*dNumF + loc_i] = locS[loc_i*dNumF + loc_j];
+	}
+
+	if(dDebugLevel > 20)
+	{
+		cout << "DKinFitter: dS: " << endl;
+		dKinFitUtils->Print_Matrix(dS);
+	}
+
+	if(!Invert_SymMatrix(dS, dS_Inverse, dS_LU, true))
+	{
+		if(dDebugLevel > 10)
+			cout << "DKinFitter: dS not invertible.  Returning false." << endl;
+		return false; // matrix is not invertible
+	}
+
+	if(dDebugLevel > 20)
+	{
+		cout << "DKinFitter: dS_Inverse: " << endl;
+		dKinFitUtils->Print_Matrix(dS_Inverse);
+	}
+	return true;
+}
+
+bool DKinFitter::Calc_dU_Blocks(void)
+{
+	//dS_Inverse_dF_dXi = dS_Inverse*dF_dXi //also used for dLambda and dVEta
+	const double* locS_Inverse = dS_Inverse.GetMatrixArray();
+	const double* locF_dXi = dF_dXi.GetMatrixArray();
+	double* locS_Inverse_F_dXi = dS_Inverse_dF_dXi.GetMatrixArray();
+	for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+	{
+		for(unsigned int loc_j = 0; loc_j < dNumXi; ++loc_j)
+		{
+			double locSum = 0.0;
+			for(unsigned int loc_k = 0; loc_k < dNumF; ++loc_k)
+				locSum += locS_Inverse[loc_i*dNumF + loc_k]*locF_dXi[loc_k*dNumXi + loc_j];
+			locS_Inverse_F_dXi[loc_i*dNumXi + loc_j] = locSum;
+		}
+	}
+
+	//dU_Inverse = dF_dXi_T*dS_Inverse*dF_dXi: symmetric
+	double* locU_Inverse = dU_Inverse.GetMatrixArray();
+	for(unsigned int loc_i = 0; loc_i < dNumXi; ++loc_i)
+	{
+		for(unsigned int loc_j = 0; loc_j <= loc_i; ++loc_j)
+		{
+			double locSum = 0.0;
+			for(unsigned int loc_k = 0; loc_k < dNumF; ++loc_k)
+				locSum += locF_dXi[loc_k*dNumXi + loc_i]*locS_Inverse_F_dXi[loc_k*dNumXi + loc_j];
+			locU_Inverse[loc_i*dNumXi + loc_j] = locSum;
+			locU_Inverse[loc_j*dNumXi + loc_i] = locSum;
+		}
+	}
+
+	if(dDebugLevel > 20)
+	{
+		cout << "DKinFitter: dU_Inverse: " << endl;
+		dKinFitUtils->Print_Matrix(dU_Inverse);
+	}
+
+	if(!Invert_SymMatrix(dU_Inverse, dU, dU_LU, false))
+	{
+		if(dDebugLevel > 10)
+			cout << "DKinFitter: dU_Inverse not invertible.  Returning false." << endl;
+		return false; // matrix is not invertible
+	}
+
+	if(dDebugLevel > 20)
+	{
+		cout << "DKinFitter: dU: " << endl;
+		dKinFitUtils->Print_Matrix(dU);
+	}
+	return true;
+}
+
+bool DKinFitter::Invert_SymMatrix(TMatrixDSym& locMatrix, TMatrixDSym& locInverse, TMatrixD& locLUMatrix, bool locLowerTolFlag)
+{
+	//Same checks as Calc_dS() (locLowerTolFlag = true) and Calc_dU()
+	//But the matrix is only decomposed once: the determinant and the inverse are both taken from the decomposition used for the checks
+	//locLUMatrix must have the same dimensions as locMatrix: it is used instead of a temporary
+	locLUMatrix = locMatrix;
+	TDecompLU locDecompLU(locLUMatrix, locMatrix.GetTol());
+	bool locDecomposedFlag = locDecompLU.Decompose();
+
+	double locDeterminant = 0.0;
+	if(locDecomposedFlag)
+	{
+		Double_t locDet1, locDet2;
+		locDecompLU.Det(locDet1, locDet2);
+		locDeterminant = locDet1*TMath::Power(2.0, locDet2);
+	}
+
+	//debugging step: lowering Tol to pass (see Calc_dS())
+	if(locLowerTolFlag && locDecomposedFlag && (locDeterminant == 0.0))
+	{
+		if(dDebugLevel > 10) cout << "trying to lower Tol = "<< locMatrix.GetTol() << "\n" << endl;
+		const TMatrixD& locLU = locDecompLU.GetLU();
+
+		//Search for smallest diagonal term in the LU matrix
+		Double_t locMinDiagElement = fabs(locLU(0, 0));
+		for(int loc_i = 1; loc_i < locLU.GetNrows(); ++loc_i)
+		{
+			if(fabs(locLU(loc_i, loc_i)) < locMinDiagElement)
+				locMinDiagElement = fabs(locLU(loc_i, loc_i));
+		}
+
+		//Set the new tolerance, and recompute the determinant with it
+		if((locMatrix.GetTol() > locMinDiagElement) && (locMinDiagElement > 1.0E-26))
+		{
+			locMatrix.SetTol(locMinDiagElement/2);
+			if(dDebugLevel > 10) cout << "New Tol is set at " << locMinDiagElement/2 << "\n"  << endl;
+
+			//decompose again with it (rare): locLUMatrix is still a copy of locMatrix
+			locDecompLU.SetMatrix(locLUMatrix);
+			locDecompLU.SetTol(locMatrix.GetTol());
+			Double_t locDet1, locDet2;
+			locDecompLU.Det(locDet1, locDet2);
+			locDeterminant = locDet1*TMath::Power(2.0, locDet2);
+		}
+	}
+
+	//check to make sure that the matrix is decomposable and has a non-zero determinant
+	if(!locDecomposedFlag || (fabs(locDeterminant) < 1.0E-300))
+		return false; // matrix is not invertible
+
+	//invert from the existing decomposition
+	if(!locDecompLU.Invert(locLUMatrix))
+		return false;
+	locInverse.SetMatrixArray(locLUMatrix.GetMatrixArray());
+
+	if(locLowerTolFlag)
+	{
+		//set back to standard value
+		locMatrix.SetTol(2.22044604925031308e-16);
+		locInverse.SetTol(2.22044604925031308e-16);
+	}
+
+	return true;
+}
+
+void DKinFitter::Calc_dVdEta_Blocks(void)
+{
+	//Same as Calc_dVdEta(): dVEta = dVY - dVY*(G - H*dVXi*H_T)*dVY, with G = dF_dEta_T*dS_Inverse*dF_dEta and H = dF_dEta_T*dS_Inverse*dF_dXi
+	//dVY*G*dVY = dF_dEta_VY_T*dS_Inverse*dF_dEta_VY, and dVY*H = dF_dEta_VY_T*dS_Inverse_dF_dXi
+	const double* locS_Inverse = dS_Inverse.GetMatrixArray();
+	const double* locF_dEta_VY = dF_dEta_VY.GetMatrixArray();
+
+	dS_Inverse_dF_dEta_VY.Zero();
+	double* locS_Inverse_F_dEta_VY_Array = dS_Inverse_dF_dEta_VY.GetMatrixArray();
+	for(unsigned int loc_i = 0; loc_i < dNumF; ++loc_i)
+	{
+		double* locRow = locS_Inverse_F_dEta_VY_Array + loc_i*dNumEta;
+		for(unsigned int loc_k = 0; loc_k < dNumF; ++loc_k)
+		{
+			double locS_Inverse_ik = locS_Inverse[loc_i*dNumF + loc_k];
+			const double* locF_dEta_VY_Row = locF_dEta_VY + loc_k*dNumEta;
+			for(unsigned int loc_j = 0; loc_j < dNumEta; ++loc_j)
+				locRow[loc_j] += locS_Inverse_ik*locF_dEta_VY_Row[loc_j];
+		}
+	}
+
+	//dVY*H, and dVY*H*dVXi //dVXi = dU
+	if(dNumXi > 0)
+	{
+		const double* locS_Inverse_F_dXi = dS_Inverse_dF_dXi.GetMatrixArray();
+		const double* locVXi = dVXi.GetMatrixArray();
+		double* locVY_H_Array = dVY_H.GetMatrixArray();
+		double* locVY_H_VXi_Array = dVY_H_VXi.GetMatrixArray();
+		for(unsigned int loc_i = 0; loc_i < dNumEta; ++loc_i)
+		{
+			for(unsigned int loc_j = 0; loc_j < dNumXi; ++loc_j)
+			{
+				double locSum = 0.0;
+				for(unsigned int loc_k = 0; loc_k < dNumF; ++loc_k)
+					locSum += locF_dEta_VY[loc_k*dNumEta + loc_i]*locS_Inverse_F_dXi[loc_k*dNumXi + loc_j];
+				locVY_H_Array[loc_i*dNumXi + loc_j] = locSum;
+			}
+			for(unsigned int loc_j = 0; loc_j < dNumXi; ++loc_j)
+			{
+				double locSum = 0.0;
+				for(unsigned int loc_k = 0; loc_k < dNumXi; ++loc_k)
+					locSum += locVY_H_Array[loc_i*dNumXi + loc_k]*locVXi[loc_k*dNumXi + loc_j];
+				locVY_H_VXi_Array[loc_i*dNumXi + loc_j] = locSum;
+			}
+		}
+	}
+
+	//dVEta = dVY - dVY*G*dVY + dVY*H*dVXi*H_T*dVY: symmetric
+	const double* locVY = dVY.GetMatrixArray();
+	const double* locVY_H_Array = dVY_H.GetMatrixArray();
+	const double* locVY_H_VXi_Array = dVY_H_VXi.GetMatrixArray();
+	double* locVEta = dVEta.GetMatrixArray();
+	for(unsigned int loc_i = 0; loc_i < dNumEta; ++loc_i)
+	{
+		for(unsigned int loc_j = 0; loc_j <= loc_i; ++loc_j)
+		{
+			double locSum = 0.0;
+			for(unsigned int loc_k = 0; loc_k < dNumF; ++loc_k)
+				locSum += locF_dEta_VY[loc_k*dNumEta + loc_i]*locS_Inverse_F_dEta_VY_Array[loc_k*dNumEta + loc_j];
+			for(unsigned int loc_k = 0; loc_k < dNumXi; ++loc_k)
+				locSum -= locVY_H_VXi_Array[loc_i*dNumXi + loc_k]*locVY_H_Array[loc_j*dNumXi + loc_k];
+			locVEta[loc_i*dNumEta + loc_j] = locVY[loc_i*dNumEta + loc_j] - locSum;
+			locVEta[loc_j*dNumEta + loc_i] = locVEta[loc_i*dNumEta + loc_j];
+		}
+	}
+
+	if(dNumXi == 0)
+		dV = dVEta;
+	else
+	{
+		//dV: the eta, xi covariance is -dVY*H*dU = -dVY*H*dVXi
+		for(unsigned int loc_i = 0; loc_i < dNumEta; ++loc_i)
+		{
+			for(unsigned int loc_j = 0; loc_j < dNumEta; ++loc_j)
+				dV(loc_i, loc_j) = dVEta(loc_i, loc_j);
+		}
+		for(unsigned int loc_i = 0; loc_i < dNumXi; ++loc_i)
+		{
+			for(unsigned int loc_j = 0; loc_j < dNumXi; ++loc_j)
+				dV(loc_i + dNumEta, loc_j + dNumEta) = dVXi(loc_i, loc_j);
+		}
+		for(unsigned int loc_i = 0; loc_i < dNumEta; ++loc_i)
+		{
+			for(unsigned int loc_j = 0; loc_j < dNumXi; ++loc_j)
+			{
+				dV(loc_i, loc_j + dNumEta) = -1.0*locVY_H_VXi_Array[loc_i*dNumXi + loc_j];
+				dV(loc_j + dNumEta, loc_i) = -1.0*locVY_H_VXi_Array[loc_i*dNumXi + loc_j];
+			}
+		}
+	}
+
+	if(dDebugLevel > 20)
+	{
+		cout << "DKinFitter: dVEta: " << endl;
+		dKinFitUtils->Print_Matrix(dVEta);
+		cout << "DKinFitter: dV: " << endl;
+		dKinFitUtils->Print_Matrix(dV);
+	}
+}
+
 void DKinFitter::Calc_dF(void)
 {
 	dF.Zero();
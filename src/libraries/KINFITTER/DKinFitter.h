@@ -67,12 +67,14 @@ class DKinFitter //purely virtual: cannot directly instantiate class, can only i
 		unsigned int Get_MaxNumIterations(void) const{return dMaxNumIterations;}
 		double Get_ConvergenceChiSqDiff(void) const{return dConvergenceChiSqDiff;}
 		double Get_ConvergenceChiSqDiff_LastResort(void) const{return dConvergenceChiSqDiff_LastResort;}
+		bool Get_UseDenseMatricesFlag(void) const{return dUseDenseMatricesFlag;}
 
 		//SET CONTROL VARIABLES
 		void Set_DebugLevel(int locDebugLevel);
 		void Set_MaxNumIterations(unsigned int locMaxNumIterations){dMaxNumIterations = locMaxNumIterations;}
 		void Set_ConvergenceChiSqDiff(double locConvergenceChiSqDiff){dConvergenceChiSqDiff = locConvergenceChiSqDiff;}
 		void Set_ConvergenceChiSqDiff_LastResort(double locConvergenceChiSqDiff){dConvergenceChiSqDiff_LastResort = locConvergenceChiSqDiff;}
+		void Set_UseDenseMatricesFlag(bool locUseDenseMatricesFlag){dUseDenseMatricesFlag = locUseDenseMatricesFlag;} //true: original dense-matrix fit (for validation)
 
 		/************************************************************** GET FIT RESULTS *************************************************************/
 
@@ -132,10 +134,21 @@ class DKinFitter //purely virtual: cannot directly instantiate class, can only i
 
 		bool Iterate(void);
 
+		//dense: every product is done with the full matrices
+		bool Calc_Step_Dense(void);
 		bool Calc_dS(void);
 		bool Calc_dU(void);
 		void Calc_dVdEta(void);
 
+		//blocks: dVY is block-diagonal by particle (see dVYBlocks)
+		void Fill_VYBlocks(void);
+		bool Calc_Step_Blocks(void);
+		void Calc_dF_dEta_VY(void);
+		bool Calc_dS_Blocks(void);
+		bool Calc_dU_Blocks(void);
+		void Calc_dVdEta_Blocks(void);
+		bool Invert_SymMatrix(TMatrixDSym& locMatrix, TMatrixDSym& locInverse, TMatrixD& locLUMatrix, bool locLowerTolFlag);
+
 		void Calc_dF(void);
 
 		void Calc_dF_P4(int locFIndex, const DKinFitParticle* locKinFitParticle, double locStateSignMultiplier);
@@ -166,6 +179,7 @@ class DKinFitter //purely virtual: cannot directly instantiate class, can only i
 
 		double dConvergenceChiSqDiff;
 		double dConvergenceChiSqDiff_LastResort; //if max # iterations hit, use this for final check (sometimes chisq walks (very slightly) forever without any meaningful change in the variables)
+		bool dUseDenseMatricesFlag; //default false: use the block-diagonal structure of dVY
 
 		/******************************************************** CONSTRAINTS AND PARTICLES *********************************************************/
 
@@ -205,6 +219,36 @@ class DKinFitter //purely virtual: cannot directly instantiate class, can only i
 		TMatrixDSym dVEta; //covariance matrix of dEta
 		TMatrixDSym dV; //full covariance matrix: dVEta at top-left and dVXi at bottom-right (+ the eta, xi covariance)
 
+		/********************************************************* BLOCK-DIAGONAL dVY MATRICES ******************************************************/
+
+		//The measured parameters of each particle are contiguous (p3, v3, t or E, v3, t), and there are no covariances between particles
+		//So dVY is block-diagonal with blocks of at most 7x7, and each constraint equation only depends on the parameters of a few particles
+		//dVY is only multiplied one block at a time, and only with the rows of dF_dEta that are non-zero for that block
+		class DKinFitVYBlock
+		{
+			public:
+				unsigned int dFirstParamIndex; //in dEta
+				unsigned int dNumParams; //at most 7
+				unsigned int dFirstActiveFIndex; //in dActiveFIndices: rows of dF_dEta that are non-zero in this block (updated each iteration)
+				unsigned int dNumActiveFIndices;
+				double dVY[7][7];
+		};
+
+		vector<DKinFitVYBlock> dVYBlocks;
+		vector<unsigned int> dActiveFIndices;
+
+		TMatrixD dF_dEta_VY; //dF_dEta*dVY //dimensions are dNumF, dNumEta
+		TMatrixD dS_Inverse_dF_dXi; //dimensions are dNumF, dNumXi
+		TMatrixD dS_Inverse_dF_dEta_VY; //for dVEta //dimensions are dNumF, dNumEta
+		TMatrixD dVY_H; //for dVEta //dimensions are dNumEta, dNumXi
+		TMatrixD dVY_H_VXi; //for dVEta //dimensions are dNumEta, dNumXi
+		TMatrixD dR; //dF + dF_dEta*(dY - dEta) //dimensions are dNumF, 1
+		TMatrixD dS_Inverse_R; //dimensions are dNumF, 1
+		TMatrixD dF_dXi_T_S_Inverse_R; //dimensions are dNumXi, 1
+		TMatrixD dDeltaXi; //dimensions are dNumXi, 1
+		TMatrixD dS_LU; //for inverting dS //dimensions are dNumF, dNumF
+		TMatrixD dU_LU; //for inverting dU_Inverse //dimensions are dNumXi, dNumXi
+
 		/*************************************************************** FIT RESULTS ****************************************************************/
 
 		double dChiSq;
@@ -0,0 +1,66 @@
+// $Id$
+//
+//    File: DKalmanSIMDTrajectory.h
+// Created: Sun Oct 18 16:05:12 EDT 2026
+//
+
+// Storage for the reference trajectories (central_traj and forward_traj)
+// of DTrackFitterKalmanSIMD.
+//
+// The fitter builds a trajectory by swimming outward and adding each
+// step to the front, then walks it by index in both directions in the
+// filter and smoother. This supports the same operations the fitter
+// used on the deque it replaces (push_front, pop_front, operator[],
+// size and clear). All steps are kept in one contiguous buffer, filled
+// from the end toward the start, so stepping through the trajectory
+// streams through memory.
+//
+// clear() keeps the buffer. The fitter object is reused for every
+// track and mass hypothesis in a thread, so once the buffer has grown
+// to fit the longest trajectory seen, no more memory is allocated.
+
+#ifndef _DKalmanSIMDTrajectory_
+#define _DKalmanSIMDTrajectory_
+
+#include <vector>
+#include <algorithm>
+
+template<class T>
+class DKalmanSIMDTrajectory{
+	public:
+		DKalmanSIMDTrajectory():head(0){}
+
+		void push_front(const T &step){
+			if(head == 0) Grow();
+			buff[--head] = step;
+		}
+		void pop_front(void){ if(head < buff.size()) head++; }
+		void clear(void){ head = buff.size(); }
+
+		T& operator[](size_t i){ return buff[head + i]; }
+		const T& operator[](size_t i) const { return buff[head + i]; }
+		size_t size(void) const { return buff.size() - head; }
+		bool empty(void) const { return head == buff.size(); }
+		size_t capacity(void) const { return buff.size(); }
+
+		void reserve(size_t n){
+			while(buff.size() < n) Grow();
+		}
+
+	protected:
+		void Grow(void){
+			/// Double the size of the buffer, keeping the existing steps
+			/// at the end of it.
+			size_t n = size();
+			size_t newsize = buff.empty() ? 256:2*buff.size();
+			std::vector<T> newbuff(newsize);
+			std::copy(buff.begin() + head, buff.end(), newbuff.end() - n);
+			buff.swap(newbuff);
+			head = newsize - n;
+		}
+
+		std::vector<T> buff;
+		size_t head;    // index of first step in buff
+};
+
+#endif // _DKalmanSIMDTrajectory_
@@ -2,3 +2,4 @@
 
 //Declare thread_local resource pools
 thread_local std::shared_ptr<DResourcePool<TMatrixFSym>> DReferenceTrajectory::dResourcePool_TMatrixFSym = std::make_shared<DResourcePool<TMatrixFSym>>(10, 10, 50);
+thread_local std::shared_ptr<DResourcePool<DReferenceTrajectory::swim_step_block_t>> DReferenceTrajectory::dResourcePool_SwimSteps = std::make_shared<DResourcePool<DReferenceTrajectory::swim_step_block_t>>(1, 1, 4, 16, 0);
@@ -26,6 +26,28 @@ using namespace std;
 
 struct StepStruct {DReferenceTrajectory::swim_step_t steps[256];};
 
+//---------------------------------
+// WireDelta2
+//---------------------------------
+static inline double WireDelta2(double x, double y, double z, const DCoordinateSystem *wire)
+{
+	/// Return the square of the distance from the point (x,y,z) to
+	/// the wire. If the point is past the end of the wire, the
+	/// distance along the wire direction from the wire's end is
+	/// added on.
+	double dx = x - wire->origin.X();
+	double dy = y - wire->origin.Y();
+	double dz = z - wire->origin.Z();
+	double u = wire->udir.X()*dx + wire->udir.Y()*dy + wire->udir.Z()*dz;
+	double delta2 = dx*dx + dy*dy + dz*dz - u*u;
+	double L_over_2 = wire->L/2.0; // half-length of wire in cm
+	if(fabs(u)>L_over_2){
+		double u_minus_L_over_2 = fabs(u)-L_over_2;
+		delta2 += u_minus_L_over_2*u_minus_L_over_2;
+	}
+	return delta2;
+}
+
 //---------------------------------
 // DReferenceTrajectory    (Constructor)
 //---------------------------------
@@ -76,15 +98,17 @@ DReferenceTrajectory::DReferenceTrajectory(const DMagneticFieldMap *bfield
 	// allocating/deallocating the large block of memory required to hold
 	// all of the trajectory info. The preferred way of calling this is 
 	// with a pointer allocated once at program startup. This code block
-	// though allows it to be allocated here if necessary.
+	// though allows it to be allocated here if necessary. In that case
+	// the block comes from a pool so it is reused by the next trajectory
+	// created after this one is deleted. When the caller supplies the
+	// swim steps, only the positions need storage so no block is taken.
 	if(!swim_steps){
-		own_swim_steps = true;
-		this->max_swim_steps = MAX_SWIM_STEPS;
-		this->swim_steps = new swim_step_t[this->max_swim_steps];
+		AllocateSwimSteps(MAX_SWIM_STEPS);
 	}else{
 		own_swim_steps = false;
 		this->max_swim_steps = max_swim_steps;
 		this->swim_steps = swim_steps;
+		ext_swim_pos.resize(max_swim_steps);
 	}
 }
 
@@ -99,8 +123,6 @@ DReferenceTrajectory::DReferenceTrajectory(const DReferenceTrajectory& rt)
 
 	this->Nswim_steps = rt.Nswim_steps;
 	this->q = rt.q;
-	this->max_swim_steps = rt.max_swim_steps;
-	this->own_swim_steps = true;
 	this->step_size = rt.step_size;
 	this->bfield = rt.bfield;
 	this->last_phi = rt.last_phi;
@@ -123,7 +145,7 @@ DReferenceTrajectory::DReferenceTrajectory(const DReferenceTrajectory& rt)
 	this->Rsqmax_exterior = 88.0*88.0; // Maximum radius (in cm) corresponding to outside of BCAL
 	
 
-	this->swim_steps = new swim_step_t[this->max_swim_steps];
+	AllocateSwimSteps(rt.max_swim_steps);
 	this->last_swim_step = NULL;
 	for(int i=0; i<Nswim_steps; i++)
 	{
@@ -131,6 +153,7 @@ DReferenceTrajectory::DReferenceTrajectory(const DReferenceTrajectory& rt)
 		if(&(rt.swim_steps[i]) == rt.last_swim_step)
 			this->last_swim_step = &(swim_steps[i]);
 	}
+	UpdateSwimPos();
 
 }
 
@@ -149,21 +172,15 @@ DReferenceTrajectory& DReferenceTrajectory::operator=(const DReferenceTrajectory
 	
 	if(&rt == this)return *this; // protect against self copies
 
-	// Free memory if block is too small
-	if(own_swim_steps==true && max_swim_steps<rt.Nswim_steps){
-		delete[] swim_steps;
-		swim_steps=NULL;
-	}
-	
-	// Forget memory block if we don't currently own it
-	if(!own_swim_steps){
-		swim_steps=NULL;
+	// Get a new memory block if ours is too small or we don't currently
+	// own it. Otherwise keep the one we have.
+	if(!own_swim_steps || max_swim_steps<rt.Nswim_steps){
+		ReleaseSwimSteps();
+		AllocateSwimSteps(rt.max_swim_steps);
 	}
 
 	this->Nswim_steps = rt.Nswim_steps;
 	this->q = rt.q;
-	this->max_swim_steps = rt.max_swim_steps;
-	this->own_swim_steps = true;
 	this->step_size = rt.step_size;
 	this->bfield = rt.bfield;
 	this->last_phi = rt.last_phi;
@@ -180,9 +197,6 @@ DReferenceTrajectory& DReferenceTrajectory::operator=(const DReferenceTrajectory
 	this->MIN_STEP_SIZE = rt.GetMinStepSize();
 	this->MAX_STEP_SIZE = rt.GetMaxStepSize();
 
-	// Allocate memory if needed
-	if(swim_steps==NULL)this->swim_steps = new swim_step_t[this->max_swim_steps];
-
 	// Copy swim steps
 	this->last_swim_step = NULL;
 	for(int i=0; i<Nswim_steps; i++)
@@ -191,6 +205,7 @@ DReferenceTrajectory& DReferenceTrajectory::operator=(const DReferenceTrajectory
 		if(&(rt.swim_steps[i]) == rt.last_swim_step)
 			this->last_swim_step = &(swim_steps[i]);
 	}
+	UpdateSwimPos();
 
 	
 	return *this;
@@ -201,8 +216,55 @@ DReferenceTrajectory& DReferenceTrajectory::operator=(const DReferenceTrajectory
 //---------------------------------
 DReferenceTrajectory::~DReferenceTrajectory()
 {
-	if(own_swim_steps){
-		delete[] swim_steps;
+	ReleaseSwimSteps();
+}
+
+//---------------------------------
+// AllocateSwimSteps
+//---------------------------------
+void DReferenceTrajectory::AllocateSwimSteps(int max_steps)
+{
+	/// Get a block from the pool to hold max_steps swim steps and
+	/// their positions. The block is grown if it was last used for
+	/// fewer steps, but is never shrunk, so once the pool holds blocks
+	/// of the usual size no more memory is allocated.
+
+	swim_step_block = dResourcePool_SwimSteps->Get_SharedResource();
+	if((int)swim_step_block->steps.size() < max_steps) swim_step_block->steps.resize(max_steps);
+	if((int)swim_step_block->pos.size() < max_steps) swim_step_block->pos.resize(max_steps);
+
+	own_swim_steps = true;
+	max_swim_steps = max_steps;
+	swim_steps = swim_step_block->steps.data();
+	vector<swim_pos_t>().swap(ext_swim_pos);
+}
+
+//---------------------------------
+// ReleaseSwimSteps
+//---------------------------------
+void DReferenceTrajectory::ReleaseSwimSteps(void)
+{
+	/// Return our block to the pool it came from.
+	swim_step_block.reset();
+	if(own_swim_steps) swim_steps = NULL;
+}
+
+//---------------------------------
+// UpdateSwimPos
+//---------------------------------
+void DReferenceTrajectory::UpdateSwimPos(int first)
+{
+	/// Copy the positions of swim steps first through Nswim_steps-1
+	/// into the compact position array. This needs to be called
+	/// whenever swim steps are added or changed.
+	vector<swim_pos_t> &posv = swim_step_block ? swim_step_block->pos:ext_swim_pos;
+	if((int)posv.size() < Nswim_steps) posv.resize(Nswim_steps);
+	swim_pos_t *pos = posv.data();
+	for(int i=first; i<Nswim_steps; i++){
+		const DVector3 &origin = swim_steps[i].origin;
+		pos[i].x = origin.X();
+		pos[i].y = origin.Y();
+		pos[i].z = origin.Z();
 	}
 }
 
@@ -216,6 +278,7 @@ void DReferenceTrajectory::CopyWithShift(const DReferenceTrajectory *rt, DVector
 	
 	// Second, shift all positions
 	for(int i=0; i<Nswim_steps; i++)swim_steps[i].origin += shift;
+	UpdateSwimPos();
 }
 
 
@@ -237,6 +300,54 @@ void DReferenceTrajectory::Reset(void){
 	this->check_material_boundaries = true;
 }
 
+//---------------------------------
+// Release
+//---------------------------------
+void DReferenceTrajectory::Release(void)
+{
+	/// Give the swim step memory back to the pool while this trajectory
+	/// is not being used. Reuse() must be called before it is used
+	/// again. This is what lets a pool of trajectories (see
+	/// DTrackingWorkspace) hold only as many blocks of swim steps as
+	/// are in use at one time. Trajectories using an external buffer
+	/// are left alone.
+	if(own_swim_steps) ReleaseSwimSteps();
+	Nswim_steps = 0;
+	last_swim_step = NULL;
+}
+
+//---------------------------------
+// Reuse
+//---------------------------------
+void DReferenceTrajectory::Reuse(const DMagneticFieldMap *bfield, const DGeometry *geom)
+{
+	/// Set this trajectory up as if it had just been made by the
+	/// constructor with the given field map (and geometry). The
+	/// values from configuration parameters are kept. If Release()
+	/// was called, a block of swim steps is taken from the pool again.
+	this->q = 1.0;
+	this->step_size = -1.0;
+	this->bfield = bfield;
+	this->RootGeom = NULL;
+	this->geom = geom;
+	this->zmin_track_boundary = -100.0;
+	this->zmax_track_boundary = 670.0;
+	this->Rsqmax_interior = 65.0*65.0;
+	this->Rsqmax_exterior = 88.0*88.0;
+	Reset();
+
+	if(own_swim_steps && !swim_step_block) AllocateSwimSteps(max_swim_steps);
+}
+
+//---------------------------------
+// GetNumSwimStepBlocks
+//---------------------------------
+size_t DReferenceTrajectory::GetNumSwimStepBlocks(void)
+{
+	/// Number of swim step blocks that currently exist (all threads)
+	return dResourcePool_SwimSteps->Get_NumObjectsAllThreads();
+}
+
 //---------------------------------
 // FastSwim -- light-weight swim to a wire that does not treat multiple 
 // scattering but does handle energy loss.
@@ -422,6 +533,7 @@ void DReferenceTrajectory::FastSwimForHitSelection(const DVector3 &pos, const DV
     }
     s += ds; 
   }
+  UpdateSwimPos();
 }
 
 // Faster version of the swimmer that uses an alternate stepper and does not
@@ -598,6 +710,7 @@ void DReferenceTrajectory::FastSwim(const DVector3 &pos, const DVector3 &mom, do
     
     old_radius_sq=Rsq;
   }
+  UpdateSwimPos();
   
   // OK. At this point the positions of the trajectory in the lab
   // frame have been recorded along with the momentum of the
@@ -635,6 +748,7 @@ void DReferenceTrajectory::Swim(const DVector3 &pos, const DVector3 &mom, double
 	double X0sum=0.0;
 	swim_step_t *last_step=NULL;
 	double old_radius_sq=1e6;
+	double old_wire_delta2=1.0e6;
 	
 	TMatrixFSym mycov(7);
 	if (cov!=NULL){
@@ -875,12 +989,18 @@ void DReferenceTrajectory::Swim(const DVector3 &pos, const DVector3 &mom, double
 		if(z>zmax_track_boundary){Nswim_steps++; break;} // ran into FCAL
 		if(z<zmin_track_boundary){Nswim_steps++; break;} // exit upstream
 		if(wire && Nswim_steps>0){ // optionally check if we passed a wire we're supposed to be swimming to
-			swim_step_t *closest_step = FindClosestSwimStep(wire);
-			if(++closest_step!=swim_step){Nswim_steps++; break;}
+			// We've passed the wire once the distance to it grows. This
+			// is the same test FindClosestSwimStep(wire) makes, but only
+			// for the newest complete step rather than all of them.
+			const DVector3 &last_origin = swim_steps[Nswim_steps-1].origin;
+			double delta2 = WireDelta2(last_origin.X(), last_origin.Y(), last_origin.Z(), wire);
+			if(delta2>old_wire_delta2){Nswim_steps++; break;}
+			old_wire_delta2 = delta2;
 		}
 
 		old_radius_sq=Rsq;
 	}
+	UpdateSwimPos();
 
 	// OK. At this point the positions of the trajectory in the lab
 	// frame have been recorded along with the momentum of the
@@ -919,18 +1039,18 @@ jerror_t DReferenceTrajectory::GetIntersectionWithRadius(double R,
   }
 
   // Loop over swim steps and find the one that crosses the radius
-  swim_step_t *swim_step = swim_steps;
+  const swim_pos_t *swim_pos = GetSwimPos();
   swim_step_t *step=NULL;
   swim_step_t *last_step=NULL;
 
   //  double inner_radius=swim_step->origin.Perp();
-  for(int i=0; i<Nswim_steps; i++, swim_step++){
-    if (swim_step->origin.Perp()>R){
-      step=swim_step;
+  for(int i=0; i<Nswim_steps; i++){
+    if (sqrt(swim_pos[i].x*swim_pos[i].x + swim_pos[i].y*swim_pos[i].y)>R){
+      step=&swim_steps[i];
       break;
     }
-    if (swim_step->origin.Z()>407.0) return VALUE_OUT_OF_RANGE;
-    last_step=swim_step;
+    if (swim_pos[i].z>407.0) return VALUE_OUT_OF_RANGE;
+    last_step=&swim_steps[i];
   }
   if (step==NULL||last_step==NULL) return VALUE_OUT_OF_RANGE;
   if (p_at_intersection!=NULL){
@@ -1248,6 +1368,7 @@ int DReferenceTrajectory::InsertSteps(const swim_step_t *start_step, double delt
 		}
 	}
 	Nswim_steps += rt.Nswim_steps-steps_to_overwrite;
+	UpdateSwimPos(istep_start+1);
 
 	// Note that the above procedure may leave us with "kinks" in the itheta0 
 	// variables. It may be that we need to recalculate those for all of the 
@@ -1313,9 +1434,11 @@ double DReferenceTrajectory::DistToRT(DVector3 hit, double *s,
 	  break;
 	}
 
-	// First, find closest step to point
-	swim_step_t *swim_step = &swim_steps[start_index];
+	// First, find closest step to point. The search is done using
+	// the compact array of step positions.
+	const swim_pos_t *swim_pos = GetSwimPos();
 	swim_step_t *step=NULL;
+	double hx=hit.X(), hy=hit.Y(), hz=hit.Z();
 	
 	//double min_delta2 = 1.0E6;
 	double old_delta2=10.e6,delta2=1.0e6;
@@ -1323,40 +1446,33 @@ double DReferenceTrajectory::DistToRT(DVector3 hit, double *s,
 	// Check if we should start at the end of the reference trajectory 
 	// or the beginning...
 	int last_index=Nswim_steps-1;
-	double forward_delta2=(swim_step->origin - hit).Mag2();
-	double backward_delta2=(swim_steps[last_index].origin-hit).Mag2();
+	double dx=swim_pos[start_index].x-hx, dy=swim_pos[start_index].y-hy, dz=swim_pos[start_index].z-hz;
+	double forward_delta2=dx*dx+dy*dy+dz*dz;
+	dx=swim_pos[last_index].x-hx; dy=swim_pos[last_index].y-hy; dz=swim_pos[last_index].z-hz;
+	double backward_delta2=dx*dx+dy*dy+dz*dz;
 
 	if (forward_delta2<backward_delta2){ // start at the beginning
-	  for(int i=start_index; i<Nswim_steps; i++, swim_step++){
+	  for(int i=start_index; i<Nswim_steps; i++){
 	    
-	    DVector3 pos_diff = swim_step->origin - hit;
-	    delta2 = pos_diff.Mag2();
+	    dx=swim_pos[i].x-hx; dy=swim_pos[i].y-hy; dz=swim_pos[i].z-hz;
+	    delta2 = dx*dx+dy*dy+dz*dz;
 
 	    if (delta2>old_delta2){
 	      break;
 	    }
 	    
-	    //if(delta2 < min_delta2){
-	    //min_delta2 = delta2;
-	    
-	    step = swim_step;
+	    step = &swim_steps[i];
 	    old_delta2=delta2;
-	    //}
 	  }
 	}
 	else{// start at the end
 	  for(int i=last_index; i>=start_index; i--){
-	    swim_step=&swim_steps[i];
-	    DVector3 pos_diff = swim_step->origin - hit;
-	    delta2 = pos_diff.Mag2();
+	    dx=swim_pos[i].x-hx; dy=swim_pos[i].y-hy; dz=swim_pos[i].z-hz;
+	    delta2 = dx*dx+dy*dy+dz*dz;
 	    if (delta2>old_delta2) break;
 	    
-	    //if(delta2 < min_delta2){
-	    //min_delta2 = delta2;
-	    
-	    step = swim_step;
+	    step = &swim_steps[i];
 	    old_delta2=delta2;
-	    //}
 	  }
 
 	}
@@ -1547,66 +1663,23 @@ DReferenceTrajectory::swim_step_t* DReferenceTrajectory::FindClosestSwimStep(con
 	if(!wire)return NULL;
 	
 	// Loop over swim steps and find the one closest to the wire
-	swim_step_t *swim_step = swim_steps;
+	const swim_pos_t *swim_pos = GetSwimPos();
 	swim_step_t *step=NULL;
 	//double min_delta2 = 1.0E6;
 	double old_delta2=1.0e6;
-	double L_over_2 = wire->L/2.0; // half-length of wire in cm
 	int istep=-1;
 
-	double dx, dy, dz;
-  
-  // w is a vector to the origin of the wire
-  // u is a unit vector along the wire
-  
-  double wx, wy, wz;
-  double ux, uy, uz;
-  
-  wx = wire->origin.X();
-  wy = wire->origin.Y();
-  wz = wire->origin.Z();
-  
-  ux = wire->udir.X();
-  uy = wire->udir.Y();
-  uz = wire->udir.Z();
-  
-  int i;
-  for(i=0; i<Nswim_steps; i++, swim_step++){
-		// Find the point's position along the wire. If the point
-		// is past the end of the wire, calculate the distance
-		// from the end of the wire.
-    //		DVector3 pos_diff = swim_step->origin - wire->origin;
-
-    dx = swim_step->origin.X() - wx;
-    dy = swim_step->origin.Y() - wy;
-    dz = swim_step->origin.Z() - wz;
-		
-    //    double u = wire->udir.Dot(pos_diff);
-    double u = ux * dx + uy * dy + uz * dz;
-
-		// Find distance perpendicular to wire
-    //		double delta2 = pos_diff.Mag2() - u*u;
-    double delta2 = dx*dx + dy*dy + dz*dz - u*u;
-
-		// If point is past end of wire, calculate distance
-		// from wire's end by adding on distance along wire direction.
-		if( fabs(u)>L_over_2){
-      //			delta2 += pow(fabs(u)-L_over_2, 2.0);
-		  double u_minus_L_over_2=fabs(u)-L_over_2;
-      delta2 += ( u_minus_L_over_2*u_minus_L_over_2 );
-      // printf("step %d\n",i);
-		}
+	int i;
+	for(i=0; i<Nswim_steps; i++){
+		// Distance of the point from the wire (or from the end of
+		// the wire if it is past it).
+		double delta2 = WireDelta2(swim_pos[i].x, swim_pos[i].y, swim_pos[i].z, wire);
 
 		if(debug_level>3)_DBG_<<"delta2="<<delta2<<"  old_delta2="<<old_delta2<<endl;
 		if (delta2>old_delta2) break;
 
-		//if(delta2 < min_delta2){
-		//	min_delta2 = delta2;
-		step = swim_step;
+		step = &swim_steps[i];
 		istep=i;
-
-		//}
-		//printf("%d delta %f min %f\n",i,delta2,min_delta2);
 		old_delta2=delta2;
 	}
 
@@ -1635,27 +1708,24 @@ DReferenceTrajectory::swim_step_t* DReferenceTrajectory::FindClosestSwimStep(con
 	norm.SetMag(1.0);
 
 	// Loop over swim steps and find the one closest to the plane
-	swim_step_t *swim_step = swim_steps;
+	const swim_pos_t *swim_pos = GetSwimPos();
 	swim_step_t *step=NULL;
 	//double min_dist = 1.0E6;
 	double old_dist=1.0e6;
 	int istep=-1;
+	double nx=norm.X(), ny=norm.Y(), nz=norm.Z();
+	double ox=origin.X(), oy=origin.Y(), oz=origin.Z();
 
-	for(int i=0; i<Nswim_steps; i++, swim_step++){
+	for(int i=0; i<Nswim_steps; i++){
 	
 		// Distance to plane is dot product of normal vector with any
 		// vector pointing from the current step to a point in the plane
-		double dist = fabs(norm.Dot(swim_step->origin-origin));
+		double dist = fabs(nx*(swim_pos[i].x-ox) + ny*(swim_pos[i].y-oy) + nz*(swim_pos[i].z-oz));
 
 		if (dist>old_dist) break;
 
-		// Check if we're the closest step
-		//if(dist < min_dist){
-		//min_dist = dist;
-
-		step = swim_step;
+		step = &swim_steps[i];
 		istep=i;
-			//}
 		old_dist=dist;
 
 		// We should probably have a break condition here so we don't
@@ -1688,48 +1758,52 @@ DReferenceTrajectory::swim_step_t* DReferenceTrajectory::FindPlaneCrossing(const
 	norm.SetMag(1.0);
 
 	// Loop over swim steps and find the one closest to the plane
-	swim_step_t *swim_step = &swim_steps[first_i];
+	const swim_pos_t *swim_pos = GetSwimPos();
 	swim_step_t *step=NULL;
 	double old_dist=1.0e6;
+	double nx=norm.X(), ny=norm.Y(), nz=norm.Z();
+	double ox=origin.X(), oy=origin.Y(), oz=origin.Z();
+
+	// Distance to plane is dot product of normal vector with any
+	// vector pointing from the step to a point in the plane
+	auto dist_to_plane = [&](int i){
+	  return nx*(swim_pos[i].x-ox) + ny*(swim_pos[i].y-oy) + nz*(swim_pos[i].z-oz);
+	};
 
 	// Check if we should start from the beginning of the reference 
 	// trajectory or the end
 	int last_index=Nswim_steps-1;
-	double forward_dist= norm.Dot(swim_step->origin-origin);
-	if( forward_dist == 0.0 ) return swim_step;
-	double backward_dist= norm.Dot(swim_steps[last_index].origin-origin);
+	double forward_dist= dist_to_plane(first_i);
+	if( forward_dist == 0.0 ) return &swim_steps[first_i];
+	double backward_dist= dist_to_plane(last_index);
 	if( backward_dist ==0.0 ) return &swim_steps[last_index];
 	if (detector==SYS_START || fabs(forward_dist)<fabs(backward_dist)){ // start at beginning
-	  for(int i=first_i; i<Nswim_steps; i++, swim_step++){
+	  for(int i=first_i; i<Nswim_steps; i++){
 	      
-	    // Distance to plane is dot product of normal vector with any
-	    // vector pointing from the current step to a point in the plane
-	    //double dist = fabs(norm.Dot(swim_step->origin-origin));
-	    double dist = norm.Dot(swim_step->origin-origin);
+	    double dist = dist_to_plane(i);
 	      
 	    // We've crossed the plane when the sign of dist changes
 	    if (dist*old_dist<0 && i>0) {
 	      if (fabs(dist)<fabs(old_dist)){
-		step=swim_step;
+		step=&swim_steps[i];
 	      }
 	      break;
 	    }
-	    step = swim_step;
+	    step = &swim_steps[i];
 	    old_dist=dist;
 	  }
 	}
 	else{ // start at end
 	  for(int i=last_index; i>=0; i--){
-	    swim_step=&swim_steps[i];
-	    double dist = norm.Dot(swim_step->origin-origin);
+	    double dist = dist_to_plane(i);
 	    // We've crossed the plane when the sign of dist changes
 	    if (dist*old_dist<0 && i<last_index) {
 	      if (fabs(dist)<fabs(old_dist)){
-		step=swim_step;
+		step=&swim_steps[i];
 	      }
 	      break;
 	    }
-	    step = swim_step;
+	    step = &swim_steps[i];
 	    old_dist=dist;
 	  }
 
@@ -74,6 +74,25 @@ class DReferenceTrajectory{
 				double invX0;
 		};
 
+		// Position of a swim step. These are kept in a compact array
+		// alongside swim_steps (see UpdateSwimPos) so the searches for
+		// the step closest to a hit, wire, or plane only need to stream
+		// through 24 bytes per step rather than the whole swim_step_t.
+		struct swim_pos_t{
+			double x,y,z;
+		};
+
+		// Storage for the swim steps and their positions. These are
+		// taken from a thread_local DResourcePool when a trajectory is
+		// created and returned to it when the trajectory is deleted so
+		// the (large) step buffers are reused rather than allocated for
+		// every trajectory.
+		class swim_step_block_t{
+			public:
+				vector<swim_step_t> steps;
+				vector<swim_pos_t> pos;
+		};
+
 		DReferenceTrajectory(const DMagneticFieldMap *
 									, double q=1.0
 									, swim_step_t *swim_steps=NULL
@@ -87,6 +106,9 @@ class DReferenceTrajectory{
 
 		void CopyWithShift(const DReferenceTrajectory *rt, DVector3 shift);
 		void Reset(void);
+		void Release(void);
+		void Reuse(const DMagneticFieldMap *bfield, const DGeometry *geom=NULL);
+		static size_t GetNumSwimStepBlocks(void);
 		
 		double DistToRT(double x, double y, double z) const {return DistToRT(DVector3(x,y,z));}
 		double DistToRT(DVector3 hit, double *s=NULL,DetectorSystem_t detector=SYS_NULL) const;
@@ -165,6 +187,7 @@ class DReferenceTrajectory{
 		void Dump(double zmin=-1000.0, double zmax=1000.0);
 
 		const swim_step_t *GetLastSwimStep(void) const {return last_swim_step;}
+		const swim_pos_t *GetSwimPos(void) const {return swim_step_block ? swim_step_block->pos.data():ext_swim_pos.data();}
 
        
 		jerror_t IntersectTracks(const DReferenceTrajectory *rt2,
@@ -204,6 +227,8 @@ class DReferenceTrajectory{
 	
 		int max_swim_steps;
 		bool own_swim_steps;
+		shared_ptr<swim_step_block_t> swim_step_block;
+		vector<swim_pos_t> ext_swim_pos; // positions when swim_steps is supplied by the caller
 		int dist_to_rt_depth;
 		double step_size;
 		const DMagneticFieldMap *bfield;
@@ -226,10 +251,16 @@ class DReferenceTrajectory{
 		double MIN_STEP_SIZE;
 		double MAX_STEP_SIZE;
 	
+		void AllocateSwimSteps(int max_steps);
+		void ReleaseSwimSteps(void);
+		void UpdateSwimPos(int first=0);
+
 	    static thread_local shared_ptr<DResourcePool<TMatrixFSym>> dResourcePool_TMatrixFSym;
+	    static thread_local shared_ptr<DResourcePool<swim_step_block_t>> dResourcePool_SwimSteps;
 
 	private:
-		DReferenceTrajectory(){} // force use of constructor with arguments.
+		friend class DResourcePool<DReferenceTrajectory>; // (see DTrackingWorkspace)
+		DReferenceTrajectory():DReferenceTrajectory(NULL){} // force use of constructor with arguments.
 
 };
 
@@ -198,6 +198,47 @@ jerror_t DTrackCandidate_factory_CDC::brun(JEventLoop *locEventLoop, int32_t run
 	for(size_t loc_i = 0; loc_i < locCDCWires.size(); ++loc_i)
 		dNumStrawsPerRing[loc_i] = locCDCWires[loc_i].size();
 
+	// Save where the straws of each ring are so that the hits near a given hit can be found from the straw occupancy
+		// The straws of a ring are (nearly) evenly spaced in phi: record how far they are from being exactly so
+	size_t locNumRings = locCDCWires.size();
+	dRingStrawHitBits.assign(locNumRings, vector<uint64_t>());
+	dRingStrawMultiHitBits.assign(locNumRings, vector<uint64_t>());
+	dRingStrawTrkHits.assign(locNumRings, vector<DCDCTrkHit*>());
+	dRingRadiusMin.assign(locNumRings, 0.0);
+	dRingRadiusMax.assign(locNumRings, 0.0);
+	dRingPhi0.assign(locNumRings, 0.0);
+	dRingPhiStep.assign(locNumRings, 0.0);
+	dRingPhiDev.assign(locNumRings, 0.0);
+	for(size_t loc_i = 0; loc_i < locNumRings; ++loc_i)
+	{
+		size_t locNumStraws = locCDCWires[loc_i].size();
+		if(locNumStraws == 0)
+			continue;
+		dRingStrawHitBits[loc_i].assign((locNumStraws + 63)/64, 0);
+		dRingStrawMultiHitBits[loc_i].assign((locNumStraws + 63)/64, 0);
+		dRingStrawTrkHits[loc_i].assign(locNumStraws, NULL);
+
+		double locPhi0 = locCDCWires[loc_i][0]->origin.Phi();
+		double locPhiStep = M_TWO_PI/double(locNumStraws);
+		if((locNumStraws > 1) && (remainder(locCDCWires[loc_i][1]->origin.Phi() - locPhi0, M_TWO_PI) < 0.0))
+			locPhiStep = -locPhiStep;
+		dRingPhi0[loc_i] = locPhi0;
+		dRingPhiStep[loc_i] = locPhiStep;
+		dRingRadiusMin[loc_i] = dRingRadiusMax[loc_i] = locCDCWires[loc_i][0]->origin.Perp();
+		for(size_t loc_j = 0; loc_j < locNumStraws; ++loc_j)
+		{
+			const DVector3& locOrigin = locCDCWires[loc_i][loc_j]->origin;
+			double locRadius = locOrigin.Perp();
+			if(locRadius < dRingRadiusMin[loc_i])
+				dRingRadiusMin[loc_i] = locRadius;
+			if(locRadius > dRingRadiusMax[loc_i])
+				dRingRadiusMax[loc_i] = locRadius;
+			double locPhiDev = fabs(remainder(locOrigin.Phi() - locPhi0 - double(loc_j)*locPhiStep, M_TWO_PI));
+			if(locPhiDev > dRingPhiDev[loc_i])
+				dRingPhiDev[loc_i] = locPhiDev;
+		}
+	}
+
 	// Clean up after using wire map
 	for (size_t i=0;i<locCDCWires.size();i++){
 	  for (size_t j=0;j<locCDCWires[i].size();j++){
@@ -426,6 +467,12 @@ jerror_t DTrackCandidate_factory_CDC::Get_CDCHits(JEventLoop* loop)
 	cdctrkhits.clear();
 	for(unsigned int i = 0; i < cdchits_by_superlayer.size(); i++)
 		cdchits_by_superlayer[i].clear();
+	for(size_t i = 0; i < dRingStrawHitBits.size(); ++i)
+	{
+		fill(dRingStrawHitBits[i].begin(), dRingStrawHitBits[i].end(), 0);
+		fill(dRingStrawMultiHitBits[i].begin(), dRingStrawMultiHitBits[i].end(), 0);
+	}
+	bool locAllHitsInStrawMapFlag = true;
 
 	// Create DCDCTrkHit objects out of these.	
 	int oldwire = -1;
@@ -448,6 +495,24 @@ jerror_t DTrackCandidate_factory_CDC::Get_CDCHits(JEventLoop* loop)
 		cdctrkhit->flags = NONE;
 		cdctrkhit->flags |= NOISE; // (see below)
 		cdctrkhits.push_back(cdctrkhit);
+
+		// Mark the straw as hit
+		size_t locRingIndex = cdctrkhit->hit->wire->ring - 1;
+		size_t locStrawIndex = cdctrkhit->hit->wire->straw - 1;
+		if((locRingIndex < dRingStrawTrkHits.size()) && (locStrawIndex < dRingStrawTrkHits[locRingIndex].size()))
+		{
+			uint64_t locStrawBit = uint64_t(1) << (locStrawIndex & 63);
+			uint64_t& locStrawWord = dRingStrawHitBits[locRingIndex][locStrawIndex >> 6];
+			if(locStrawWord & locStrawBit)
+				dRingStrawMultiHitBits[locRingIndex][locStrawIndex >> 6] |= locStrawBit; //hits on the same wire, but not consecutive
+			else
+			{
+				locStrawWord |= locStrawBit;
+				dRingStrawTrkHits[locRingIndex][locStrawIndex] = cdctrkhit;
+			}
+		}
+		else
+			locAllHitsInStrawMapFlag = false;
     
 		// Sort into list of hits by superlayer
 		for(size_t j = 0; j < superlayer_boundaries.size(); ++j)
@@ -465,7 +530,8 @@ jerror_t DTrackCandidate_factory_CDC::Get_CDCHits(JEventLoop* loop)
 		stable_sort(cdchits_by_superlayer[i].begin(), cdchits_by_superlayer[i].end(), CDCSortByRdecreasing);
 
 	// Filter out noise hits. All hits are initially flagged as "noise".
-		// Hits with a neighbor within MAX_HIT_DIST have their noise flags cleared.
+		// Hits with a neighbor within 3*MAX_HIT_DIST have their noise flags cleared.
+		// The neighbor is searched for in the straw occupancy (only if all hits are in it, otherwise all pairs are tried)
 	// Also flag hits as out-of-time if their drift time is too large
 	for(size_t i = 0; i < cdctrkhits.size(); ++i)
 	{
@@ -474,6 +540,15 @@ jerror_t DTrackCandidate_factory_CDC::Get_CDCHits(JEventLoop* loop)
 			trkhit1->flags |= OUT_OF_TIME;
 		if(!(trkhit1->flags & NOISE))
 			continue; // this hit already not marked for noise
+		if(locAllHitsInStrawMapFlag)
+		{
+			DCDCTrkHit* locNeighborHit = Find_NeighborHit(trkhit1, 3.0*MAX_HIT_DIST);
+			if(locNeighborHit == NULL)
+				continue;
+			trkhit1->flags &= ~NOISE;
+			locNeighborHit->flags &= ~NOISE;
+			continue;
+		}
 		for(size_t j = 0; j < cdctrkhits.size(); ++j)
 		{
 			if(j == i)
@@ -490,6 +565,89 @@ jerror_t DTrackCandidate_factory_CDC::Get_CDCHits(JEventLoop* loop)
 	return NOERROR;
 }
 
+//-----------------
+// Find_NeighborHit
+//-----------------
+DTrackCandidate_factory_CDC::DCDCTrkHit* DTrackCandidate_factory_CDC::Find_NeighborHit(DCDCTrkHit* locTrkHit, double locMaxDist)
+{
+	/// Returns a hit (other than locTrkHit) whose wire center is within locMaxDist of locTrkHit's, or NULL if there isn't one.
+	/// Rather than checking every hit in the event, only the occupied straws in the part of each ring that could be that close are checked. 
+	/// Two points at radii r1 and r2 that are dphi apart are at least 2*sqrt(r1*r2)*sin(dphi/2) apart, which bounds the phi (and thus the straw) range. 
+	/// Within that range, the set bits of the straw occupancy are looped over and the distance is checked exactly as before. 
+	const DVector3& locOrigin = locTrkHit->hit->wire->origin;
+	double locRadius = locOrigin.Perp();
+	double locPhi = locOrigin.Phi();
+	double locMaxDist2 = locMaxDist*locMaxDist;
+	double locSearchDist = locMaxDist + 1.0E-3; //a little extra so that rounding can't lose a neighbor
+
+	for(size_t loc_i = 0; loc_i < dRingStrawTrkHits.size(); ++loc_i)
+	{
+		int locNumStraws = dRingStrawTrkHits[loc_i].size();
+		if(locNumStraws == 0)
+			continue;
+		if((locRadius < dRingRadiusMin[loc_i] - locSearchDist) || (locRadius > dRingRadiusMax[loc_i] + locSearchDist))
+			continue; //whole ring is too far away
+
+		//range of straws to check: locFirstStraw to locFirstStraw + locNumStrawsToCheck - 1 (straw indices, wrapping around the ring)
+		int locFirstStraw = 0;
+		int locNumStrawsToCheck = locNumStraws;
+		double locRadiusProduct = 4.0*locRadius*dRingRadiusMin[loc_i];
+		if(locRadiusProduct > locSearchDist*locSearchDist)
+		{
+			double locMaxDeltaPhi = 2.0*asin(locSearchDist/sqrt(locRadiusProduct)) + dRingPhiDev[loc_i];
+			int locHalfWidth = int(locMaxDeltaPhi/fabs(dRingPhiStep[loc_i])) + 1;
+			if(2*locHalfWidth + 1 < locNumStraws)
+			{
+				int locCenterStraw = int(lround(remainder(locPhi - dRingPhi0[loc_i], M_TWO_PI)/dRingPhiStep[loc_i]));
+				locFirstStraw = (locCenterStraw - locHalfWidth)%locNumStraws;
+				if(locFirstStraw < 0)
+					locFirstStraw += locNumStraws;
+				locNumStrawsToCheck = 2*locHalfWidth + 1;
+			}
+		}
+
+		const vector<uint64_t>& locHitBits = dRingStrawHitBits[loc_i];
+		const vector<uint64_t>& locMultiHitBits = dRingStrawMultiHitBits[loc_i];
+		const vector<DCDCTrkHit*>& locStrawTrkHits = dRingStrawTrkHits[loc_i];
+
+		//the range may wrap around the ring: check it in (at most) two pieces
+		int locRangeBegin = locFirstStraw;
+		int locNumStrawsLeft = locNumStrawsToCheck;
+		while(locNumStrawsLeft > 0)
+		{
+			int locRangeEnd = min(locRangeBegin + locNumStrawsLeft, locNumStraws); //one past the last straw index
+			locNumStrawsLeft -= locRangeEnd - locRangeBegin;
+			for(int locWordIndex = (locRangeBegin >> 6); locWordIndex <= ((locRangeEnd - 1) >> 6); ++locWordIndex)
+			{
+				uint64_t locBits = locHitBits[locWordIndex];
+				if(locWordIndex == (locRangeBegin >> 6))
+					locBits &= ~uint64_t(0) << (locRangeBegin & 63);
+				if(locWordIndex == ((locRangeEnd - 1) >> 6))
+					locBits &= ~uint64_t(0) >> (63 - ((locRangeEnd - 1) & 63));
+				while(locBits != 0)
+				{
+					int locBitIndex = __builtin_ctzll(locBits);
+					locBits &= locBits - 1;
+					int locStrawIndex = (locWordIndex << 6) + locBitIndex;
+					DCDCTrkHit* locStrawTrkHit = locStrawTrkHits[locStrawIndex];
+					if(locStrawTrkHit == locTrkHit)
+					{
+						//another hit on the same wire is at distance 0
+						if(locMultiHitBits[locWordIndex] & (uint64_t(1) << locBitIndex))
+							return locTrkHit;
+						continue;
+					}
+					if(!(locTrkHit->Dist2(locStrawTrkHit) > locMaxDist2))
+						return locStrawTrkHit;
+				}
+			}
+			locRangeBegin = 0;
+		}
+	}
+
+	return NULL;
+}
+
 /*********************************************************************************************************************************************************************/
 /********************************************************************** BUILD SUPER LAYER SEEDS **********************************************************************/
 /*********************************************************************************************************************************************************************/
@@ -527,7 +685,7 @@ void DTrackCandidate_factory_CDC::Find_SuperLayerSeeds(vector<DCDCTrkHit*>& locS
 				cout << "new ring, last ring = " << trkhit->hit->wire->ring << ", " << last_ring << endl;
 			//ring # has changed: save the current DCDCRingSeed (from the previous ring) (if not empty)
 			if(!locCDCRingSeed.hits.empty())
-				locCDCRingSeeds.push_back(locCDCRingSeed);
+				locCDCRingSeeds.push_back(std::move(locCDCRingSeed));
 			//if > 1 DCDCRingSeed on the previous ring: compare first and last DCDCRingSeeds
 				//if they are adjacent (extending through the straw = 1 boundary): merge DCDCRingSeeds
 			if(locCDCRingSeeds.size() > 1)
@@ -544,11 +702,11 @@ void DTrackCandidate_factory_CDC::Find_SuperLayerSeeds(vector<DCDCTrkHit*>& locS
 					locCDCRingSeeds.pop_back();
 				}
 			}
+			if(DEBUG_LEVEL > 3)
+				cout << "  ringseed hits:" << (locCDCRingSeeds.empty() ? 0 : locCDCRingSeeds.back().hits.size()) << "  locCDCRingSeeds:" << locCDCRingSeeds.size() << endl;
 			//if there was at least one DCDCRingSeed found on the previous ring, save it in the 2d vector
 			if(!locCDCRingSeeds.empty())
-				rings.push_back(locCDCRingSeeds);
-			if(DEBUG_LEVEL > 3)
-				cout << "  ringseed hits:" << locCDCRingSeed.hits.size() << "  locCDCRingSeeds:" << locCDCRingSeeds.size() << endl;
+				rings.push_back(std::move(locCDCRingSeeds));
 			//reset for finding the next group of hits
 			locCDCRingSeeds.clear();
 			locCDCRingSeed.hits.clear();
@@ -566,10 +724,10 @@ void DTrackCandidate_factory_CDC::Find_SuperLayerSeeds(vector<DCDCTrkHit*>& locS
 			//not a neighbor: save old and create new ringseed
 			if(DEBUG_LEVEL > 20)
 				cout << "straw diff" << endl;
-			if(!locCDCRingSeed.hits.empty())
-				locCDCRingSeeds.push_back(locCDCRingSeed);
 			if(DEBUG_LEVEL > 3)
 				cout << "ringseed hits: " << locCDCRingSeed.hits.size() << endl;
+			if(!locCDCRingSeed.hits.empty())
+				locCDCRingSeeds.push_back(std::move(locCDCRingSeed));
 			locCDCRingSeed.hits.clear();
 			locCDCRingSeed.linked = false;
 		}
@@ -666,9 +824,9 @@ void DTrackCandidate_factory_CDC::Link_RingSeeds(vector<DCDCRingSeed*>& parent,
 	/// entry, <i>parent</i> contains a list of pointers to all of the ringseeds
 	/// from the rings outside of <i>ring</i> that are to be combined into
 	/// a seed. This will search through all ringseeds of <i>ring</i> and if
-	/// any are found that can extend the parent, a copy of parent is made,
-	/// the current ringseed of this ring is added to it, and then it is
-	/// passed on to another call to this routine. If no matches are found, 
+	/// any are found that can extend the parent, the current ringseed of this
+	/// ring is added to the end of parent, it is passed on to another call to
+	/// this routine, and then it is removed again. If no matches are found, 
 	/// then it will try skipping a ring to find matches (if enabled). 
 	/// If still no matches are found (which will be the case for the outer-most ring), then
 	/// the ringseeds in <i>parent</i> will be combined into a single DCDCSuperLayerSeed.
@@ -703,11 +861,11 @@ void DTrackCandidate_factory_CDC::Link_RingSeeds(vector<DCDCRingSeed*>& parent,
 			if(locTransverseDist2 < MAX_HIT_DIST2)
 			{
 				// link them together
-				vector<DCDCRingSeed*> myparent = parent;
-				myparent.push_back(&locCDCRingSeeds[i]);
+				parent.push_back(&locCDCRingSeeds[i]);
 				locCDCRingSeeds[i].linked = true;
 				// recursive call: try to link this grouping of DCDCRingSeed's to a DCDCRingSeed in the next ring
-				Link_RingSeeds(myparent, ring, ringend, locSuperLayer, 0);
+				Link_RingSeeds(parent, ring, ringend, locSuperLayer, 0);
+				parent.pop_back();
 				seed_extended = true;
 			}
 		}
@@ -775,11 +933,13 @@ void DTrackCandidate_factory_CDC::Link_RingSeeds(vector<DCDCRingSeed*>& parent,
 		}
 
 		DCDCSuperLayerSeed* locSuperLayerSeed = Get_Resource_CDCSuperLayerSeed();
-		for(size_t i = 0; i < parent.size(); ++i)
+		locSuperLayerSeed->dCDCRingSeeds.reserve(parent.size());
+		for(size_t i = parent.size(); i-- > 0;) //input rings were in reverse order!!
 		{
 			if((int(i) == locSpiralRingIndex) && locSeparateSeedsFlag)
 				continue;
-			locSuperLayerSeed->dCDCRingSeeds.insert(locSuperLayerSeed->dCDCRingSeeds.begin(), *(parent[i])); //input rings were in reverse order!!
+			//copy: the same ring seed may end up in several super layer seeds
+			locSuperLayerSeed->dCDCRingSeeds.push_back(*(parent[i]));
 			for(size_t loc_j = 0; loc_j < parent[i]->hits.size(); ++loc_j)
 				parent[i]->hits[loc_j]->flags |= USED;
 		}
@@ -1343,30 +1503,16 @@ bool DTrackCandidate_factory_CDC::SearchFor_SpiralTurn_ManyHitsAdjacentRing(DCDC
 	if(locSuperLayerSeed1->Are_AllHitsOnRingShared(locSuperLayerSeed2, locRingToCheck))
 		return false; //these hits are the same
 
-	vector<DCDCTrkHit*> locHits1;
-	for(size_t loc_i = 0; loc_i < locSuperLayerSeed1->dCDCRingSeeds.size(); ++loc_i)
-	{
-		if(locSuperLayerSeed1->dCDCRingSeeds[loc_i].ring != locRingToCheck)
-			continue;
-		locHits1 = locSuperLayerSeed1->dCDCRingSeeds[loc_i].hits;
-		break;
-	}
-	if(locHits1.empty())
+	const vector<DCDCTrkHit*>* locHits1 = locSuperLayerSeed1->Get_RingHits(locRingToCheck);
+	if((locHits1 == NULL) || locHits1->empty())
 		return false;
 
-	vector<DCDCTrkHit*> locHits2;
-	for(size_t loc_j = 0; loc_j < locSuperLayerSeed2->dCDCRingSeeds.size(); ++loc_j)
-	{
-		if(locSuperLayerSeed2->dCDCRingSeeds[loc_j].ring != locRingToCheck)
-			continue;
-		locHits2 = locSuperLayerSeed2->dCDCRingSeeds[loc_j].hits;
-		break;
-	}
-	if(locHits2.empty())
+	const vector<DCDCTrkHit*>* locHits2 = locSuperLayerSeed2->Get_RingHits(locRingToCheck);
+	if((locHits2 == NULL) || locHits2->empty())
 		return false;
 
-	int locNumHits1 = locHits1.size();
-	int locNumHits2 = locHits2.size();
+	int locNumHits1 = locHits1->size();
+	int locNumHits2 = locHits2->size();
 
 	if((locNumHits1 < int(locMinStrawsAdjacentRing)) || (locNumHits2 < int(locMinStrawsAdjacentRing)))
 		return false; //neither seed has enough hits on the adjacent ring: return false
@@ -4766,25 +4912,11 @@ void DTrackCandidate_factory_CDC::DCDCSuperLayerSeed::Reset(void)
 
 bool DTrackCandidate_factory_CDC::DCDCSuperLayerSeed::Are_AllHitsOnRingShared(const DCDCSuperLayerSeed* locCDCSuperLayerSeed, int locRing) const
 {
-	vector<DCDCTrkHit*> locRingHits;
-	for(size_t loc_i = 0; loc_i < dCDCRingSeeds.size(); ++loc_i)
-	{
-		if(dCDCRingSeeds[loc_i].ring != locRing)
-			continue;
-		locRingHits = dCDCRingSeeds[loc_i].hits;
-		break;
-	}
-
-	vector<DCDCTrkHit*> locRingHits_CompareTo;
-	for(size_t loc_i = 0; loc_i < locCDCSuperLayerSeed->dCDCRingSeeds.size(); ++loc_i)
-	{
-		if(locCDCSuperLayerSeed->dCDCRingSeeds[loc_i].ring != locRing)
-			continue;
-		locRingHits_CompareTo = locCDCSuperLayerSeed->dCDCRingSeeds[loc_i].hits;
-		break;
-	}
-
-	return (locRingHits == locRingHits_CompareTo);
+	const vector<DCDCTrkHit*>* locRingHits = Get_RingHits(locRing);
+	const vector<DCDCTrkHit*>* locRingHits_CompareTo = locCDCSuperLayerSeed->Get_RingHits(locRing);
+	if((locRingHits == NULL) || (locRingHits_CompareTo == NULL))
+		return ((locRingHits == NULL) || locRingHits->empty()) && ((locRingHits_CompareTo == NULL) || locRingHits_CompareTo->empty());
+	return (*locRingHits == *locRingHits_CompareTo);
 }
 
 void DTrackCandidate_factory_CDC::DCDCTrackCircle::Reset(void)
@@ -10,6 +10,7 @@
 
 #include <map>
 #include <vector>
+#include <stdint.h>
 using namespace std;
 
 #include "TDirectory.h"
@@ -87,6 +88,16 @@ class DTrackCandidate_factory_CDC : public JFactory<DTrackCandidate>
 			public:
 				void Reset(void);
 				bool Are_AllHitsOnRingShared(const DCDCSuperLayerSeed* locCDCSuperLayerSeed, int locRing) const;
+				inline const vector<DCDCTrkHit*>* Get_RingHits(int locRing) const
+				{
+					//NULL if this seed has no hits on the ring
+					for(size_t loc_i = 0; loc_i < dCDCRingSeeds.size(); ++loc_i)
+					{
+						if(dCDCRingSeeds[loc_i].ring == locRing)
+							return &dCDCRingSeeds[loc_i].hits;
+					}
+					return NULL;
+				}
 				inline void Get_Hits(vector<DCDCTrkHit*>& locHits) const
 				{
 					locHits.clear();
@@ -194,6 +205,7 @@ class DTrackCandidate_factory_CDC : public JFactory<DTrackCandidate>
 
 		// Make Super Layer Seeds
 		jerror_t Get_CDCHits(JEventLoop* loop);
+		DCDCTrkHit* Find_NeighborHit(DCDCTrkHit* locTrkHit, double locMaxDist);
 		void Find_SuperLayerSeeds(vector<DCDCTrkHit*>& locSuperLayerHits, unsigned int locSuperLayer);
 		void Link_RingSeeds(vector<DCDCRingSeed*>& parent, ringiter ring, ringiter ringend, unsigned int locSuperLayer, unsigned int locNumPreviousRingsWithoutHit);
 		double MinDist2(const DCDCRingSeed& locInnerRingSeed, const DCDCRingSeed& locOuterRingSeed);
@@ -305,6 +317,17 @@ class DTrackCandidate_factory_CDC : public JFactory<DTrackCandidate>
 		vector<DHelicalFit*> dHelicalFitPool_Available;
 
 		vector<unsigned int> dNumStrawsPerRing; //index is ring index
+
+		// Straw occupancy of the current event: 1st dimension is ring index, bit (straw - 1) is set if the straw has a hit
+		vector<vector<uint64_t> > dRingStrawHitBits;
+		vector<vector<uint64_t> > dRingStrawMultiHitBits; //set if the straw has more than one DCDCTrkHit
+		vector<vector<DCDCTrkHit*> > dRingStrawTrkHits; //first DCDCTrkHit on each straw: only valid if its bit is set
+		// Wire positions of each ring (index is ring index), used to find the straws near a hit
+		vector<double> dRingRadiusMin; //smallest radius of a wire center in the ring
+		vector<double> dRingRadiusMax;
+		vector<double> dRingPhi0; //phi of straw 1
+		vector<double> dRingPhiStep; //phi from one straw to the next (negative if phi decreases with straw #)
+		vector<double> dRingPhiDev; //largest difference of a straw's phi from dRingPhi0 + (straw - 1)*dRingPhiStep
 		vector<unsigned int> superlayer_boundaries;
 
 		unsigned int dNumCDCHits;
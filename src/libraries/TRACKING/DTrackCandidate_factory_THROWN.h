@@ -10,6 +10,7 @@
 
 #include <JANA/JFactory.h>
 #include <TRACKING/DReferenceTrajectory.h>
+#include <TRACKING/DTrackingWorkspace.h>
 #include "DTrackCandidate.h"
 #include "PID/DParticleID.h"
 
@@ -46,11 +47,12 @@ class DTrackCandidate_factory_THROWN:public jana::JFactory<DTrackCandidate>{
 		jerror_t brun(jana::JEventLoop *eventLoop, int32_t runnumber);	///< Called everytime a new run number is detected.
 		jerror_t evnt(jana::JEventLoop *eventLoop, uint64_t eventnumber);	///< Called every event.
 		//jerror_t erun(void);						///< Called everytime run number changes, provided brun has been called.
-		//jerror_t fini(void);						///< Called after last event of last event source has been processed.
+		jerror_t fini(void);						///< Called after last event of last event source has been processed.
 
 		DTrackFitter *fitter;
 		const DTrackHitSelector *hitselector;
-		vector<DReferenceTrajectory*> rt_pool;
+		shared_ptr<DTrackingWorkspace> dTrackingWorkspace;
+		vector<DReferenceTrajectory*> rts_in_use; // given back at the start of the next event
 		const DMagneticFieldMap *bfield;
 		const DParticleID* dParticleID;
 
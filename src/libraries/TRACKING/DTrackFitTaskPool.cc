@@ -0,0 +1,149 @@
+// $Id$
+//
+//    File: DTrackFitTaskPool.cc
+// Created: Sun Oct 18 17:12:40 EDT 2026
+//
+
+#include "DTrackFitTaskPool.h"
+#include "DTrackFitter.h"
+using namespace std;
+using namespace jana;
+
+//-------------------
+// DTrackFitTaskPool  (Constructor)
+//-------------------
+DTrackFitTaskPool::DTrackFitTaskPool(unsigned int Nhelpers)
+{
+	task_func  = NULL;
+	Ntasks     = 0;
+	next_task  = 0;
+	Nbusy      = 0;
+	generation = 0;
+	done       = false;
+
+	for(unsigned int i=0; i<Nhelpers; i++){
+		threads.push_back(thread(&DTrackFitTaskPool::HelperLoop, this, i+1));
+	}
+}
+
+//-------------------
+// ~DTrackFitTaskPool  (Destructor)
+//-------------------
+DTrackFitTaskPool::~DTrackFitTaskPool()
+{
+	{
+		lock_guard<mutex> lck(mtx);
+		done = true;
+	}
+	cv_start.notify_all();
+	for(auto &t : threads) t.join();
+
+	DeleteFitters();
+}
+
+//-------------------
+// MakeFitters
+//-------------------
+bool DTrackFitTaskPool::MakeFitters(DTrackFitter *fitter, JEventLoop *loop)
+{
+	/// Set up the fitters for all workers. Worker 0 (the calling
+	/// thread) uses the given fitter. The helper threads each get
+	/// a new fitter of the same type. Returns false (leaving no
+	/// fitters) if the fitter type can't make new instances of
+	/// itself.
+
+	DeleteFitters();
+	if(!fitter) return false;
+
+	fitters.push_back(fitter);
+	for(unsigned int i=0; i<threads.size(); i++){
+		DTrackFitter *f = fitter->MakeNew(loop);
+		if(!f){
+			DeleteFitters();
+			return false;
+		}
+		fitters.push_back(f);
+	}
+
+	return true;
+}
+
+//-------------------
+// DeleteFitters
+//-------------------
+void DTrackFitTaskPool::DeleteFitters(void)
+{
+	for(unsigned int i=1; i<fitters.size(); i++) delete fitters[i];
+	fitters.clear();
+}
+
+//-------------------
+// Run
+//-------------------
+void DTrackFitTaskPool::Run(unsigned int Ntasks, const function<void(unsigned int itask, unsigned int iworker)> &task)
+{
+	/// Call task(itask, iworker) for every itask from 0 to Ntasks-1
+	/// using all workers. This does not return until all tasks
+	/// are finished.
+
+	if(Ntasks == 0) return;
+
+	// Don't bother waking the helpers if there is only one task
+	if(threads.empty() || Ntasks==1){
+		for(unsigned int i=0; i<Ntasks; i++) task(i, 0);
+		return;
+	}
+
+	{
+		lock_guard<mutex> lck(mtx);
+		task_func = &task;
+		this->Ntasks = Ntasks;
+		next_task = 0;
+		Nbusy = threads.size();
+		generation++;
+	}
+	cv_start.notify_all();
+
+	DoTasks(0);
+
+	unique_lock<mutex> lck(mtx);
+	cv_done.wait(lck, [this]{return Nbusy==0;});
+	task_func = NULL;
+}
+
+//-------------------
+// HelperLoop
+//-------------------
+void DTrackFitTaskPool::HelperLoop(unsigned int iworker)
+{
+	uint64_t last_generation = 0;
+	while(true){
+		{
+			unique_lock<mutex> lck(mtx);
+			cv_start.wait(lck, [&]{return done || generation!=last_generation;});
+			if(done) return;
+			last_generation = generation;
+		}
+
+		DoTasks(iworker);
+
+		bool notify = false;
+		{
+			lock_guard<mutex> lck(mtx);
+			notify = (--Nbusy == 0);
+		}
+		if(notify) cv_done.notify_one();
+	}
+}
+
+//-------------------
+// DoTasks
+//-------------------
+void DTrackFitTaskPool::DoTasks(unsigned int iworker)
+{
+	while(true){
+		unsigned int itask = next_task++;
+		if(itask >= Ntasks) break;
+		(*task_func)(itask, iworker);
+	}
+}
@@ -0,0 +1,84 @@
+// $Id$
+//
+//    File: DTrackFitTaskPool.h
+// Created: Sun Oct 18 17:12:40 EDT 2026
+//
+
+#ifndef _DTrackFitTaskPool_
+#define _DTrackFitTaskPool_
+
+#include <stdint.h>
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include <JANA/JEventLoop.h>
+
+class DTrackFitter;
+
+///////////////////////////////////////////////////////////////////////
+/// The DTrackFitTaskPool class is used by the wire-based and time-based
+/// track factories to spread the fits for a single event over several
+/// threads. JANA only processes different events in parallel so in
+/// events with many tracks the fits for that one event can limit the
+/// latency.
+///
+/// A pool owns Nhelpers threads that sleep until Run() is called. The
+/// thread calling Run() works on the tasks too so up to Nhelpers+1
+/// tasks are done at once. Each worker takes the next task from a
+/// shared counter as soon as it finishes its previous one so a worker
+/// that gets quick fits picks up more of them. Run() returns only after
+/// all tasks are complete.
+///
+/// The task function is passed both the task index and the index of
+/// the worker (0 for the calling thread, 1..Nhelpers for the helper
+/// threads). Each worker needs its own DTrackFitter (and anything else
+/// with per-fit state) so the worker index is used to choose which
+/// one to use. MakeFitters() sets these up with worker 0 using the
+/// fitter the factory already has. Results should be written into a
+/// slot indexed by the task so that the order they are used in
+/// afterwards does not depend on which thread did which fit.
+///////////////////////////////////////////////////////////////////////
+
+class DTrackFitTaskPool{
+	public:
+		DTrackFitTaskPool(unsigned int Nhelpers);
+		virtual ~DTrackFitTaskPool();
+
+		unsigned int GetNworkers(void) const {return threads.size()+1;}
+
+		bool MakeFitters(DTrackFitter *fitter, jana::JEventLoop *loop);
+		void DeleteFitters(void);
+		bool HasFitters(DTrackFitter *fitter) const {return !fitters.empty() && fitters[0]==fitter;}
+		DTrackFitter* GetFitter(unsigned int iworker) const {return fitters[iworker];}
+		unsigned int GetNfitters(void) const {return fitters.size();}
+
+		void Run(unsigned int Ntasks, const std::function<void(unsigned int itask, unsigned int iworker)> &task);
+
+	protected:
+		void HelperLoop(unsigned int iworker);
+		void DoTasks(unsigned int iworker);
+
+		std::vector<std::thread> threads;
+		std::vector<DTrackFitter*> fitters;  // one per worker (fitters[0] is not owned by us)
+		std::mutex mtx;
+		std::condition_variable cv_start;
+		std::condition_variable cv_done;
+
+		const std::function<void(unsigned int, unsigned int)> *task_func;
+		unsigned int Ntasks;
+		std::atomic<unsigned int> next_task;
+		unsigned int Nbusy;      // helpers still working on current Run() call
+		uint64_t generation;     // incremented for each call to Run()
+		bool done;
+
+	private:
+		DTrackFitTaskPool(const DTrackFitTaskPool&);
+		DTrackFitTaskPool& operator=(const DTrackFitTaskPool&);
+};
+
+#endif // _DTrackFitTaskPool_
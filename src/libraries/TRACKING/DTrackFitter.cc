@@ -200,24 +200,10 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
 				  JEventLoop *loop, 
 				  double mass,int N,double t0,
 				  DetectorSystem_t t0_det){
-  // Reset fitter saving the type of fit we're doing
-  fit_type_t save_type = fit_type;
-  Reset();
-  fit_type = save_type;
-	
-  // If a mass<0 is passed in, get it from starting_params instead
-  if(mass<0.0)mass = starting_params.mass();
-  // charge of the track
-  double q=starting_params.charge();
-
   // Get pointer to DTrackHitSelector object
   vector<const DTrackHitSelector *> hitselectors;
   loop->Get(hitselectors);
-  if(hitselectors.size()<1){
-    _DBG_<<"Unable to get a DTrackHitSelector object! NO Charged track fitting will be done!"<<endl;
-    return fit_status = kFitNotDone;
-  }
-  const DTrackHitSelector * hitselector = hitselectors[0];
+  const DTrackHitSelector * hitselector = hitselectors.empty() ? NULL:hitselectors[0];
 
   // Get hits to be used for the fit
   vector<const DCDCTrackHit*> cdctrackhits;
@@ -225,6 +211,39 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
   loop->Get(cdctrackhits);
   loop->Get(fdcpseudos);
 
+  return FindHitsAndFitTrack(starting_params, extrapolations, hitselector,
+			     cdctrackhits, fdcpseudos, mass, N, t0, t0_det);
+}
+//-------------------
+// FindHitsAndFitTrack
+//-------------------
+DTrackFitter::fit_status_t 
+DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params, 
+				  const map<DetectorSystem_t,vector<DTrackFitter::Extrapolation_t> >&extrapolations,
+				  const DTrackHitSelector *hitselector,
+				  const vector<const DCDCTrackHit*> &cdctrackhits,
+				  const vector<const DFDCPseudo*> &fdcpseudos,
+				  double mass,int N,double t0,
+				  DetectorSystem_t t0_det){
+  /// Fit a track using hits chosen by the given hit selector from the
+  /// given lists. This does not use the JEventLoop so it may be called
+  /// from a thread other than the one processing the event.
+
+  // Reset fitter saving the type of fit we're doing
+  fit_type_t save_type = fit_type;
+  Reset();
+  fit_type = save_type;
+
+  if(!hitselector){
+    _DBG_<<"Unable to get a DTrackHitSelector object! NO Charged track fitting will be done!"<<endl;
+    return fit_status = kFitNotDone;
+  }
+	
+  // If a mass<0 is passed in, get it from starting_params instead
+  if(mass<0.0)mass = starting_params.mass();
+  // charge of the track
+  double q=starting_params.charge();
+
   // Get Bfield at the position at the middle of the extrapolations, i.e. the 
   // region where we actually have measurements...
   bool got_hits=false;
@@ -272,6 +291,38 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
 				  const DReferenceTrajectory *rt, JEventLoop *loop, 
 				  double mass,int N,double t0,
 				  DetectorSystem_t t0_det)
+{
+	/// Fit a DTrackCandidate using a given mass hypothesis.
+	///
+	/// The JEventLoop given will be used to get the hits (CDC
+	/// and FDC) and default DTrackHitSelector to use for the
+	/// fit. See the version below for details.
+
+	// Get pointer to DTrackHitSelector object
+	vector<const DTrackHitSelector *> hitselectors;
+	loop->Get(hitselectors);
+	const DTrackHitSelector * hitselector = hitselectors.empty() ? NULL:hitselectors[0];
+
+	// Get hits to be used for the fit
+	vector<const DCDCTrackHit*> cdctrackhits;
+	vector<const DFDCPseudo*> fdcpseudos;
+	loop->Get(cdctrackhits);
+	loop->Get(fdcpseudos);
+
+	return FindHitsAndFitTrack(starting_params, rt, hitselector, cdctrackhits,
+				   fdcpseudos, mass, N, t0, t0_det);
+}
+//-------------------
+// FindHitsAndFitTrack
+//-------------------
+DTrackFitter::fit_status_t 
+DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
+				  const DReferenceTrajectory *rt, 
+				  const DTrackHitSelector *hitselector,
+				  const vector<const DCDCTrackHit*> &cdctrackhits,
+				  const vector<const DFDCPseudo*> &fdcpseudos,
+				  double mass,int N,double t0,
+				  DetectorSystem_t t0_det)
 {
 	/// Fit a DTrackCandidate using a given mass hypothesis.
 	///
@@ -280,9 +331,10 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
 	/// candidate. The given DReferenceTrajectory is used to
 	/// swim the track numerous times during the various stages
 	/// but will be left with the final time-based fit result.
-	/// The JEventLoop given will be used to get the hits (CDC
-	/// and FDC) and default DTrackHitSelector to use for the
-	/// fit.
+	/// The hits are chosen from the given CDC and FDC lists
+	/// using the given DTrackHitSelector. This does not use the
+	/// JEventLoop so it may be called from a thread other than
+	/// the one processing the event.
 #ifdef PROFILE_TRK_TIMES
   prof_times["Ntracks"].real += 1.0; // keep count of the number of tracks we fit
 
@@ -293,6 +345,11 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
 	fit_type_t save_type = fit_type;
 	Reset();
 	fit_type = save_type;
+
+	if(!hitselector){
+		_DBG_<<"Unable to get a DTrackHitSelector object! NO Charged track fitting will be done!"<<endl;
+		return fit_status = kFitNotDone;
+	}
 	
 	// If a mass<0 is passed in, get it from starting_params instead
 	if(mass<0.0)mass = starting_params.mass();
@@ -317,20 +374,6 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
 	//rt->Swim(pos, mom, q);
 	//if(rt->Nswim_steps<1)return fit_status = kFitFailed;
 
-	// Get pointer to DTrackHitSelector object
-	vector<const DTrackHitSelector *> hitselectors;
-	loop->Get(hitselectors);
-	if(hitselectors.size()<1){
-		_DBG_<<"Unable to get a DTrackHitSelector object! NO Charged track fitting will be done!"<<endl;
-		return fit_status = kFitNotDone;
-	}
-	const DTrackHitSelector * hitselector = hitselectors[0];
-
-	// Get hits to be used for the fit
-	vector<const DCDCTrackHit*> cdctrackhits;
-	vector<const DFDCPseudo*> fdcpseudos;
-	loop->Get(cdctrackhits);
-	loop->Get(fdcpseudos);
 	DTrackHitSelector::fit_type_t input_type = fit_type==kTimeBased ? DTrackHitSelector::kWireBased:DTrackHitSelector::kHelical;
 	hitselector->GetAllHits(input_type, rt, cdctrackhits, fdcpseudos, this,N);
 
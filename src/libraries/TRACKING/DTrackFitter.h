@@ -30,6 +30,7 @@ using namespace std;
 
 class DReferenceTrajectory;
 class DGeometry;
+class DTrackHitSelector;
 
 //////////////////////////////////////////////////////////////////////////////////
 /// The DTrackFitter class is a base class for different charged track
@@ -189,6 +190,25 @@ class DTrackFitter:public jana::JObject{
 				      JEventLoop *loop, 
 				      double mass,int N,double t0,
 				      DetectorSystem_t t0_det);
+		fit_status_t 
+		  FindHitsAndFitTrack(const DKinematicData &starting_params, 
+				      const DReferenceTrajectory *rt, 
+				      const DTrackHitSelector *hitselector,
+				      const vector<const DCDCTrackHit*> &cdctrackhits,
+				      const vector<const DFDCPseudo*> &fdcpseudos,
+				      double mass=-1.0,
+				      int N=0,
+				      double t0=QuietNaN,
+				      DetectorSystem_t t0_det=SYS_NULL
+				      ); ///< Same as above, but with hits and hit selector given instead of taken from JEventLoop
+		fit_status_t 
+		  FindHitsAndFitTrack(const DKinematicData &starting_params, 
+				      const map<DetectorSystem_t,vector<DTrackFitter::Extrapolation_t> >&extrapolations,
+				      const DTrackHitSelector *hitselector,
+				      const vector<const DCDCTrackHit*> &cdctrackhits,
+				      const vector<const DFDCPseudo*> &fdcpseudos,
+				      double mass,int N,double t0,
+				      DetectorSystem_t t0_det); ///< Same as above, but with hits and hit selector given instead of taken from JEventLoop
 		
 		jerror_t CorrectForELoss(const DKinematicData &starting_params, DReferenceTrajectory *rt, DVector3 &pos, DVector3 &mom, double mass);
 		double CalcDensityEffect(double p,double mass,double density,
@@ -214,6 +234,7 @@ class DTrackFitter:public jana::JObject{
 	      
 		//---- The following need to be supplied by the subclass ----
 		virtual string Name(void) const =0;
+		virtual DTrackFitter* MakeNew(JEventLoop *loop) const {return NULL;} ///< New fitter of the same type for fitting on another thread (NULL if not supported)
 		virtual fit_status_t FitTrack(void)=0;
 		virtual double ChiSq(fit_type_t fit_type, DReferenceTrajectory *rt, double *chisq_ptr=NULL, int *dof_ptr=NULL, vector<pull_t> *pulls_ptr=NULL)=0;
 
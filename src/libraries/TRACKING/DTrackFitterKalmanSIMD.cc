@@ -7,6 +7,7 @@
 #include "HDGEOMETRY/DLorentzDeflections.h"
 #include "HDGEOMETRY/DMaterialMap.h"
 #include "HDGEOMETRY/DRootGeom.h"
+#include "HDGEOMETRY/DMagneticFieldMapNoField.h"
 #include "DANA/DApplication.h"
 #include <JANA/JCalibration.h>
 #include "PID/DParticleID.h"
@@ -348,6 +349,15 @@ DTrackFitterKalmanSIMD::DTrackFitterKalmanSIMD(JEventLoop *loop):DTrackFitter(lo
    PLANE_TO_SKIP=0;
    gPARMS->SetDefaultParameter("KALMAN:PLANE_TO_SKIP",PLANE_TO_SKIP); 
 
+   // With the field off the propagation in z is done with versions of the
+   // stepping routines that skip the field lookups and curvature terms.
+   // The results are the same either way; this is here for benchmarking.
+   bool NO_FIELD_PROPAGATION=true;
+   gPARMS->SetDefaultParameter("KALMAN:NO_FIELD_PROPAGATION",NO_FIELD_PROPAGATION,
+         "Use straight-line propagation routines when the field is off");
+   dIsNoFieldFlag = NO_FIELD_PROPAGATION
+      && (dynamic_cast<const DMagneticFieldMapNoField*>(bfield) != NULL);
+
    MINIMUM_HIT_FRACTION=0.7;
    gPARMS->SetDefaultParameter("KALMAN:MINIMUM_HIT_FRACTION",MINIMUM_HIT_FRACTION); 
    MIN_HITS_FOR_REFIT=6; 
@@ -1094,6 +1104,15 @@ jerror_t DTrackFitterKalmanSIMD::AddCDCHit (const DCDCTrackHit *cdchit){
 }
 
 // Calculate the derivative of the state vector with respect to z
+jerror_t DTrackFitterKalmanSIMD::CalcDeriv(double z,
+      const DMatrix5x1 &S, 
+      double dEdx, 
+      DMatrix5x1 &D){
+   if (dIsNoFieldFlag) return CalcDeriv<DKalmanNoFieldPolicy>(z,S,dEdx,D);
+   return CalcDeriv<DKalmanFieldMapPolicy>(z,S,dEdx,D);
+}
+
+template<class FieldPolicy>
 jerror_t DTrackFitterKalmanSIMD::CalcDeriv(double z,
       const DMatrix5x1 &S, 
       double dEdx, 
@@ -1110,21 +1129,27 @@ jerror_t DTrackFitterKalmanSIMD::CalcDeriv(double z,
    if (fabs(ty)>TAN_MAX) ty=TAN_MAX*(ty>0.0?1.:-1.);
 
    // useful combinations of terms
-   double kq_over_p=qBr2p*q_over_p;
    double tx2=tx*tx;
    double ty2=ty*ty;
-   double txty=tx*ty;
    double one_plus_tx2=1.+tx2;
    double dsdz=sqrt(one_plus_tx2+ty2);
-   double dtx_Bfac=ty*Bz+txty*Bx-one_plus_tx2*By;
-   double dty_Bfac=Bx*(1.+ty2)-txty*By-tx*Bz;
-   double kq_over_p_dsdz=kq_over_p*dsdz;
 
    // Derivative of S with respect to z
    D(state_x)=tx;
    D(state_y)=ty;
-   D(state_tx)=kq_over_p_dsdz*dtx_Bfac;
-   D(state_ty)=kq_over_p_dsdz*dty_Bfac;
+   if (FieldPolicy::kHasField){
+      double kq_over_p=qBr2p*q_over_p;
+      double txty=tx*ty;
+      double dtx_Bfac=ty*Bz+txty*Bx-one_plus_tx2*By;
+      double dty_Bfac=Bx*(1.+ty2)-txty*By-tx*Bz;
+      double kq_over_p_dsdz=kq_over_p*dsdz;
+      D(state_tx)=kq_over_p_dsdz*dtx_Bfac;
+      D(state_ty)=kq_over_p_dsdz*dty_Bfac;
+   }
+   else{
+      D(state_tx)=0.;
+      D(state_ty)=0.;
+   }
 
    D(state_q_over_p)=0.;
    if (CORRECT_FOR_ELOSS && fabs(dEdx)>EPS){
@@ -1916,35 +1941,19 @@ jerror_t DTrackFitterKalmanSIMD::SetReferenceTrajectory(DMatrix5x1 &S){
    // return an error if there are not enough entries in the trajectory
    if (forward_traj.size()<2) return RESOURCE_UNAVAILABLE;
 
-   // Fill in Lorentz deflection parameters
+   // Fill in Lorentz deflection parameters. First find the trajectory
+   // steps that go with each FDC plane, then get the magnetic field for
+   // all of them at once.
+   lorentz_m.clear();
+   lorentz_hit_id.clear();
    for (unsigned int m=0;m<forward_traj.size();m++){
       if (my_id>0){
          unsigned int hit_id=my_id-1;
          double z=forward_traj[m].z;
          if (fabs(z-my_fdchits[hit_id]->z)<EPS2){
             forward_traj[m].h_id=my_id;
-
-            // Get the magnetic field at this position along the trajectory
-            bfield->GetField(forward_traj[m].S(state_x),forward_traj[m].S(state_y),
-                  z,Bx,By,Bz);
-            double Br=sqrt(Bx*Bx+By*By);
-
-            // Angle between B and wire
-            double my_phi=0.;
-            if (Br>0.) my_phi=acos((Bx*my_fdchits[hit_id]->sina 
-                     +By*my_fdchits[hit_id]->cosa)/Br);
-            /*
-               lorentz_def->GetLorentzCorrectionParameters(forward_traj[m].pos.x(),
-               forward_traj[m].pos.y(),
-               forward_traj[m].pos.z(),
-               tanz,tanr);
-               my_fdchits[hit_id]->nr=tanr;
-               my_fdchits[hit_id]->nz=tanz;
-               */
-
-            my_fdchits[hit_id]->nr=LORENTZ_NR_PAR1*Bz*(1.+LORENTZ_NR_PAR2*Br);
-            my_fdchits[hit_id]->nz=(LORENTZ_NZ_PAR1+LORENTZ_NZ_PAR2*Bz)*(Br*cos(my_phi));
-
+            lorentz_m.push_back(m);
+            lorentz_hit_id.push_back(hit_id);
 
             my_id--;
 
@@ -1961,6 +1970,46 @@ jerror_t DTrackFitterKalmanSIMD::SetReferenceTrajectory(DMatrix5x1 &S){
       }
    }
 
+   unsigned int num_lorentz=lorentz_m.size();
+   if (num_lorentz>0){
+      // Get the magnetic field at these positions along the trajectory
+      lorentz_pos.resize(3*num_lorentz);
+      lorentz_B.resize(3*num_lorentz);
+      double *xpos=&lorentz_pos[0],*ypos=xpos+num_lorentz,*zpos=ypos+num_lorentz;
+      double *Bxv=&lorentz_B[0],*Byv=Bxv+num_lorentz,*Bzv=Byv+num_lorentz;
+      for (unsigned int k=0;k<num_lorentz;k++){
+         const DKalmanForwardTrajectory_t &traj=forward_traj[lorentz_m[k]];
+         xpos[k]=traj.S(state_x);
+         ypos[k]=traj.S(state_y);
+         zpos[k]=traj.z;
+      }
+      bfield->GetFields(num_lorentz,xpos,ypos,zpos,Bxv,Byv,Bzv);
+
+      for (unsigned int k=0;k<num_lorentz;k++){
+         unsigned int hit_id=lorentz_hit_id[k];
+         Bx=Bxv[k];
+         By=Byv[k];
+         Bz=Bzv[k];
+         double Br=sqrt(Bx*Bx+By*By);
+
+         // Angle between B and wire
+         double my_phi=0.;
+         if (Br>0.) my_phi=acos((Bx*my_fdchits[hit_id]->sina 
+                  +By*my_fdchits[hit_id]->cosa)/Br);
+         /*
+            lorentz_def->GetLorentzCorrectionParameters(forward_traj[m].pos.x(),
+            forward_traj[m].pos.y(),
+            forward_traj[m].pos.z(),
+            tanz,tanr);
+            my_fdchits[hit_id]->nr=tanr;
+            my_fdchits[hit_id]->nz=tanz;
+            */
+
+         my_fdchits[hit_id]->nr=LORENTZ_NR_PAR1*Bz*(1.+LORENTZ_NR_PAR2*Br);
+         my_fdchits[hit_id]->nz=(LORENTZ_NZ_PAR1+LORENTZ_NZ_PAR2*Bz)*(Br*cos(my_phi));
+      }
+   }
+
    if (DEBUG_LEVEL>20)
    {
       cout << "--- Forward fdc trajectory ---" <<endl;
@@ -2001,6 +2050,13 @@ jerror_t DTrackFitterKalmanSIMD::SetReferenceTrajectory(DMatrix5x1 &S){
 
 // Step the state vector through the field from oldz to newz.
 // Uses the 4th-order Runga-Kutte algorithm.
+double DTrackFitterKalmanSIMD::Step(double oldz,double newz, double dEdx,
+      DMatrix5x1 &S){
+   if (dIsNoFieldFlag) return Step<DKalmanNoFieldPolicy>(oldz,newz,dEdx,S);
+   return Step<DKalmanFieldMapPolicy>(oldz,newz,dEdx,S);
+}
+
+template<class FieldPolicy>
 double DTrackFitterKalmanSIMD::Step(double oldz,double newz, double dEdx,
       DMatrix5x1 &S){
    double delta_z=newz-oldz;
@@ -2016,46 +2072,53 @@ double DTrackFitterKalmanSIMD::Step(double oldz,double newz, double dEdx,
    DMatrix5x1 D1,D2,D3,D4;
 
    //B-field and gradient at  at (x,y,z)
-   bfield->GetFieldAndGradient(S(state_x),S(state_y),oldz,Bx,By,Bz, 
+   FieldPolicy::GetFieldAndGradient(bfield,S(state_x),S(state_y),oldz,Bx,By,Bz, 
          dBxdx,dBxdy,dBxdz,dBydx,
          dBydy,dBydz,dBzdx,dBzdy,dBzdz);
    double Bx0=Bx,By0=By,Bz0=Bz;
 
    // Calculate the derivative and propagate the state to the next point
-   CalcDeriv(oldz,S,dEdx,D1);
+   CalcDeriv<FieldPolicy>(oldz,S,dEdx,D1);
    DMatrix5x1 S1=S+delta_z_over_2*D1;
 
    // Calculate the field at the first intermediate point
-   double dx=S1(state_x)-S(state_x);
-   double dy=S1(state_y)-S(state_y);
-   Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z_over_2;
-   By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z_over_2;
-   Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z_over_2;
+   double dx=0.,dy=0.;
+   if (FieldPolicy::kHasField){
+      dx=S1(state_x)-S(state_x);
+      dy=S1(state_y)-S(state_y);
+      Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z_over_2;
+      By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z_over_2;
+      Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z_over_2;
+   }
 
    // Calculate the derivative and propagate the state to the next point
-   CalcDeriv(midz,S1,dEdx,D2);
+   CalcDeriv<FieldPolicy>(midz,S1,dEdx,D2);
    S1=S+delta_z_over_2*D2;
 
    // Calculate the field at the second intermediate point
-   dx=S1(state_x)-S(state_x);
-   dy=S1(state_y)-S(state_y);
-   Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z_over_2;
-   By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z_over_2;
-   Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z_over_2;
+   if (FieldPolicy::kHasField){
+      dx=S1(state_x)-S(state_x);
+      dy=S1(state_y)-S(state_y);
+      Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z_over_2;
+      By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z_over_2;
+      Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z_over_2;
+   }
 
    // Calculate the derivative and propagate the state to the next point
-   CalcDeriv(midz,S1,dEdx,D3);
+   CalcDeriv<FieldPolicy>(midz,S1,dEdx,D3);
    S1=S+delta_z*D3;
 
    // Calculate the field at the final point
-   dx=S1(state_x)-S(state_x);
-   dy=S1(state_y)-S(state_y);
-   Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z;
-   By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z;
-   Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z;
+   if (FieldPolicy::kHasField){
+      dx=S1(state_x)-S(state_x);
+      dy=S1(state_y)-S(state_y);
+      Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z;
+      By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z;
+      Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z;
+   }
 
    // Final derivative
-   CalcDeriv(newz,S1,dEdx,D4);
+   CalcDeriv<FieldPolicy>(newz,S1,dEdx,D4);
 
    //  S+=delta_z*(ONE_SIXTH*D1+ONE_THIRD*D2+ONE_THIRD*D3+ONE_SIXTH*D4);
    double dz_over_6=delta_z*ONE_SIXTH;
@@ -2080,6 +2143,13 @@ double DTrackFitterKalmanSIMD::Step(double oldz,double newz, double dEdx,
 // Uses the 4th-order Runga-Kutte algorithm.
 // Uses the gradient to compute the field at the intermediate and last 
 // points.
+double DTrackFitterKalmanSIMD::FasterStep(double oldz,double newz, double dEdx,
+      DMatrix5x1 &S){
+   if (dIsNoFieldFlag) return FasterStep<DKalmanNoFieldPolicy>(oldz,newz,dEdx,S);
+   return FasterStep<DKalmanFieldMapPolicy>(oldz,newz,dEdx,S);
+}
+
+template<class FieldPolicy>
 double DTrackFitterKalmanSIMD::FasterStep(double oldz,double newz, double dEdx,
       DMatrix5x1 &S){
    double delta_z=newz-oldz;
@@ -2099,40 +2169,47 @@ double DTrackFitterKalmanSIMD::FasterStep(double oldz,double newz, double dEdx,
    // obtained at the end of the previous step through StepJacobian
 
    // Calculate the derivative and propagate the state to the next point
-   CalcDeriv(oldz,S,dEdx,D1);
+   CalcDeriv<FieldPolicy>(oldz,S,dEdx,D1);
    DMatrix5x1 S1=S+delta_z_over_2*D1;
 
    // Calculate the field at the first intermediate point
-   double dx=S1(state_x)-S(state_x);
-   double dy=S1(state_y)-S(state_y);
-   Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z_over_2;
-   By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z_over_2;
-   Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z_over_2;
+   double dx=0.,dy=0.;
+   if (FieldPolicy::kHasField){
+      dx=S1(state_x)-S(state_x);
+      dy=S1(state_y)-S(state_y);
+      Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z_over_2;
+      By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z_over_2;
+      Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z_over_2;
+   }
 
    // Calculate the derivative and propagate the state to the next point
-   CalcDeriv(midz,S1,dEdx,D2);
+   CalcDeriv<FieldPolicy>(midz,S1,dEdx,D2);
    S1=S+delta_z_over_2*D2;
 
    // Calculate the field at the second intermediate point
-   dx=S1(state_x)-S(state_x);
-   dy=S1(state_y)-S(state_y);
-   Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z_over_2;
-   By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z_over_2;
-   Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z_over_2;
+   if (FieldPolicy::kHasField){
+      dx=S1(state_x)-S(state_x);
+      dy=S1(state_y)-S(state_y);
+      Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z_over_2;
+      By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z_over_2;
+      Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z_over_2;
+   }
 
    // Calculate the derivative and propagate the state to the next point
-   CalcDeriv(midz,S1,dEdx,D3);
+   CalcDeriv<FieldPolicy>(midz,S1,dEdx,D3);
    S1=S+delta_z*D3;
 
    // Calculate the field at the final point
-   dx=S1(state_x)-S(state_x);
-   dy=S1(state_y)-S(state_y);
-   Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z;
-   By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z;
-   Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z;
+   if (FieldPolicy::kHasField){
+      dx=S1(state_x)-S(state_x);
+      dy=S1(state_y)-S(state_y);
+      Bx=Bx0+dBxdx*dx+dBxdy*dy+dBxdz*delta_z;
+      By=By0+dBydx*dx+dBydy*dy+dBydz*delta_z;
+      Bz=Bz0+dBzdx*dx+dBzdy*dy+dBzdz*delta_z;
+   }
 
    // Final derivative
-   CalcDeriv(newz,S1,dEdx,D4);
+   CalcDeriv<FieldPolicy>(newz,S1,dEdx,D4);
 
    //  S+=delta_z*(ONE_SIXTH*D1+ONE_THIRD*D2+ONE_THIRD*D3+ONE_SIXTH*D4);
    double dz_over_6=delta_z*ONE_SIXTH;
@@ -2157,6 +2234,14 @@ double DTrackFitterKalmanSIMD::FasterStep(double oldz,double newz, double dEdx,
 
 
 // Compute the Jacobian matrix for the forward parametrization.
+jerror_t DTrackFitterKalmanSIMD::StepJacobian(double oldz,double newz,
+      const DMatrix5x1 &S,
+      double dEdx,DMatrix5x5 &J){
+   if (dIsNoFieldFlag) return StepJacobian<DKalmanNoFieldPolicy>(oldz,newz,S,dEdx,J);
+   return StepJacobian<DKalmanFieldMapPolicy>(oldz,newz,S,dEdx,J);
+}
+
+template<class FieldPolicy>
 jerror_t DTrackFitterKalmanSIMD::StepJacobian(double oldz,double newz,
       const DMatrix5x1 &S,
       double dEdx,DMatrix5x5 &J){
@@ -2175,7 +2260,7 @@ jerror_t DTrackFitterKalmanSIMD::StepJacobian(double oldz,double newz,
 
    //B-field and field gradient at (x,y,z)
    //if (get_field) 
-   bfield->GetFieldAndGradient(x,y,oldz,Bx,By,Bz,dBxdx,dBxdy,
+   FieldPolicy::GetFieldAndGradient(bfield,x,y,oldz,Bx,By,Bz,dBxdx,dBxdy,
          dBxdz,dBydx,dBydy,
          dBydz,dBzdx,dBzdy,dBzdz);
 
@@ -2188,47 +2273,50 @@ jerror_t DTrackFitterKalmanSIMD::StepJacobian(double oldz,double newz,
    if (fabs(tx)>TAN_MAX) tx=TAN_MAX*(tx>0.0?1.:-1.); 
    if (fabs(ty)>TAN_MAX) ty=TAN_MAX*(ty>0.0?1.:-1.);
    // useful combinations of terms
-   double kq_over_p=qBr2p*q_over_p;
    double tx2=tx*tx;
-   double twotx2=2.*tx2;
    double ty2=ty*ty;
-   double twoty2=2.*ty2;
-   double txty=tx*ty;
-   double one_plus_tx2=1.+tx2;
-   double one_plus_ty2=1.+ty2;
-   double one_plus_twotx2_plus_ty2=one_plus_ty2+twotx2;
-   double one_plus_twoty2_plus_tx2=one_plus_tx2+twoty2;
    double dsdz=sqrt(1.+tx2+ty2);
    double ds=dsdz*delta_z;
-   double kds=qBr2p*ds;
-   double kqdz_over_p_over_dsdz=kq_over_p*delta_z/dsdz;
-   double kq_over_p_ds=kq_over_p*ds;
-   double dtx_Bdep=ty*Bz+txty*Bx-one_plus_tx2*By;
-   double dty_Bdep=Bx*one_plus_ty2-txty*By-tx*Bz;
-   double Bxty=Bx*ty;
-   double Bytx=By*tx;
-   double Bztxty=Bz*txty;
-   double Byty=By*ty;
-   double Bxtx=Bx*tx;
 
    // Jacobian
    J(state_x,state_tx)=J(state_y,state_ty)=delta_z;
-   J(state_tx,state_q_over_p)=kds*dtx_Bdep;
-   J(state_ty,state_q_over_p)=kds*dty_Bdep;
-   J(state_tx,state_tx)+=kqdz_over_p_over_dsdz*(Bxty*(one_plus_twotx2_plus_ty2)
-         -Bytx*(3.*one_plus_tx2+twoty2)
-         +Bztxty);
-   J(state_tx,state_x)=kq_over_p_ds*(ty*dBzdx+txty*dBxdx-one_plus_tx2*dBydx);
-   J(state_ty,state_ty)+=kqdz_over_p_over_dsdz*(Bxty*(3.*one_plus_ty2+twotx2)
-         -Bytx*(one_plus_twoty2_plus_tx2)
-         -Bztxty);
-   J(state_ty,state_y)= kq_over_p_ds*(one_plus_ty2*dBxdy-txty*dBydy-tx*dBzdy);
-   J(state_tx,state_ty)=kqdz_over_p_over_dsdz
-      *((Bxtx+Bz)*(one_plus_twoty2_plus_tx2)-Byty*one_plus_tx2);
-   J(state_tx,state_y)= kq_over_p_ds*(tx*dBzdy+txty*dBxdy-one_plus_tx2*dBydy);
-   J(state_ty,state_tx)=-kqdz_over_p_over_dsdz*((Byty+Bz)*(one_plus_twotx2_plus_ty2)
-         -Bxtx*one_plus_ty2);
-   J(state_ty,state_x)=kq_over_p_ds*(one_plus_ty2*dBxdx-txty*dBydx-tx*dBzdx);
+   if (FieldPolicy::kHasField){
+      double kq_over_p=qBr2p*q_over_p;
+      double twotx2=2.*tx2;
+      double twoty2=2.*ty2;
+      double txty=tx*ty;
+      double one_plus_tx2=1.+tx2;
+      double one_plus_ty2=1.+ty2;
+      double one_plus_twotx2_plus_ty2=one_plus_ty2+twotx2;
+      double one_plus_twoty2_plus_tx2=one_plus_tx2+twoty2;
+      double kds=qBr2p*ds;
+      double kqdz_over_p_over_dsdz=kq_over_p*delta_z/dsdz;
+      double kq_over_p_ds=kq_over_p*ds;
+      double dtx_Bdep=ty*Bz+txty*Bx-one_plus_tx2*By;
+      double dty_Bdep=Bx*one_plus_ty2-txty*By-tx*Bz;
+      double Bxty=Bx*ty;
+      double Bytx=By*tx;
+      double Bztxty=Bz*txty;
+      double Byty=By*ty;
+      double Bxtx=Bx*tx;
+
+      J(state_tx,state_q_over_p)=kds*dtx_Bdep;
+      J(state_ty,state_q_over_p)=kds*dty_Bdep;
+      J(state_tx,state_tx)+=kqdz_over_p_over_dsdz*(Bxty*(one_plus_twotx2_plus_ty2)
+            -Bytx*(3.*one_plus_tx2+twoty2)
+            +Bztxty);
+      J(state_tx,state_x)=kq_over_p_ds*(ty*dBzdx+txty*dBxdx-one_plus_tx2*dBydx);
+      J(state_ty,state_ty)+=kqdz_over_p_over_dsdz*(Bxty*(3.*one_plus_ty2+twotx2)
+            -Bytx*(one_plus_twoty2_plus_tx2)
+            -Bztxty);
+      J(state_ty,state_y)= kq_over_p_ds*(one_plus_ty2*dBxdy-txty*dBydy-tx*dBzdy);
+      J(state_tx,state_ty)=kqdz_over_p_over_dsdz
+         *((Bxtx+Bz)*(one_plus_twoty2_plus_tx2)-Byty*one_plus_tx2);
+      J(state_tx,state_y)= kq_over_p_ds*(tx*dBzdy+txty*dBxdy-one_plus_tx2*dBydy);
+      J(state_ty,state_tx)=-kqdz_over_p_over_dsdz*((Byty+Bz)*(one_plus_twotx2_plus_ty2)
+            -Bxtx*one_plus_ty2);
+      J(state_ty,state_x)=kq_over_p_ds*(one_plus_ty2*dBxdx-txty*dBydx-tx*dBzdx);
+   }
    if (CORRECT_FOR_ELOSS && fabs(dEdx)>EPS){
       double one_over_p_sq=q_over_p*q_over_p;
       double E=sqrt(1./one_over_p_sq+mass2); 
@@ -18,6 +18,7 @@
 #include <TH1I.h>
 #include <TMatrixFSym.h>
 #include "DResourcePool.h"
+#include "DKalmanSIMDTrajectory.h"
 
 #ifndef M_TWO_PI
 #define M_TWO_PI 6.28318530717958647692
@@ -132,6 +133,40 @@ typedef struct{
   bool used_in_fit;
 }DKalmanUpdate_t;
 
+// Field policies for the propagation routines for the forward
+// parametrization (Step, FasterStep, StepJacobian, CalcDeriv). These
+// are instantiated once for the field map and once for running with
+// the field off (DMagneticFieldMapNoField). In the latter the field
+// lookups and all of the terms proportional to the field drop out at
+// compile time, leaving straight-line propagation with energy loss.
+class DKalmanFieldMapPolicy{
+ public:
+  static const bool kHasField=true;
+  static inline void GetFieldAndGradient(const DMagneticFieldMap *bfield,
+					 double x,double y,double z,
+					 double &Bx,double &By,double &Bz,
+					 double &dBxdx,double &dBxdy,double &dBxdz,
+					 double &dBydx,double &dBydy,double &dBydz,
+					 double &dBzdx,double &dBzdy,double &dBzdz){
+    bfield->GetFieldAndGradient(x,y,z,Bx,By,Bz,dBxdx,dBxdy,dBxdz,
+				dBydx,dBydy,dBydz,dBzdx,dBzdy,dBzdz);
+  }
+};
+
+class DKalmanNoFieldPolicy{
+ public:
+  static const bool kHasField=false;
+  static inline void GetFieldAndGradient(const DMagneticFieldMap *bfield,
+					 double x,double y,double z,
+					 double &Bx,double &By,double &Bz,
+					 double &dBxdx,double &dBxdy,double &dBxdz,
+					 double &dBydx,double &dBydy,double &dBydz,
+					 double &dBzdx,double &dBzdy,double &dBzdz){
+    Bx=By=Bz=0.;
+    dBxdx=dBxdy=dBxdz=dBydx=dBydy=dBydz=dBzdx=dBzdy=dBzdz=0.;
+  }
+};
+
 
 class DTrackFitterKalmanSIMD: public DTrackFitter{
  public:
@@ -173,6 +208,9 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
 
   // Virtual methods from TrackFitter base class
   string Name(void) const {return string("KalmanSIMD");}
+  // No helper fitters with KALMAN:DEBUG_HISTS: they would make and fill
+  // the same-named debugging histograms from several threads.
+  DTrackFitter* MakeNew(JEventLoop *loop) const {return DEBUG_HISTS ? NULL:new DTrackFitterKalmanSIMD(loop);}
   fit_status_t FitTrack(void);
   double ChiSq(fit_type_t fit_type, DReferenceTrajectory *rt, double *chisq_ptr=NULL, int *dof_ptr=NULL, vector<pull_t> *pulls_ptr=NULL);
 
@@ -273,8 +311,15 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
 
   double Step(double oldz,double newz, double dEdx,DMatrix5x1 &S);
   double FasterStep(double oldz,double newz, double dEdx,DMatrix5x1 &S);
+  template<class FieldPolicy>
+  double Step(double oldz,double newz, double dEdx,DMatrix5x1 &S);
+  template<class FieldPolicy>
+  double FasterStep(double oldz,double newz, double dEdx,DMatrix5x1 &S);
   void FastStep(double &z,double ds, double dEdx,DMatrix5x1 &S); 
   void FastStep(DVector2 &xy,double ds, double dEdx,DMatrix5x1 &S);
+  jerror_t StepJacobian(double oldz,double newz,const DMatrix5x1 &S,
+			double dEdx,DMatrix5x5 &J);
+  template<class FieldPolicy>
   jerror_t StepJacobian(double oldz,double newz,const DMatrix5x1 &S,
 			double dEdx,DMatrix5x5 &J);
   jerror_t CalcDerivAndJacobian(double z,double dz,const DMatrix5x1 &S,
@@ -282,6 +327,9 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
 				DMatrix5x5 &J,DMatrix5x1 &D);
   jerror_t CalcJacobian(double z,double dz,const DMatrix5x1 &S,
 			double dEdx,DMatrix5x5 &J);
+  jerror_t CalcDeriv(double z,const DMatrix5x1 &S, double dEdx, 
+		     DMatrix5x1 &D);
+  template<class FieldPolicy>
   jerror_t CalcDeriv(double z,const DMatrix5x1 &S, double dEdx, 
 		     DMatrix5x1 &D);
   jerror_t CalcDeriv(DVector2 &dxy,
@@ -413,8 +461,14 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
   vector< vector <double> > fcov;
   
   // Lists containing state, covariance, and jacobian at each step
-  deque<DKalmanCentralTrajectory_t>central_traj;
-  deque<DKalmanForwardTrajectory_t>forward_traj;
+  DKalmanSIMDTrajectory<DKalmanCentralTrajectory_t>central_traj;
+  DKalmanSIMDTrajectory<DKalmanForwardTrajectory_t>forward_traj;
+
+  // Scratch space for the Lorentz deflection parameters in
+  // SetReferenceTrajectory (trajectory step, FDC hit, and SoA positions
+  // and field for the batch field lookup). Kept between fits.
+  vector<unsigned int>lorentz_m,lorentz_hit_id;
+  vector<double>lorentz_pos,lorentz_B;
 
   // lists containing updated state vector and covariance at measurement point
   vector<DKalmanUpdate_t>fdc_updates;
@@ -431,6 +485,7 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
   double Bx,By,Bz;
   double dBxdx,dBxdy,dBxdz,dBydx,dBydy,dBydz,dBzdx,dBzdy,dBzdz;
   bool get_field;
+  bool dIsNoFieldFlag; // use the DKalmanNoFieldPolicy versions of the propagation routines
   double FactorForSenseOfRotation;
 
   // endplate dimensions and location
@@ -23,6 +23,7 @@ class DTrackFitterKalmanSIMD_ALT1: public DTrackFitterKalmanSIMD{
   
   // Virtual methods from TrackFitter base class
   string Name(void) const {return string("KalmanSIMD_ALT1");}
+  DTrackFitter* MakeNew(JEventLoop *loop) const {return DEBUG_HISTS ? NULL:new DTrackFitterKalmanSIMD_ALT1(loop);}
  protected:
 	
   
@@ -0,0 +1,260 @@
+// $Id$
+//
+//    File: DTrackHitIndex.cc
+// Created: Sun Oct 18 19:02:11 EDT 2026
+//
+
+#include <cmath>
+#include <algorithm>
+using namespace std;
+
+#include <CDC/DCDCTrackHit.h>
+#include <FDC/DFDCPseudo.h>
+#include <TRACKING/DReferenceTrajectory.h>
+
+#include "DTrackHitIndex.h"
+
+//---------------------------------
+// MaxStepLength
+//---------------------------------
+static double MaxStepLength(const DReferenceTrajectory::swim_pos_t *pos, int Nsteps)
+{
+	/// Return the largest distance between two consecutive swim steps.
+	double max_len2 = 0.0;
+	for(int i=1; i<Nsteps; i++){
+		double dx = pos[i].x - pos[i-1].x;
+		double dy = pos[i].y - pos[i-1].y;
+		double dz = pos[i].z - pos[i-1].z;
+		double len2 = dx*dx + dy*dy + dz*dz;
+		if(len2 > max_len2) max_len2 = len2;
+	}
+	return sqrt(max_len2);
+}
+
+//---------------------------------
+// DCDCHitIndex    (Constructor)
+//---------------------------------
+DCDCHitIndex::DCDCHitIndex(const vector<const DCDCTrackHit*> &hits_in, vector<const DCDCTrackHit*> &&hits_sorted)
+{
+	/// hits_sorted should be hits_in sorted by ring and then straw. It
+	/// is moved into this object.
+	for(auto hit : hits_in) key.push_back(make_pair((const void*)hit, (const void*)hit->wire));
+	this->hits_sorted = std::move(hits_sorted);
+
+	// Hits in the same ring are next to each other in the sorted list
+	int last_ring = -1;
+	for(unsigned int i=0; i<this->hits_sorted.size(); i++){
+		const DCDCWire *wire = this->hits_sorted[i]->wire;
+		double rho = wire->origin.Perp();
+		double z0 = wire->origin.Z();
+		double uz = fabs(wire->udir.Z());
+		double tan_stereo = uz>0.0 ? wire->udir.Perp()/uz:1.0E6;
+
+		if(rings.empty() || wire->ring!=last_ring){
+			rings.push_back(ring_t());
+			ring_t &ring = rings.back();
+			ring.rho_min = ring.rho_max = rho;
+			ring.z0_min = ring.z0_max = z0;
+			ring.tan_max = tan_stereo;
+			ring.uz_min = uz;
+			last_ring = wire->ring;
+		}
+		ring_t &ring = rings.back();
+		ring.rho_min = min(ring.rho_min, rho);
+		ring.rho_max = max(ring.rho_max, rho);
+		ring.z0_min  = min(ring.z0_min, z0);
+		ring.z0_max  = max(ring.z0_max, z0);
+		ring.tan_max = max(ring.tan_max, tan_stereo);
+		ring.uz_min  = min(ring.uz_min, uz);
+		ring.phi_index.push_back(make_pair(wire->origin.Phi(), i));
+	}
+
+	for(auto &ring : rings) sort(ring.phi_index.begin(), ring.phi_index.end());
+}
+
+//---------------------------------
+// Matches
+//---------------------------------
+bool DCDCHitIndex::Matches(const vector<const DCDCTrackHit*> &hits_in) const
+{
+	/// Return true if this index was made from the given list of hits
+	if(hits_in.size() != key.size()) return false;
+	for(unsigned int i=0; i<hits_in.size(); i++){
+		if(key[i].first != hits_in[i]) return false;
+		if(key[i].second != hits_in[i]->wire) return false;
+	}
+	return true;
+}
+
+//---------------------------------
+// FindCandidates
+//---------------------------------
+void DCDCHitIndex::FindCandidates(const DReferenceTrajectory *rt, double max_doca, double margin, vector<char> &in_corridor) const
+{
+	/// Set in_corridor[i] to 1 for every hit in the sorted list whose
+	/// wire may be within max_doca of the trajectory and 0 for the rest.
+	///
+	/// The distance of a point to a wire is at least |u_z| times the
+	/// distance in x/y from the point to the wire at the same z. At the
+	/// z of a swim step, a wire is displaced from its center by at most
+	/// |z-z0|*tan(stereo) so only wires whose centers lie within a
+	/// circle of radius W around the step need to be checked. In (r,phi)
+	/// that is a radial band around the step's radius and a phi range of
+	/// +/-asin(W/r) around the step's phi.
+
+	in_corridor.assign(hits_sorted.size(), 0);
+
+	const DReferenceTrajectory::swim_pos_t *pos = rt->GetSwimPos();
+	int Nsteps = rt->Nswim_steps;
+	if(Nsteps<1){
+		// Let the hit selector deal with this
+		in_corridor.assign(hits_sorted.size(), 1);
+		return;
+	}
+
+	double reach = max_doca + MaxStepLength(pos, Nsteps) + margin;
+
+	for(auto &ring : rings){
+		if(ring.uz_min < 0.5){
+			for(auto &p : ring.phi_index) in_corridor[p.second] = 1;
+			continue;
+		}
+		double reach_xy = reach/ring.uz_min;
+
+		for(int i=0; i<Nsteps; i++){
+			double x = pos[i].x;
+			double y = pos[i].y;
+			double z = pos[i].z;
+			double r = sqrt(x*x + y*y);
+			double dz = max(fabs(z - ring.z0_min), fabs(z - ring.z0_max));
+			double W = reach_xy + dz*ring.tan_max;
+			if(r < ring.rho_min - W) continue;
+			if(r > ring.rho_max + W) continue;
+			if(W >= r){
+				for(auto &p : ring.phi_index) in_corridor[p.second] = 1;
+				break;
+			}
+			double phi = atan2(y, x);
+			double dphi = asin(W/r) + 1.0E-6;
+			MarkPhiRange(ring, phi-dphi, phi+dphi, in_corridor);
+		}
+	}
+}
+
+//---------------------------------
+// MarkPhiRange
+//---------------------------------
+void DCDCHitIndex::MarkPhiRange(const ring_t &ring, double phi_lo, double phi_hi, vector<char> &in_corridor) const
+{
+	/// Flag all hits in the ring with phi_lo <= phi <= phi_hi. The range
+	/// may extend past +/-pi by up to 2pi.
+	if(phi_lo < -M_PI){
+		MarkPhiRange(ring, phi_lo+2.0*M_PI, M_PI, in_corridor);
+		phi_lo = -M_PI;
+	}
+	if(phi_hi > M_PI){
+		MarkPhiRange(ring, -M_PI, phi_hi-2.0*M_PI, in_corridor);
+		phi_hi = M_PI;
+	}
+
+	auto it = lower_bound(ring.phi_index.begin(), ring.phi_index.end(), make_pair(phi_lo, 0U));
+	for(; it!=ring.phi_index.end() && it->first<=phi_hi; it++) in_corridor[it->second] = 1;
+}
+
+//---------------------------------
+// DFDCHitIndex    (Constructor)
+//---------------------------------
+DFDCHitIndex::DFDCHitIndex(const vector<const DFDCPseudo*> &hits_in, vector<const DFDCPseudo*> &&hits_sorted)
+{
+	/// hits_sorted should be hits_in sorted by layer and then wire. It
+	/// is moved into this object.
+	for(auto hit : hits_in) key.push_back(make_pair((const void*)hit, (const void*)hit->wire));
+	this->hits_sorted = std::move(hits_sorted);
+
+	// Hits in the same plane are next to each other in the sorted list
+	int last_layer = -1;
+	for(unsigned int i=0; i<this->hits_sorted.size(); i++){
+		const DFDCWire *wire = this->hits_sorted[i]->wire;
+		double z = wire->origin.Z();
+		double cosa = wire->udir.Y();
+		double sina = wire->udir.X();
+
+		if(planes.empty() || wire->layer!=last_layer){
+			planes.push_back(plane_t());
+			plane_t &plane = planes.back();
+			plane.z_min = plane.z_max = z;
+			plane.cosa = cosa;
+			plane.sina = sina;
+			plane.mark_all = false;
+			last_layer = wire->layer;
+		}
+		plane_t &plane = planes.back();
+		plane.z_min = min(plane.z_min, z);
+		plane.z_max = max(plane.z_max, z);
+		if(fabs(wire->udir.Z())>1.0E-3) plane.mark_all = true;
+		if(fabs(cosa-plane.cosa)>1.0E-6 || fabs(sina-plane.sina)>1.0E-6) plane.mark_all = true;
+		double w = wire->origin.X()*plane.cosa - wire->origin.Y()*plane.sina;
+		plane.w_index.push_back(make_pair(w, i));
+	}
+
+	for(auto &plane : planes) sort(plane.w_index.begin(), plane.w_index.end());
+}
+
+//---------------------------------
+// Matches
+//---------------------------------
+bool DFDCHitIndex::Matches(const vector<const DFDCPseudo*> &hits_in) const
+{
+	/// Return true if this index was made from the given list of hits
+	if(hits_in.size() != key.size()) return false;
+	for(unsigned int i=0; i<hits_in.size(); i++){
+		if(key[i].first != hits_in[i]) return false;
+		if(key[i].second != hits_in[i]->wire) return false;
+	}
+	return true;
+}
+
+//---------------------------------
+// FindCandidates
+//---------------------------------
+void DFDCHitIndex::FindCandidates(const DReferenceTrajectory *rt, double max_doca, double margin, vector<char> &in_corridor) const
+{
+	/// Set in_corridor[i] to 1 for every hit in the sorted list whose
+	/// wire may be within max_doca of the trajectory and 0 for the rest.
+	///
+	/// The wires of a plane lie in the plane and are parallel so the
+	/// distance of a point to a wire is at least the distance in z to
+	/// the plane and at least the distance in the direction in the
+	/// plane perpendicular to the wires. Only swim steps near the plane
+	/// in z need to be looked at and for those only the wires within
+	/// the reach in that perpendicular direction.
+
+	in_corridor.assign(hits_sorted.size(), 0);
+
+	const DReferenceTrajectory::swim_pos_t *pos = rt->GetSwimPos();
+	int Nsteps = rt->Nswim_steps;
+	if(Nsteps<1){
+		// Let the hit selector deal with this
+		in_corridor.assign(hits_sorted.size(), 1);
+		return;
+	}
+
+	double reach = max_doca + MaxStepLength(pos, Nsteps) + margin;
+	double reach_z = 1.001*reach; // allow for wires very slightly out of the plane
+
+	for(auto &plane : planes){
+		if(plane.mark_all){
+			for(auto &p : plane.w_index) in_corridor[p.second] = 1;
+			continue;
+		}
+
+		for(int i=0; i<Nsteps; i++){
+			if(pos[i].z < plane.z_min - reach_z) continue;
+			if(pos[i].z > plane.z_max + reach_z) continue;
+
+			double w = pos[i].x*plane.cosa - pos[i].y*plane.sina;
+			auto it = lower_bound(plane.w_index.begin(), plane.w_index.end(), make_pair(w-reach, 0U));
+			for(; it!=plane.w_index.end() && it->first<=w+reach; it++) in_corridor[it->second] = 1;
+		}
+	}
+}
@@ -0,0 +1,92 @@
+// $Id$
+//
+//    File: DTrackHitIndex.h
+// Created: Sun Oct 18 19:02:11 EDT 2026
+//
+
+#ifndef _DTrackHitIndex_
+#define _DTrackHitIndex_
+
+#include <vector>
+#include <utility>
+
+class DReferenceTrajectory;
+class DCDCTrackHit;
+class DFDCPseudo;
+
+///////////////////////////////////////////////////////////////////////
+/// The DCDCHitIndex and DFDCHitIndex classes are used by the hit
+/// selector to avoid calculating the DOCA of every hit in the event
+/// to every track. They hold a list of drift chamber hits in the same
+/// sorted order the hit selector loops over them, with CDC hits
+/// grouped by ring and ordered in phi and FDC hits grouped by plane
+/// and ordered in the coordinate perpendicular to the wires.
+///
+/// FindCandidates() walks the swim steps of a trajectory and flags
+/// every hit whose wire passes within MAX_DOCA (plus the length of the
+/// longest swim step and the given margin) of the trajectory. The test
+/// is conservative: a hit that is not flagged can not have a DOCA less
+/// than MAX_DOCA so skipping it does not change which hits are
+/// selected. If the hit geometry is unusual (e.g. a wire direction
+/// far from the expected one) all hits in that ring/plane are flagged.
+///
+/// An index is built once for a given list of hits and reused for as
+/// long as the same list is passed in (see Matches()). Only the wires
+/// of the hits are used so the index is still valid if the contents
+/// of a hit object change.
+///////////////////////////////////////////////////////////////////////
+
+class DCDCHitIndex{
+	public:
+		DCDCHitIndex(const std::vector<const DCDCTrackHit*> &hits_in, std::vector<const DCDCTrackHit*> &&hits_sorted);
+		virtual ~DCDCHitIndex(){}
+
+		bool Matches(const std::vector<const DCDCTrackHit*> &hits_in) const;
+		const std::vector<const DCDCTrackHit*>& GetSortedHits(void) const {return hits_sorted;}
+		void FindCandidates(const DReferenceTrajectory *rt, double max_doca, double margin, std::vector<char> &in_corridor) const;
+
+	protected:
+		class ring_t{
+			public:
+				double rho_min;   // range of radii of wire centers
+				double rho_max;
+				double z0_min;    // range of z of wire centers
+				double z0_max;
+				double tan_max;   // largest |u_perp/u_z| (stereo angle)
+				double uz_min;    // smallest |u_z|
+				std::vector<std::pair<double,unsigned int> > phi_index; // (phi of wire center, index in hits_sorted)
+		};
+
+		void MarkPhiRange(const ring_t &ring, double phi_lo, double phi_hi, std::vector<char> &in_corridor) const;
+
+		std::vector<std::pair<const void*,const void*> > key; // (hit, wire) for hits_in
+		std::vector<const DCDCTrackHit*> hits_sorted;
+		std::vector<ring_t> rings;
+};
+
+class DFDCHitIndex{
+	public:
+		DFDCHitIndex(const std::vector<const DFDCPseudo*> &hits_in, std::vector<const DFDCPseudo*> &&hits_sorted);
+		virtual ~DFDCHitIndex(){}
+
+		bool Matches(const std::vector<const DFDCPseudo*> &hits_in) const;
+		const std::vector<const DFDCPseudo*>& GetSortedHits(void) const {return hits_sorted;}
+		void FindCandidates(const DReferenceTrajectory *rt, double max_doca, double margin, std::vector<char> &in_corridor) const;
+
+	protected:
+		class plane_t{
+			public:
+				double z_min;     // range of z of wire centers
+				double z_max;
+				double cosa;      // wire direction (y and x components)
+				double sina;
+				bool mark_all;    // wires not all parallel and in the plane
+				std::vector<std::pair<double,unsigned int> > w_index; // (wire position perp. to wires, index in hits_sorted)
+		};
+
+		std::vector<std::pair<const void*,const void*> > key; // (hit, wire) for hits_in
+		std::vector<const DFDCPseudo*> hits_sorted;
+		std::vector<plane_t> planes;
+};
+
+#endif // _DTrackHitIndex_
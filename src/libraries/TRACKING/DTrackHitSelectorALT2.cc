@@ -65,8 +65,12 @@ DTrackHitSelectorALT2::DTrackHitSelectorALT2(jana::JEventLoop *loop, int32_t run
 	MIN_FDC_SIGMA_ANODE_WIREBASED = 0.0100;
 	MIN_FDC_SIGMA_CATHODE_WIREBASED = 0.0100;
 	MAX_DOCA=2.5;
+	USE_HIT_INDEX = true;
+	HIT_INDEX_MARGIN = 2.0;
 
 	gPARMS->SetDefaultParameter("TRKFIT:MAX_DOCA",MAX_DOCA,"Maximum doca for associating hit with track");
+	gPARMS->SetDefaultParameter("TRKFIT:USE_HIT_INDEX", USE_HIT_INDEX, "Only calculate the DOCA to the reference trajectory for hits whose wires pass near it (the selected hits are the same either way)");
+	gPARMS->SetDefaultParameter("TRKFIT:HIT_INDEX_MARGIN", HIT_INDEX_MARGIN, "Distance (cm) added to MAX_DOCA and the swim step length when finding hits near the reference trajectory");
 
 	gPARMS->SetDefaultParameter("TRKFIT:HS_DEBUG_LEVEL", HS_DEBUG_LEVEL, "Debug verbosity level for hit selector used in track fitting (0=no debug messages)");
 	gPARMS->SetDefaultParameter("TRKFIT:MAKE_DEBUG_TREES", MAKE_DEBUG_TREES, "Create a TTree with debugging info on hit selection for the FDC and CDC");
@@ -128,6 +132,50 @@ DTrackHitSelectorALT2::~DTrackHitSelectorALT2()
 
 }
 
+//---------------------------------
+// GetCDCHitIndex
+//---------------------------------
+shared_ptr<const DCDCHitIndex> DTrackHitSelectorALT2::GetCDCHitIndex(const vector<const DCDCTrackHit*> &cdchits_in) const
+{
+	/// Return the index for the given list of hits. The wire-based
+	/// fits of all tracks in an event use the same list so the index
+	/// made for the first one is normally reused for the rest.
+	{
+		lock_guard<mutex> lck(hit_index_mutex);
+		if(cdc_hit_index && cdc_hit_index->Matches(cdchits_in)) return cdc_hit_index;
+	}
+
+	// Make the new index without holding the lock so other threads
+	// aren't held up
+	vector<const DCDCTrackHit*> cdchits_in_sorted = cdchits_in;
+	sort(cdchits_in_sorted.begin(),cdchits_in_sorted.end(),DTrackHitSelector_cdchit_in_cmp);
+	auto index = make_shared<const DCDCHitIndex>(cdchits_in, std::move(cdchits_in_sorted));
+
+	lock_guard<mutex> lck(hit_index_mutex);
+	cdc_hit_index = index;
+	return index;
+}
+
+//---------------------------------
+// GetFDCHitIndex
+//---------------------------------
+shared_ptr<const DFDCHitIndex> DTrackHitSelectorALT2::GetFDCHitIndex(const vector<const DFDCPseudo*> &fdchits_in) const
+{
+	/// Return the index for the given list of hits (see GetCDCHitIndex)
+	{
+		lock_guard<mutex> lck(hit_index_mutex);
+		if(fdc_hit_index && fdc_hit_index->Matches(fdchits_in)) return fdc_hit_index;
+	}
+
+	vector<const DFDCPseudo*> fdchits_in_sorted = fdchits_in;
+	sort(fdchits_in_sorted.begin(),fdchits_in_sorted.end(),DTrackHitSelector_fdchit_in_cmp);
+	auto index = make_shared<const DFDCHitIndex>(fdchits_in, std::move(fdchits_in_sorted));
+
+	lock_guard<mutex> lck(hit_index_mutex);
+	fdc_hit_index = index;
+	return index;
+}
+
 //---------------------------------
 // GetCDCHits
 //---------------------------------
@@ -356,9 +404,20 @@ void DTrackHitSelectorALT2::GetCDCHits(fit_type_t fit_type, const DReferenceTraj
   /// time-based tracks and the distance to the wire for
   /// wire-based tracks.
 
-  // Sort so innermost ring is first and outermost is last
-  vector<const DCDCTrackHit*> cdchits_in_sorted = cdchits_in;
-  sort(cdchits_in_sorted.begin(),cdchits_in_sorted.end(),DTrackHitSelector_cdchit_in_cmp);
+  // Sort so innermost ring is first and outermost is last. If the hit
+  // index is used, it holds the sorted list and flags the hits that are
+  // close enough to the trajectory to be worth calculating the DOCA for.
+  vector<const DCDCTrackHit*> cdchits_in_sorted;
+  shared_ptr<const DCDCHitIndex> hit_index;
+  vector<char> in_corridor;
+  if(USE_HIT_INDEX){
+    hit_index = GetCDCHitIndex(cdchits_in);
+    hit_index->FindCandidates(rt, MAX_DOCA, HIT_INDEX_MARGIN, in_corridor);
+  }else{
+    cdchits_in_sorted = cdchits_in;
+    sort(cdchits_in_sorted.begin(),cdchits_in_sorted.end(),DTrackHitSelector_cdchit_in_cmp);
+  }
+  const vector<const DCDCTrackHit*> &cdchits = hit_index ? hit_index->GetSortedHits():cdchits_in_sorted;
   
   // Calculate beta of particle.
   //double my_mass=rt->GetMass();
@@ -400,9 +459,8 @@ void DTrackHitSelectorALT2::GetCDCHits(fit_type_t fit_type, const DReferenceTraj
 
   // Loop over hits
   bool outermost_hit=true;
-  vector<const DCDCTrackHit*>::const_reverse_iterator iter;
-  for(iter=cdchits_in_sorted.rbegin(); iter!=cdchits_in_sorted.rend(); iter++){
-    const DCDCTrackHit *hit = *iter;
+  for(int ihit=(int)cdchits.size()-1; ihit>=0; ihit--){
+    const DCDCTrackHit *hit = cdchits[ihit];
     
     // Skip hit if it is on the same wire as the previous hit
     if (hit->wire->ring == old_ring && hit->wire->straw==old_straw){
@@ -412,6 +470,10 @@ void DTrackHitSelectorALT2::GetCDCHits(fit_type_t fit_type, const DReferenceTraj
     old_ring=hit->wire->ring;
     old_straw=hit->wire->straw;
 
+    // Skip hit if its wire is too far from the trajectory for the DOCA
+    // to pass the cut below
+    if (hit_index && !in_corridor[ihit]) continue;
+
     // Find the DOCA to this wire
     double s=0.;
     double doca = rt->DistToRT(hit->wire, &s);
@@ -580,9 +642,20 @@ void DTrackHitSelectorALT2::GetFDCHits(fit_type_t fit_type, const DReferenceTraj
   /// of the trajectory to the wire and the drift distance
   /// and the distance along the wire.
 
-  // Sort so innermost ring is first and outermost is last
-  vector<const DFDCPseudo*> fdchits_in_sorted = fdchits_in;
-  sort(fdchits_in_sorted.begin(),fdchits_in_sorted.end(),DTrackHitSelector_fdchit_in_cmp);
+  // Sort so innermost ring is first and outermost is last. If the hit
+  // index is used, it holds the sorted list and flags the hits that are
+  // close enough to the trajectory to be worth calculating the DOCA for.
+  vector<const DFDCPseudo*> fdchits_in_sorted;
+  shared_ptr<const DFDCHitIndex> hit_index;
+  vector<char> in_corridor;
+  if(USE_HIT_INDEX){
+    hit_index = GetFDCHitIndex(fdchits_in);
+    hit_index->FindCandidates(rt, MAX_DOCA, HIT_INDEX_MARGIN, in_corridor);
+  }else{
+    fdchits_in_sorted = fdchits_in;
+    sort(fdchits_in_sorted.begin(),fdchits_in_sorted.end(),DTrackHitSelector_fdchit_in_cmp);
+  }
+  const vector<const DFDCPseudo*> &fdchits = hit_index ? hit_index->GetSortedHits():fdchits_in_sorted;
 
   // The variance on the residual due to measurement error.
   double var_anode = 0.25*ONE_OVER_12;
@@ -619,9 +692,12 @@ void DTrackHitSelectorALT2::GetFDCHits(fit_type_t fit_type, const DReferenceTraj
 
   // Loop over hits
   bool most_downstream_hit=true;
-  vector<const DFDCPseudo*>::const_reverse_iterator iter;
-  for(iter=fdchits_in_sorted.rbegin(); iter!=fdchits_in_sorted.rend(); iter++){
-    const DFDCPseudo *hit = *iter;
+  for(int ihit=(int)fdchits.size()-1; ihit>=0; ihit--){
+    const DFDCPseudo *hit = fdchits[ihit];
+
+    // Skip hit if its wire is too far from the trajectory for the DOCA
+    // to pass the cut below
+    if (hit_index && !in_corridor[ihit]) continue;
     
     // Find the DOCA to this wire
     double s=0.;
@@ -7,6 +7,9 @@
 
 #ifndef _DTrackHitSelectorALT2_
 #define _DTrackHitSelectorALT2_
+#include <memory>
+#include <mutex>
+
 #include <TMath.h>
 #include <TTree.h>
 #include <JANA/jerror.h>
@@ -14,6 +17,7 @@
 
 
 #include <TRACKING/DTrackHitSelector.h>
+#include <TRACKING/DTrackHitIndex.h>
 
 class DTrackHitSelectorALT2:public DTrackHitSelector{
 	public:
@@ -29,6 +33,16 @@ class DTrackHitSelectorALT2:public DTrackHitSelector{
 	private:
 		const DMagneticFieldMap *bfield;
 
+		std::shared_ptr<const DCDCHitIndex> GetCDCHitIndex(const vector<const DCDCTrackHit*> &cdchits_in) const;
+		std::shared_ptr<const DFDCHitIndex> GetFDCHitIndex(const vector<const DFDCPseudo*> &fdchits_in) const;
+
+		// Index of the hits passed in most recently. These are shared by
+		// all threads using this hit selector so access is through the
+		// mutex.
+		mutable std::mutex hit_index_mutex;
+		mutable std::shared_ptr<const DCDCHitIndex> cdc_hit_index;
+		mutable std::shared_ptr<const DFDCHitIndex> fdc_hit_index;
+
 		int HS_DEBUG_LEVEL;
 		bool MAKE_DEBUG_TREES;
 		double MIN_HIT_PROB_CDC;
@@ -38,6 +52,8 @@ class DTrackHitSelectorALT2:public DTrackHitSelector{
 		double MIN_FDC_SIGMA_ANODE_WIREBASED;
 		double MIN_FDC_SIGMA_CATHODE_WIREBASED;
 		double MAX_DOCA;
+		bool USE_HIT_INDEX;
+		double HIT_INDEX_MARGIN;
 		
 		TTree *cdchitsel;
 		TTree *fdchitsel;
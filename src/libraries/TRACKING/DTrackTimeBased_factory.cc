@@ -149,6 +149,17 @@ jerror_t DTrackTimeBased_factory::init(void)
 	
 	USE_BCAL_TIME=true;
 	gPARMS->SetDefaultParameter("TRKFIT:USE_BCAL_TIME",USE_BCAL_TIME);
+
+	PARALLEL_FIT_THREADS=0;
+	gPARMS->SetDefaultParameter("TRKFIT:PARALLEL_FIT_THREADS",PARALLEL_FIT_THREADS,
+				    "Number of extra threads each event processing thread may use to fit the tracks of a single event (0=fit all tracks in the event processing thread)");
+	PARALLEL_FIT_MIN_TRACKS=10;
+	gPARMS->SetDefaultParameter("TRKFIT:PARALLEL_FIT_MIN_TRACKS",PARALLEL_FIT_MIN_TRACKS,
+				    "Minimum number of tracks in an event for its fits to be spread over threads when TRKFIT:PARALLEL_FIT_THREADS>0");
+	// The hit selector debug trees are filled without a lock, so fits
+	// are not spread over threads when they are being made
+	MAKE_DEBUG_TREES=false;
+	gPARMS->SetDefaultParameter("TRKFIT:MAKE_DEBUG_TREES",MAKE_DEBUG_TREES,"Create a TTree with debugging info on hit selection for the FDC and CDC");
        
 	return NOERROR;
 }
@@ -175,6 +186,10 @@ jerror_t DTrackTimeBased_factory::brun(jana::JEventLoop *loop, int32_t runnumber
     ClearFactoryFlag(NOT_OBJECT_OWNER); //This factory will create it's own obje
   }
 
+  // The task pool for parallel fits is shared with the other tracking
+  // factories of this thread
+  if(!dTrackingWorkspace) dTrackingWorkspace = DTrackingWorkspace::Get(loop);
+
   // Get pointer to TrackFitter object that actually fits a track
   vector<const DTrackFitter *> fitters;
   loop->Get(fitters);
@@ -185,6 +200,10 @@ jerror_t DTrackTimeBased_factory::brun(jana::JEventLoop *loop, int32_t runnumber
   
   // Drop the const qualifier from the DTrackFitter pointer (I'm surely going to hell for this!)
   fitter = const_cast<DTrackFitter*>(fitters[0]);
+
+  // Fitters used by the extra threads hold calibration constants for
+  // the previous run. They are remade as needed in evnt.
+  dTrackingWorkspace->DeleteHelperFitters();
   
   // Warn user if something happened that caused us NOT to get a fitter object pointer
   if(!fitter){
@@ -289,21 +308,75 @@ jerror_t DTrackTimeBased_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
   vector<const DMCThrown*> mcthrowns;
   loop->Get(mcthrowns, "FinalState");
    
-  // Loop over candidates
+  // Hits and hit selector used when hits are not taken from the
+  // wire-based fit. These are gotten here so that the fits
+  // themselves don't need the JEventLoop.
+  const DTrackHitSelector *hitselector=NULL;
+  vector<const DCDCTrackHit*>cdctrackhits;
+  vector<const DFDCPseudo*>fdcpseudos;
+  if (!USE_HITS_FROM_WIREBASED_FIT){
+    vector<const DTrackHitSelector *> hitselectors;
+    loop->Get(hitselectors);
+    if(hitselectors.size()>0) hitselector=hitselectors[0];
+    loop->Get(cdctrackhits);
+    loop->Get(fdcpseudos);
+  }
+
+  // Create vectors of start times from various sources
+  vector<vector<DTrackTimeBased::DStartTime_t> >start_times(tracks.size());
   for(unsigned int i=0; i<tracks.size(); i++){
-    const DTrackWireBased *track = tracks[i];
+    CreateStartTimeList(tracks[i],sc_hits,tof_points,bcal_showers,fcal_showers,
+			start_times[i]);
+  }
 
-    unsigned int num=_data.size();
+  // Fit the tracks. For events with many tracks the fits may be spread
+  // over several threads. Results are kept in the order of the 
+  // wire-based tracks either way.
+  vector<DTrackTimeBased*>fit_results(tracks.size(),NULL);
+  bool fit_in_parallel=(PARALLEL_FIT_THREADS>0 && !DEBUG_HISTS && !MAKE_DEBUG_TREES
+			&& tracks.size()>=PARALLEL_FIT_MIN_TRACKS);
+  DTrackFitTaskPool *fit_pool=NULL;
+  if (fit_in_parallel){
+    fit_pool=dTrackingWorkspace->Get_FitTaskPool(PARALLEL_FIT_THREADS);
+    if (!fit_pool->HasFitters(fitter) && !fit_pool->MakeFitters(fitter,loop)){
+      static once_flag fitter_warn_flag;
+      call_once(fitter_warn_flag, [this](){
+	  jout << "TRKFIT:PARALLEL_FIT_THREADS>0 but the "<< fitter->Name() 
+	       << " fitter can't be used by more than one thread (e.g. with KALMAN:DEBUG_HISTS). Tracks will be fit serially." << endl;
+	});
+      fit_in_parallel=false;
+    }
+  }
+  if (fit_in_parallel){
+    // Start the fits with the most hits (largest Ndof from the wire-based
+    // fit) first so that a long fit does not end up running on its own
+    // at the end.
+    vector<unsigned int>order(tracks.size());
+    for(unsigned int i=0; i<tracks.size(); i++) order[i]=i;
+    stable_sort(order.begin(),order.end(),[&tracks](unsigned int a,unsigned int b){
+	return tracks[a]->Ndof>tracks[b]->Ndof;
+      });
+
+    fit_pool->Run(tracks.size(),[&](unsigned int itask,unsigned int iworker){
+	unsigned int i=order[itask];
+	fit_results[i]=DoFit(fit_pool->GetFitter(iworker),tracks[i],start_times[i],
+			     hitselector,cdctrackhits,fdcpseudos,tracks[i]->mass());
+      });
+  }
+  else{
+    for(unsigned int i=0; i<tracks.size(); i++){
+      fit_results[i]=DoFit(fitter,tracks[i],start_times[i],hitselector,
+			   cdctrackhits,fdcpseudos,tracks[i]->mass());
+    }
+  }
 
-    // Create vector of start times from various sources
-    vector<DTrackTimeBased::DStartTime_t>start_times;
-    CreateStartTimeList(track,sc_hits,tof_points,bcal_showers,fcal_showers,start_times);
+  // Loop over candidates
+  for(unsigned int i=0; i<tracks.size(); i++){
+    if (fit_results[i]==NULL) continue;
+    _data.push_back(fit_results[i]);
 	
-    // Fit the track
-    DoFit(track,start_times,loop,track->mass());
-  
     //_DBG_<< "eventnumber:   " << eventnumber << endl;
-    if (PID_FORCE_TRUTH && _data.size()>num) {
+    if (PID_FORCE_TRUTH) {
       // Add figure-of-merit based on difference between thrown and reconstructed momentum 
       // if more than half of the track's hits match MC truth hits and also (charge,mass)
       // match; add FOM=0 otherwise	  
@@ -351,6 +424,8 @@ jerror_t DTrackTimeBased_factory::erun(void)
 //------------------
 jerror_t DTrackTimeBased_factory::fini(void)
 {
+	dTrackingWorkspace.reset();
+
 	return NOERROR;
 }
 
@@ -694,20 +769,21 @@ void DTrackTimeBased_factory
   start_time.system=track->t0_detector();
   start_times.push_back(start_time);
 
-  // Set t0 for the fit to the first entry in the list. Usually this will be
-  // from the start counter.
-  mStartTime=start_times[0].t0;
-  mStartDetector=start_times[0].system;
-
-  //  _DBG_ << mStartDetector << " " << mStartTime << endl;
-
 }
 
 // Create a list of start times and do the fit for a particular mass hypothesis
-bool DTrackTimeBased_factory::DoFit(const DTrackWireBased *track,
-				    vector<DTrackTimeBased::DStartTime_t>&start_times,
-				    JEventLoop *loop,
-				    double mass){  
+DTrackTimeBased* DTrackTimeBased_factory::DoFit(DTrackFitter *fitter,
+						const DTrackWireBased *track,
+						const vector<DTrackTimeBased::DStartTime_t>&start_times,
+						const DTrackHitSelector *hitselector,
+						const vector<const DCDCTrackHit*>&cdctrackhits,
+						const vector<const DFDCPseudo*>&fdcpseudos,
+						double mass){  
+  /// Fit the track with the given fitter and return a new DTrackTimeBased
+  /// object with the results (or NULL if the fit failed). This does not
+  /// use the JEventLoop or modify the factory so it may be called for
+  /// different tracks at the same time from several threads, as long as
+  /// each uses its own fitter.
   if(DEBUG_LEVEL>1){_DBG__;_DBG_<<"---- Starting time based fit with mass: "<<mass<<endl;}
   // Get the hits from the wire-based track
   vector<const DFDCPseudo*>myfdchits;
@@ -715,6 +791,11 @@ bool DTrackTimeBased_factory::DoFit(const DTrackWireBased *track,
   vector<const DCDCTrackHit *>mycdchits;
   track->GetT(mycdchits);
 
+  // Set t0 for the fit to the first entry in the list. Usually this will be
+  // from the start counter.
+  double locStartTime=start_times[0].t0;
+  DetectorSystem_t locStartDetector=start_times[0].system;
+
   // Do the fit
   DTrackFitter::fit_status_t status = DTrackFitter::kFitNotDone;
   if (USE_HITS_FROM_WIREBASED_FIT) {
@@ -725,15 +806,16 @@ bool DTrackTimeBased_factory::DoFit(const DTrackWireBased *track,
     fitter->AddHits(mycdchits);
 
     status=fitter->FitTrack(track->position(),track->momentum(),
-			    track->charge(),mass,mStartTime,mStartDetector);
+			    track->charge(),mass,locStartTime,locStartDetector);
   }   
   else{   
     fitter->Reset();
     fitter->SetFitType(DTrackFitter::kTimeBased);    
-    status = fitter->FindHitsAndFitTrack(*track, track->extrapolations,loop, 
+    status = fitter->FindHitsAndFitTrack(*track, track->extrapolations,
+					 hitselector,cdctrackhits,fdcpseudos,
 					 mass,
 					 mycdchits.size()+2*myfdchits.size(),
-					 mStartTime,mStartDetector);
+					 locStartTime,locStartDetector);
     
     // If the status is kFitNotDone, then not enough hits were attached to this
     // track using the hit-gathering algorithm.  In this case get the hits 
@@ -746,7 +828,7 @@ bool DTrackTimeBased_factory::DoFit(const DTrackWireBased *track,
       fitter->AddHits(mycdchits);
       
       status=fitter->FitTrack(track->position(),track->momentum(),
-			      track->charge(),mass,mStartTime,mStartDetector);
+			      track->charge(),mass,locStartTime,locStartDetector);
     }
 
   }
@@ -823,10 +905,7 @@ bool DTrackTimeBased_factory::DoFit(const DTrackWireBased *track,
  	  timebased_track->potential_fdc_hits_on_track = fitter->GetNumPotentialFDCHits();
 
       timebased_track->AddAssociatedObject(track);
-      _data.push_back(timebased_track);
-      
-      return true;
-      break;
+      return timebased_track;
     }
   case DTrackFitter::kFitSuccess:
     {
@@ -834,7 +913,7 @@ bool DTrackTimeBased_factory::DoFit(const DTrackWireBased *track,
       DTrackTimeBased *timebased_track = new DTrackTimeBased();
       *static_cast<DTrackingData*>(timebased_track) = fitter->GetFitParameters();
 
-      timebased_track->setTime(mStartTime);
+      timebased_track->setTime(locStartTime);
       timebased_track->chisq = fitter->GetChisq();
       timebased_track->Ndof = fitter->GetNdof();
       timebased_track->pulls = std::move(fitter->GetPulls());  
@@ -845,16 +924,16 @@ bool DTrackTimeBased_factory::DoFit(const DTrackWireBased *track,
       timebased_track->flags=DTrackTimeBased::FLAG__GOODFIT;
       
       // Set the start time and add the list of start times
-      timebased_track->setT0(mStartTime,start_times[0].t0_sigma, mStartDetector);
+      timebased_track->setT0(locStartTime,start_times[0].t0_sigma, locStartDetector);
       timebased_track->start_times.assign(start_times.begin(), start_times.end());
 	  
       if (DEBUG_HISTS){
 	int id=0;
-	if (mStartDetector==SYS_CDC) id=1;
-	else if (mStartDetector==SYS_FDC) id=2;
-	else if (mStartDetector==SYS_BCAL) id=3;
-	else if (mStartDetector==SYS_FCAL) id=4;
-	else if (mStartDetector==SYS_TOF) id=5;
+	if (locStartDetector==SYS_CDC) id=1;
+	else if (locStartDetector==SYS_FDC) id=2;
+	else if (locStartDetector==SYS_BCAL) id=3;
+	else if (locStartDetector==SYS_FCAL) id=4;
+	else if (locStartDetector==SYS_TOF) id=5;
 
 	Hstart_time->Fill(start_times[0].t0,id);
       }
@@ -928,16 +1007,13 @@ bool DTrackTimeBased_factory::DoFit(const DTrackWireBased *track,
       timebased_track->FOM = TMath::Prob(timebased_track->chisq, timebased_track->Ndof);
       //_DBG_<< "FOM:   " << timebased_track->FOM << endl;
 
-      _data.push_back(timebased_track);
-     
-      return true;
-      break;
+      return timebased_track;
 	  
     }
   default:
     break;
   }
-  return false;
+  return NULL;
 }
 
 
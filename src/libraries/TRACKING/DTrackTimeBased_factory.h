@@ -25,6 +25,8 @@
 #include "DTrackFitter.h"
 #include "DTrackTimeBased.h"
 #include "DReferenceTrajectory.h"
+#include "DTrackFitTaskPool.h"
+#include "DTrackingWorkspace.h"
 
 class DTrackWireBased;
 class DTrackHitSelector;
@@ -48,8 +50,12 @@ class DTrackTimeBased_factory:public jana::JFactory<DTrackTimeBased>{
   int DEBUG_LEVEL;
   bool PID_FORCE_TRUTH;
   bool USE_HITS_FROM_WIREBASED_FIT;
+  unsigned int PARALLEL_FIT_THREADS;
+  unsigned int PARALLEL_FIT_MIN_TRACKS;
+  bool MAKE_DEBUG_TREES;
 
   DTrackFitter *fitter;
+  shared_ptr<DTrackingWorkspace> dTrackingWorkspace; // (task pool shared with DTrackWireBased_factory)
   const DParticleID* pid_algorithm;
   vector<int> mass_hypotheses_positive;
   vector<int> mass_hypotheses_negative;
@@ -71,9 +77,13 @@ class DTrackTimeBased_factory:public jana::JFactory<DTrackTimeBased>{
 			   vector<const DBCALShower*>&bcal_showers,	  
 			   vector<const DFCALShower*>&fcal_showers,
 			   vector<DTrackTimeBased::DStartTime_t>&start_times);
-  bool DoFit(const DTrackWireBased *track,
-	     vector<DTrackTimeBased::DStartTime_t>&start_times,
-	     JEventLoop *loop,double mass);  
+  DTrackTimeBased* DoFit(DTrackFitter *fitter,
+			 const DTrackWireBased *track,
+			 const vector<DTrackTimeBased::DStartTime_t>&start_times,
+			 const DTrackHitSelector *hitselector,
+			 const vector<const DCDCTrackHit*>&cdctrackhits,
+			 const vector<const DFDCPseudo*>&fdcpseudos,
+			 double mass);  
 
   void AddMissingTrackHypothesis(vector<DTrackTimeBased*>&tracks_to_add,
 				 const DTrackTimeBased *src_track,
@@ -89,10 +99,6 @@ class DTrackTimeBased_factory:public jana::JFactory<DTrackTimeBased>{
   // Geometry
   const DGeometry *geom;
 
-//  double mPathLength,mEndTime,mStartTime,mFlightTime;
-  double mStartTime;
-//  DetectorSystem_t mDetector, mStartDetector;
-  DetectorSystem_t mStartDetector;
   int mNumHypPlus,mNumHypMinus;
   bool dIsNoFieldFlag;
   bool USE_SC_TIME; // use start counter hits for t0
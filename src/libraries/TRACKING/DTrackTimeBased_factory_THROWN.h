@@ -10,6 +10,7 @@
 
 #include <JANA/JFactory.h>
 #include <TRACKING/DReferenceTrajectory.h>
+#include <TRACKING/DTrackingWorkspace.h>
 #include <HDGEOMETRY/DRootGeom.h>
 #include <HDGEOMETRY/DGeometry.h>
 #include <HDGEOMETRY/DMagneticFieldMap.h>
@@ -31,12 +32,13 @@ class DTrackTimeBased_factory_THROWN:public JFactory<DTrackTimeBased>{
 		jerror_t brun(JEventLoop *eventLoop, int32_t runnumber);	///< Called everytime a new run number is detected.
 		jerror_t evnt(JEventLoop *eventLoop, uint64_t eventnumber);	///< Called every event.
 		//jerror_t erun(void);						///< Called everytime run number changes, provided brun has been called.
-		//jerror_t fini(void);						///< Called after last event of last event source has been processed.
+		jerror_t fini(void);						///< Called after last event of last event source has been processed.
 		
 		DTrackFitter *fitter;
 		const DTrackHitSelector *hitselector;
 		const DParticleID* dParticleID;
-		vector<DReferenceTrajectory*> rt_pool;
+		shared_ptr<DTrackingWorkspace> dTrackingWorkspace;
+		vector<DReferenceTrajectory*> rts_in_use; // given back at the start of the next event
 		
 		DRootGeom *RootGeom;
 		DGeometry *geom;
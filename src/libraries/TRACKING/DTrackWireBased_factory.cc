@@ -74,6 +74,7 @@ bool DTrackWireBased_cmp(DTrackWireBased *a,DTrackWireBased *b){
 jerror_t DTrackWireBased_factory::init(void)
 {
    fitter = NULL;
+   rt = NULL;
 
    //DEBUG_HISTS = true;	
    DEBUG_HISTS = false;
@@ -146,6 +147,17 @@ jerror_t DTrackWireBased_factory::init(void)
    mNumHypPlus=mass_hypotheses_positive.size();
    mNumHypMinus=mass_hypotheses_negative.size();
 
+   PARALLEL_FIT_THREADS=0;
+   gPARMS->SetDefaultParameter("TRKFIT:PARALLEL_FIT_THREADS",PARALLEL_FIT_THREADS,
+			       "Number of extra threads each event processing thread may use to fit the tracks of a single event (0=fit all tracks in the event processing thread)");
+   PARALLEL_FIT_MIN_TRACKS=10;
+   gPARMS->SetDefaultParameter("TRKFIT:PARALLEL_FIT_MIN_TRACKS",PARALLEL_FIT_MIN_TRACKS,
+			       "Minimum number of tracks in an event for its fits to be spread over threads when TRKFIT:PARALLEL_FIT_THREADS>0");
+   // The hit selector debug trees are filled without a lock, so fits
+   // are not spread over threads when they are being made
+   MAKE_DEBUG_TREES=false;
+   gPARMS->SetDefaultParameter("TRKFIT:MAKE_DEBUG_TREES",MAKE_DEBUG_TREES,"Create a TTree with debugging info on hit selection for the FDC and CDC");
+
    return NOERROR;
 }
 
@@ -158,7 +170,7 @@ jerror_t DTrackWireBased_factory::brun(jana::JEventLoop *loop, int32_t runnumber
    DApplication* dapp=dynamic_cast<DApplication*>(loop->GetJApplication());
    geom = dapp->GetDGeometry(runnumber);
    // Check for magnetic field
-   const DMagneticFieldMap *bfield=dapp->GetBfield(runnumber);
+   bfield=dapp->GetBfield(runnumber);
    dIsNoFieldFlag = (dynamic_cast<const DMagneticFieldMapNoField*>(bfield) != NULL);
    
    if(dIsNoFieldFlag){
@@ -172,9 +184,8 @@ jerror_t DTrackWireBased_factory::brun(jana::JEventLoop *loop, int32_t runnumber
      ClearFactoryFlag(NOT_OBJECT_OWNER); //This factory will create it's own obje
    }
 
-   // set up reference trajectory
-   rt = new DReferenceTrajectory(bfield);
-   rt->SetDGeometry(geom);
+   // Reference trajectories come from the workspace for this thread
+   if(!dTrackingWorkspace) dTrackingWorkspace = DTrackingWorkspace::Get(loop);
 
    // Get pointer to DTrackFitter object that actually fits a track
    vector<const DTrackFitter *> fitters;
@@ -188,6 +199,10 @@ jerror_t DTrackWireBased_factory::brun(jana::JEventLoop *loop, int32_t runnumber
    // Drop the const qualifier from the DTrackFitter pointer (I'm surely going to hell for this!)
    fitter = const_cast<DTrackFitter*>(fitters[0]);
 
+   // Fitters used by the extra threads are for the previous run. They
+   // are remade as needed in evnt.
+   dTrackingWorkspace->DeleteHelperFitters();
+
    // Warn user if something happened that caused us NOT to get a fitter object pointer
    if(!fitter){
       _DBG_<<"Unable to get a DTrackFitter object! NO Charged track fitting will be done!"<<endl;
@@ -275,7 +290,13 @@ jerror_t DTrackWireBased_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
 
    if (candidates.size()==0) return NOERROR;
 
-   // Loop over candidates
+   // Reference trajectory used for the fits. It is given back to the
+   // workspace at the end of the event.
+   rt = dTrackingWorkspace->Get_ReferenceTrajectory(bfield, geom);
+
+   // Make a list of the fits to do: one for each candidate and mass 
+   // hypothesis.
+   vector<pair<unsigned int,double> >fits; // (candidate index,mass)
    for(unsigned int i=0; i<candidates.size(); i++){
       const DTrackCandidate *candidate = candidates[i];
 
@@ -285,14 +306,10 @@ jerror_t DTrackWireBased_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
       }
 
       if (SKIP_MASS_HYPOTHESES_WIRE_BASED){
-	rt->Reset();
-	rt->q = candidate->charge();
-
-	DoFit(i,candidate,rt,loop,ParticleMass(PiPlus));
+	fits.push_back(make_pair(i,ParticleMass(PiPlus)));
 	// Only do fit for proton mass hypothesis for low momentum particles
 	if (candidate->momentum().Mag()<PROTON_MOM_THRESH){
-	  rt->Reset();
-	  DoFit(i,candidate,rt,loop,ParticleMass(Proton));
+	  fits.push_back(make_pair(i,ParticleMass(Proton)));
 	}
       }
       else{
@@ -311,14 +328,91 @@ jerror_t DTrackWireBased_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
          for(unsigned int j=0; j<mass_hypotheses.size(); j++){
             if(DEBUG_LEVEL>1){_DBG__;_DBG_<<"---- Starting wire based fit with id: "<<mass_hypotheses[j]<<endl;}
 
-	    rt->Reset();
-            rt->q = candidate->charge();
-            DoFit(i,candidate,rt,loop,ParticleMass(Particle_t(mass_hypotheses[j])));
+            fits.push_back(make_pair(i,ParticleMass(Particle_t(mass_hypotheses[j]))));
          }
 
       }
    }
 
+   // Hits and hit selector used when hits are not taken from the
+   // candidate. These are gotten here so that the fits themselves
+   // don't need the JEventLoop.
+   const DTrackHitSelector *hitselector=NULL;
+   vector<const DCDCTrackHit*>cdctrackhits;
+   vector<const DFDCPseudo*>fdcpseudos;
+   if (!USE_HITS_FROM_CANDIDATE && fits.size()>0){
+      vector<const DTrackHitSelector *> hitselectors;
+      loop->Get(hitselectors);
+      if(hitselectors.size()>0) hitselector=hitselectors[0];
+      loop->Get(cdctrackhits);
+      loop->Get(fdcpseudos);
+   }
+
+   // Do the fits. For events with many candidates the fits may be 
+   // spread over several threads. Results are kept in the same order
+   // either way.
+   vector<DTrackWireBased*>fit_results(fits.size(),NULL);
+   bool fit_in_parallel=(PARALLEL_FIT_THREADS>0 && !DEBUG_HISTS && !MAKE_DEBUG_TREES
+			 && candidates.size()>=PARALLEL_FIT_MIN_TRACKS);
+   DTrackFitTaskPool *fit_pool=NULL;
+   if (fit_in_parallel){
+      fit_pool=dTrackingWorkspace->Get_FitTaskPool(PARALLEL_FIT_THREADS);
+      if (!fit_pool->HasFitters(fitter) && !fit_pool->MakeFitters(fitter,loop)){
+	 static once_flag fitter_warn_flag;
+	 call_once(fitter_warn_flag, [this](){
+	       jout << "TRKFIT:PARALLEL_FIT_THREADS>0 but the "<< fitter->Name() 
+		    << " fitter can't be used by more than one thread (e.g. with KALMAN:DEBUG_HISTS). Tracks will be fit serially." << endl;
+	    });
+	 fit_in_parallel=false;
+      }
+   }
+   if (fit_in_parallel){
+      // Each helper thread needs its own reference trajectory
+      while (worker_rts.size()+1<fit_pool->GetNworkers()){
+	 worker_rts.push_back(dTrackingWorkspace->Get_ReferenceTrajectory(bfield, geom));
+      }
+
+      // Start the fits for candidates with the most hits first so that
+      // a long fit does not end up running on its own at the end.
+      vector<unsigned int>nhits(candidates.size());
+      for(unsigned int i=0; i<candidates.size(); i++){
+	 vector<const DFDCPseudo*>myfdchits;
+	 vector<const DCDCTrackHit *>mycdchits;
+	 candidates[i]->GetT(myfdchits);
+	 candidates[i]->GetT(mycdchits);
+	 nhits[i]=myfdchits.size()+mycdchits.size();
+      }
+      vector<unsigned int>order(fits.size());
+      for(unsigned int k=0; k<fits.size(); k++) order[k]=k;
+      stable_sort(order.begin(),order.end(),[&](unsigned int a,unsigned int b){
+	    return nhits[fits[a].first]>nhits[fits[b].first];
+	 });
+
+      fit_pool->Run(fits.size(),[&](unsigned int itask,unsigned int iworker){
+	    unsigned int k=order[itask];
+	    const DTrackCandidate *candidate=candidates[fits[k].first];
+	    DReferenceTrajectory *my_rt=(iworker==0)?rt:worker_rts[iworker-1];
+	    my_rt->Reset();
+	    my_rt->q = candidate->charge();
+	    fit_results[k]=DoFit(fit_pool->GetFitter(iworker),fits[k].first,
+				 candidate,my_rt,hitselector,cdctrackhits,
+				 fdcpseudos,fits[k].second);
+	 });
+      dTrackingWorkspace->Recycle_ReferenceTrajectories(worker_rts);
+   }
+   else{
+      for(unsigned int k=0; k<fits.size(); k++){
+	 const DTrackCandidate *candidate=candidates[fits[k].first];
+	 rt->Reset();
+	 rt->q = candidate->charge();
+	 fit_results[k]=DoFit(fitter,fits[k].first,candidate,rt,hitselector,
+			      cdctrackhits,fdcpseudos,fits[k].second);
+      }
+   }
+   for(unsigned int k=0; k<fit_results.size(); k++){
+      if (fit_results[k]) _data.push_back(fit_results[k]);
+   }
+
    // Filter out duplicate tracks
    FilterDuplicates();
 
@@ -327,6 +421,9 @@ jerror_t DTrackWireBased_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
      InsertMissingHypotheses();
    }
 
+   dTrackingWorkspace->Recycle_ReferenceTrajectory(rt);
+   rt=NULL;
+
    return NOERROR;
 }
 
@@ -336,7 +433,6 @@ jerror_t DTrackWireBased_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
 //------------------
 jerror_t DTrackWireBased_factory::erun(void)
 {
-  if (rt) delete rt;
    return NOERROR;
 }
 
@@ -345,6 +441,7 @@ jerror_t DTrackWireBased_factory::erun(void)
 //------------------
 jerror_t DTrackWireBased_factory::fini(void)
 {
+   dTrackingWorkspace.reset();
 
    return NOERROR;
 }
@@ -429,10 +526,20 @@ void DTrackWireBased_factory::FilterDuplicates(void)
 }
 
 // Routine to find the hits, do the fit, and fill the list of wire-based tracks
-void DTrackWireBased_factory::DoFit(unsigned int c_id,
+DTrackWireBased* DTrackWireBased_factory::DoFit(DTrackFitter *fitter,
+      unsigned int c_id,
       const DTrackCandidate *candidate,
       DReferenceTrajectory *rt,
-      JEventLoop *loop, double mass){
+      const DTrackHitSelector *hitselector,
+      const vector<const DCDCTrackHit*> &cdctrackhits,
+      const vector<const DFDCPseudo*> &fdcpseudos,
+      double mass){
+   /// Fit the candidate with the given fitter and return a new
+   /// DTrackWireBased object with the results (or NULL if the fit
+   /// failed). This does not use the JEventLoop or modify the factory
+   /// so it may be called for different candidates at the same time
+   /// from several threads, as long as each uses its own fitter and
+   /// reference trajectory.
    // Get the hits from the candidate
   vector<const DFDCPseudo*>myfdchits;
   candidate->GetT(myfdchits);
@@ -460,7 +567,8 @@ void DTrackWireBased_factory::DoFit(unsigned int c_id,
       //rt->Swim(candidate->position(),candidate->momentum(),candidate->charge());
       rt->FastSwimForHitSelection(candidate->position(),candidate->momentum(),candidate->charge());
 
-      status=fitter->FindHitsAndFitTrack(*candidate,rt,loop,mass,
+      status=fitter->FindHitsAndFitTrack(*candidate,rt,hitselector,
+					 cdctrackhits,fdcpseudos,mass,
 					 mycdchits.size()+2*myfdchits.size());
       if (/*false && */status==DTrackFitter::kFitNotDone){
          if (DEBUG_LEVEL>1)_DBG_ << "Using hits from candidate..." << endl;
@@ -519,12 +627,12 @@ void DTrackWireBased_factory::DoFit(unsigned int c_id,
             // Add DTrackCandidate as associated object
             track->AddAssociatedObject(candidate);
 
-            _data.push_back(track);
-            break;
+            return track;
          }
       default:
          break;
    }
+   return NULL;
 }
 
 // If the fit failed for certain hypotheses, fill in the gaps using data from
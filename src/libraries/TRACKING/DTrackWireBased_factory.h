@@ -13,6 +13,8 @@
 
 #include <TRACKING/DTrackFitter.h>
 #include <TRACKING/DTrackHitSelector.h>
+#include <TRACKING/DTrackFitTaskPool.h>
+#include <TRACKING/DTrackingWorkspace.h>
 #include "PID/DParticleID.h"
 #include "HDGEOMETRY/DMagneticFieldMapNoField.h"
 
@@ -62,7 +64,17 @@ class DTrackWireBased_factory:public jana::JFactory<DTrackWireBased>{
 
 		int DEBUG_LEVEL;
 		DTrackFitter *fitter;
-		DReferenceTrajectory *rt;
+		DReferenceTrajectory *rt; // (only valid during evnt)
+		const DMagneticFieldMap *bfield;
+
+		// Reference trajectories and the task pool used to fit the tracks
+		// of one event on several threads are shared with the other
+		// tracking factories of this JEventLoop
+		shared_ptr<DTrackingWorkspace> dTrackingWorkspace;
+		unsigned int PARALLEL_FIT_THREADS;
+		unsigned int PARALLEL_FIT_MIN_TRACKS;
+		bool MAKE_DEBUG_TREES;
+		vector<DReferenceTrajectory*> worker_rts; // reference trajectories for helper threads (only valid during evnt)
 
 		vector<int> mass_hypotheses_positive;
 		vector<int> mass_hypotheses_negative;
@@ -70,9 +82,13 @@ class DTrackWireBased_factory:public jana::JFactory<DTrackWireBased>{
 		int mNumHypPlus,mNumHypMinus;
 
 		void FilterDuplicates(void);
-		void DoFit(unsigned int c_id,const DTrackCandidate *candidate,
-			   DReferenceTrajectory *rt,jana::JEventLoop *loop, 
-			   double mass);
+		DTrackWireBased* DoFit(DTrackFitter *fitter,unsigned int c_id,
+				       const DTrackCandidate *candidate,
+				       DReferenceTrajectory *rt,
+				       const DTrackHitSelector *hitselector,
+				       const vector<const DCDCTrackHit*> &cdctrackhits,
+				       const vector<const DFDCPseudo*> &fdcpseudos,
+				       double mass);
 		void AddMissingTrackHypothesis(vector<DTrackWireBased*>&tracks_to_add,
 					       const DTrackWireBased *src_track,
 					       double my_mass,double q);
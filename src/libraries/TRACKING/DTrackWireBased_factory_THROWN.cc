@@ -39,6 +39,10 @@ DTrackWireBased_factory_THROWN::DTrackWireBased_factory_THROWN()
 //------------------
 jerror_t DTrackWireBased_factory_THROWN::brun(jana::JEventLoop *loop, int32_t runnumber)
 {
+	// Reference trajectories come from the workspace shared with the
+	// other tracking factories of this thread
+	if(!dTrackingWorkspace) dTrackingWorkspace = DTrackingWorkspace::Get(loop);
+
 	// Get pointer to DTrackFitter object that actually fits a track
 	vector<const DTrackFitter *> fitters;
 	loop->Get(fitters);
@@ -83,6 +87,9 @@ jerror_t DTrackWireBased_factory_THROWN::brun(jana::JEventLoop *loop, int32_t ru
 //------------------
 jerror_t DTrackWireBased_factory_THROWN::evnt(JEventLoop *loop, uint64_t eventnumber)
 {
+	// The trajectories from the last event are no longer used
+	dTrackingWorkspace->Recycle_ReferenceTrajectories(rts_in_use);
+
 	vector<const DMCThrown*> mcthrowns;
 	vector<const DCDCTrackHit*> cdctrackhits;
 	vector<const DFDCPseudo*> fdcpseudos;
@@ -102,19 +109,10 @@ jerror_t DTrackWireBased_factory_THROWN::evnt(JEventLoop *loop, uint64_t eventnu
 		// Add DMCThrown as associated object
 		track->AddAssociatedObject(thrown);
 
-		// We need to swim a reference trajectory here. To avoid the overhead
-		// of allocating/deallocating them every event, we keep a pool and
-		// re-use them. If the pool is not big enough, then add one to the
-		// pool.
-      unsigned int locNumInitialReferenceTrajectories = rt_pool.size();
-		if(rt_pool.size()<=_data.size()){
-			// This is a little ugly, but only gets called a few times throughout the life of the process
-			// Note: these never get deleted, even at the end of process.
-			rt_pool.push_back(new DReferenceTrajectory(bfield));
-		}
-		DReferenceTrajectory *rt = rt_pool[_data.size()];
-      if(locNumInitialReferenceTrajectories == rt_pool.size()) //didn't create a new one
-        rt->Reset();
+		// We need to swim a reference trajectory here. It is taken from the
+		// workspace and given back at the start of the next event.
+		DReferenceTrajectory *rt = dTrackingWorkspace->Get_ReferenceTrajectory(bfield);
+		rts_in_use.push_back(rt);
       rt->q = track->charge();
 	       
 		DVector3 pos = track->position();
@@ -182,3 +180,14 @@ jerror_t DTrackWireBased_factory_THROWN::evnt(JEventLoop *loop, uint64_t eventnu
 	return NOERROR;
 }
 
+//------------------
+// fini
+//------------------
+jerror_t DTrackWireBased_factory_THROWN::fini(void)
+{
+	if(dTrackingWorkspace) dTrackingWorkspace->Recycle_ReferenceTrajectories(rts_in_use);
+	dTrackingWorkspace.reset();
+
+	return NOERROR;
+}
+
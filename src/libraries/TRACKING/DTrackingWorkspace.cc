@@ -0,0 +1,185 @@
+// $Id$
+//
+//    File: DTrackingWorkspace.cc
+// Created: Sun Oct 18 20:31:05 EDT 2026
+//
+
+#include <algorithm>
+using namespace std;
+
+#include "DTrackingWorkspace.h"
+#include "DReferenceTrajectory.h"
+#include "DTrackFitTaskPool.h"
+using namespace jana;
+
+mutex DTrackingWorkspace::dWorkspacesMutex;
+map<JEventLoop*, weak_ptr<DTrackingWorkspace> > DTrackingWorkspace::dWorkspaces;
+unsigned int DTrackingWorkspace::dNumWorkspaces = 0;
+unsigned int DTrackingWorkspace::dNumWorkspacesMax = 0;
+unsigned int DTrackingWorkspace::dNrt_in_use_max = 0;
+uint64_t DTrackingWorkspace::dNrt_in_use_sum = 0;
+size_t DTrackingWorkspace::dNrt_all_threads_max = 0;
+size_t DTrackingWorkspace::dNswim_step_blocks_max = 0;
+uint64_t DTrackingWorkspace::dNhelper_fitters = 0;
+
+//-------------------
+// Get
+//-------------------
+shared_ptr<DTrackingWorkspace> DTrackingWorkspace::Get(JEventLoop *loop)
+{
+	/// Return the workspace for the given JEventLoop, making it if
+	/// this is the first request for it.
+
+	lock_guard<mutex> lck(dWorkspacesMutex);
+
+	shared_ptr<DTrackingWorkspace> workspace = dWorkspaces[loop].lock();
+	if(!workspace){
+		workspace = shared_ptr<DTrackingWorkspace>(new DTrackingWorkspace());
+		dWorkspaces[loop] = workspace;
+		dNumWorkspaces++;
+		dNumWorkspacesMax = max(dNumWorkspacesMax, dNumWorkspaces);
+	}
+
+	return workspace;
+}
+
+//-------------------
+// DTrackingWorkspace  (Constructor)
+//-------------------
+DTrackingWorkspace::DTrackingWorkspace()
+{
+	dResourcePool_ReferenceTrajectory = make_shared<DResourcePool<DReferenceTrajectory> >(1, 1, 16, 32, 0);
+	fit_pool = NULL;
+
+	Nrt_in_use = 0;
+	Nrt_in_use_max = 0;
+	Nrt_all_threads_max = 0;
+	Nswim_step_blocks_max = 0;
+	Nhelper_fitters_max = 0;
+}
+
+//-------------------
+// ~DTrackingWorkspace  (Destructor)
+//-------------------
+DTrackingWorkspace::~DTrackingWorkspace()
+{
+	UpdateHelperFitterCount();
+	if(fit_pool) delete fit_pool;
+	fit_pool = NULL;
+
+	lock_guard<mutex> lck(dWorkspacesMutex);
+
+	// Forget about workspaces that no longer exist (including this one)
+	for(auto it=dWorkspaces.begin(); it!=dWorkspaces.end(); ){
+		if(it->second.expired())
+			it = dWorkspaces.erase(it);
+		else
+			it++;
+	}
+
+	dNrt_in_use_max = max(dNrt_in_use_max, Nrt_in_use_max);
+	dNrt_in_use_sum += Nrt_in_use_max;
+	dNrt_all_threads_max = max(dNrt_all_threads_max, Nrt_all_threads_max);
+	dNswim_step_blocks_max = max(dNswim_step_blocks_max, Nswim_step_blocks_max);
+	dNhelper_fitters += Nhelper_fitters_max;
+
+	if(--dNumWorkspaces == 0) PrintReport();
+}
+
+//-------------------
+// Get_ReferenceTrajectory
+//-------------------
+DReferenceTrajectory* DTrackingWorkspace::Get_ReferenceTrajectory(const DMagneticFieldMap *bfield, const DGeometry *geom)
+{
+	/// Get a reference trajectory set up as if it were just made with
+	/// the given field map and geometry. It must be given back with
+	/// Recycle_ReferenceTrajectory() once it is no longer needed.
+
+	DReferenceTrajectory *rt = dResourcePool_ReferenceTrajectory->Get_Resource();
+	rt->Reuse(bfield, geom);
+
+	Nrt_in_use++;
+	Nrt_in_use_max = max(Nrt_in_use_max, Nrt_in_use);
+	Nrt_all_threads_max = max(Nrt_all_threads_max, dResourcePool_ReferenceTrajectory->Get_NumObjectsAllThreads());
+	Nswim_step_blocks_max = max(Nswim_step_blocks_max, DReferenceTrajectory::GetNumSwimStepBlocks());
+
+	return rt;
+}
+
+//-------------------
+// Recycle_ReferenceTrajectory
+//-------------------
+void DTrackingWorkspace::Recycle_ReferenceTrajectory(DReferenceTrajectory *rt)
+{
+	if(!rt) return;
+	rt->Release();
+	dResourcePool_ReferenceTrajectory->Recycle(rt);
+	if(Nrt_in_use > 0) Nrt_in_use--;
+}
+
+//-------------------
+// Recycle_ReferenceTrajectories
+//-------------------
+void DTrackingWorkspace::Recycle_ReferenceTrajectories(vector<DReferenceTrajectory*> &rts)
+{
+	for(auto rt : rts) Recycle_ReferenceTrajectory(rt);
+	rts.clear();
+}
+
+//-------------------
+// Get_FitTaskPool
+//-------------------
+DTrackFitTaskPool* DTrackingWorkspace::Get_FitTaskPool(unsigned int Nhelpers)
+{
+	/// Return the task pool used to spread fits over Nhelpers extra
+	/// threads. The same pool (and its fitters) is returned to every
+	/// factory using this workspace.
+
+	UpdateHelperFitterCount();
+	if(fit_pool && fit_pool->GetNworkers()!=Nhelpers+1){
+		delete fit_pool;
+		fit_pool = NULL;
+	}
+	if(!fit_pool) fit_pool = new DTrackFitTaskPool(Nhelpers);
+
+	return fit_pool;
+}
+
+//-------------------
+// DeleteHelperFitters
+//-------------------
+void DTrackingWorkspace::DeleteHelperFitters(void)
+{
+	/// Delete the fitters of the task pool's helper threads. This should
+	/// be called when the run changes since the fitters are made from
+	/// the fitter for the previous run. They are made again the next
+	/// time the pool is used.
+	UpdateHelperFitterCount();
+	if(fit_pool) fit_pool->DeleteFitters();
+}
+
+//-------------------
+// UpdateHelperFitterCount
+//-------------------
+void DTrackingWorkspace::UpdateHelperFitterCount(void)
+{
+	// The first fitter of the task pool is the factory's own
+	if(fit_pool && fit_pool->GetNfitters()>1) Nhelper_fitters_max = max(Nhelper_fitters_max, fit_pool->GetNfitters()-1);
+}
+
+//-------------------
+// PrintReport
+//-------------------
+void DTrackingWorkspace::PrintReport(void)
+{
+	/// Print the high-water marks for the job. This is called (with
+	/// dWorkspacesMutex locked) when the last workspace is deleted.
+
+	if(dNrt_in_use_sum==0 && dNhelper_fitters==0) return;
+
+	jout << "Tracking workspace high-water marks (" << dNumWorkspacesMax << " event loops):" << endl;
+	jout << "   Reference trajectories in use at once: " << dNrt_in_use_max << " in one event loop, " << dNrt_in_use_sum << " summed over event loops" << endl;
+	jout << "   Reference trajectories allocated (all threads): " << dNrt_all_threads_max << endl;
+	jout << "   Swim step blocks allocated (all threads): " << dNswim_step_blocks_max << endl;
+	jout << "   Fitters for parallel fit helper threads: " << dNhelper_fitters << endl;
+}
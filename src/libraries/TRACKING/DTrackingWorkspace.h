@@ -0,0 +1,96 @@
+// $Id$
+//
+//    File: DTrackingWorkspace.h
+// Created: Sun Oct 18 20:31:05 EDT 2026
+//
+
+#ifndef _DTrackingWorkspace_
+#define _DTrackingWorkspace_
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <vector>
+
+#include <JANA/JEventLoop.h>
+#include <DResourcePool.h>
+
+class DReferenceTrajectory;
+class DMagneticFieldMap;
+class DGeometry;
+class DTrackFitTaskPool;
+
+///////////////////////////////////////////////////////////////////////
+/// The DTrackingWorkspace class holds the large, briefly used objects
+/// the tracking factories of one JEventLoop (i.e. one thread) need so
+/// that they are shared between the factories rather than each
+/// factory keeping its own copies:
+///
+///  - Reference trajectories come from a DResourcePool. A trajectory
+///    gives its block of swim steps back (see
+///    DReferenceTrajectory::Release()) when it is recycled so only as
+///    many blocks as are in use at one time are held.
+///
+///  - The DTrackFitTaskPool used to fit the tracks of one event on
+///    several threads (TRKFIT:PARALLEL_FIT_THREADS) is shared by the
+///    wire-based and time-based factories, along with the extra
+///    fitters for its helper threads. The fitters' trajectory buffers
+///    only grow to the size of the longest track they have fit.
+///
+/// Factories get the workspace for their JEventLoop with Get() and
+/// keep the shared_ptr until fini(). When the last workspace is
+/// deleted the high-water marks for the job are printed.
+///
+/// A workspace is not thread safe. Only the thread running its
+/// JEventLoop should get or recycle trajectories (a trajectory may be
+/// used on a helper thread in between).
+///////////////////////////////////////////////////////////////////////
+
+class DTrackingWorkspace{
+	public:
+		virtual ~DTrackingWorkspace();
+
+		static std::shared_ptr<DTrackingWorkspace> Get(jana::JEventLoop *loop);
+
+		DReferenceTrajectory* Get_ReferenceTrajectory(const DMagneticFieldMap *bfield, const DGeometry *geom=NULL);
+		void Recycle_ReferenceTrajectory(DReferenceTrajectory *rt);
+		void Recycle_ReferenceTrajectories(std::vector<DReferenceTrajectory*> &rts); // clears rts
+
+		DTrackFitTaskPool* Get_FitTaskPool(unsigned int Nhelpers);
+		void DeleteHelperFitters(void);
+
+	protected:
+		DTrackingWorkspace();
+
+		std::shared_ptr<DResourcePool<DReferenceTrajectory> > dResourcePool_ReferenceTrajectory;
+		DTrackFitTaskPool *fit_pool;
+
+		// High-water marks for this workspace
+		unsigned int Nrt_in_use;
+		unsigned int Nrt_in_use_max;
+		size_t Nrt_all_threads_max;        // reference trajectories existing in all threads
+		size_t Nswim_step_blocks_max;      // blocks of swim steps existing in all threads
+		unsigned int Nhelper_fitters_max;
+
+		// Totals over all workspaces
+		static std::mutex dWorkspacesMutex;
+		static std::map<jana::JEventLoop*, std::weak_ptr<DTrackingWorkspace> > dWorkspaces;
+		static unsigned int dNumWorkspaces;
+		static unsigned int dNumWorkspacesMax;
+		static unsigned int dNrt_in_use_max;     // largest for one workspace
+		static uint64_t dNrt_in_use_sum;         // sum of the largest for each workspace
+		static size_t dNrt_all_threads_max;
+		static size_t dNswim_step_blocks_max;
+		static uint64_t dNhelper_fitters;
+
+		void UpdateHelperFitterCount(void);
+		void PrintReport(void);
+
+	private:
+		DTrackingWorkspace(const DTrackingWorkspace&);
+		DTrackingWorkspace& operator=(const DTrackingWorkspace&);
+};
+
+#endif // _DTrackingWorkspace_
@@ -13,6 +13,7 @@
 #include <DAQ/DModuleType.h>
 #include <DAQ/JEventSource_EVIO.h>
 #include <DAQ/JEventSource_EVIOpp.h>
+#include <DAQ/DParsedEvent.h>
 #include <PAIR_SPECTROMETER/DPSGeometry.h>
 
 using namespace jana;
@@ -50,6 +51,12 @@ map<uint32_t, uint32_t>& DTranslationTable::Get_ROCID_Inv_Map(void) const
 	return rocid_inv_map;
 }
 
+DTranslationTable::DChannelLookup_t& DTranslationTable::Get_TT_Lookup(void) const
+{
+	static DTranslationTable::DChannelLookup_t tt_lookup; // (see CompileLookupTable() for details)
+	return tt_lookup;
+}
+
 map<DTranslationTable::Detector_t, set<uint32_t> >& DTranslationTable::Get_ROCID_By_System(void)
 {
 	static map<DTranslationTable::Detector_t, set<uint32_t> > rocid_by_system;
@@ -99,6 +106,7 @@ DTranslationTable::DTranslationTable(JEventLoop *loop)
    VERBOSE = 0;
    SYSTEMS_TO_PARSE = "";
    CALL_STACK = false;
+   DENSE_LOOKUP = true;
    gPARMS->SetDefaultParameter("TT:NO_CCDB", NO_CCDB, 
            "Don't try getting translation table from CCDB and just look"
            " for file. Only useful if you want to force reading tt.xml."
@@ -125,6 +133,10 @@ DTranslationTable::DTranslationTable(JEventLoop *loop)
 			"JANA call stack. You will want this if using the janadot"
 			"plugin, but otherwise, it will just give a slight performance"
 			"hit.");
+	gPARMS->SetDefaultParameter("TT:DENSE_LOOKUP", DENSE_LOOKUP,
+			"Set this to zero to find channels by searching the TT map"
+			" rather than using the compiled lookup table. The results"
+			" should be identical. This is only useful for debugging.");
 	if(SYSTEMS_TO_PARSE != ""){
 		jerr << "You have set the TT:SYSTEMS_TO_PARSE config. parameter." << endl;
 		jerr << "This is now deprecated. Please use EVIO:SYSTEMS_TO_PARSE" << endl;
@@ -149,6 +161,7 @@ DTranslationTable::DTranslationTable(JEventLoop *loop)
 	// Read in Translation table. This will create DChannelInfo objects
 	// and store them in the "TT" map, indexed by csc_t objects
 	ReadTranslationTable(loop->GetJCalibration());
+	tt_lookup = &Get_TT_Lookup();
    
 	// Set up pointers to the factories for this JEventLoop.
 	// (n.b. each JEventLoop will have it's own DTranslationTable object)
@@ -322,6 +335,19 @@ void DTranslationTable::SetSystemsToParse(string systems, JEventSource *eventsou
 
 }
 
+//---------------------------------
+// TranslateHits
+//---------------------------------
+template<class T>
+void DTranslationTable::TranslateHits(const vector<T*> &hits) const
+{
+   /// Make DigiHit objects for all of the given low level hits. T
+   /// may be either a const or non-const low level hit type.
+
+   if (VERBOSE > 2) ttout << "  Number " << remove_const<T>::type::static_className() << " objects: " << hits.size() << std::endl;
+   for (auto hit : hits) TranslateHit(hit);
+}
+
 //---------------------------------
 // ApplyTranslationTable
 //---------------------------------
@@ -343,362 +369,89 @@ void DTranslationTable::ApplyTranslationTable(JEventLoop *loop) const
    // of the loop->Get() call that we are already in. (Confusing eh?) 
    bool record_call_stack = loop->GetCallStackRecordingStatus();
    if (record_call_stack) loop->DisableCallStackRecording();
-   
+
    // Df250PulseIntegral (will apply Df250PulseTime via associated objects)
    vector<const Df250PulseIntegral*> pulseintegrals250;
    loop->Get(pulseintegrals250);
-   if (VERBOSE > 2) ttout << "  Number Df250PulseIntegral objects: "  << pulseintegrals250.size() << std::endl;
-   for (uint32_t i=0; i<pulseintegrals250.size(); i++) {
-      const Df250PulseIntegral *pi = pulseintegrals250[i];
-      
-      // Apply optional rocid translation
-      uint32_t rocid = pi->rocid;
-      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
-      if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
-      
-      if (VERBOSE > 4)
-         ttout << "    Looking for rocid:" << rocid << " slot:" << pi->slot
-               << " chan:" << pi->channel << std::endl;
-      
-      // Create crate,slot,channel index and find entry in Translation table.
-      // If none is found, then just quietly skip this hit.
-      csc_t csc = {rocid, pi->slot, pi->channel};
-      map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
-      if (iter == Get_TT().end()) {
-         if (VERBOSE > 6)
-            ttout << "     - Didn't find it" << std::endl;
-         continue;
-      }
-      const DChannelInfo &chaninfo = iter->second;
-      if (VERBOSE > 6)
-         ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys)
-               << std::endl;
-      
-      // Check for a pulse time (this should have been added in JEventSource_EVIO.cc)
-      const Df250PulseTime *pt = NULL;
-      const Df250PulsePedestal *pp = NULL;
-	  pi->GetSingle(pt);
-	  pi->GetSingle(pp);
-
-      // Avoid f250 Error with extra PulseIntegral word
-      if( pt == NULL || pp == NULL) continue;
-
-      // Create the appropriate hit type based on detector type
-      switch (chaninfo.det_sys) {
-         case BCAL:       MakeBCALDigiHit(chaninfo.bcal, pi, pt, pp);              break;
-         case FCAL:       MakeFCALDigiHit(chaninfo.fcal, pi, pt, pp);              break;
-         case CCAL:       MakeCCALDigiHit(chaninfo.ccal, pi, pt, pp);              break;
-         case CCAL_REF:   MakeCCALRefDigiHit(chaninfo.ccal_ref, pi, pt, pp);       break;
-         case SC:         MakeSCDigiHit(  chaninfo.sc, pi, pt, pp);                break;
-         case TOF:        MakeTOFDigiHit( chaninfo.tof, pi, pt, pp);               break;
-         case TAGM:       MakeTAGMDigiHit(chaninfo.tagm, pi, pt, pp);              break;
-         case TAGH:       MakeTAGHDigiHit(chaninfo.tagh, pi, pt, pp);              break;
-         case PS:         MakePSDigiHit(chaninfo.ps, pi, pt, pp);                  break;
-         case PSC:        MakePSCDigiHit(chaninfo.psc, pi, pt, pp);                break;
-         case RF:         MakeRFDigiTime(chaninfo.rf, pt);                         break;
-         case TPOLSECTOR: MakeTPOLSectorDigiHit(chaninfo.tpolsector, pi, pt, pp);  break;
-         case TAC:        MakeTACDigiHit(chaninfo.tac, pi, pt, pp);  	   	   break;
-
-         default:
-            if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
-            break;
-      }
-   }
+   TranslateHits(pulseintegrals250);
 
    // Df250PulseData
    vector<const Df250PulseData*> pulsedatas250;
    loop->Get(pulsedatas250);
-   if (VERBOSE > 2) ttout << "  Number Df250PulseData objects: "  << pulsedatas250.size() << std::endl;
-   for(auto pd : pulsedatas250){
-      
-      // Apply optional rocid translation
-      uint32_t rocid = pd->rocid;
-      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
-      if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
-      
-      if (VERBOSE > 4) ttout << "    Looking for rocid:" << rocid << " slot:" << pd->slot << " chan:" << pd->channel << std::endl;
-      
-      // Create crate,slot,channel index and find entry in Translation table.
-      // If none is found, then just quietly skip this hit.
-      csc_t csc = {rocid, pd->slot, pd->channel};
-      map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
-      if (iter == Get_TT().end()) {
-         if (VERBOSE > 6)  ttout << "     - Didn't find it" << std::endl;
-         continue;
-      }
-      const DChannelInfo &chaninfo = iter->second;
-      if (VERBOSE > 6) ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys) << std::endl;
-
-      // Create the appropriate hit type based on detector type
-      switch (chaninfo.det_sys) {
-         case BCAL:       MakeBCALDigiHit( chaninfo.bcal, pd);             break;
-         case FCAL:       MakeFCALDigiHit( chaninfo.fcal, pd);             break;
-         case CCAL:       MakeCCALDigiHit( chaninfo.ccal, pd);             break;
-         case CCAL_REF:   MakeCCALRefDigiHit( chaninfo.ccal_ref, pd);      break;	   
-         case SC:         MakeSCDigiHit(   chaninfo.sc,   pd);             break;
-         case TOF:        MakeTOFDigiHit(  chaninfo.tof,  pd);             break;
-         case TAGM:       MakeTAGMDigiHit( chaninfo.tagm, pd);             break;
-         case TAGH:       MakeTAGHDigiHit( chaninfo.tagh, pd);             break;
-         case PS:         MakePSDigiHit(   chaninfo.ps,   pd);             break;
-         case PSC:        MakePSCDigiHit(  chaninfo.psc,  pd);             break;
-         case RF:         MakeRFDigiTime(  chaninfo.rf,   pd);             break;
-         case TPOLSECTOR: MakeTPOLSectorDigiHit(chaninfo.tpolsector, pd);  break;
-         case TAC: 		  MakeTACDigiHit(chaninfo.tac, pd);  			   break;
-        default:
-            if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
-            break;
-      }
-   }
+   TranslateHits(pulsedatas250);
 
    // Df125PulseIntegral (will apply Df125PulseTime via associated objects)
    vector<const Df125PulseIntegral*> pulseintegrals125;
    loop->Get(pulseintegrals125);
-   if (VERBOSE > 2) ttout << "  Number Df125PulseIntegral objects: " << pulseintegrals125.size() << std::endl;
-   for (uint32_t i=0; i<pulseintegrals125.size(); i++) {
-      const Df125PulseIntegral *pi = pulseintegrals125[i];
-
-      // Apply optional rocid translation
-      uint32_t rocid = pi->rocid;
-      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
-      if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
-      
-      if (VERBOSE > 4)
-         ttout << "    Looking for rocid:" << rocid << " slot:" << pi->slot
-               << " chan:" << pi->channel << std::endl;
-   
-      // Create crate,slot,channel index and find entry in Translation table.
-      // If none is found, then just quietly skip this hit.
-      csc_t csc = {rocid, pi->slot, pi->channel};
-      map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
-      if (iter == Get_TT().end()) {
-          if (VERBOSE > 6)
-             ttout << "     - Didn't find it" << std::endl;
-          continue;
-      }
-      const DChannelInfo &chaninfo = iter->second;
-      if (VERBOSE > 6)
-         ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys) 
-               << std::endl;
-
-      // Check for a pulse time (this should have been added in JEventSource_EVIO.cc
-      const Df125PulseTime *pt = NULL;
-      const Df125PulsePedestal *pp = NULL;
-	  pi->GetSingle(pt);
-	  pi->GetSingle(pp);
-
-      // Create the appropriate hit type based on detector type
-      switch (chaninfo.det_sys) {
-         case CDC:           MakeCDCDigiHit(chaninfo.cdc, pi, pt, pp);                 break;
-         case FDC_CATHODES:  MakeFDCCathodeDigiHit(chaninfo.fdc_cathodes, pi, pt, pp); break;
-         default: 
-             if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl; 
-             break;
-      }
-   }
+   TranslateHits(pulseintegrals125);
 
    // Df125CDCPulse
    vector<const Df125CDCPulse*> cdcpulses;
    loop->Get(cdcpulses);
-   if (VERBOSE > 2) ttout << "  Number Df125CDCPulse objects: " << cdcpulses.size() << std::endl;
-   for (uint32_t i=0; i<cdcpulses.size(); i++) {
-      const Df125CDCPulse *p = cdcpulses[i];
-
-      // Apply optional rocid translation
-      uint32_t rocid = p->rocid;
-      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
-      if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
-      
-      if (VERBOSE > 4)
-         ttout << "    Looking for rocid:" << rocid << " slot:" << p->slot
-               << " chan:" << p->channel << std::endl;
-   
-      // Create crate,slot,channel index and find entry in Translation table.
-      // If none is found, then just quietly skip this hit.
-      csc_t csc = {rocid, p->slot, p->channel};
-      map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
-      if (iter == Get_TT().end()) {
-          if (VERBOSE > 6)
-             ttout << "     - Didn't find it" << std::endl;
-          continue;
-      }
-      const DChannelInfo &chaninfo = iter->second;
-      if (VERBOSE > 6)
-         ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys) 
-               << std::endl;
-
-      // Create the appropriate hit type based on detector type
-      switch (chaninfo.det_sys) {
-         case CDC:  MakeCDCDigiHit(chaninfo.cdc, p); break;
-         default: 
-             if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
-             break;
-      }
-   }
+   TranslateHits(cdcpulses);
 
    // Df125FDCPulse
    vector<const Df125FDCPulse*> fdcpulses;
    loop->Get(fdcpulses);
-   if (VERBOSE > 2) ttout << "  Number Df125FDCPulse objects: " << fdcpulses.size() << std::endl;
-   for (uint32_t i=0; i<fdcpulses.size(); i++) {
-      const Df125FDCPulse *p = fdcpulses[i];
-
-      // Apply optional rocid translation
-      uint32_t rocid = p->rocid;
-      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
-      if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
-      
-      if (VERBOSE > 4)
-         ttout << "    Looking for rocid:" << rocid << " slot:" << p->slot
-               << " chan:" << p->channel << std::endl;
-   
-      // Create crate,slot,channel index and find entry in Translation table.
-      // If none is found, then just quietly skip this hit.
-      csc_t csc = {rocid, p->slot, p->channel};
-      map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
-      if (iter == Get_TT().end()) {
-          if (VERBOSE > 6)
-             ttout << "     - Didn't find it" << std::endl;
-          continue;
-      }
-      const DChannelInfo &chaninfo = iter->second;
-      if (VERBOSE > 6)
-         ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys) 
-               << std::endl;
-
-      // Create the appropriate hit type based on detector type
-      switch (chaninfo.det_sys) {
-			case FDC_CATHODES:  MakeFDCCathodeDigiHit(chaninfo.fdc_cathodes, p); break;
-         case CDC         :  MakeCDCDigiHit(chaninfo.cdc, p); break;
-         default: 
-             if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
-             break;
-      }
-   }
+   TranslateHits(fdcpulses);
 
    // DF1TDCHit
    vector<const DF1TDCHit*> f1tdchits;
    loop->Get(f1tdchits);
-   if (VERBOSE > 2) ttout << "  Number DF1TDCHit objects: " << f1tdchits.size() << std::endl;
-   for (uint32_t i=0; i<f1tdchits.size(); i++) {
-      const DF1TDCHit *hit = f1tdchits[i];
-
-      // Apply optional rocid translation
-      uint32_t rocid = hit->rocid;
-      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
-      if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
-
-      if (VERBOSE > 4)
-         ttout << "    Looking for rocid:" << rocid << " slot:" << hit->slot
-               << " chan:" << hit->channel << std::endl;
-
-      // Create crate,slot,channel index and find entry in Translation table.
-      // If none is found, then just quietly skip this hit.
-      csc_t csc = {rocid, hit->slot, hit->channel};
-      map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
-      if (iter == Get_TT().end()) {
-          if (VERBOSE > 6)
-             ttout << "     - Didn't find it" << std::endl;
-          continue;
-      }
-      const DChannelInfo &chaninfo = iter->second;
-      if (VERBOSE > 6) 
-         ttout << "     - Found entry for: " 
-               << DetectorName(chaninfo.det_sys) << std::endl;
-      
-      // Create the appropriate hit type based on detector type
-      switch (chaninfo.det_sys) {
-         case BCAL:        MakeBCALTDCDigiHit(chaninfo.bcal, hit);      break;
-         case FDC_WIRES:   MakeFDCWireDigiHit(chaninfo.fdc_wires, hit); break;
-         case RF:          MakeRFTDCDigiTime(chaninfo.rf, hit);         break;
-         case SC:          MakeSCTDCDigiHit(chaninfo.sc, hit);          break;
-         case TAGM:        MakeTAGMTDCDigiHit(chaninfo.tagm, hit);      break;
-         case TAGH:        MakeTAGHTDCDigiHit(chaninfo.tagh, hit);      break;
-         case PSC:         MakePSCTDCDigiHit(chaninfo.psc, hit);        break;
-        default:
-             if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
-             break;
-      }
-   }
+   TranslateHits(f1tdchits);
 
    // DCAEN1290TDCHit
    vector<const DCAEN1290TDCHit*> caen1290tdchits;
    loop->Get(caen1290tdchits);
-   if (VERBOSE > 2) ttout << "  Number DCAEN1290TDCHit objects: " << caen1290tdchits.size() << std::endl;
-   for (uint32_t i=0; i<caen1290tdchits.size(); i++) {
-      const DCAEN1290TDCHit *hit = caen1290tdchits[i];
+   TranslateHits(caen1290tdchits);
 
-      // Apply optional rocid translation
-      uint32_t rocid = hit->rocid;
-      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
-      if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
-
-      if (VERBOSE > 4)
-         ttout << "    Looking for rocid:" << rocid << " slot:" << hit->slot
-               << " chan:" << hit->channel << std::endl;
-      
-      // Create crate,slot,channel index and find entry in Translation table.
-      // If none is found, then just quietly skip this hit.
-      csc_t csc = {rocid, hit->slot, hit->channel};
-      map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
-      if (iter == Get_TT().end()) {
-          if (VERBOSE > 6)
-             ttout << "     - Didn't find it" << std::endl;
-          continue;
-      }
-      const DChannelInfo &chaninfo = iter->second;
-      if (VERBOSE > 6)
-         ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys)
-               << std::endl;
-      
-      // Create the appropriate hit type based on detector type
-      switch (chaninfo.det_sys) {
-         case TOF:    MakeTOFTDCDigiHit(chaninfo.tof, hit); break;
-         case RF:     MakeRFTDCDigiTime(chaninfo.rf, hit);  break;
-         case TAC:    MakeTACTDCDigiHit(chaninfo.tac, hit); break;
-         default:     
-             if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
-             break;
-      }
-   }
-	
    // DDIRCTDCHit
    vector<const DDIRCTDCHit*> dirctdchits;
    loop->Get(dirctdchits);
-   if (VERBOSE > 2) ttout << "  Number DDIRCTDCHit objects: " << dirctdchits.size() << std::endl;
-   for (uint32_t i=0; i<dirctdchits.size(); i++) {
-      const DDIRCTDCHit *hit = dirctdchits[i];
+   TranslateHits(dirctdchits);
 
-      // Apply optional rocid translation
-      uint32_t rocid = hit->rocid;
-      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
-      if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
+   FinishTranslation(loop, record_call_stack, cdcpulses.size()>0, fdcpulses.size()>0);
+}
 
-      if (VERBOSE > 4)
-         ttout << "    Looking for rocid:" << rocid << " slot:" << hit->slot
-               << " chan:" << hit->channel << std::endl;
-      
-      // Create crate,slot,channel index and find entry in Translation table.
-      // If none is found, then just quietly skip this hit.
-      csc_t csc = {rocid, hit->slot, hit->channel};
-      map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
-      if (iter == Get_TT().end()) {
-          if (VERBOSE > 6)
-             ttout << "     - Didn't find it" << std::endl;
-          continue;
-      }
-      const DChannelInfo &chaninfo = iter->second;
-      if (VERBOSE > 6)
-	      ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys)
-               << std::endl; 
-      
-      // Create the appropriate hit type based on detector type
-      switch (chaninfo.det_sys) {
-         case DIRC:    MakeDIRCTDCDigiHit(chaninfo.dirc, hit); break;
-         default:     
-             if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
-             break;
-      }
-   }
+//---------------------------------
+// ApplyTranslationTable
+//---------------------------------
+void DTranslationTable::ApplyTranslationTable(JEventLoop *loop, const DParsedEvent *pe) const
+{
+   /// This does the same as ApplyTranslationTable(loop) except the
+   /// low level objects are taken straight from the DParsedEvent
+   /// vectors. It saves asking the JEventLoop for each type and is
+   /// what JEventSource_EVIOpp uses right after it has copied those
+   /// same vectors into the factories.
+
+   if (VERBOSE > 2) ttout << "Entering ApplyTranslationTable (DParsedEvent):" << std::endl;
+   
+   // Clear our internal vectors of pointers from previous event
+   ClearVectors();
+   
+   // (see comments in ApplyTranslationTable above)
+   bool record_call_stack = loop->GetCallStackRecordingStatus();
+   if (record_call_stack) loop->DisableCallStackRecording();
+
+   TranslateHits(pe->vDf250PulseIntegral);
+   TranslateHits(pe->vDf250PulseData);
+   TranslateHits(pe->vDf125PulseIntegral);
+   TranslateHits(pe->vDf125CDCPulse);
+   TranslateHits(pe->vDf125FDCPulse);
+   TranslateHits(pe->vDF1TDCHit);
+   TranslateHits(pe->vDCAEN1290TDCHit);
+   TranslateHits(pe->vDDIRCTDCHit);
+
+   FinishTranslation(loop, record_call_stack, !pe->vDf125CDCPulse.empty(), !pe->vDf125FDCPulse.empty());
+}
+
+//---------------------------------
+// FinishTranslation
+//---------------------------------
+void DTranslationTable::FinishTranslation(JEventLoop *loop, bool record_call_stack, bool have_cdcpulses, bool have_fdcpulses) const
+{
+   /// Hand all of the objects made by TranslateHit for this event
+   /// over to the factories.
 
 	// Optionally overwrite nsamples_integral and/or nsamples_pedestal if 
 	// user specified via config. parameters.
@@ -708,8 +461,8 @@ void DTranslationTable::ApplyTranslationTable(JEventLoop *loop) const
 	sort(vDBCALDigiHit.begin(), vDBCALDigiHit.end(), SortBCALDigiHit);
    
    // Copy pointers to all objects produced to their appropriate
-   // factories. This hands ownership of them over to the factories
-   // so JANA will delete them.
+   // factories. The objects live in our arenas so the factories
+   // are told not to delete them.
    CopyToFactories();
    
    
@@ -731,8 +484,8 @@ void DTranslationTable::ApplyTranslationTable(JEventLoop *loop) const
       	Addf250ObjectsToCallStack(loop, "DSCDigiHit");
       	Addf250ObjectsToCallStack(loop, "DTOFDigiHit");
       	Addf250ObjectsToCallStack(loop, "DTACDigiHit");
-      	Addf125CDCObjectsToCallStack(loop, "DCDCDigiHit", cdcpulses.size()>0);
-      	Addf125FDCObjectsToCallStack(loop, "DFDCCathodeDigiHit", fdcpulses.size()>0);
+      	Addf125CDCObjectsToCallStack(loop, "DCDCDigiHit", have_cdcpulses);
+      	Addf125FDCObjectsToCallStack(loop, "DFDCCathodeDigiHit", have_fdcpulses);
       	AddF1TDCObjectsToCallStack(loop, "DBCALTDCDigiHit");
       	AddF1TDCObjectsToCallStack(loop, "DFDCWireDigiHit");
       	AddF1TDCObjectsToCallStack(loop, "DRFDigiTime");
@@ -744,6 +497,299 @@ void DTranslationTable::ApplyTranslationTable(JEventLoop *loop) const
    }
 }
 
+//---------------------------------
+// TranslateHit
+//---------------------------------
+void DTranslationTable::TranslateHit(const Df250PulseIntegral *pi) const
+{
+   if (VERBOSE > 4)
+      ttout << "    Looking for rocid:" << pi->rocid << " slot:" << pi->slot
+            << " chan:" << pi->channel << std::endl;
+   
+   // Find entry in Translation table (optional rocid translation is
+   // already folded in). If none is found, then just quietly skip this hit.
+   const DChannelInfo *pchaninfo = FindChannel(pi->rocid, pi->slot, pi->channel);
+   if (pchaninfo == NULL) {
+      if (VERBOSE > 6)
+         ttout << "     - Didn't find it" << std::endl;
+      return;
+   }
+   const DChannelInfo &chaninfo = *pchaninfo;
+   if (VERBOSE > 6)
+      ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys)
+            << std::endl;
+   
+   // Check for a pulse time (this should have been added in JEventSource_EVIO.cc)
+   const Df250PulseTime *pt = NULL;
+   const Df250PulsePedestal *pp = NULL;
+   pi->GetSingle(pt);
+   pi->GetSingle(pp);
+
+   // Avoid f250 Error with extra PulseIntegral word
+   if( pt == NULL || pp == NULL) return;
+
+   // Create the appropriate hit type based on detector type
+   switch (chaninfo.det_sys) {
+      case BCAL:       MakeBCALDigiHit(chaninfo.bcal, pi, pt, pp);              break;
+      case FCAL:       MakeFCALDigiHit(chaninfo.fcal, pi, pt, pp);              break;
+      case CCAL:       MakeCCALDigiHit(chaninfo.ccal, pi, pt, pp);              break;
+      case CCAL_REF:   MakeCCALRefDigiHit(chaninfo.ccal_ref, pi, pt, pp);       break;
+      case SC:         MakeSCDigiHit(  chaninfo.sc, pi, pt, pp);                break;
+      case TOF:        MakeTOFDigiHit( chaninfo.tof, pi, pt, pp);               break;
+      case TAGM:       MakeTAGMDigiHit(chaninfo.tagm, pi, pt, pp);              break;
+      case TAGH:       MakeTAGHDigiHit(chaninfo.tagh, pi, pt, pp);              break;
+      case PS:         MakePSDigiHit(chaninfo.ps, pi, pt, pp);                  break;
+      case PSC:        MakePSCDigiHit(chaninfo.psc, pi, pt, pp);                break;
+      case RF:         MakeRFDigiTime(chaninfo.rf, pt);                         break;
+      case TPOLSECTOR: MakeTPOLSectorDigiHit(chaninfo.tpolsector, pi, pt, pp);  break;
+      case TAC:        MakeTACDigiHit(chaninfo.tac, pi, pt, pp);  	   	   break;
+
+      default:
+         if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
+         break;
+   }
+}
+
+//---------------------------------
+// TranslateHit
+//---------------------------------
+void DTranslationTable::TranslateHit(const Df250PulseData *pd) const
+{
+   if (VERBOSE > 4) ttout << "    Looking for rocid:" << pd->rocid << " slot:" << pd->slot << " chan:" << pd->channel << std::endl;
+   
+   // Find entry in Translation table (optional rocid translation is
+   // already folded in). If none is found, then just quietly skip this hit.
+   const DChannelInfo *pchaninfo = FindChannel(pd->rocid, pd->slot, pd->channel);
+   if (pchaninfo == NULL) {
+      if (VERBOSE > 6)  ttout << "     - Didn't find it" << std::endl;
+      return;
+   }
+   const DChannelInfo &chaninfo = *pchaninfo;
+   if (VERBOSE > 6) ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys) << std::endl;
+
+   // Create the appropriate hit type based on detector type
+   switch (chaninfo.det_sys) {
+      case BCAL:       MakeBCALDigiHit( chaninfo.bcal, pd);             break;
+      case FCAL:       MakeFCALDigiHit( chaninfo.fcal, pd);             break;
+      case CCAL:       MakeCCALDigiHit( chaninfo.ccal, pd);             break;
+      case CCAL_REF:   MakeCCALRefDigiHit( chaninfo.ccal_ref, pd);      break;	   
+      case SC:         MakeSCDigiHit(   chaninfo.sc,   pd);             break;
+      case TOF:        MakeTOFDigiHit(  chaninfo.tof,  pd);             break;
+      case TAGM:       MakeTAGMDigiHit( chaninfo.tagm, pd);             break;
+      case TAGH:       MakeTAGHDigiHit( chaninfo.tagh, pd);             break;
+      case PS:         MakePSDigiHit(   chaninfo.ps,   pd);             break;
+      case PSC:        MakePSCDigiHit(  chaninfo.psc,  pd);             break;
+      case RF:         MakeRFDigiTime(  chaninfo.rf,   pd);             break;
+      case TPOLSECTOR: MakeTPOLSectorDigiHit(chaninfo.tpolsector, pd);  break;
+      case TAC: 		  MakeTACDigiHit(chaninfo.tac, pd);  			   break;
+     default:
+         if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
+         break;
+   }
+}
+
+//---------------------------------
+// TranslateHit
+//---------------------------------
+void DTranslationTable::TranslateHit(const Df125PulseIntegral *pi) const
+{
+   if (VERBOSE > 4)
+      ttout << "    Looking for rocid:" << pi->rocid << " slot:" << pi->slot
+            << " chan:" << pi->channel << std::endl;
+
+   // Find entry in Translation table (optional rocid translation is
+   // already folded in). If none is found, then just quietly skip this hit.
+   const DChannelInfo *pchaninfo = FindChannel(pi->rocid, pi->slot, pi->channel);
+   if (pchaninfo == NULL) {
+       if (VERBOSE > 6)
+          ttout << "     - Didn't find it" << std::endl;
+       return;
+   }
+   const DChannelInfo &chaninfo = *pchaninfo;
+   if (VERBOSE > 6)
+      ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys) 
+            << std::endl;
+
+   // Check for a pulse time (this should have been added in JEventSource_EVIO.cc
+   const Df125PulseTime *pt = NULL;
+   const Df125PulsePedestal *pp = NULL;
+   pi->GetSingle(pt);
+   pi->GetSingle(pp);
+
+   // Create the appropriate hit type based on detector type
+   switch (chaninfo.det_sys) {
+      case CDC:           MakeCDCDigiHit(chaninfo.cdc, pi, pt, pp);                 break;
+      case FDC_CATHODES:  MakeFDCCathodeDigiHit(chaninfo.fdc_cathodes, pi, pt, pp); break;
+      default: 
+          if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl; 
+          break;
+   }
+}
+
+//---------------------------------
+// TranslateHit
+//---------------------------------
+void DTranslationTable::TranslateHit(const Df125CDCPulse *p) const
+{
+   if (VERBOSE > 4)
+      ttout << "    Looking for rocid:" << p->rocid << " slot:" << p->slot
+            << " chan:" << p->channel << std::endl;
+
+   // Find entry in Translation table (optional rocid translation is
+   // already folded in). If none is found, then just quietly skip this hit.
+   const DChannelInfo *pchaninfo = FindChannel(p->rocid, p->slot, p->channel);
+   if (pchaninfo == NULL) {
+       if (VERBOSE > 6)
+          ttout << "     - Didn't find it" << std::endl;
+       return;
+   }
+   const DChannelInfo &chaninfo = *pchaninfo;
+   if (VERBOSE > 6)
+      ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys) 
+            << std::endl;
+
+   // Create the appropriate hit type based on detector type
+   switch (chaninfo.det_sys) {
+      case CDC:  MakeCDCDigiHit(chaninfo.cdc, p); break;
+      default: 
+          if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
+          break;
+   }
+}
+
+//---------------------------------
+// TranslateHit
+//---------------------------------
+void DTranslationTable::TranslateHit(const Df125FDCPulse *p) const
+{
+   if (VERBOSE > 4)
+      ttout << "    Looking for rocid:" << p->rocid << " slot:" << p->slot
+            << " chan:" << p->channel << std::endl;
+
+   // Find entry in Translation table (optional rocid translation is
+   // already folded in). If none is found, then just quietly skip this hit.
+   const DChannelInfo *pchaninfo = FindChannel(p->rocid, p->slot, p->channel);
+   if (pchaninfo == NULL) {
+       if (VERBOSE > 6)
+          ttout << "     - Didn't find it" << std::endl;
+       return;
+   }
+   const DChannelInfo &chaninfo = *pchaninfo;
+   if (VERBOSE > 6)
+      ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys) 
+            << std::endl;
+
+   // Create the appropriate hit type based on detector type
+   switch (chaninfo.det_sys) {
+			case FDC_CATHODES:  MakeFDCCathodeDigiHit(chaninfo.fdc_cathodes, p); break;
+      case CDC         :  MakeCDCDigiHit(chaninfo.cdc, p); break;
+      default: 
+          if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
+          break;
+   }
+}
+
+//---------------------------------
+// TranslateHit
+//---------------------------------
+void DTranslationTable::TranslateHit(const DF1TDCHit *hit) const
+{
+   if (VERBOSE > 4)
+      ttout << "    Looking for rocid:" << hit->rocid << " slot:" << hit->slot
+            << " chan:" << hit->channel << std::endl;
+
+   // Find entry in Translation table (optional rocid translation is
+   // already folded in). If none is found, then just quietly skip this hit.
+   const DChannelInfo *pchaninfo = FindChannel(hit->rocid, hit->slot, hit->channel);
+   if (pchaninfo == NULL) {
+       if (VERBOSE > 6)
+          ttout << "     - Didn't find it" << std::endl;
+       return;
+   }
+   const DChannelInfo &chaninfo = *pchaninfo;
+   if (VERBOSE > 6) 
+      ttout << "     - Found entry for: " 
+            << DetectorName(chaninfo.det_sys) << std::endl;
+   
+   // Create the appropriate hit type based on detector type
+   switch (chaninfo.det_sys) {
+      case BCAL:        MakeBCALTDCDigiHit(chaninfo.bcal, hit);      break;
+      case FDC_WIRES:   MakeFDCWireDigiHit(chaninfo.fdc_wires, hit); break;
+      case RF:          MakeRFTDCDigiTime(chaninfo.rf, hit);         break;
+      case SC:          MakeSCTDCDigiHit(chaninfo.sc, hit);          break;
+      case TAGM:        MakeTAGMTDCDigiHit(chaninfo.tagm, hit);      break;
+      case TAGH:        MakeTAGHTDCDigiHit(chaninfo.tagh, hit);      break;
+      case PSC:         MakePSCTDCDigiHit(chaninfo.psc, hit);        break;
+     default:
+          if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
+          break;
+   }
+}
+
+//---------------------------------
+// TranslateHit
+//---------------------------------
+void DTranslationTable::TranslateHit(const DCAEN1290TDCHit *hit) const
+{
+   if (VERBOSE > 4)
+      ttout << "    Looking for rocid:" << hit->rocid << " slot:" << hit->slot
+            << " chan:" << hit->channel << std::endl;
+   
+   // Find entry in Translation table (optional rocid translation is
+   // already folded in). If none is found, then just quietly skip this hit.
+   const DChannelInfo *pchaninfo = FindChannel(hit->rocid, hit->slot, hit->channel);
+   if (pchaninfo == NULL) {
+       if (VERBOSE > 6)
+          ttout << "     - Didn't find it" << std::endl;
+       return;
+   }
+   const DChannelInfo &chaninfo = *pchaninfo;
+   if (VERBOSE > 6)
+      ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys)
+            << std::endl;
+   
+   // Create the appropriate hit type based on detector type
+   switch (chaninfo.det_sys) {
+      case TOF:    MakeTOFTDCDigiHit(chaninfo.tof, hit); break;
+      case RF:     MakeRFTDCDigiTime(chaninfo.rf, hit);  break;
+      case TAC:    MakeTACTDCDigiHit(chaninfo.tac, hit); break;
+      default:     
+          if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
+          break;
+   }
+}
+
+//---------------------------------
+// TranslateHit
+//---------------------------------
+void DTranslationTable::TranslateHit(const DDIRCTDCHit *hit) const
+{
+   if (VERBOSE > 4)
+      ttout << "    Looking for rocid:" << hit->rocid << " slot:" << hit->slot
+            << " chan:" << hit->channel << std::endl;
+   
+   // Find entry in Translation table (optional rocid translation is
+   // already folded in). If none is found, then just quietly skip this hit.
+   const DChannelInfo *pchaninfo = FindChannel(hit->rocid, hit->slot, hit->channel);
+   if (pchaninfo == NULL) {
+       if (VERBOSE > 6)
+          ttout << "     - Didn't find it" << std::endl;
+       return;
+   }
+   const DChannelInfo &chaninfo = *pchaninfo;
+   if (VERBOSE > 6)
+	      ttout << "     - Found entry for: " << DetectorName(chaninfo.det_sys)
+            << std::endl; 
+   
+   // Create the appropriate hit type based on detector type
+   switch (chaninfo.det_sys) {
+      case DIRC:    MakeDIRCTDCDigiHit(chaninfo.dirc, hit); break;
+      default:     
+          if (VERBOSE > 4) ttout << "       - Don't know how to make DigiHit objects for this detector type!" << std::endl;
+          break;
+   }
+}
+
 //---------------------------------
 // MakeBCALDigiHit
 //---------------------------------
@@ -755,7 +801,7 @@ DBCALDigiHit* DTranslationTable::MakeBCALDigiHit(const BCALIndex_t &idx,
             << idx.module << "," << idx.layer << "," << idx.sector 
             << "," << (DBCALGeometry::End)idx.end << std::endl;
 
-   DBCALDigiHit *h = new DBCALDigiHit();
+   DBCALDigiHit *h = arena_DBCALDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->module = idx.module;
@@ -774,7 +820,7 @@ DBCALDigiHit* DTranslationTable::MakeBCALDigiHit(const BCALIndex_t &idx,
 DFCALDigiHit* DTranslationTable::MakeFCALDigiHit(const FCALIndex_t &idx,
                                                  const Df250PulseData *pd) const
 {
-   DFCALDigiHit *h = new DFCALDigiHit();
+   DFCALDigiHit *h = arena_DFCALDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->row    = idx.row;
@@ -791,7 +837,7 @@ DFCALDigiHit* DTranslationTable::MakeFCALDigiHit(const FCALIndex_t &idx,
 DCCALDigiHit* DTranslationTable::MakeCCALDigiHit(const CCALIndex_t &idx,
                                                  const Df250PulseData *pd) const
 {
-   DCCALDigiHit *h = new DCCALDigiHit();
+   DCCALDigiHit *h = arena_DCCALDigiHit.New();
    CopyDf250Info(h, pd);
 
    // The CCAL coordinate system: (column,row) = (0,0) in the bottom right corner
@@ -820,7 +866,7 @@ DCCALDigiHit* DTranslationTable::MakeCCALDigiHit(const CCALIndex_t &idx,
 DCCALRefDigiHit* DTranslationTable::MakeCCALRefDigiHit(const CCALRefIndex_t &idx,
                                                  const Df250PulseData *pd) const
 {
-   DCCALRefDigiHit *h = new DCCALRefDigiHit();
+   DCCALRefDigiHit *h = arena_DCCALRefDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->id     = idx.id;
@@ -837,7 +883,7 @@ DCCALRefDigiHit* DTranslationTable::MakeCCALRefDigiHit(const CCALRefIndex_t &idx
 DTOFDigiHit* DTranslationTable::MakeTOFDigiHit(const TOFIndex_t &idx,
                                                const Df250PulseData *pd) const
 {
-   DTOFDigiHit *h = new DTOFDigiHit();
+   DTOFDigiHit *h = arena_DTOFDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->plane = idx.plane;
@@ -855,7 +901,7 @@ DTOFDigiHit* DTranslationTable::MakeTOFDigiHit(const TOFIndex_t &idx,
 DSCDigiHit* DTranslationTable::MakeSCDigiHit(const SCIndex_t &idx, 
                                              const Df250PulseData *pd) const
 {
-   DSCDigiHit *h = new DSCDigiHit();
+   DSCDigiHit *h = arena_DSCDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->sector = idx.sector;
@@ -871,7 +917,7 @@ DSCDigiHit* DTranslationTable::MakeSCDigiHit(const SCIndex_t &idx,
 DTAGMDigiHit* DTranslationTable::MakeTAGMDigiHit(const TAGMIndex_t &idx,
                                                  const Df250PulseData *pd) const
 {
-   DTAGMDigiHit *h = new DTAGMDigiHit();
+   DTAGMDigiHit *h = arena_DTAGMDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->row = idx.row;
@@ -888,7 +934,7 @@ DTAGMDigiHit* DTranslationTable::MakeTAGMDigiHit(const TAGMIndex_t &idx,
 DTAGHDigiHit* DTranslationTable::MakeTAGHDigiHit(const TAGHIndex_t &idx,
                                                  const Df250PulseData *pd) const
 {
-   DTAGHDigiHit *h = new DTAGHDigiHit();
+   DTAGHDigiHit *h = arena_DTAGHDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->counter_id = idx.id;
@@ -904,7 +950,7 @@ DTAGHDigiHit* DTranslationTable::MakeTAGHDigiHit(const TAGHIndex_t &idx,
 DPSCDigiHit* DTranslationTable::MakePSCDigiHit(const PSCIndex_t &idx,
 											   const Df250PulseData *pd) const
 {
-   DPSCDigiHit *h = new DPSCDigiHit();
+   DPSCDigiHit *h = arena_DPSCDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->counter_id = idx.id;
@@ -920,7 +966,7 @@ DPSCDigiHit* DTranslationTable::MakePSCDigiHit(const PSCIndex_t &idx,
 DPSDigiHit* DTranslationTable::MakePSDigiHit(const PSIndex_t &idx,
                                              const Df250PulseData *pd) const
 {
-   DPSDigiHit *h = new DPSDigiHit();
+   DPSDigiHit *h = arena_DPSDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->arm = (DPSGeometry::Arm)idx.side;
@@ -944,7 +990,7 @@ DBCALDigiHit* DTranslationTable::MakeBCALDigiHit(const BCALIndex_t &idx,
             << idx.module << "," << idx.layer << "," << idx.sector 
             << "," << (DBCALGeometry::End)idx.end << std::endl;
 
-   DBCALDigiHit *h = new DBCALDigiHit();
+   DBCALDigiHit *h = arena_DBCALDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->pulse_peak = pp==NULL ? 0 : pp->pulse_peak; // Include pulse peak information in the digihit for BCAL
@@ -967,7 +1013,7 @@ DFCALDigiHit* DTranslationTable::MakeFCALDigiHit(const FCALIndex_t &idx,
                                                  const Df250PulseTime *pt,
                                                  const Df250PulsePedestal *pp) const
 {
-   DFCALDigiHit *h = new DFCALDigiHit();
+   DFCALDigiHit *h = arena_DFCALDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->row    = idx.row;
@@ -986,7 +1032,7 @@ DCCALDigiHit* DTranslationTable::MakeCCALDigiHit(const CCALIndex_t &idx,
                                                  const Df250PulseTime *pt,
                                                  const Df250PulsePedestal *pp) const
 {
-   DCCALDigiHit *h = new DCCALDigiHit();
+   DCCALDigiHit *h = arena_DCCALDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    if(idx.col < 0)
@@ -1015,7 +1061,7 @@ DCCALRefDigiHit* DTranslationTable::MakeCCALRefDigiHit(const CCALRefIndex_t &idx
                                                  const Df250PulseTime *pt,
                                                  const Df250PulsePedestal *pp) const
 {
-   DCCALRefDigiHit *h = new DCCALRefDigiHit();
+   DCCALRefDigiHit *h = arena_DCCALRefDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->id    = idx.id;
@@ -1034,7 +1080,7 @@ DTOFDigiHit* DTranslationTable::MakeTOFDigiHit(const TOFIndex_t &idx,
                                                const Df250PulseTime *pt,
                                                const Df250PulsePedestal *pp) const
 {
-   DTOFDigiHit *h = new DTOFDigiHit();
+   DTOFDigiHit *h = arena_DTOFDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->plane = idx.plane;
@@ -1054,7 +1100,7 @@ DSCDigiHit* DTranslationTable::MakeSCDigiHit(const SCIndex_t &idx,
                                              const Df250PulseTime *pt,
                                              const Df250PulsePedestal *pp) const
 {
-   DSCDigiHit *h = new DSCDigiHit();
+   DSCDigiHit *h = arena_DSCDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->sector = idx.sector;
@@ -1072,7 +1118,7 @@ DTAGMDigiHit* DTranslationTable::MakeTAGMDigiHit(const TAGMIndex_t &idx,
                                                  const Df250PulseTime *pt,
                                                  const Df250PulsePedestal *pp) const
 {
-   DTAGMDigiHit *h = new DTAGMDigiHit();
+   DTAGMDigiHit *h = arena_DTAGMDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->row = idx.row;
@@ -1091,7 +1137,7 @@ DTAGHDigiHit* DTranslationTable::MakeTAGHDigiHit(const TAGHIndex_t &idx,
                                                  const Df250PulseTime *pt,
                                                  const Df250PulsePedestal *pp) const
 {
-   DTAGHDigiHit *h = new DTAGHDigiHit();
+   DTAGHDigiHit *h = arena_DTAGHDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->counter_id = idx.id;
@@ -1109,7 +1155,7 @@ DPSCDigiHit* DTranslationTable::MakePSCDigiHit(const PSCIndex_t &idx,
 					       const Df250PulseTime *pt,
 					       const Df250PulsePedestal *pp) const
 {
-   DPSCDigiHit *h = new DPSCDigiHit();
+   DPSCDigiHit *h = arena_DPSCDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->counter_id = idx.id;
@@ -1127,7 +1173,7 @@ DPSDigiHit* DTranslationTable::MakePSDigiHit(const PSIndex_t &idx,
 					     const Df250PulseTime *pt,
 					     const Df250PulsePedestal *pp) const
 {
-   DPSDigiHit *h = new DPSDigiHit();
+   DPSDigiHit *h = arena_DPSDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->arm = (DPSGeometry::Arm)idx.side;
@@ -1146,7 +1192,7 @@ DCDCDigiHit* DTranslationTable::MakeCDCDigiHit(const CDCIndex_t &idx,
                                                const Df125PulseTime *pt,
                                                const Df125PulsePedestal *pp) const
 {
-   DCDCDigiHit *h = new DCDCDigiHit();
+   DCDCDigiHit *h = arena_DCDCDigiHit.New();
    CopyDf125Info(h, pi, pt, pp);
 
    h->ring = idx.ring;
@@ -1164,7 +1210,7 @@ DCDCDigiHit* DTranslationTable::MakeCDCDigiHit(const CDCIndex_t &idx,
 DCDCDigiHit* DTranslationTable::MakeCDCDigiHit(const CDCIndex_t &idx,
                                                const Df125CDCPulse *p) const
 {
-	DCDCDigiHit *h = new DCDCDigiHit();
+	DCDCDigiHit *h = arena_DCDCDigiHit.New();
 	h->ring              = idx.ring;
 	h->straw             = idx.straw;
 	h->pulse_peak        = p->first_max_amp;
@@ -1188,7 +1234,7 @@ DCDCDigiHit* DTranslationTable::MakeCDCDigiHit(const CDCIndex_t &idx,
 DCDCDigiHit* DTranslationTable::MakeCDCDigiHit(const CDCIndex_t &idx,
                                                const Df125FDCPulse *p) const
 {
-	DCDCDigiHit *h = new DCDCDigiHit();
+	DCDCDigiHit *h = arena_DCDCDigiHit.New();
 	h->ring              = idx.ring;
 	h->straw             = idx.straw;
 	h->pulse_peak        = p->peak_amp;
@@ -1215,7 +1261,7 @@ DFDCCathodeDigiHit* DTranslationTable::MakeFDCCathodeDigiHit(
                                        const Df125PulseTime *pt,
                                        const Df125PulsePedestal *pp) const
 {
-   DFDCCathodeDigiHit *h = new DFDCCathodeDigiHit();
+   DFDCCathodeDigiHit *h = arena_DFDCCathodeDigiHit.New();
    CopyDf125Info(h, pi, pt, pp);
 
    h->package    = idx.package;
@@ -1237,7 +1283,7 @@ DFDCCathodeDigiHit* DTranslationTable::MakeFDCCathodeDigiHit(
                                        const FDC_CathodesIndex_t &idx,
                                        const Df125FDCPulse *p) const
 {
-	DFDCCathodeDigiHit *h = new DFDCCathodeDigiHit();
+	DFDCCathodeDigiHit *h = arena_DFDCCathodeDigiHit.New();
 	h->package           = idx.package;
 	h->chamber           = idx.chamber;
 	h->view              = idx.view;
@@ -1264,7 +1310,7 @@ DBCALTDCDigiHit* DTranslationTable::MakeBCALTDCDigiHit(
                                     const BCALIndex_t &idx,
                                     const DF1TDCHit *hit) const
 {
-   DBCALTDCDigiHit *h = new DBCALTDCDigiHit();
+   DBCALTDCDigiHit *h = arena_DBCALTDCDigiHit.New();
    CopyDF1TDCInfo(h, hit);
 
    h->module = idx.module;
@@ -1284,7 +1330,7 @@ DFDCWireDigiHit* DTranslationTable::MakeFDCWireDigiHit(
                                     const FDC_WiresIndex_t &idx,
                                     const DF1TDCHit *hit) const
 {
-   DFDCWireDigiHit *h = new DFDCWireDigiHit();
+   DFDCWireDigiHit *h = arena_DFDCWireDigiHit.New();
    CopyDF1TDCInfo(h, hit);
 
    h->package = idx.package;
@@ -1303,7 +1349,7 @@ DRFTDCDigiTime*  DTranslationTable::MakeRFTDCDigiTime(
                                    const RFIndex_t &idx,
                                    const DF1TDCHit *hit) const
 {
-   DRFTDCDigiTime *h = new DRFTDCDigiTime();
+   DRFTDCDigiTime *h = arena_DRFTDCDigiTime.New();
    CopyDF1TDCInfo(h, hit);
 
    h->dSystem = idx.dSystem;
@@ -1321,7 +1367,7 @@ DRFTDCDigiTime*  DTranslationTable::MakeRFTDCDigiTime(
                                    const RFIndex_t &idx,
                                    const DCAEN1290TDCHit *hit) const
 {
-   DRFTDCDigiTime *h = new DRFTDCDigiTime();
+   DRFTDCDigiTime *h = arena_DRFTDCDigiTime.New();
    CopyDCAEN1290TDCInfo(h, hit);
 
    h->dSystem = idx.dSystem;
@@ -1339,7 +1385,7 @@ DRFDigiTime*  DTranslationTable::MakeRFDigiTime(
                                    const RFIndex_t &idx,
                                    const Df250PulseTime *hit) const
 {
-   DRFDigiTime *h = new DRFDigiTime();
+   DRFDigiTime *h = arena_DRFDigiTime.New();
    h->time = hit->time;
 
    h->dSystem = idx.dSystem;
@@ -1356,7 +1402,7 @@ DRFDigiTime*  DTranslationTable::MakeRFDigiTime(
                                    const RFIndex_t &idx,
                                    const Df250PulseData *hit) const
 {
-   DRFDigiTime *h = new DRFDigiTime();
+   DRFDigiTime *h = arena_DRFDigiTime.New();
    h->time = (hit->course_time<<6) + hit->fine_time;
 
    h->dSystem = idx.dSystem;
@@ -1373,7 +1419,7 @@ DSCTDCDigiHit*  DTranslationTable::MakeSCTDCDigiHit(
                                    const SCIndex_t &idx,
                                    const DF1TDCHit *hit) const
 {
-   DSCTDCDigiHit *h = new DSCTDCDigiHit();
+   DSCTDCDigiHit *h = arena_DSCTDCDigiHit.New();
    CopyDF1TDCInfo(h, hit);
 
    h->sector = idx.sector;
@@ -1390,7 +1436,7 @@ DTAGMTDCDigiHit*  DTranslationTable::MakeTAGMTDCDigiHit(
                                      const TAGMIndex_t &idx,
                                      const DF1TDCHit *hit) const
 {
-   DTAGMTDCDigiHit *h = new DTAGMTDCDigiHit();
+   DTAGMTDCDigiHit *h = arena_DTAGMTDCDigiHit.New();
    CopyDF1TDCInfo(h, hit);
 
    h->row = idx.row;
@@ -1408,7 +1454,7 @@ DTAGHTDCDigiHit*  DTranslationTable::MakeTAGHTDCDigiHit(
                                      const TAGHIndex_t &idx,
                                      const DF1TDCHit *hit) const
 {
-   DTAGHTDCDigiHit *h = new DTAGHTDCDigiHit();
+   DTAGHTDCDigiHit *h = arena_DTAGHTDCDigiHit.New();
    CopyDF1TDCInfo(h, hit);
 
    h->counter_id = idx.id;
@@ -1425,7 +1471,7 @@ DPSCTDCDigiHit*  DTranslationTable::MakePSCTDCDigiHit(
                                      const PSCIndex_t &idx,
                                      const DF1TDCHit *hit) const
 {
-   DPSCTDCDigiHit *h = new DPSCTDCDigiHit();
+   DPSCTDCDigiHit *h = arena_DPSCTDCDigiHit.New();
    CopyDF1TDCInfo(h, hit);
 
    h->counter_id = idx.id;
@@ -1442,7 +1488,7 @@ DTOFTDCDigiHit*  DTranslationTable::MakeTOFTDCDigiHit(
                                     const TOFIndex_t &idx,
                                     const DCAEN1290TDCHit *hit) const
 {
-   DTOFTDCDigiHit *h = new DTOFTDCDigiHit();
+   DTOFTDCDigiHit *h = arena_DTOFTDCDigiHit.New();
    CopyDCAEN1290TDCInfo(h, hit);
 
    h->plane = idx.plane;
@@ -1462,7 +1508,7 @@ DTPOLSectorDigiHit* DTranslationTable::MakeTPOLSectorDigiHit(const TPOLSECTORInd
 							     const Df250PulseTime *pt,
 							     const Df250PulsePedestal *pp) const
 {
-   DTPOLSectorDigiHit *h = new DTPOLSectorDigiHit();
+   DTPOLSectorDigiHit *h = arena_DTPOLSectorDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    h->sector = idx.sector;
@@ -1478,7 +1524,7 @@ DTPOLSectorDigiHit* DTranslationTable::MakeTPOLSectorDigiHit(const TPOLSECTORInd
 DTPOLSectorDigiHit* DTranslationTable::MakeTPOLSectorDigiHit(const TPOLSECTORIndex_t &idx,
 							     const Df250PulseData *pd) const
 {
-   DTPOLSectorDigiHit *h = new DTPOLSectorDigiHit();
+   DTPOLSectorDigiHit *h = arena_DTPOLSectorDigiHit.New();
    CopyDf250Info(h, pd);
 
    h->sector = idx.sector;
@@ -1498,7 +1544,7 @@ DTACDigiHit* DTranslationTable::MakeTACDigiHit(const TACIndex_t &idx,
 							     const Df250PulseTime *pt,
 							     const Df250PulsePedestal *pp) const
 {
-   DTACDigiHit *h = new DTACDigiHit();
+   DTACDigiHit *h = arena_DTACDigiHit.New();
    CopyDf250Info(h, pi, pt, pp);
 
    vDTACDigiHit.push_back(h);
@@ -1512,7 +1558,7 @@ DTACDigiHit* DTranslationTable::MakeTACDigiHit(const TACIndex_t &idx,
 DTACDigiHit* DTranslationTable::MakeTACDigiHit(const TACIndex_t &idx,
 							     const Df250PulseData *pd) const
 {
-	   DTACDigiHit *h = new DTACDigiHit();
+	   DTACDigiHit *h = arena_DTACDigiHit.New();
 	   CopyDf250Info(h, pd);
 
 	   vDTACDigiHit.push_back(h);
@@ -1527,7 +1573,7 @@ DTACTDCDigiHit*  DTranslationTable::MakeTACTDCDigiHit(
                                     const TACIndex_t &idx,
                                     const DCAEN1290TDCHit *hit) const
 {
-   DTACTDCDigiHit *h = new DTACTDCDigiHit();
+   DTACTDCDigiHit *h = arena_DTACTDCDigiHit.New();
    CopyDCAEN1290TDCInfo(h, hit);
 
    vDTACTDCDigiHit.push_back(h);
@@ -1542,7 +1588,7 @@ DDIRCTDCDigiHit*  DTranslationTable::MakeDIRCTDCDigiHit(
                                     const DIRCIndex_t &idx,
                                     const DDIRCTDCHit *hit) const
 {
-   DDIRCTDCDigiHit *h = new DDIRCTDCDigiHit();
+   DDIRCTDCDigiHit *h = arena_DDIRCTDCDigiHit.New();
    CopyDIRCTDCInfo(h, hit);
 
    h->channel = idx.pixel;
@@ -1571,6 +1617,26 @@ const DTranslationTable::DChannelInfo
     return detector_index_itr->second;
 }
 
+//---------------------------------
+// FindChannelInMap
+//---------------------------------
+const DTranslationTable::DChannelInfo* 
+     DTranslationTable::FindChannelInMap(uint32_t rocid, uint32_t slot, uint32_t channel) const
+{
+   /// This does the same thing as FindChannel, but by searching the
+   /// rocid map and TT directly. It is only used if TT:DENSE_LOOKUP=0.
+
+   // Apply optional rocid translation
+   map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
+   if (rocid_iter != Get_ROCID_Map().end()) rocid = rocid_iter->second;
+
+   csc_t csc = {rocid, slot, channel};
+   map<csc_t, DChannelInfo>::const_iterator iter = Get_TT().find(csc);
+   if (iter == Get_TT().end()) return NULL;
+
+   return &iter->second;
+}
+
 //---------------------------------
 // GetDAQIndex
 //---------------------------------
@@ -1968,8 +2034,93 @@ void DTranslationTable::ReadTranslationTable(JCalibration *jcalib)
    jout << Get_TT().size() << " channels defined in translation table" << std::endl;
    XML_ParserFree(xmlParser);
 
-   pthread_mutex_unlock(&Get_TT_Mutex());
+   // Make the lookup table used by ApplyTranslationTable
+   CompileLookupTable();
+
+   // n.b. this must be set before releasing the lock so another
+   // thread doesn't rebuild the lookup table while it is in use
    Get_TT_Initialized() = true;
+   pthread_mutex_unlock(&Get_TT_Mutex());
+}
+
+//---------------------------------
+// CompileLookupTable
+//---------------------------------
+void DTranslationTable::CompileLookupTable(void)
+{
+   /// Fill the dense lookup table used by FindChannel from the TT map.
+   /// This must be called with the TT mutex locked.
+   ///
+   /// The DChannelInfo objects are copied into a single vector in
+   /// crate, slot, channel order. Each (rocid, slot) that appears in
+   /// the TT gets a contiguous block of pointers into that vector,
+   /// one for every channel number up to the largest one used in that
+   /// slot (unused channels are NULL). The slot_index table gives the
+   /// start and size of the block for every rocid and slot. The table
+   /// is indexed by the rocid found in the EVIO file so the optional
+   /// rocid map is applied here rather than for every hit.
+
+   DChannelLookup_t &lookup = Get_TT_Lookup();
+   lookup.Nrocids = 0;
+   lookup.Nslots  = 0;
+   lookup.slot_index.clear();
+   lookup.channels.clear();
+   lookup.chaninfo.clear();
+   if (Get_TT().empty()) return;
+
+   // Copy entries. The TT map is ordered by rocid, slot, channel so
+   // all of the entries for a given rocid and slot are contiguous.
+   uint32_t max_rocid = 0;
+   uint32_t max_slot  = 0;
+   lookup.chaninfo.reserve(Get_TT().size());
+   for (auto &p : Get_TT()) {
+      lookup.chaninfo.push_back(p.second);
+      if (p.first.rocid > max_rocid) max_rocid = p.first.rocid;
+      if (p.first.slot  > max_slot ) max_slot  = p.first.slot;
+   }
+   for (auto &p : Get_ROCID_Map()) {
+      if (p.first > max_rocid) max_rocid = p.first;
+   }
+   lookup.Nrocids = max_rocid + 1;
+   lookup.Nslots  = max_slot + 1;
+   lookup.slot_index.assign(lookup.Nrocids*lookup.Nslots, pair<uint32_t, uint32_t>(0, 0));
+
+   // Find range of chaninfo entries for each TT (rocid, slot)
+   map<pair<uint32_t, uint32_t>, pair<uint32_t, uint32_t> > tt_slots; // key=(rocid, slot) val=(first, last+1)
+   for (uint32_t i=0; i<lookup.chaninfo.size(); i++) {
+      const csc_t &csc = lookup.chaninfo[i].CSC;
+      auto ret = tt_slots.insert(make_pair(make_pair(csc.rocid, csc.slot), make_pair(i, i+1)));
+      if (!ret.second) ret.first->second.second = i+1;
+   }
+
+   // Fill in block of channels for every EVIO rocid and slot
+   for (uint32_t rocid=0; rocid<lookup.Nrocids; rocid++) {
+
+      // Apply optional rocid translation
+      uint32_t tt_rocid = rocid;
+      map<uint32_t, uint32_t>::iterator rocid_iter = Get_ROCID_Map().find(rocid);
+      if (rocid_iter != Get_ROCID_Map().end()) tt_rocid = rocid_iter->second;
+
+      for (uint32_t slot=0; slot<lookup.Nslots; slot++) {
+         auto it = tt_slots.find(make_pair(tt_rocid, slot));
+         if (it == tt_slots.end()) continue;
+         uint32_t first = it->second.first;
+         uint32_t last  = it->second.second;
+         uint32_t Nchannels = lookup.chaninfo[last-1].CSC.channel + 1;
+
+         pair<uint32_t, uint32_t> &idx = lookup.slot_index[rocid*lookup.Nslots + slot];
+         idx.first  = lookup.channels.size();
+         idx.second = Nchannels;
+         lookup.channels.resize(idx.first + Nchannels, NULL);
+         for (uint32_t i=first; i<last; i++) {
+            lookup.channels[idx.first + lookup.chaninfo[i].CSC.channel] = &lookup.chaninfo[i];
+         }
+      }
+   }
+
+   if (VERBOSE > 0)
+      jout << "TT lookup table: " << lookup.Nrocids << " rocids x " << lookup.Nslots
+           << " slots, " << lookup.channels.size() << " channel entries" << std::endl;
 }
 
 //---------------------------------
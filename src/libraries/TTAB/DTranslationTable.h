@@ -10,6 +10,7 @@
 
 #include <set>
 #include <string>
+#include <type_traits>
 
 using namespace std;
 
@@ -42,6 +43,7 @@ using namespace jana;
 #include <DAQ/DF1TDCTriggerTime.h>
 #include <DAQ/DCAEN1290TDCHit.h>
 #include <DAQ/DDIRCTDCHit.h>
+#include <DAQ/DParsedObjectArena.h>
 
 #include <BCAL/DBCALDigiHit.h>
 #include <BCAL/DBCALTDCDigiHit.h>
@@ -116,6 +118,8 @@ using namespace jana;
 
 #include "GlueX.h"
 
+class DParsedEvent;
+
 class DTranslationTable:public jana::JObject{
 	public:
 		JOBJECT_PUBLIC(DTranslationTable);
@@ -383,6 +387,23 @@ class DTranslationTable:public jana::JObject{
 				};
 		};
 
+		// DChannelLookup_t is a dense, directly indexed copy of the TT
+		// used by ApplyTranslationTable so that finding the DChannelInfo
+		// for a hit costs a couple of array lookups rather than searching
+		// two maps. It is indexed by the rocid as it appears in the EVIO
+		// file so any rocid translation (see ReadOptionalROCidTranslation)
+		// is already folded in. See CompileLookupTable() for details.
+		class DChannelLookup_t{
+			public:
+				DChannelLookup_t():Nrocids(0),Nslots(0){}
+
+				uint32_t Nrocids;                            // largest EVIO rocid + 1
+				uint32_t Nslots;                             // largest slot + 1
+				vector<pair<uint32_t, uint32_t> > slot_index; // (first entry in channels, Nchannels) for rocid*Nslots + slot
+				vector<const DChannelInfo*> channels;        // NULL for channels not in TT
+				vector<DChannelInfo> chaninfo;               // copy of TT entries in csc order
+		};
+
 		//-----------------------------------------------------------------------
 		//
 		// Pre-processor macro monkey shines using the MyTypes define above to repeat
@@ -397,6 +418,12 @@ class DTranslationTable:public jana::JObject{
 		#define makevector(A) mutable vector<A*>  v##A;
 		MyTypes(makevector)
 		
+		// The objects themselves are kept in an arena for each type
+		// (see DParsedObjectArena.h) so they can be reused from event
+		// to event rather than being allocated one at a time.
+		#define makearena(A) mutable DParsedObjectArena<A>  arena_##A;
+		MyTypes(makearena)
+		
 		// Similarly, define a pointer to the factory for each type.
 		#define makefactoryptr(A) JFactory<A> *fac_##A;
 		MyTypes(makefactoryptr)
@@ -405,12 +432,16 @@ class DTranslationTable:public jana::JObject{
 		#define copyfactoryptr(A) fac_##A = (JFactory<A>*)loop->GetFactory(#A);
 		void InitFactoryPointers(JEventLoop *loop){ MyTypes(copyfactoryptr) }
 
-		// Method to clear each of the vectors at beginning of event
-		#define clearvector(A) v##A.clear();
+		// Method to clear each of the vectors (and arenas) at beginning of event
+		#define clearvector(A) v##A.clear(); arena_##A.Reset();
 		void ClearVectors(void) const { MyTypes(clearvector) }
 
-		// Method to copy all produced objects to respective factories
-		#define copytofactory(A) fac_##A->CopyTo(v##A);
+		// Method to copy all produced objects to respective factories.
+		// The objects belong to our arenas so factories must not delete them.
+		// The flag stays set after this event so any other source that fills
+		// one of these factories with its own objects (e.g. DEventSourceHDDM)
+		// must clear it again.
+		#define copytofactory(A) fac_##A->CopyTo(v##A); fac_##A->SetFactoryFlag(JFactory_base::NOT_OBJECT_OWNER);
 		void CopyToFactories(void) const { MyTypes(copytofactory) }
 		
 		// Method to check class name against each classname in MyTypes returning
@@ -459,6 +490,9 @@ class DTranslationTable:public jana::JObject{
 
 		// Methods
 		void ApplyTranslationTable(jana::JEventLoop *loop) const;
+		void ApplyTranslationTable(jana::JEventLoop *loop, const DParsedEvent *pe) const;
+		inline const DChannelInfo* FindChannel(uint32_t rocid, uint32_t slot, uint32_t channel) const;
+		void SetDenseLookup(bool dense_lookup){ DENSE_LOOKUP = dense_lookup; }
 		
 		// fADC250 -- Fall 2016 -> ?
 		DBCALDigiHit*       MakeBCALDigiHit(       const BCALIndex_t &idx,       const Df250PulseData *pd) const;
@@ -532,6 +566,18 @@ class DTranslationTable:public jana::JObject{
 		template<class T> void CopyDCAEN1290TDCInfo(T *h, const DCAEN1290TDCHit *hit) const;
 		template<class T> void CopyDIRCTDCInfo(T *h, const DDIRCTDCHit *hit) const;
 
+		// Make DigiHit object(s) for low level hits
+		template<class T> void TranslateHits(const vector<T*> &hits) const;
+		void TranslateHit(const Df250PulseIntegral *pi) const;
+		void TranslateHit(const Df250PulseData *pd) const;
+		void TranslateHit(const Df125PulseIntegral *pi) const;
+		void TranslateHit(const Df125CDCPulse *p) const;
+		void TranslateHit(const Df125FDCPulse *p) const;
+		void TranslateHit(const DF1TDCHit *hit) const;
+		void TranslateHit(const DCAEN1290TDCHit *hit) const;
+		void TranslateHit(const DDIRCTDCHit *hit) const;
+		void FinishTranslation(JEventLoop *loop, bool record_call_stack, bool have_cdcpulses, bool have_fdcpulses) const;
+
 		
 		// methods for others to search the Translation Table
 		const DChannelInfo &GetDetectorIndex(const csc_t &in_daq_index) const;
@@ -576,10 +622,15 @@ class DTranslationTable:public jana::JObject{
 		string SYSTEMS_TO_PARSE;
 		string ROCID_MAP_FILENAME;
 		bool CALL_STACK;
+		bool DENSE_LOOKUP;
+		
+		const DChannelLookup_t *tt_lookup;
 		
 		mutable JStreamLog ttout;
 
 		string Channel2Str(const DChannelInfo &in_channel) const;
+		const DChannelInfo* FindChannelInMap(uint32_t rocid, uint32_t slot, uint32_t channel) const;
+		void CompileLookupTable(void);
 
 	private:
 
@@ -608,8 +659,25 @@ class DTranslationTable:public jana::JObject{
 		map<DTranslationTable::csc_t, DTranslationTable::DChannelInfo>& Get_TT(void) const;
 		map<uint32_t, uint32_t>& Get_ROCID_Map(void) const;
 		map<uint32_t, uint32_t>& Get_ROCID_Inv_Map(void) const;
+		DChannelLookup_t& Get_TT_Lookup(void) const;
 };
 
+//---------------------------------
+// FindChannel
+//---------------------------------
+inline const DTranslationTable::DChannelInfo* DTranslationTable::FindChannel(uint32_t rocid, uint32_t slot, uint32_t channel) const
+{
+	/// Return the TT entry for the given crate, slot, channel or NULL
+	/// if there is none. The rocid should be the one from the EVIO
+	/// file (i.e. before any optional rocid translation).
+	if(!DENSE_LOOKUP) return FindChannelInMap(rocid, slot, channel);
+
+	if(rocid >= tt_lookup->Nrocids || slot >= tt_lookup->Nslots) return NULL;
+	const pair<uint32_t, uint32_t> &idx = tt_lookup->slot_index[rocid*tt_lookup->Nslots + slot];
+	if(channel >= idx.second) return NULL;
+	return tt_lookup->channels[idx.first + channel];
+}
+
 //---------------------------------
 // CopyDf250Info
 //---------------------------------
@@ -718,6 +786,7 @@ void DTranslationTable::CopyDIRCTDCInfo(T *h, const DDIRCTDCHit *hit) const
 #undef MyTypes
 #undef MyfADCTypes
 #undef makevector
+#undef makearena
 #undef makefactoryptr
 #undef copyfactoryptr
 #undef clearvector
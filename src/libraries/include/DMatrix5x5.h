@@ -636,6 +636,25 @@ inline DMatrix5x5 operator*(const double c,const DMatrix5x5 &M){
 
 // Matrix class with SIMD instructions
 
+#ifdef USE_AVX2
+// Multiply-add used by the AVX2 versions of the (5x5) x (5x5) and
+// (5x5) x (5x1) products. Rows 0-3 of a column are handled as one
+// 256-bit vector. The columns are only 16-byte aligned so the 256-bit
+// loads are unaligned. With FMA the product is not rounded before the
+// add so results can differ from the SSE versions in the last bit.
+// Transpose, SandwichMultiply and the inversions keep their SSE
+// versions.
+#ifdef __FMA__
+#define FMADD256(a,b,c) _mm256_fmadd_pd((a),(b),(c))
+#define FMADD128(a,b,c) _mm_fmadd_pd((a),(b),(c))
+#define FMADDSD(a,b,c) _mm_fmadd_sd((a),(b),(c))
+#else
+#define FMADD256(a,b,c) _mm256_add_pd(_mm256_mul_pd((a),(b)),(c))
+#define FMADD128(a,b,c) _mm_add_pd(_mm_mul_pd((a),(b)),(c))
+#define FMADDSD(a,b,c) _mm_add_sd(_mm_mul_sd((a),(b)),(c))
+#endif
+#endif
+
 class DMatrix5x5{
    public:
       DMatrix5x5()
@@ -817,6 +836,19 @@ class DMatrix5x5{
                SUB(1,3),SUB(1,4),SUB(2,4));
       }
 
+#ifdef USE_AVX2
+      // Matrix multiplication:  (5x5) x (5x1)
+      DMatrix5x1 operator*(const DMatrix5x1 &m2){
+         __m256d c03=_mm256_setzero_pd();
+         __m128d c4=_mm_setzero_pd();
+         for (unsigned int j=0;j<5;j++){
+            double b=m2(j);
+            c03=FMADD256(_mm256_loadu_pd(&mA[j].d[0]),_mm256_set1_pd(b),c03);
+            c4=FMADD128(mA[j].v[2],_mm_set1_pd(b),c4);
+         }
+         return DMatrix5x1(_mm256_castpd256_pd128(c03),_mm256_extractf128_pd(c03,1),c4);
+      }
+#else
       // Matrix multiplication:  (5x5) x (5x1)
       DMatrix5x1 operator*(const DMatrix5x1 &m2){
          ALIGNED_16_BLOCK_WITH_PTR(__m128d, 5, p)
@@ -849,6 +881,7 @@ class DMatrix5x5{
 
 
       }
+#endif
 
       // Matrix multiplication:  (5x5) x (5x2)
       DMatrix5x2 operator*(const DMatrix5x2 &m2){
@@ -1095,6 +1128,46 @@ class DMatrix5x5{
          return DMatrix5x5(C11,C12,C13,C14,C15,C22,C23,C24,C25,C33,C34,C35,C44,C45,C55);
       }
 
+#ifdef USE_AVX2
+      // Matrix multiplication: (5x5) x (5x5)
+      // Rows 0-3 of each result column are one 256-bit sum over the
+      // columns of this matrix, with the elements of m2 broadcast from
+      // memory. Row 4 is the dot product of row 4 of this matrix with
+      // the column of m2. The columns are fully unrolled so that each
+      // has its own accumulators and the FMA chains can overlap.
+      DMatrix5x5 operator*(const DMatrix5x5 &m2){
+         __m256d a0=_mm256_loadu_pd(&mA[0].d[0]);
+         __m256d a1=_mm256_loadu_pd(&mA[1].d[0]);
+         __m256d a2=_mm256_loadu_pd(&mA[2].d[0]);
+         __m256d a3=_mm256_loadu_pd(&mA[3].d[0]);
+         __m256d a4=_mm256_loadu_pd(&mA[4].d[0]);
+         __m128d r4_01=_mm_setr_pd(mA[0].d[4],mA[1].d[4]);
+         __m128d r4_23=_mm_setr_pd(mA[2].d[4],mA[3].d[4]);
+         __m128d r4_4=_mm_set_sd(mA[4].d[4]);
+#define AVX2_MULT_COLUMN(k) \
+         __m256d c03_##k=_mm256_mul_pd(a0,_mm256_broadcast_sd(&m2.mA[k].d[0])); \
+         __m256d t03_##k=_mm256_mul_pd(a1,_mm256_broadcast_sd(&m2.mA[k].d[1])); \
+         c03_##k=FMADD256(a2,_mm256_broadcast_sd(&m2.mA[k].d[2]),c03_##k); \
+         t03_##k=FMADD256(a3,_mm256_broadcast_sd(&m2.mA[k].d[3]),t03_##k); \
+         c03_##k=FMADD256(a4,_mm256_broadcast_sd(&m2.mA[k].d[4]),c03_##k); \
+         c03_##k=_mm256_add_pd(c03_##k,t03_##k); \
+         __m128d c4_##k=FMADD128(r4_23,m2.mA[k].v[1],_mm_mul_pd(r4_01,m2.mA[k].v[0])); \
+         c4_##k=FMADDSD(r4_4,m2.mA[k].v[2],_mm_hadd_pd(c4_##k,c4_##k));
+         AVX2_MULT_COLUMN(0)
+         AVX2_MULT_COLUMN(1)
+         AVX2_MULT_COLUMN(2)
+         AVX2_MULT_COLUMN(3)
+         AVX2_MULT_COLUMN(4)
+#undef AVX2_MULT_COLUMN
+         return DMatrix5x5(_mm256_castpd256_pd128(c03_0),_mm256_castpd256_pd128(c03_1),
+               _mm256_castpd256_pd128(c03_2),_mm256_castpd256_pd128(c03_3),
+               _mm256_castpd256_pd128(c03_4),
+               _mm256_extractf128_pd(c03_0,1),_mm256_extractf128_pd(c03_1,1),
+               _mm256_extractf128_pd(c03_2,1),_mm256_extractf128_pd(c03_3,1),
+               _mm256_extractf128_pd(c03_4,1),
+               c4_0,c4_1,c4_2,c4_3,c4_4);
+      }
+#else
       // Matrix multiplication. Requires the SSE3 instruction HADD (horizontal add)
       DMatrix5x5 operator*(const DMatrix5x5 &m2){
          ALIGNED_16_BLOCK_WITH_PTR(__m128d, 8, p)
@@ -1154,6 +1227,7 @@ class DMatrix5x5{
                   _mm_set_sd(mA[0].d[4]*m2(0,4)+mA[1].d[4]*m2(1,4)+mA[2].d[4]*m2(2,4)+mA[3].d[4]*m2(3,4)+mA[4].d[4]*m2(4,4))
                      );
       }
+#endif // USE_AVX2
 
 
 #else 
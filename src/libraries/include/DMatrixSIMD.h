@@ -8,6 +8,12 @@
 #ifdef USE_SSE3
 #include <pmmintrin.h> // Header file for SSE3 SIMD instructions
 #endif
+#ifdef USE_AVX2
+#ifndef USE_SSE3
+#error "USE_AVX2 must be used together with USE_SSE2 and USE_SSE3"
+#endif
+#include <immintrin.h> // Header file for AVX2 and FMA SIMD instructions
+#endif
 #include <iostream>
 #include <iomanip>
 using namespace std;
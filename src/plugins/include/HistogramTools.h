@@ -3,10 +3,18 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <functional>
 
 #include <JANA/JApplication.h>
 #include <TH1I.h>
+#include <TH1D.h>
 #include <TH2I.h>
+#include <TH2D.h>
 #include <TH3I.h>
 #include <TProfile.h>
 #include <TProfile2D.h>
@@ -707,4 +715,402 @@ TObject* GetHistPointer(const char * plugin, const char * directoryName, const c
 
 }
 
+//-----------------------------------------------------------------------------
+// Histogram handles
+//
+// The FillXXX functions above look up the histogram by name and take a
+// lock on every call. For histograms filled many times per event the
+// handle interface below can be used instead. A handle is obtained once
+// (in init()) for a histogram that is made (or found) exactly as the
+// FillXXX functions would make it, so the two can be mixed and
+// GetHistPointer() and SortDirectories() work the same.
+//
+// Filling through a handle only touches a copy of the histogram
+// contents that belongs to the calling thread. No locks are taken. The
+// copies are added to the ROOT histograms by MergeHistogramHandles(),
+// which should be called in erun() and fini(). It may also be called at
+// any other time (e.g. for an online snapshot) from any thread, in which
+// case fills done at the same moment by other threads may be split
+// between this merge and the next one.
+//
+//    // in the class definition
+//    HistogramHandle1D hE;
+//
+//    // init()
+//    hE = Get1DHistogramHandle("myplugin", "dir", "E", "Energy;E (GeV)", 100, 0.0, 10.0);
+//
+//    // evnt()
+//    hE.Fill(E);
+//
+//    // erun() and fini()
+//    MergeHistogramHandles();
+//
+// Statistics follow TH1::Fill: fills in the under/overflow bins count
+// as entries but are not included in the mean and RMS. Handles of
+// unweighted histograms have no weight argument. Handles from
+// Get1DWeightedHistogramHandle and Get2DWeightedHistogramHandle take
+// one and keep the sum of squares of weights as TH1::Fill does.
+//-----------------------------------------------------------------------------
+
+class HistogramAxisShadow{
+   public:
+      void Set(const TAxis *axis){
+         nbins = axis->GetNbins();
+         xmin  = axis->GetXmin();
+         xmax  = axis->GetXmax();
+         const TArrayD *xbins = axis->GetXbins();
+         edges.assign(xbins->GetArray(), xbins->GetArray()+xbins->GetSize());
+      }
+
+      // Same result as TAxis::FindFixBin
+      inline int FindBin(double x) const {
+         if (x < xmin) return 0;
+         if (!(x < xmax)) return nbins+1;
+         if (edges.empty()) return 1 + int(nbins*(x-xmin)/(xmax-xmin));
+         return std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+      }
+
+      int nbins;
+      double xmin, xmax;
+      vector<double> edges; // only for variable bin sizes
+};
+
+class HistogramHandleInfo{
+   public:
+      TH1 *histogram;
+      pthread_rwlock_t *histogramLock; // the same lock the FillXXX functions use
+      int ndim;
+      bool weighted;
+      HistogramAxisShadow xaxis, yaxis;
+      unsigned int nbins_total; // including under/overflow bins
+};
+
+// The contents of one histogram filled by one thread. Only the owning
+// thread writes to the atomics (so a load and a store is enough to add
+// to them). The merged_xxx values are what has been added to the ROOT
+// histogram so far and are only used while merging.
+class HistogramShadow{
+   public:
+      enum{kEntries, kSumw, kSumw2, kSumwx, kSumwx2, kSumwy, kSumwy2, kSumwxy, kNstats};
+
+      HistogramShadow(const HistogramHandleInfo *info):info(info),non_unit_weight(false){
+         sumw.reset(new atomic<double>[info->nbins_total]);
+         merged_sumw.assign(info->nbins_total, 0.0);
+         for (unsigned int i=0; i<info->nbins_total; i++) sumw[i].store(0.0, memory_order_relaxed);
+         if (info->weighted){
+            sumw2.reset(new atomic<double>[info->nbins_total]);
+            merged_sumw2.assign(info->nbins_total, 0.0);
+            for (unsigned int i=0; i<info->nbins_total; i++) sumw2[i].store(0.0, memory_order_relaxed);
+         }
+         for (int i=0; i<kNstats; i++){
+            stats[i].store(0.0, memory_order_relaxed);
+            merged_stats[i] = 0.0;
+         }
+      }
+
+      static inline void Add(atomic<double> &a, double v){ a.store(a.load(memory_order_relaxed) + v, memory_order_relaxed); }
+
+      inline void Fill1D(double x, double w){
+         int bin = info->xaxis.FindBin(x);
+         Add(stats[kEntries], 1.0);
+         Add(sumw[bin], w);
+         if (info->weighted){
+            Add(sumw2[bin], w*w);
+            if (w != 1.0) non_unit_weight.store(true, memory_order_relaxed);
+         }
+         if (bin == 0 || bin > info->xaxis.nbins) return;
+         Add(stats[kSumw], w);
+         Add(stats[kSumw2], w*w);
+         Add(stats[kSumwx], w*x);
+         Add(stats[kSumwx2], w*x*x);
+      }
+
+      inline void Fill2D(double x, double y, double w){
+         int binx = info->xaxis.FindBin(x);
+         int biny = info->yaxis.FindBin(y);
+         int bin = binx + (info->xaxis.nbins+2)*biny;
+         Add(stats[kEntries], 1.0);
+         Add(sumw[bin], w);
+         if (info->weighted){
+            Add(sumw2[bin], w*w);
+            if (w != 1.0) non_unit_weight.store(true, memory_order_relaxed);
+         }
+         if (binx == 0 || binx > info->xaxis.nbins) return;
+         if (biny == 0 || biny > info->yaxis.nbins) return;
+         Add(stats[kSumw], w);
+         Add(stats[kSumw2], w*w);
+         Add(stats[kSumwx], w*x);
+         Add(stats[kSumwx2], w*x*x);
+         Add(stats[kSumwy], w*y);
+         Add(stats[kSumwy2], w*y*y);
+         Add(stats[kSumwxy], w*x*y);
+      }
+
+      void Merge(void){
+         // Add what has been filled since the last merge to the ROOT
+         // histogram. The ROOT and histogram locks must be held.
+         TH1 *h = info->histogram;
+
+         double hstats[13] = {0.0};
+         h->GetStats(hstats); // (before changing the bin contents)
+         double entries = h->GetEntries();
+
+         // Weighted fills switch the histogram to storing the sum of
+         // squares of weights the same way TH1::Fill does
+         if (info->weighted && non_unit_weight.load(memory_order_relaxed) && h->GetSumw2N()==0) h->Sumw2();
+         TArrayD *hsumw2 = h->GetSumw2N()>0 ? h->GetSumw2():NULL;
+
+         for (unsigned int bin=0; bin<info->nbins_total; bin++){
+            double w = sumw[bin].load(memory_order_relaxed);
+            double dw = w - merged_sumw[bin];
+            double dw2 = dw;
+            if (info->weighted){
+               double w2 = sumw2[bin].load(memory_order_relaxed);
+               dw2 = w2 - merged_sumw2[bin];
+               merged_sumw2[bin] = w2;
+            }
+            if (dw == 0.0 && dw2 == 0.0) continue;
+            merged_sumw[bin] = w;
+            h->AddBinContent(bin, dw);
+            if (hsumw2) hsumw2->fArray[bin] += dw2;
+         }
+
+         double d[kNstats];
+         for (int i=0; i<kNstats; i++){
+            double v = stats[i].load(memory_order_relaxed);
+            d[i] = v - merged_stats[i];
+            merged_stats[i] = v;
+         }
+         hstats[0] += d[kSumw];
+         hstats[1] += d[kSumw2];
+         hstats[2] += d[kSumwx];
+         hstats[3] += d[kSumwx2];
+         if (info->ndim == 2){
+            hstats[4] += d[kSumwy];
+            hstats[5] += d[kSumwy2];
+            hstats[6] += d[kSumwxy];
+         }
+         h->PutStats(hstats);
+         h->SetEntries(entries + d[kEntries]);
+      }
+
+      const HistogramHandleInfo *info;
+      unique_ptr<atomic<double>[]> sumw, sumw2;
+      atomic<double> stats[kNstats];
+      atomic<bool> non_unit_weight;
+      vector<double> merged_sumw, merged_sumw2;
+      double merged_stats[kNstats];
+};
+
+class HistogramShadowSet{
+   public:
+      vector<HistogramShadow*> shadows; // indexed by handle id
+};
+
+mutex& GetHistogramHandleMutex(void){
+   static mutex handleMutex;
+   return handleMutex;
+}
+
+vector<HistogramHandleInfo*>& GetHistogramHandleInfos(void){
+   static vector<HistogramHandleInfo*> handleInfos;
+   return handleInfos;
+}
+
+vector<HistogramShadowSet*>& GetHistogramShadowSets(void){
+   // Sets for all threads. These are kept until the end of the program
+   // so nothing is lost if a thread ends before the last merge.
+   static vector<HistogramShadowSet*> shadowSets;
+   return shadowSets;
+}
+
+inline HistogramShadowSet*& GetThreadHistogramShadowSet(void){
+   static thread_local HistogramShadowSet *shadowSet = NULL;
+   return shadowSet;
+}
+
+HistogramShadow* MakeHistogramShadow(unsigned int id){
+   // Called the first time a thread fills a given handle. The lock keeps
+   // MergeHistogramHandles() from looking at the set while it changes.
+   lock_guard<mutex> lck(GetHistogramHandleMutex());
+
+   HistogramShadowSet *&shadowSet = GetThreadHistogramShadowSet();
+   if (shadowSet == NULL){
+      shadowSet = new HistogramShadowSet();
+      GetHistogramShadowSets().push_back(shadowSet);
+   }
+   if (shadowSet->shadows.size() <= id) shadowSet->shadows.resize(id+1, NULL);
+   if (shadowSet->shadows[id] == NULL) shadowSet->shadows[id] = new HistogramShadow(GetHistogramHandleInfos()[id]);
+
+   return shadowSet->shadows[id];
+}
+
+inline HistogramShadow* GetHistogramShadow(unsigned int id){
+   HistogramShadowSet *shadowSet = GetThreadHistogramShadowSet();
+   if (shadowSet && id < shadowSet->shadows.size() && shadowSet->shadows[id]) return shadowSet->shadows[id];
+   return MakeHistogramShadow(id);
+}
+
+// Handles for the unweighted (TH1I/TH2I) histograms take no weight, the
+// same as Fill1DHistogram/Fill2DHistogram. Use the weighted handles
+// (TH1D/TH2D) for weights.
+class HistogramHandle1D{
+   public:
+      HistogramHandle1D():id(0),valid(false){}
+      HistogramHandle1D(unsigned int id):id(id),valid(true){}
+
+      inline void Fill(double x) const {
+         if (valid) GetHistogramShadow(id)->Fill1D(x, 1.0);
+      }
+
+   private:
+      unsigned int id;
+      bool valid;
+};
+
+class HistogramWeightedHandle1D{
+   public:
+      HistogramWeightedHandle1D():id(0),valid(false){}
+      HistogramWeightedHandle1D(unsigned int id):id(id),valid(true){}
+
+      inline void Fill(double x, double w) const {
+         if (valid) GetHistogramShadow(id)->Fill1D(x, w);
+      }
+
+   private:
+      unsigned int id;
+      bool valid;
+};
+
+class HistogramHandle2D{
+   public:
+      HistogramHandle2D():id(0),valid(false){}
+      HistogramHandle2D(unsigned int id):id(id),valid(true){}
+
+      inline void Fill(double x, double y) const {
+         if (valid) GetHistogramShadow(id)->Fill2D(x, y, 1.0);
+      }
+
+   private:
+      unsigned int id;
+      bool valid;
+};
+
+class HistogramWeightedHandle2D{
+   public:
+      HistogramWeightedHandle2D():id(0),valid(false){}
+      HistogramWeightedHandle2D(unsigned int id):id(id),valid(true){}
+
+      inline void Fill(double x, double y, double w) const {
+         if (valid) GetHistogramShadow(id)->Fill2D(x, y, w);
+      }
+
+   private:
+      unsigned int id;
+      bool valid;
+};
+
+template<class T>
+T* MakeHistogramForHandle(map<TString, pair<T*, pthread_rwlock_t*> > &histMap, const char * plugin, const char * directoryName, const char * name, pthread_rwlock_t *&histogramLock, const function<T*(void)> &make){
+   // Find the histogram in the map used by the FillXXX functions or
+   // make it in the same directory they would. The handle mutex and
+   // the ROOT lock must be held.
+   char fullNameChar[500];
+   sprintf(fullNameChar, "%s/%s/%s", plugin, directoryName, name);
+   TString fullName = TString(fullNameChar);
+
+   auto iter = histMap.find(fullName);
+   if (iter != histMap.end()){
+      histogramLock = iter->second.second;
+      return iter->second.first;
+   }
+
+   histogramLock = new pthread_rwlock_t();
+   pthread_rwlock_init(histogramLock, NULL);
+
+   TDirectory *homedir = gDirectory;
+   TDirectory *temp;
+   temp = gDirectory->mkdir(plugin);
+   if(temp) GetAllDirectories().push_back(temp);
+   gDirectory->cd(plugin);
+   GetAllDirectories().push_back(gDirectory->mkdir(directoryName));
+   gDirectory->cd(directoryName);
+   T *histogram = make();
+   homedir->cd();
+
+   histMap[fullName] = make_pair(histogram, histogramLock);
+   return histogram;
+}
+
+template<class T>
+unsigned int RegisterHistogramHandle(map<TString, pair<T*, pthread_rwlock_t*> > &histMap, const char * plugin, const char * directoryName, const char * name, int ndim, bool weighted, const function<T*(void)> &make){
+   // Should be called from init() since the histogram maps are not
+   // otherwise protected from the FillXXX functions here.
+   lock_guard<mutex> lck(GetHistogramHandleMutex());
+   japp->RootWriteLock();
+
+   HistogramHandleInfo *info = new HistogramHandleInfo();
+   info->histogram = MakeHistogramForHandle(histMap, plugin, directoryName, name, info->histogramLock, make);
+   info->ndim = ndim;
+   info->weighted = weighted;
+   info->xaxis.Set(info->histogram->GetXaxis());
+   info->yaxis.Set(info->histogram->GetYaxis());
+   info->nbins_total = (info->xaxis.nbins+2)*(ndim==2 ? info->yaxis.nbins+2:1);
+
+   japp->RootUnLock();
+
+   GetHistogramHandleInfos().push_back(info);
+   return GetHistogramHandleInfos().size()-1;
+}
+
+HistogramHandle1D Get1DHistogramHandle(const char * plugin, const char * directoryName, const char * name, const char * title, int nBins, double xmin, double xmax){
+   return HistogramHandle1D(RegisterHistogramHandle<TH1I>(Get1DMap(), plugin, directoryName, name, 1, false,
+      [&](){return new TH1I(name, title, nBins, xmin, xmax);}));
+}
+
+HistogramHandle1D Get1DHistogramHandle(const char * plugin, const char * directoryName, const char * name, const char * title, int nBins, double *xbins){
+   return HistogramHandle1D(RegisterHistogramHandle<TH1I>(Get1DMap(), plugin, directoryName, name, 1, false,
+      [&](){return new TH1I(name, title, nBins, xbins);}));
+}
+
+HistogramWeightedHandle1D Get1DWeightedHistogramHandle(const char * plugin, const char * directoryName, const char * name, const char * title, int nBins, double xmin, double xmax){
+   return HistogramWeightedHandle1D(RegisterHistogramHandle<TH1D>(Get1DWeightedMap(), plugin, directoryName, name, 1, true,
+      [&](){return new TH1D(name, title, nBins, xmin, xmax);}));
+}
+
+HistogramHandle2D Get2DHistogramHandle(const char * plugin, const char * directoryName, const char * name, const char * title, int nBinsX, double xmin, double xmax, int nBinsY, double ymin, double ymax){
+   return HistogramHandle2D(RegisterHistogramHandle<TH2I>(Get2DMap(), plugin, directoryName, name, 2, false,
+      [&](){return new TH2I(name, title, nBinsX, xmin, xmax, nBinsY, ymin, ymax);}));
+}
+
+HistogramHandle2D Get2DHistogramHandle(const char * plugin, const char * directoryName, const char * name, const char * title, int nBinsX, double *xbins, int nBinsY, double *ybins){
+   return HistogramHandle2D(RegisterHistogramHandle<TH2I>(Get2DMap(), plugin, directoryName, name, 2, false,
+      [&](){return new TH2I(name, title, nBinsX, xbins, nBinsY, ybins);}));
+}
+
+HistogramWeightedHandle2D Get2DWeightedHistogramHandle(const char * plugin, const char * directoryName, const char * name, const char * title, int nBinsX, double xmin, double xmax, int nBinsY, double ymin, double ymax){
+   return HistogramWeightedHandle2D(RegisterHistogramHandle<TH2D>(Get2DWeightedMap(), plugin, directoryName, name, 2, true,
+      [&](){return new TH2D(name, title, nBinsX, xmin, xmax, nBinsY, ymin, ymax);}));
+}
+
+void MergeHistogramHandles(){
+   // Add the contents filled through handles by all threads to the
+   // ROOT histograms
+   lock_guard<mutex> lck(GetHistogramHandleMutex());
+   japp->RootWriteLock();
+
+   vector<HistogramHandleInfo*> &handleInfos = GetHistogramHandleInfos();
+   vector<HistogramShadowSet*> &shadowSets = GetHistogramShadowSets();
+   for (unsigned int id=0; id<handleInfos.size(); id++){
+      pthread_rwlock_wrlock(handleInfos[id]->histogramLock);
+      for (auto shadowSet : shadowSets){
+         if (id < shadowSet->shadows.size() && shadowSet->shadows[id]) shadowSet->shadows[id]->Merge();
+      }
+      pthread_rwlock_unlock(handleInfos[id]->histogramLock);
+   }
+
+   japp->RootUnLock();
+}
+
+
 #endif
@@ -0,0 +1,451 @@
+
+// Benchmark for magnetic field lookups in DMagneticFieldMapFineMesh.
+//
+// A set of trajectories is swum through the field with
+// DMagneticFieldStepper (or read from a file written by an earlier
+// run using -o) and the position of every step is recorded. The field
+// and gradient are then looked up at all of the recorded points using:
+//
+//   old     - the fine mesh copied into the nested vector<vector<>>
+//             layout the map used to have, with the old lookup code
+//   scalar  - GetFieldAndGradient one point at a time
+//   batch   - GetFieldsAndGradients with the SIMD kernel disabled
+//   SIMD    - GetFieldsAndGradients using AVX2 (if supported)
+//
+// Results of every method are checked against the scalar one.
+//
+// With -f the table is then converted to single precision (as with
+// BFIELD_FINEMESH_FLOAT=1) and the scalar and SIMD methods are timed
+// again. Their results are compared to the double precision ones and
+// the largest differences in the field and the gradient are printed.
+// The single precision SIMD results are also checked against the
+// single precision scalar ones.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+using namespace std;
+using namespace std::chrono;
+
+#include <DANA/DApplication.h>
+#include <HDGEOMETRY/DMagneticFieldMapFineMesh.h>
+#include <TRACKING/DMagneticFieldStepper.h>
+
+void Usage(string mess);
+void ParseCommandLineArguments(int narg, char *argv[], vector<char*> &unused_args);
+void SwimTrajectories(const DMagneticFieldMap *bfield, vector<double> &x, vector<double> &y, vector<double> &z);
+bool ReadTrajectories(string fname, vector<double> &x, vector<double> &y, vector<double> &z);
+void WriteTrajectories(string fname, vector<double> &x, vector<double> &y, vector<double> &z);
+
+int32_t  RUN_NUMBER = 30000;
+uint32_t NTRACKS    = 2000;
+uint32_t NREPEAT    = 20;
+double   STEP_SIZE  = 0.5;
+string   INFILE;
+string   OUTFILE;
+bool     COMPARE_FLOAT = false;
+
+typedef DMagneticFieldMapFineMesh::DBfieldCylindrical_t DBfieldCylindrical_t;
+
+// The fine mesh in the layout DMagneticFieldMapFineMesh used before it
+// was flattened. Lookup follows the old GetFieldAndGradient. Points
+// not in the fine mesh are passed on to the map itself.
+class OldFineMesh{
+	public:
+		OldFineMesh(const DMagneticFieldMapFineMesh *bfield):bfield(bfield){
+			double rmin, dr, dz;
+			unsigned int Nr, Nz;
+			bfield->GetFineMeshLimits(rmin, rmaxFine, dr, Nr, zminFine, zmaxFine, dz, Nz);
+			rscale = 1./dr;
+			zscale = 1./dz;
+
+			// The table is single precision if BFIELD_FINEMESH_FLOAT=1
+			const double *cell  = bfield->GetFineMesh();
+			const float  *cellF = bfield->GetFineMeshFloat();
+			if(cell==NULL && cellF==NULL){
+				// No fine mesh. Pass every point on to the map.
+				zminFine = zmaxFine = rmaxFine = 0.0;
+				return;
+			}
+			auto value = [&](size_t offset, int k){ return cell!=NULL ? cell[offset+k]:(double)cellF[offset+k]; };
+			size_t offset = 0;
+			mBfine.resize(Nr);
+			for(auto &row : mBfine){
+				row.resize(Nz);
+				for(auto &f : row){
+					f.Br    = value(offset, DMagneticFieldMapFineMesh::kBr   );
+					f.Bz    = value(offset, DMagneticFieldMapFineMesh::kBz   );
+					f.dBrdr = value(offset, DMagneticFieldMapFineMesh::kdBrdr);
+					f.dBrdz = value(offset, DMagneticFieldMapFineMesh::kdBrdz);
+					f.dBzdr = value(offset, DMagneticFieldMapFineMesh::kdBzdr);
+					f.dBzdz = value(offset, DMagneticFieldMapFineMesh::kdBzdz);
+					offset += DMagneticFieldMapFineMesh::kNfineValues;
+				}
+			}
+		}
+
+		void GetFieldAndGradient(double x,double y,double z,
+			double &Bx_,double &By_,double &Bz_,
+			double &dBxdx_, double &dBxdy_, double &dBxdz_,
+			double &dBydx_, double &dBydy_, double &dBydz_,
+			double &dBzdx_, double &dBzdy_, double &dBzdz_) const;
+
+	protected:
+		const DMagneticFieldMapFineMesh *bfield;
+		vector<vector<DBfieldCylindrical_t> > mBfine;
+		double zminFine, zmaxFine, rmaxFine;
+		double rscale, zscale;
+};
+
+// Output arrays for one method
+class FieldAndGradient{
+	public:
+		FieldAndGradient(size_t n){ for(auto &v : vals) v.resize(n); }
+		double* operator[](int i){ return vals[i].data(); }
+		bool operator==(const FieldAndGradient &o) const {
+			for(int k=0; k<12; k++){
+				if(memcmp(vals[k].data(), o.vals[k].data(), vals[k].size()*sizeof(double))) return false;
+			}
+			return true;
+		}
+		vector<double> vals[12];
+};
+
+void MaxDifference(FieldAndGradient &ref, FieldAndGradient &out, double &maxdB, double &maxdB_rel, double &maxdgrad);
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	vector<char*> unused_args;
+	ParseCommandLineArguments(narg, argv, unused_args);
+
+	DApplication *dapp = new DApplication(unused_args.size(), unused_args.empty() ? NULL:&unused_args[0]);
+	dapp->Init();
+
+	DMagneticFieldMapFineMesh *bfield = dynamic_cast<DMagneticFieldMapFineMesh*>(dapp->GetBfield(RUN_NUMBER));
+	if(!bfield){
+		cout << "Field map is not a DMagneticFieldMapFineMesh. Nothing to benchmark." << endl;
+		return -1;
+	}
+
+	// Get trajectory points
+	vector<double> x, y, z;
+	if(!INFILE.empty()){
+		if(!ReadTrajectories(INFILE, x, y, z)) return -1;
+	}else{
+		SwimTrajectories(bfield, x, y, z);
+	}
+	if(!OUTFILE.empty()) WriteTrajectories(OUTFILE, x, y, z);
+	size_t N = x.size();
+	if(N == 0){
+		cout << "No trajectory points!" << endl;
+		return -1;
+	}
+	cout << N << " trajectory points. Each looked up " << NREPEAT << " times per method" << endl;
+	cout << endl;
+
+	OldFineMesh old(bfield);
+	FieldAndGradient ref(N);
+	FieldAndGradient out(N);
+
+	// The scalar method is done first to provide the reference results
+	const char *names[4] = {"scalar", "old", "batch", "SIMD"};
+	double t[4];
+	string status[4];
+	for(int method=0; method<4; method++){
+
+		FieldAndGradient &o = method==0 ? ref:out;
+		for(auto &v : o.vals) memset(v.data(), 0, N*sizeof(double));
+
+		auto tstart = high_resolution_clock::now();
+		for(uint32_t irep=0; irep<NREPEAT; irep++){
+			switch(method){
+				case 0:
+					for(size_t i=0; i<N; i++){
+						bfield->GetFieldAndGradient(x[i], y[i], z[i], o[0][i], o[1][i], o[2][i],
+							o[3][i], o[4][i], o[5][i], o[6][i], o[7][i], o[8][i], o[9][i], o[10][i], o[11][i]);
+					}
+					break;
+				case 1:
+					for(size_t i=0; i<N; i++){
+						old.GetFieldAndGradient(x[i], y[i], z[i], o[0][i], o[1][i], o[2][i],
+							o[3][i], o[4][i], o[5][i], o[6][i], o[7][i], o[8][i], o[9][i], o[10][i], o[11][i]);
+					}
+					break;
+				case 2:
+				case 3:
+					bfield->SetBatchSIMD(method==3);
+					bfield->GetFieldsAndGradients(N, x.data(), y.data(), z.data(), o[0], o[1], o[2],
+						o[3], o[4], o[5], o[6], o[7], o[8], o[9], o[10], o[11]);
+					break;
+			}
+		}
+		auto tend = high_resolution_clock::now();
+		t[method] = duration_cast<duration<double>>(tend - tstart).count();
+
+		if(method != 0) status[method] = (out == ref) ? "OK":"MISMATCH!";
+		if(method==3 && !bfield->GetBatchSIMD()) status[method] += " (AVX2 not supported)";
+	}
+	bfield->SetBatchSIMD(true);
+
+	for(int method=0; method<4; method++){
+		char str[256];
+		sprintf(str, "%8s: %8.3f s  %7.2f ns/point  speedup vs. old=%5.2f  %s",
+			names[method], t[method], t[method]/(double)N/(double)NREPEAT*1.0E9, t[1]/t[method], status[method].c_str());
+		cout << str << endl;
+	}
+	cout << endl;
+
+	// Single precision table
+	if(COMPARE_FLOAT){
+		if(bfield->IsFineMeshFloat()){
+			cout << "Fine mesh is already single precision. Nothing to compare to." << endl;
+			return 0;
+		}
+		bfield->ConvertFineMeshToFloat();
+		cout << "Single precision fine mesh (differences are from double precision scalar):" << endl;
+		const char *fnames[2] = {"f scalar", "f SIMD"};
+		FieldAndGradient fref(N);
+		for(int method=0; method<2; method++){
+			// f scalar provides the reference for f SIMD
+			FieldAndGradient &o = method==0 ? fref:out;
+			for(auto &v : o.vals) memset(v.data(), 0, N*sizeof(double));
+			bfield->SetBatchSIMD(method==1);
+			auto tstart = high_resolution_clock::now();
+			for(uint32_t irep=0; irep<NREPEAT; irep++){
+				if(method==0){
+					for(size_t i=0; i<N; i++){
+						bfield->GetFieldAndGradient(x[i], y[i], z[i], o[0][i], o[1][i], o[2][i],
+							o[3][i], o[4][i], o[5][i], o[6][i], o[7][i], o[8][i], o[9][i], o[10][i], o[11][i]);
+					}
+				}else{
+					bfield->GetFieldsAndGradients(N, x.data(), y.data(), z.data(), o[0], o[1], o[2],
+						o[3], o[4], o[5], o[6], o[7], o[8], o[9], o[10], o[11]);
+				}
+			}
+			auto tend = high_resolution_clock::now();
+			double tf = duration_cast<duration<double>>(tend - tstart).count();
+
+			double maxdB, maxdB_rel, maxdgrad;
+			MaxDifference(ref, o, maxdB, maxdB_rel, maxdgrad);
+			char str[256];
+			sprintf(str, "%8s: %8.3f s  %7.2f ns/point  speedup vs. old=%5.2f  max|dB|=%.2e T (%.2e of |B|)  max|dgrad|=%.2e T/cm",
+				fnames[method], tf, tf/(double)N/(double)NREPEAT*1.0E9, t[1]/tf, maxdB, maxdB_rel, maxdgrad);
+			cout << str << endl;
+		}
+
+		// The SIMD lookup in the single precision table should give the
+		// same results as the scalar one
+		double maxdB, maxdB_rel, maxdgrad;
+		MaxDifference(fref, out, maxdB, maxdB_rel, maxdgrad);
+		char str[256];
+		sprintf(str, "f SIMD vs. f scalar: max|dB|=%.2e T (%.2e of |B|)  max|dgrad|=%.2e T/cm  %s%s",
+			maxdB, maxdB_rel, maxdgrad, (out == fref) ? "OK":"MISMATCH!",
+			bfield->GetBatchSIMD() ? "":" (AVX2 not supported)");
+		cout << str << endl;
+		bfield->SetBatchSIMD(true);
+		cout << endl;
+	}
+
+	return 0;
+}
+
+//----------------
+// OldFineMesh::GetFieldAndGradient
+//----------------
+void OldFineMesh::GetFieldAndGradient(double x,double y,double z,
+	double &Bx_,double &By_,double &Bz_,
+	double &dBxdx_, double &dBxdy_, double &dBxdz_,
+	double &dBydx_, double &dBydy_, double &dBydz_,
+	double &dBzdx_, double &dBzdy_, double &dBzdz_) const
+{
+	double r = sqrt(x*x + y*y);
+	if (z<zminFine || z>=zmaxFine || r>=rmaxFine){
+		bfield->GetFieldAndGradient(x, y, z, Bx_, By_, Bz_,
+			dBxdx_, dBxdy_, dBxdz_,
+			dBydx_, dBydy_, dBydz_,
+			dBzdx_, dBzdy_, dBzdz_);
+		return;
+	}
+
+	unsigned int indr=static_cast<unsigned int>(r*rscale);
+	unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
+	const DBfieldCylindrical_t *field=&mBfine[indr][indz];
+
+	Bz_=field->Bz;
+	double Br_=field->Br;
+	double dBrdx_=field->dBrdr;
+	double dBrdz_=field->dBrdz;
+	dBzdz_=field->dBzdz;
+	dBzdx_=field->dBzdr;
+
+	double cos_theta = x/r;
+	double sin_theta = y/r;
+	if(r==0.0){
+		cos_theta=1.0;
+		sin_theta=0.0;
+	}
+	Bx_=Br_*cos_theta;
+	By_=Br_*sin_theta;
+
+	dBxdx_ =dBrdx_*cos_theta*cos_theta;
+	dBxdy_ =dBrdx_*cos_theta*sin_theta;
+	dBxdz_ =dBrdz_*cos_theta;
+	dBydx_=dBxdy_;
+	dBydy_ = dBrdx_*sin_theta*sin_theta;
+	dBydz_ = dBrdz_*sin_theta;
+	dBzdx_ = dBzdx_*cos_theta;
+	dBzdy_ = dBzdx_*sin_theta;
+}
+
+//----------------
+// MaxDifference
+//----------------
+void MaxDifference(FieldAndGradient &ref, FieldAndGradient &out, double &maxdB, double &maxdB_rel, double &maxdgrad)
+{
+	/// Find the largest difference between out and ref in any field
+	/// component, the same relative to the field magnitude, and the
+	/// largest difference in any gradient component.
+	maxdB = maxdB_rel = maxdgrad = 0.0;
+	size_t N = ref.vals[0].size();
+	for(size_t i=0; i<N; i++){
+		double Bmag = sqrt(ref[0][i]*ref[0][i] + ref[1][i]*ref[1][i] + ref[2][i]*ref[2][i]);
+		for(int k=0; k<3; k++){
+			double d = fabs(out[k][i] - ref[k][i]);
+			if(d > maxdB) maxdB = d;
+			if(Bmag>0.0 && d/Bmag > maxdB_rel) maxdB_rel = d/Bmag;
+		}
+		for(int k=3; k<12; k++){
+			double d = fabs(out[k][i] - ref[k][i]);
+			if(d > maxdgrad) maxdgrad = d;
+		}
+	}
+}
+
+//----------------
+// SwimTrajectories
+//----------------
+void SwimTrajectories(const DMagneticFieldMap *bfield, vector<double> &x, vector<double> &y, vector<double> &z)
+{
+	/// Swim NTRACKS tracks of random charge and momentum from the
+	/// target and record the position after every step until the
+	/// track leaves the tracking volume.
+	mt19937 rng(1234);
+	uniform_real_distribution<double> flat(0.0, 1.0);
+
+	DMagneticFieldStepper stepper(bfield);
+	stepper.SetStepSize(STEP_SIZE);
+	for(uint32_t itrk=0; itrk<NTRACKS; itrk++){
+		double q     = flat(rng)<0.5 ? -1.0:+1.0;
+		double p     = 0.2 + 3.8*flat(rng);
+		double theta = (1.0 + 139.0*flat(rng))*M_PI/180.0;
+		double phi   = 2.0*M_PI*flat(rng);
+		DVector3 pos(0.0, 0.0, 50.0 + 30.0*flat(rng));
+		DVector3 mom;
+		mom.SetMagThetaPhi(p, theta, phi);
+		stepper.SetStartingParams(q, &pos, &mom);
+		for(int istep=0; istep<10000; istep++){
+			stepper.Step(&pos);
+			if(pos.Perp()>90.0 || pos.z()<0.0 || pos.z()>650.0) break;
+			x.push_back(pos.x());
+			y.push_back(pos.y());
+			z.push_back(pos.z());
+		}
+	}
+	cout << "Swam " << NTRACKS << " tracks with step size " << STEP_SIZE << " cm" << endl;
+}
+
+//----------------
+// ReadTrajectories
+//----------------
+bool ReadTrajectories(string fname, vector<double> &x, vector<double> &y, vector<double> &z)
+{
+	/// Read trajectory points written by WriteTrajectories. The file
+	/// is just x,y,z triplets of doubles.
+	ifstream ifs(fname.c_str(), ios::binary);
+	if(!ifs.is_open()){
+		cout << "Unable to open " << fname << " for reading!" << endl;
+		return false;
+	}
+	double pos[3];
+	while(ifs.read((char*)pos, sizeof(pos))){
+		x.push_back(pos[0]);
+		y.push_back(pos[1]);
+		z.push_back(pos[2]);
+	}
+	cout << "Read " << x.size() << " trajectory points from " << fname << endl;
+	return true;
+}
+
+//----------------
+// WriteTrajectories
+//----------------
+void WriteTrajectories(string fname, vector<double> &x, vector<double> &y, vector<double> &z)
+{
+	ofstream ofs(fname.c_str(), ios::binary);
+	for(size_t i=0; i<x.size(); i++){
+		double pos[3] = {x[i], y[i], z[i]};
+		ofs.write((char*)pos, sizeof(pos));
+	}
+	cout << "Wrote " << x.size() << " trajectory points to " << fname << endl;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    bfield_bench [options] [JANA options]" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -R run        Run number used to get field map (default 30000)" << endl;
+	cout << "   -t Ntracks    Number of tracks to swim (default 2000)" << endl;
+	cout << "   -s step       Swim step size in cm (default 0.5)" << endl;
+	cout << "   -r Nrepeat    Number of times to look up each point (default 20)" << endl;
+	cout << "   -i file       Read trajectory points from file instead of swimming" << endl;
+	cout << "   -o file       Write trajectory points to file" << endl;
+	cout << "   -f            Also time and check a single precision fine mesh" << endl;
+	cout << endl;
+	cout << "Any other arguments are passed to DApplication (e.g." << endl;
+	cout << "-PBFIELD_MAP=Magnets/Solenoid/solenoid_1350A_poisson_20160222)" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int narg, char *argv[], vector<char*> &unused_args)
+{
+	unused_args.push_back(argv[0]);
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-R"){ RUN_NUMBER = atoi(next.c_str()); i++;}
+		else if(arg == "-t"){ NTRACKS    = atoi(next.c_str()); i++;}
+		else if(arg == "-s"){ STEP_SIZE  = atof(next.c_str()); i++;}
+		else if(arg == "-r"){ NREPEAT    = atoi(next.c_str()); i++;}
+		else if(arg == "-i"){ INFILE     = next; i++;}
+		else if(arg == "-o"){ OUTFILE    = next; i++;}
+		else if(arg == "-f"){ COMPARE_FLOAT = true;}
+		else unused_args.push_back(argv[i]);
+	}
+}
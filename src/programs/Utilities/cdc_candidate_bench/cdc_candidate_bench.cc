@@ -0,0 +1,224 @@
+
+// Benchmark for the CDC track finding in DTrackCandidate_factory_CDC.
+//
+// Events are read in the usual way. Events with fewer than MIN_HITS
+// DCDCTrackHit objects are skipped so that the timing can be limited
+// to high-occupancy events. For the others, the CDC hits are made once
+// and then the DTrackCandidate:CDC factory is reset and run NREPEAT
+// times. The time spent in the factory is accumulated and reported
+// per event and per CDC hit.
+//
+// If an output file is given with -o, the number of CDC hits and the
+// charge, momentum, and position of every candidate found are written
+// to it in text form. Running two builds over the same events and
+// diffing the files will show any change in the candidates found.
+//
+// Any JANA options (e.g. -PEVENTS_TO_KEEP=1000) may be given on the
+// command line along with the input file(s).
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+using namespace std;
+using namespace std::chrono;
+
+#include <JANA/JEventProcessor.h>
+#include <JANA/JEventLoop.h>
+#include <JANA/JFactory.h>
+using namespace jana;
+
+#include <DANA/DApplication.h>
+#include <CDC/DCDCTrackHit.h>
+#include <TRACKING/DTrackCandidate.h>
+
+
+void Usage(string mess);
+void ParseCommandLineArguments(int &narg, char *argv[]);
+
+uint32_t NREPEAT  = 10;
+uint32_t MIN_HITS = 200;
+string OUTFILE = "";
+
+//----------------
+// CDCCandidateBenchProcessor
+//----------------
+class CDCCandidateBenchProcessor:public JEventProcessor{
+	public:
+		jerror_t init(void);
+		jerror_t evnt(JEventLoop *loop, uint64_t eventnumber);
+		jerror_t fini(void);
+
+		std::mutex mtx;
+		FILE *fout = NULL;
+
+		uint64_t Nevents  = 0;
+		uint64_t Nskipped = 0;
+		uint64_t Nhits    = 0;
+		uint64_t Ncands   = 0;
+		double   t_find   = 0.0;
+};
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	CDCCandidateBenchProcessor proc;
+	DApplication *app = new DApplication(narg, argv);
+	app->Run(&proc);
+
+	delete app;
+
+	return 0;
+}
+
+//----------------
+// init
+//----------------
+jerror_t CDCCandidateBenchProcessor::init(void)
+{
+	if(OUTFILE != ""){
+		fout = fopen(OUTFILE.c_str(), "w");
+		if(!fout) cerr << "Unable to open \"" << OUTFILE << "\" for writing!" << endl;
+	}
+
+	return NOERROR;
+}
+
+//----------------
+// evnt
+//----------------
+jerror_t CDCCandidateBenchProcessor::evnt(JEventLoop *loop, uint64_t eventnumber)
+{
+	// Make the hits outside of the timed part
+	vector<const DCDCTrackHit*> cdchits;
+	loop->Get(cdchits);
+	if(cdchits.size() < MIN_HITS){
+		lock_guard<mutex> lck(mtx);
+		Nskipped++;
+		return NOERROR;
+	}
+
+	JFactory_base *fac = loop->GetFactory("DTrackCandidate", "CDC");
+	if(!fac) return RESOURCE_UNAVAILABLE;
+
+	double t = 0.0;
+	vector<const DTrackCandidate*> cands;
+	for(uint32_t irep=0; irep<NREPEAT; irep++){
+		fac->Reset(); // deletes candidates from previous pass
+
+		auto tstart = high_resolution_clock::now();
+		loop->Get(cands, "CDC");
+		auto tend = high_resolution_clock::now();
+		t += duration_cast<duration<double>>(tend - tstart).count();
+	}
+
+	vector<string> results;
+	if(fout){
+		for(auto cand : cands){
+			DVector3 mom = cand->momentum();
+			DVector3 pos = cand->position();
+			char str[512];
+			sprintf(str, "%lu %lu %d %.9g %.9g %.9g %.9g %.9g %.9g",
+					(unsigned long)eventnumber, (unsigned long)cdchits.size(), (int)cand->charge(),
+					mom.x(), mom.y(), mom.z(), pos.x(), pos.y(), pos.z());
+			results.push_back(str);
+		}
+	}
+
+	lock_guard<mutex> lck(mtx);
+	Nevents++;
+	Nhits  += cdchits.size();
+	Ncands += cands.size();
+	t_find += t;
+	if(fout) for(auto &s : results) fprintf(fout, "%s\n", s.c_str());
+
+	return NOERROR;
+}
+
+//----------------
+// fini
+//----------------
+jerror_t CDCCandidateBenchProcessor::fini(void)
+{
+	if(fout) fclose(fout);
+	fout = NULL;
+
+	if(Nevents == 0){
+		cout << "No events with at least " << MIN_HITS << " CDC hits (" << Nskipped << " events skipped)" << endl;
+		return NOERROR;
+	}
+
+	double Ncalls = (double)Nevents*NREPEAT;
+	char str[256];
+	cout << endl;
+	cout << "Found CDC candidates in " << Nevents << " events " << NREPEAT << " times each";
+	cout << " (" << Nskipped << " events with < " << MIN_HITS << " CDC hits skipped)" << endl;
+	sprintf(str, "  DTrackCandidate:CDC: %8.3f s  %8.2f us/event  %6.1f ns/hit  %5.2f hits/event  %5.2f candidates/event",
+			t_find, 1.0E6*t_find/Ncalls, 1.0E9*t_find/((double)Nhits*NREPEAT),
+			(double)Nhits/(double)Nevents, (double)Ncands/(double)Nevents);
+	cout << str << endl;
+	if(OUTFILE != "") cout << "Candidates written to: " << OUTFILE << endl;
+	cout << endl;
+
+	return NOERROR;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    cdc_candidate_bench [options] file.evio|file.hddm" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -r Nrepeat    Number of times to find the candidates in each event (default 10)" << endl;
+	cout << "   -m Nhits      Skip events with fewer than this many CDC hits (default 200)" << endl;
+	cout << "   -o file       Write the candidates found to the given text file" << endl;
+	cout << "   -PKEY=VALUE   JANA configuration parameter (e.g. -PEVENTS_TO_KEEP=1000)" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int &narg, char *argv[])
+{
+	/// Handle our own options and remove them from the argument
+	/// list so the rest can be passed to DApplication.
+
+	if(narg<2) Usage("You must supply a filename!");
+
+	int nkeep = 1;
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-r"){ NREPEAT = atoi(next.c_str()); i++;}
+		else if(arg == "-m"){ MIN_HITS = atoi(next.c_str()); i++;}
+		else if(arg == "-o"){ OUTFILE = next; i++;}
+		else argv[nkeep++] = argv[i];
+	}
+	narg = nkeep;
+
+	if(narg<2) Usage("You must supply a filename!");
+	if(NREPEAT<1) NREPEAT = 1;
+}
+
@@ -0,0 +1,410 @@
+
+// Benchmark for the DMatrix5x5 operations used by DTrackFitterKalmanSIMD.
+//
+// A set of random Jacobians, covariance matrices, and state vectors is
+// made once. Each operation the Kalman filter uses in its propagation
+// and update steps is then timed over the full set NREPEAT times.
+//
+// Every result is also compared with the same operation done with
+// plain double arithmetic. The largest difference relative to the
+// size of the matrix elements is reported for each operation. This is
+// not always zero since some versions sum the products in a different
+// order and with FMA the intermediate products are not rounded, but it
+// should be at the level of a few times the double precision epsilon.
+//
+// Which implementation is timed is decided when this is compiled
+// (USE_SSE2, USE_SSE3, USE_AVX2), the same as for the fitter. Build
+// it once per setting (e.g. scons SIMD=sse3 and SIMD=avx2) to compare
+// them. The inputs are the same for every build so the results of one
+// build can be saved with -o and checked against another with -c, e.g.
+//
+//   dmatrix_bench -o sse2.dat        (SSE2 build)
+//   dmatrix_bench -c sse2.dat        (AVX2 build)
+//
+// The program exits with a non-zero code if any result differs from
+// the plain double one, or from the saved results, by more than the
+// tolerance for that operation.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+using namespace std;
+using namespace std::chrono;
+
+#include <DMatrixSIMD.h>
+
+
+void Usage(string mess);
+void ParseCommandLineArguments(int narg, char *argv[]);
+
+uint32_t NMATRICES = 1000;
+uint32_t NREPEAT   = 2000;
+string   OUTFILE   = "";
+string   CHECKFILE = "";
+
+// Plain row-major copies of the inputs used for the reference values
+struct M5x5{ double a[5][5]; };
+struct M5x1{ double a[5]; };
+
+void   FillRandom(DMatrix5x5 &J, DMatrix5x5 &C, DMatrix5x5 &Q, DMatrix5x1 &x);
+M5x5   ToM5x5(const DMatrix5x5 &m);
+M5x5   Mult(const M5x5 &a, const M5x5 &b);
+M5x5   MultTranspose(const M5x5 &a, const M5x5 &b);
+double MaxRelDiff(const DMatrix5x5 &m, const M5x5 &ref);
+double MaxRelDiff(const DMatrix5x1 &m, const M5x1 &ref);
+double MaxRelDiff(const double *a, const double *b, uint32_t n);
+double TimeIt(const function<void(uint32_t)> &op);
+
+double sink = 0.0; // keeps the compiler from optimizing away the timed loops
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	const char *impl = "scalar";
+#if defined(USE_AVX2) && defined(__FMA__)
+	impl = "AVX2+FMA";
+#elif defined(USE_AVX2)
+	impl = "AVX2";
+#elif defined(USE_SSE3)
+	impl = "SSE3";
+#elif defined(USE_SSE2)
+	impl = "SSE2";
+#endif
+
+	srand48(12345);
+	vector<DMatrix5x5> J(NMATRICES), C(NMATRICES), Q(NMATRICES);
+	vector<DMatrix5x1> x(NMATRICES);
+	for(uint32_t i=0; i<NMATRICES; i++) FillRandom(J[i], C[i], Q[i], x[i]);
+
+	vector<DMatrix5x5> R(NMATRICES);
+	vector<DMatrix5x1> r(NMATRICES);
+
+	cout << "DMatrix5x5 implementation: " << impl << endl;
+	cout << "Timing " << NMATRICES << " matrices " << NREPEAT << " times per operation" << endl;
+	cout << endl;
+
+	// tol is the largest relative difference allowed. The products are
+	// only affected by the order of the sums and FMA so they must agree
+	// to a few times the double precision epsilon. The check of the
+	// inverse includes the rounding of C*C^-1 itself.
+	struct op_t{
+		string name;
+		function<void(uint32_t)> op;
+		function<double(uint32_t)> check;
+		double tol;
+		bool vector_result; // result is in r instead of R
+	};
+	vector<op_t> ops;
+
+	ops.push_back({"J*C", [&](uint32_t i){ R[i] = J[i]*C[i]; },
+		[&](uint32_t i){ return MaxRelDiff(R[i], Mult(ToM5x5(J[i]), ToM5x5(C[i]))); }, 1.0E-14, false});
+
+	ops.push_back({"J*C*J^T", [&](uint32_t i){ R[i] = J[i]*C[i]*J[i].Transpose(); },
+		[&](uint32_t i){ return MaxRelDiff(R[i], MultTranspose(Mult(ToM5x5(J[i]), ToM5x5(C[i])), ToM5x5(J[i]))); }, 1.0E-14, false});
+
+	ops.push_back({"C.SandwichMultiply(J)", [&](uint32_t i){ R[i] = C[i].SandwichMultiply(J[i]); },
+		[&](uint32_t i){ return MaxRelDiff(R[i], MultTranspose(Mult(ToM5x5(J[i]), ToM5x5(C[i])), ToM5x5(J[i]))); }, 1.0E-14, false});
+
+	ops.push_back({"Q.AddSym(C)", [&](uint32_t i){ R[i] = Q[i].AddSym(C[i]); },
+		[&](uint32_t i){
+			M5x5 q = ToM5x5(Q[i]), c = ToM5x5(C[i]);
+			for(int j=0; j<5; j++) for(int k=0; k<5; k++) q.a[j][k] += c.a[j][k];
+			return MaxRelDiff(R[i], q); }, 1.0E-14, false});
+
+	ops.push_back({"C.SubSym(Q)", [&](uint32_t i){ R[i] = C[i].SubSym(Q[i]); },
+		[&](uint32_t i){
+			M5x5 c = ToM5x5(C[i]), q = ToM5x5(Q[i]);
+			for(int j=0; j<5; j++) for(int k=0; k<5; k++) c.a[j][k] -= q.a[j][k];
+			return MaxRelDiff(R[i], c); }, 1.0E-14, false});
+
+	ops.push_back({"C.InvertSym()", [&](uint32_t i){ R[i] = C[i].InvertSym(); },
+		[&](uint32_t i){
+			// C*C^-1 should be the identity
+			M5x5 p = Mult(ToM5x5(C[i]), ToM5x5(R[i]));
+			for(int j=0; j<5; j++) p.a[j][j] -= 1.0;
+			double maxdiff = 0.0;
+			for(int j=0; j<5; j++) for(int k=0; k<5; k++) maxdiff = fmax(maxdiff, fabs(p.a[j][k]));
+			return maxdiff; }, 1.0E-12, false});
+
+	ops.push_back({"J*x", [&](uint32_t i){ r[i] = J[i]*x[i]; },
+		[&](uint32_t i){
+			M5x5 j = ToM5x5(J[i]);
+			M5x1 ref;
+			for(int k=0; k<5; k++){
+				ref.a[k] = 0.0;
+				for(int m=0; m<5; m++) ref.a[k] += j.a[k][m]*x[i](m);
+			}
+			return MaxRelDiff(r[i], ref); }, 1.0E-14, true});
+
+	// Results of all operations in the order they are done. These are
+	// what is written with -o and compared with -c.
+	vector<double> results;
+	vector<double> saved;
+	if(CHECKFILE != ""){
+		FILE *f = fopen(CHECKFILE.c_str(), "rb");
+		if(!f){
+			cout << "Unable to open " << CHECKFILE << endl;
+			return -1;
+		}
+		double d;
+		while(fread(&d, sizeof(d), 1, f) == 1) saved.push_back(d);
+		fclose(f);
+	}
+
+	bool passed = true;
+	for(auto &op : ops){
+		double t = TimeIt(op.op);
+
+		double maxdiff = 0.0;
+		for(uint32_t i=0; i<NMATRICES; i++) maxdiff = fmax(maxdiff, op.check(i));
+		bool ok = maxdiff <= op.tol;
+
+		// Compare with the saved results of another build
+		size_t istart = results.size();
+		for(uint32_t i=0; i<NMATRICES; i++){
+			if(op.vector_result){
+				for(int j=0; j<5; j++) results.push_back(r[i](j));
+			}else{
+				for(int j=0; j<5; j++) for(int k=0; k<5; k++) results.push_back(R[i](j,k));
+			}
+		}
+		char savedstr[64] = "";
+		if(CHECKFILE != ""){
+			double maxsaveddiff = 1.0E99;
+			if(saved.size() >= results.size()){
+				uint32_t n = op.vector_result ? 5:25;
+				maxsaveddiff = 0.0;
+				for(size_t j=istart; j<results.size(); j+=n) maxsaveddiff = fmax(maxsaveddiff, MaxRelDiff(&results[j], &saved[j], n));
+			}
+			sprintf(savedstr, "  vs. %s=%8.2e", CHECKFILE.c_str(), maxsaveddiff);
+			if(maxsaveddiff > op.tol) ok = false;
+		}
+		if(!ok) passed = false;
+
+		double Nops = (double)NMATRICES*(double)NREPEAT;
+		char str[512];
+		sprintf(str, "%22s: %8.3f s  %8.2f ns/op  max rel. diff.=%8.2e%s  %s",
+			op.name.c_str(), t, 1.0E9*t/Nops, maxdiff, savedstr, ok ? "OK":"FAILED");
+		cout << str << endl;
+	}
+	cout << endl;
+
+	if(CHECKFILE!="" && saved.size()!=results.size()){
+		cout << CHECKFILE << " has " << saved.size() << " values but " << results.size() << " were made (different -n?)" << endl;
+		passed = false;
+	}
+
+	if(OUTFILE != ""){
+		FILE *f = fopen(OUTFILE.c_str(), "wb");
+		if(!f || fwrite(results.data(), sizeof(double), results.size(), f) != results.size()){
+			cout << "Unable to write " << OUTFILE << endl;
+			passed = false;
+		}else{
+			cout << "Wrote results to " << OUTFILE << endl;
+		}
+		if(f) fclose(f);
+	}
+
+	if(sink == 12345.6789) cout << sink << endl; // (never true)
+
+	if(!passed) cout << "Some results are outside of the tolerance!" << endl;
+
+	return passed ? 0:-1;
+}
+
+//----------------
+// TimeIt
+//----------------
+double TimeIt(const function<void(uint32_t)> &op)
+{
+	/// Call op for every matrix index NREPEAT times and return
+	/// the time it took in seconds.
+
+	auto tstart = high_resolution_clock::now();
+	for(uint32_t irep=0; irep<NREPEAT; irep++){
+		for(uint32_t i=0; i<NMATRICES; i++) op(i);
+	}
+	auto tend = high_resolution_clock::now();
+
+	return duration_cast<duration<double>>(tend - tstart).count();
+}
+
+//----------------
+// FillRandom
+//----------------
+void FillRandom(DMatrix5x5 &J, DMatrix5x5 &C, DMatrix5x5 &Q, DMatrix5x1 &x)
+{
+	/// Make a Jacobian that looks like a propagation step (identity
+	/// plus small off-diagonal terms), a positive definite covariance
+	/// matrix C, a small symmetric process noise matrix Q, and a
+	/// state vector x.
+
+	for(int i=0; i<5; i++){
+		x(i) = drand48() - 0.5;
+		for(int j=0; j<5; j++){
+			J(i,j) = (i==j ? 1.0:0.0) + 0.1*(drand48() - 0.5);
+		}
+	}
+
+	// C = A*A^T + diagonal. The elements of A are multiples of 2^-10 so
+	// C is exact and the same for every build (with or without FMA).
+	double A[5][5];
+	for(int i=0; i<5; i++) for(int j=0; j<5; j++) A[i][j] = floor(1024.0*drand48())/1024.0 - 0.5;
+	for(int i=0; i<5; i++){
+		for(int j=0; j<=i; j++){
+			double c = (i==j ? 0.1:0.0);
+			for(int k=0; k<5; k++) c += A[i][k]*A[j][k];
+			C(i,j) = C(j,i) = c;
+			double q = 1.0E-3*(drand48() - 0.5);
+			Q(i,j) = Q(j,i) = q;
+		}
+	}
+}
+
+//----------------
+// ToM5x5
+//----------------
+M5x5 ToM5x5(const DMatrix5x5 &m)
+{
+	M5x5 out;
+	for(int i=0; i<5; i++) for(int j=0; j<5; j++) out.a[i][j] = m(i,j);
+	return out;
+}
+
+//----------------
+// Mult
+//----------------
+M5x5 Mult(const M5x5 &a, const M5x5 &b)
+{
+	/// Return a*b
+	M5x5 out;
+	for(int i=0; i<5; i++){
+		for(int j=0; j<5; j++){
+			out.a[i][j] = 0.0;
+			for(int k=0; k<5; k++) out.a[i][j] += a.a[i][k]*b.a[k][j];
+		}
+	}
+	return out;
+}
+
+//----------------
+// MultTranspose
+//----------------
+M5x5 MultTranspose(const M5x5 &a, const M5x5 &b)
+{
+	/// Return a*b^T
+	M5x5 out;
+	for(int i=0; i<5; i++){
+		for(int j=0; j<5; j++){
+			out.a[i][j] = 0.0;
+			for(int k=0; k<5; k++) out.a[i][j] += a.a[i][k]*b.a[j][k];
+		}
+	}
+	return out;
+}
+
+//----------------
+// MaxRelDiff
+//----------------
+double MaxRelDiff(const DMatrix5x5 &m, const M5x5 &ref)
+{
+	/// Return the largest difference between m and ref divided
+	/// by the largest element of ref.
+	double maxref = 0.0;
+	double maxdiff = 0.0;
+	for(int i=0; i<5; i++){
+		for(int j=0; j<5; j++){
+			maxref  = fmax(maxref, fabs(ref.a[i][j]));
+			maxdiff = fmax(maxdiff, fabs(m(i,j) - ref.a[i][j]));
+			sink += m(i,j);
+		}
+	}
+	return maxref>0.0 ? maxdiff/maxref:maxdiff;
+}
+
+//----------------
+// MaxRelDiff
+//----------------
+double MaxRelDiff(const DMatrix5x1 &m, const M5x1 &ref)
+{
+	double maxref = 0.0;
+	double maxdiff = 0.0;
+	for(int i=0; i<5; i++){
+		maxref  = fmax(maxref, fabs(ref.a[i]));
+		maxdiff = fmax(maxdiff, fabs(m(i) - ref.a[i]));
+		sink += m(i);
+	}
+	return maxref>0.0 ? maxdiff/maxref:maxdiff;
+}
+
+//----------------
+// MaxRelDiff
+//----------------
+double MaxRelDiff(const double *a, const double *b, uint32_t n)
+{
+	/// Return the largest difference between the n values of a and
+	/// b divided by the largest of the values of b.
+	double maxref = 0.0;
+	double maxdiff = 0.0;
+	for(uint32_t i=0; i<n; i++){
+		maxref  = fmax(maxref, fabs(b[i]));
+		maxdiff = fmax(maxdiff, fabs(a[i] - b[i]));
+	}
+	return maxref>0.0 ? maxdiff/maxref:maxdiff;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    dmatrix_bench [options]" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -n Nmatrices  Number of different matrices to use (default 1000)" << endl;
+	cout << "   -r Nrepeat    Number of times to repeat each operation on all matrices (default 2000)" << endl;
+	cout << "   -o file       Write the results to file (e.g. from the SSE2 build)" << endl;
+	cout << "   -c file       Check the results against those written to file with -o" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int narg, char *argv[])
+{
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-n"){ NMATRICES = atoi(next.c_str()); i++;}
+		else if(arg == "-r"){ NREPEAT = atoi(next.c_str()); i++;}
+		else if(arg == "-o"){ OUTFILE = next; i++;}
+		else if(arg == "-c"){ CHECKFILE = next; i++;}
+		else Usage("Unknown argument: " + arg);
+	}
+
+	if(NMATRICES<1) NMATRICES = 1;
+	if(NREPEAT<1) NREPEAT = 1;
+}
+
@@ -16,6 +16,8 @@ using namespace std;
 #include <evioUtil.hxx>
 using namespace evio;
 
+#include <DAQ/HDEVIO.h>
+
 
 #ifndef _DBG_
 #define _DBG_ cout<<__FILE__<<":"<<__LINE__<<" "
@@ -26,6 +28,7 @@ void ParseCommandLineArguments(int narg, char* argv[]);
 void Usage(void);
 void ctrlCHandle(int x);
 void Process(unsigned int &NEvents, unsigned int &NEvents_read);
+bool ProcessIndexed(unsigned int &NEvents, unsigned int &NEvents_read);
 uint64_t FindEventNumber(evioDOMTree *evt, uint64_t &block_size);
 
 
@@ -38,6 +41,7 @@ unsigned int SPECIFIC_OFFSET_TO_KEEP = 0;
 unsigned int SPECIFIC_EVENT_TO_KEEP = 0;
 unsigned int BUFFER_SIZE = 20000000;
 bool EVENT_TO_KEEP_MODE = false;
+bool USE_INDEX = true;
 
 
 
@@ -60,8 +64,9 @@ int main(int narg,char* argv[])
 	unsigned int NEvents = 0;
 	unsigned int NEvents_read = 0;
 
-	// Process all events
-	Process(NEvents, NEvents_read);
+	// Process all events. Use the block map to jump straight
+	// to the events of interest if possible.
+	if( !(USE_INDEX && ProcessIndexed(NEvents, NEvents_read)) ) Process(NEvents, NEvents_read);
 	
 	cout<<endl;
 	cout<<" "<<NEvents_read<<" events read, "<<NEvents<<" events written"<<endl;
@@ -84,6 +89,7 @@ void ParseCommandLineArguments(int narg, char* argv[])
 				case 'h': Usage();  break;
 				case 'o': OUTFILENAME=&ptr[2];  break;
 				case 'b': BUFFER_SIZE=atoi(&ptr[2]); break;
+				case 'L': USE_INDEX=false; break;
 				case 's': EVENTS_TO_SKIP=atoi(&ptr[2]); break;
 				case 'k': EVENTS_TO_KEEP=atoi(&ptr[2]); break;
 				case 'e': SPECIFIC_OFFSET_TO_KEEP=atoi(&ptr[2]); break;
@@ -143,6 +149,7 @@ void Usage(void)
 	cout<<"    -eSingleEvent    Keep only the single, specified event (file pos.)"<<endl;
 	cout<<"    -ESingleEvent    Keep only the single, specified event (event number)"<<endl;
 	cout<<"    -bBufferSize     Size of EVIO input buffer in bytes (def. " << (BUFFER_SIZE>>20) << "MB)" << endl;
+	cout<<"    -L               Read linearly through file(s) rather than using block map"<<endl;
 	cout<<endl;
 	cout<<" This will copy a continguous set of events from the combined event streams"<<endl;
 	cout<<" into a seperate output file. The primary use for this would be to copy"<<endl;
@@ -156,6 +163,11 @@ void Usage(void)
 	cout<<" If the -ENNN option is used then only a single event is extracted"<<endl;
 	cout<<" (the specified event number) and written to a file with the name EvtNNN.hddm."<<endl;
 	cout<<" "<<endl;
+	cout<<" By default, a block map of each input file is used to seek directly"<<endl;
+	cout<<" to the events to be written. The map is read from a file.evio.bmap or"<<endl;
+	cout<<" file.evio.map file if one exists (see hdevio_scan -x) and generated"<<endl;
+	cout<<" otherwise."<<endl;
+	cout<<" "<<endl;
 	cout<<endl;
 
 	exit(0);
@@ -263,6 +275,102 @@ void Process(unsigned int &NEvents, unsigned int &NEvents_read)
 
 }
 
+//-----------
+// ProcessIndexed
+//-----------
+bool ProcessIndexed(unsigned int &NEvents, unsigned int &NEvents_read)
+{
+	/// Copy events using the HDEVIO block map of each input file to
+	/// seek directly to the first event to be written. Events are
+	/// copied as raw EVIO banks without being parsed into a DOM tree.
+	/// Returns false without writing anything if any input file can't
+	/// be opened by HDEVIO so the caller can fall back to Process().
+
+	NEvents = 0;
+	NEvents_read = 0;
+
+	vector<HDEVIO*> hdevios;
+	for(auto fname : INFILENAMES){
+		HDEVIO *hdevio = new HDEVIO(fname);
+		if(!hdevio->is_open){
+			cerr << hdevio->err_mess.str() << endl;
+			delete hdevio;
+			for(auto h : hdevios) delete h;
+			return false;
+		}
+		hdevios.push_back(hdevio);
+	}
+
+	// Output file
+	cout<<" output file: "<<OUTFILENAME<<endl;
+	evioFileChannel ochan(OUTFILENAME, "w", BUFFER_SIZE);
+	ochan.open();
+	
+	uint32_t buff_len = 1000000;
+	uint32_t *buff = new uint32_t[buff_len];
+	uint64_t Nskip = EVENTS_TO_SKIP;
+	
+	for(unsigned int i=0; i<hdevios.size() && !QUIT; i++){
+		HDEVIO *hdevio = hdevios[i];
+		cout << "Opening input file : \"" << INFILENAMES[i] << "\"" << endl;
+
+		if(SPECIFIC_EVENT_TO_KEEP>0){
+			if(!hdevio->SeekToEvent(SPECIFIC_EVENT_TO_KEEP)) continue;
+		}else{
+			// Count EVIO events in this file so whole files can be skipped
+			uint64_t Nevio = 0;
+			for(auto &br : hdevio->GetEVIOBlockRecords()) Nevio += br.evio_events.size();
+			if(Nskip >= Nevio){
+				Nskip -= Nevio;
+				NEvents_read += Nevio;
+				continue;
+			}
+			hdevio->SeekToEVIOEvent(Nskip);
+			NEvents_read += Nskip;
+			Nskip = 0;
+		}
+		
+		while(NEvents < EVENTS_TO_KEEP && !QUIT){
+			hdevio->readSparse(buff, buff_len);
+			if(hdevio->err_code == HDEVIO::HDEVIO_USER_BUFFER_TOO_SMALL){
+				delete[] buff;
+				buff_len = hdevio->last_event_len;
+				buff = new uint32_t[buff_len];
+				continue;
+			}
+			if(hdevio->err_code == HDEVIO::HDEVIO_EOF) break;
+			NEvents_read++;
+			if(hdevio->err_code != HDEVIO::HDEVIO_OK){
+				cerr << hdevio->err_mess.str() << endl;
+				continue;
+			}
+			
+			if(SPECIFIC_EVENT_TO_KEEP>0){
+				uint32_t M = buff[1]&0xFF;
+				if(M > 1){
+					cout << endl;
+					cout << "WARNING: The CODA block size for this data is not \"1\"!" << endl;
+					cout << "The entire block of " << M << " events is being written" << endl;
+					cout << "that contains the requested event." << endl;
+				}
+			}
+			
+			ochan.write(buff);
+			NEvents++;
+		}
+		
+		if(NEvents >= EVENTS_TO_KEEP) break;
+	}
+	
+	// Close output file
+	ochan.close();
+
+	delete[] buff;
+	for(auto h : hdevios) delete h;
+
+	return true;
+}
+
 //----------------
 // FindEventNumber
 //----------------
@@ -27,6 +27,8 @@ void MapEVIOWords(void);
 vector<string> filenames;
 bool   PRINT_SUMMARY = true;
 bool   SAVE_FILE_MAP = false;
+bool   SAVE_BINARY_MAP = false;
+int    MAP_NTHREADS = -1; // <0 means use HDEVIO default
 bool   SKIP_EVENT_MAPPING = false;
 bool   MAP_WORDS     = false;
 bool   GENERATE_ERROR_REPORT = false;
@@ -76,7 +78,9 @@ void Usage(string mess="")
 	cout << "   -s                Save file block/event map" << endl;
 	cout << "   -blocksonly       Save only block map not events. (Only use with -s)" << endl;
 	cout << "   -f file.map       Set name of file to save block/event to. " << endl;
-	cout << "                     (implies -s)" << endl;
+	cout << "                     (implies -s. Use .bmap suffix for binary map)" << endl;
+	cout << "   -x                Save binary block/event index (file.evio.bmap)" << endl;
+	cout << "   -t nthreads       Number of threads to use for mapping file" << endl;
 	cout << endl;
 	cout << "n.b. When using the -i (ignore) flag, the total number of events" << endl;
 	cout << "     read in will be the sum of how many are ignored and the \"max\"" << endl;
@@ -110,6 +114,8 @@ void ParseCommandLineArguments(int narg, char *argv[])
 		else if(arg == "-n"){ MAX_HISTORY_BUFF_SIZE = atoi(next.c_str()); i++;}		
 		else if(arg == "-s"){ SAVE_FILE_MAP = true;}
 		else if(arg == "-f"){ SAVE_FILE_MAP = true; MAP_FILENAME = next; i++;}
+		else if(arg == "-x"){ SAVE_BINARY_MAP = true;}
+		else if(arg == "-t"){ MAP_NTHREADS = atoi(next.c_str()); i++;}
 		else if(arg == "-blocksonly") { SKIP_EVENT_MAPPING = true;}
 		else if(arg[0] == '-') {cout << "Unknown option \""<<arg<<"\" !" << endl; exit(-1);}
 		else filenames.push_back(arg);
@@ -133,6 +139,7 @@ void PrintSummary(void)
 		}
 		
 		if(SKIP_EVENT_MAPPING) hdevio->SKIP_EVENT_MAPPING = true;
+		if(MAP_NTHREADS >= 0 ) hdevio->MAP_NTHREADS = MAP_NTHREADS;
 		
 		time_t start_time = time(NULL);
 		hdevio->PrintFileSummary();
@@ -204,6 +211,7 @@ void PrintSummary(void)
 		}
 		
 		if(SAVE_FILE_MAP) hdevio->SaveFileMap(MAP_FILENAME);
+		if(SAVE_BINARY_MAP) hdevio->SaveBinaryFileMap();
 		
 		delete hdevio;
 
@@ -0,0 +1,242 @@
+
+// Benchmark for the EVIO bank byte swapping routines.
+//
+// Events are read from an EVIO file into memory and converted to
+// the opposite byte order if they are not already in it. Each
+// available swap implementation (scalar, SSSE3, AVX2) is then timed
+// swapping the full set of events with swap_bank, the same routine
+// DEVIOWorkerThread uses for JOB_SWAP. The output of every
+// implementation is checked against the scalar one.
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+using namespace std;
+using namespace std::chrono;
+
+#include <DAQ/HDEVIO.h>
+#include <DAQ/swap_bank.h>
+
+
+void Usage(string mess);
+void ParseCommandLineArguments(int narg, char *argv[]);
+uint32_t UnswapBank(uint32_t *outbuff, const uint32_t *inbuff, uint32_t len);
+
+
+string   FILENAME;
+uint64_t MAX_EVENTS = 10000;
+uint32_t NREPEAT    = 20;
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	HDEVIO *hdevio = new HDEVIO(FILENAME, false, 0);
+	if(!hdevio->is_open){
+		cout << hdevio->err_mess.str() << endl;
+		return -1;
+	}
+
+	// Read events into memory without swapping. Keep all events
+	// in one contiguous buffer in the byte order that needs swapping
+	// (i.e. big endian on x86). The native copy is made with the
+	// scalar routine since it is the reference for all others.
+	SetSwapSIMDLevel(kSwapScalar);
+	vector<uint32_t> foreign;
+	vector<uint32_t> native;
+	vector<uint32_t> event_offsets;
+	uint32_t buff_len = 1000000;
+	uint32_t *buff = new uint32_t[buff_len];
+	uint64_t Nevents = 0;
+	while(Nevents < MAX_EVENTS){
+		hdevio->readNoFileBuff(buff, buff_len, false);
+		if(hdevio->err_code == HDEVIO::HDEVIO_USER_BUFFER_TOO_SMALL){
+			delete[] buff;
+			buff_len = hdevio->last_event_len;
+			buff = new uint32_t[buff_len];
+			continue;
+		}
+		if(hdevio->err_code != HDEVIO::HDEVIO_OK) break;
+
+		uint32_t len = hdevio->last_event_len;
+		size_t off = foreign.size();
+		event_offsets.push_back(off);
+		foreign.resize(off + len);
+		native.resize(off + len);
+		if(hdevio->swap_needed){
+			memcpy(&foreign[off], buff, len*sizeof(uint32_t));
+			swap_bank(&native[off], &foreign[off], len);
+		}else{
+			memcpy(&native[off], buff, len*sizeof(uint32_t));
+			UnswapBank(&foreign[off], &native[off], len);
+		}
+		Nevents++;
+	}
+	delete[] buff;
+	delete hdevio;
+
+	if(Nevents == 0){
+		cout << "No events read from " << FILENAME << endl;
+		return -1;
+	}
+	event_offsets.push_back(foreign.size());
+	double MB = (double)foreign.size()*sizeof(uint32_t)/1.0E6;
+
+	cout << "Read " << Nevents << " events (" << MB << " MB) from " << FILENAME << endl;
+	cout << "Swapping each event " << NREPEAT << " times per implementation" << endl;
+	cout << endl;
+
+	// Time each implementation
+	int max_level = GetMaxSwapSIMDLevel();
+	vector<uint32_t> out(foreign.size());
+	double t_scalar = 0.0;
+	bool all_same = true;
+	for(int level=kSwapScalar; level<=max_level; level++){
+
+		SetSwapSIMDLevel(level);
+		memset(out.data(), 0, out.size()*sizeof(uint32_t));
+
+		auto tstart = high_resolution_clock::now();
+		for(uint32_t irep=0; irep<NREPEAT; irep++){
+			for(uint64_t i=0; i<Nevents; i++){
+				uint32_t off = event_offsets[i];
+				uint32_t len = event_offsets[i+1] - off;
+				swap_bank(&out[off], &foreign[off], len);
+			}
+		}
+		auto tend = high_resolution_clock::now();
+		double t = duration_cast<duration<double>>(tend - tstart).count();
+		if(level == kSwapScalar) t_scalar = t;
+
+		bool same = memcmp(out.data(), native.data(), out.size()*sizeof(uint32_t)) == 0;
+		if(!same) all_same = false;
+
+		char str[256];
+		sprintf(str, "%8s: %8.3f s  %9.1f MB/s  speedup=%5.2f  %s",
+			GetSwapSIMDName(level), t, MB*NREPEAT/t, t_scalar/t, same ? "OK":"MISMATCH!");
+		cout << str << endl;
+	}
+	cout << endl;
+
+	return all_same ? 0:-1;
+}
+
+//----------------
+// UnswapBank
+//----------------
+uint32_t UnswapBank(uint32_t *outbuff, const uint32_t *inbuff, uint32_t len)
+{
+	/// Convert a native byte order EVIO bank to the opposite byte
+	/// order. This is the inverse of swap_bank (which takes the
+	/// structure information from the swapped words). It is only
+	/// used to make test input from files written in native order.
+
+	if(len < 2) return 0;
+	uint32_t bank_len = inbuff[0];
+	if(bank_len+1 > len) return 0;
+
+	outbuff[0] = swap32(inbuff[0]);
+	outbuff[1] = swap32(inbuff[1]);
+
+	uint32_t type = (inbuff[1]>>8) & 0xFF;
+	uint32_t Nwords = bank_len - 1;
+	uint32_t Nswapped = 2;
+	switch(type){
+		case 0x0e:
+		case 0x10:
+			while(Nswapped < Nwords+2){
+				uint32_t N = UnswapBank(&outbuff[Nswapped], &inbuff[Nswapped], Nwords+2-Nswapped);
+				if(N == 0) break;
+				Nswapped += N;
+			}
+			break;
+		case 0x0c:
+		case 0x0d:
+		case 0x20:
+			// (tag)segments: header word then data
+			while(Nswapped < Nwords+2){
+				uint32_t seg_header = inbuff[Nswapped];
+				uint32_t seg_len  = seg_header & 0xFFFF;
+				uint32_t seg_type = (seg_header>>16) & (type==0x0c ? 0x0F:0x3F);
+				const uint32_t *in = &inbuff[Nswapped+1];
+				uint32_t *out = &outbuff[Nswapped+1];
+				outbuff[Nswapped] = swap32(seg_header);
+				if(Nswapped+1+seg_len > Nwords+2) break;
+				for(uint32_t i=0; i<seg_len; i++){
+					switch(seg_type){
+						case 0x0a: case 0x08: case 0x09: ((uint64_t*)out)[i/2] = swap64(((const uint64_t*)in)[i/2]); i++; break;
+						case 0x01: case 0x02: case 0x0b: out[i] = swap32(in[i]); break;
+						case 0x05: case 0x04: ((uint16_t*)out)[2*i] = swap16(((const uint16_t*)in)[2*i]); ((uint16_t*)out)[2*i+1] = swap16(((const uint16_t*)in)[2*i+1]); break;
+						default: out[i] = in[i];
+					}
+				}
+				Nswapped += 1 + seg_len;
+			}
+			break;
+		default:
+			for(uint32_t i=0; i<Nwords; i++){
+				const uint32_t *in = &inbuff[2];
+				uint32_t *out = &outbuff[2];
+				switch(type){
+					case 0x0a: case 0x08: case 0x09: ((uint64_t*)out)[i/2] = swap64(((const uint64_t*)in)[i/2]); i++; break;
+					case 0x01: case 0x02: case 0x0b: out[i] = swap32(in[i]); break;
+					case 0x05: case 0x04: ((uint16_t*)out)[2*i] = swap16(((const uint16_t*)in)[2*i]); ((uint16_t*)out)[2*i+1] = swap16(((const uint16_t*)in)[2*i+1]); break;
+					default: out[i] = in[i];
+				}
+			}
+			Nswapped += Nwords;
+	}
+
+	return Nswapped;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    hdevio_swap_bench [options] file.evio" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -n Nevents    Number of EVIO events to read in (default 10000)" << endl;
+	cout << "   -r Nrepeat    Number of times to swap the full set of events (default 20)" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int narg, char *argv[])
+{
+	if(narg<2) Usage("You must supply a filename!");
+
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-n"    ){ MAX_EVENTS = atoi(next.c_str()); i++;}
+		else if(arg == "-r"    ){ NREPEAT    = atoi(next.c_str()); i++;}
+		else if(arg[0] == '-') {cout << "Unknown option \""<<arg<<"\" !" << endl; exit(-1);}
+		else FILENAME = arg;
+	}
+
+	if(FILENAME.empty()) Usage("You must supply a filename!");
+}
@@ -0,0 +1,192 @@
+
+// Contention benchmark for the histogram filling in HistogramTools.h.
+//
+// For each number of threads (1, 2, 4, ... up to the maximum given
+// with -t) every thread fills NFILLS random values into one 1D and one
+// 2D histogram, first with Fill1DHistogram/Fill2DHistogram (name
+// lookup plus locks on every fill) and then through histogram handles
+// (thread-local copies merged with MergeHistogramHandles). The time
+// per fill, the total fill rate over all threads, and the time taken
+// by the merge are reported for each.
+//
+// The same values are filled both ways into histograms with different
+// names. After each pass the bin contents, number of entries, and the
+// mean and RMS along each axis of the two sets of histograms are
+// compared and the largest difference is reported. The mean and RMS
+// may differ by rounding since the sums are added up in another order.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <functional>
+using namespace std;
+using namespace std::chrono;
+
+#include <DANA/DApplication.h>
+#include <HistogramTools.h>
+
+
+void Usage(string mess);
+void ParseCommandLineArguments(int narg, char *argv[]);
+double RunThreads(unsigned int Nthreads, const function<void(unsigned int ithread)> &work);
+double MaxDiff(const char *name1, const char *name2);
+
+uint32_t NFILLS      = 1000000;
+uint32_t MAX_THREADS = 64;
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	// The DApplication is only needed for the ROOT lock (japp)
+	char *dargv[] = {argv[0]};
+	DApplication *app = new DApplication(1, dargv);
+
+	cout << "Filling " << NFILLS << " values per thread into a 1D and a 2D histogram" << endl;
+	cout << endl;
+	cout << "threads          method   ns/fill/thread     Mfills/s   merge (ms)  max diff." << endl;
+
+	for(unsigned int Nthreads=1; Nthreads<=MAX_THREADS; Nthreads*=2){
+
+		char name1D_legacy[256], name2D_legacy[256], name1D_handle[256], name2D_handle[256];
+		sprintf(name1D_legacy, "h1D_legacy_%02d", Nthreads);
+		sprintf(name2D_legacy, "h2D_legacy_%02d", Nthreads);
+		sprintf(name1D_handle, "h1D_handle_%02d", Nthreads);
+		sprintf(name2D_handle, "h2D_handle_%02d", Nthreads);
+
+		// Values are made from a per-thread seed so both passes fill the same ones
+		double t_legacy = RunThreads(Nthreads, [&](unsigned int ithread){
+			unsigned short seed[3] = {(unsigned short)ithread, 1, 2};
+			for(uint32_t i=0; i<NFILLS; i++){
+				double x = erand48(seed)*12.0 - 1.0;
+				double y = erand48(seed)*12.0 - 1.0;
+				Fill1DHistogram("histfill_bench", "legacy", name1D_legacy, x, ";x", 100, 0.0, 10.0);
+				Fill2DHistogram("histfill_bench", "legacy", name2D_legacy, x, y, ";x;y", 100, 0.0, 10.0, 100, 0.0, 10.0);
+			}
+		});
+
+		HistogramHandle1D h1D = Get1DHistogramHandle("histfill_bench", "handle", name1D_handle, ";x", 100, 0.0, 10.0);
+		HistogramHandle2D h2D = Get2DHistogramHandle("histfill_bench", "handle", name2D_handle, ";x;y", 100, 0.0, 10.0, 100, 0.0, 10.0);
+		double t_handle = RunThreads(Nthreads, [&](unsigned int ithread){
+			unsigned short seed[3] = {(unsigned short)ithread, 1, 2};
+			for(uint32_t i=0; i<NFILLS; i++){
+				double x = erand48(seed)*12.0 - 1.0;
+				double y = erand48(seed)*12.0 - 1.0;
+				h1D.Fill(x);
+				h2D.Fill(x, y);
+			}
+		});
+
+		auto tstart = high_resolution_clock::now();
+		MergeHistogramHandles();
+		auto tend = high_resolution_clock::now();
+		double t_merge = duration_cast<duration<double>>(tend - tstart).count();
+
+		double maxdiff = max(MaxDiff(name1D_legacy, name1D_handle), MaxDiff(name2D_legacy, name2D_handle));
+
+		double Nfills = 2.0*(double)NFILLS; // per thread
+		char str[256];
+		sprintf(str, "%7d %15s %16.1f %12.2f", Nthreads, "FillXXX", 1.0E9*t_legacy/Nfills, 1.0E-6*Nfills*Nthreads/t_legacy);
+		cout << str << endl;
+		sprintf(str, "%7d %15s %16.1f %12.2f %12.3f %10g", Nthreads, "handle", 1.0E9*t_handle/Nfills, 1.0E-6*Nfills*Nthreads/t_handle, 1.0E3*t_merge, maxdiff);
+		cout << str << endl;
+	}
+	cout << endl;
+
+	delete app;
+
+	return 0;
+}
+
+//----------------
+// RunThreads
+//----------------
+double RunThreads(unsigned int Nthreads, const function<void(unsigned int ithread)> &work)
+{
+	/// Run work on Nthreads threads at once and return the wall
+	/// time it took in seconds.
+
+	auto tstart = high_resolution_clock::now();
+	vector<thread> threads;
+	for(unsigned int i=0; i<Nthreads; i++) threads.push_back(thread(work, i));
+	for(auto &t : threads) t.join();
+	auto tend = high_resolution_clock::now();
+
+	return duration_cast<duration<double>>(tend - tstart).count();
+}
+
+//----------------
+// MaxDiff
+//----------------
+double MaxDiff(const char *name1, const char *name2)
+{
+	/// Return the largest difference in bin content, number of entries,
+	/// mean or RMS between the legacy histogram name1 and the handle
+	/// histogram name2.
+
+	TH1 *h1 = (TH1*)GetHistPointer("histfill_bench", "legacy", name1);
+	TH1 *h2 = (TH1*)GetHistPointer("histfill_bench", "handle", name2);
+	if(!h1 || !h2) return -1.0;
+
+	double maxdiff = fabs(h1->GetEntries() - h2->GetEntries());
+	for(int bin=0; bin<h1->GetNcells(); bin++){
+		maxdiff = fmax(maxdiff, fabs(h1->GetBinContent(bin) - h2->GetBinContent(bin)));
+	}
+	for(int axis=1; axis<=h1->GetDimension(); axis++){
+		maxdiff = fmax(maxdiff, fabs(h1->GetMean(axis) - h2->GetMean(axis)));
+		maxdiff = fmax(maxdiff, fabs(h1->GetRMS(axis)  - h2->GetRMS(axis)));
+	}
+
+	return maxdiff;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    histfill_bench [options]" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -n Nfills     Number of fills per thread of each histogram (default 1000000)" << endl;
+	cout << "   -t Nthreads   Largest number of threads to use (default 64)" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int narg, char *argv[])
+{
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-n"){ NFILLS = atoi(next.c_str()); i++;}
+		else if(arg == "-t"){ MAX_THREADS = atoi(next.c_str()); i++;}
+		else Usage("Unknown argument: " + arg);
+	}
+
+	if(NFILLS<1) NFILLS = 1;
+	if(MAX_THREADS<1) MAX_THREADS = 1;
+}
+
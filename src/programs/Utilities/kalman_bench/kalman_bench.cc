@@ -0,0 +1,451 @@
+
+// Benchmark for the time-based track fit in DTrackFitterKalmanSIMD.
+//
+// Events are read in the usual way. For each DTrackWireBased track in
+// an event the time-based fit is redone NREPEAT times for each of the
+// pion and proton mass hypotheses using the hits from the wire-based
+// fit (as DTrackTimeBased_factory does when
+// TRKFIT:USE_HITS_FROM_WIREBASED_FIT=1). The time spent in FitTrack
+// is accumulated and reported per fit.
+//
+// If an output file is given with -o, the fit status, chi-squared,
+// Ndof, and fitted momentum/position of every fit are written to it
+// in text form. Running two builds over the same events and diffing
+// the files will show any change in the fit results.
+//
+// Any JANA options (e.g. -PEVENTS_TO_KEEP=1000) may be given on the
+// command line along with the input file(s).
+//
+// For field-off data (-PBFIELD_TYPE=NoField) the fitter uses
+// propagation routines specialized for straight tracks. Running once
+// with -PKALMAN:NO_FIELD_PROPAGATION=0 and once with the default (1)
+// gives the field-off fit throughput with and without them. The fit
+// results written with -o should be identical.
+//
+// With -l no events are read. Instead the reference trajectory storage
+// of the fitter is timed on synthetic trajectories. The steps are kept
+// both in DKalmanSIMDTrajectory (one array of step structs, which the
+// fitter uses) and in a structure-of-arrays layout with one array per
+// member. For each trajectory the steps are added with push_front and
+// then a filter pass (reading S, J, Q and xy and writing Skk and Ckk
+// at each step as KalmanCentral does) and a smoother pass (reading
+// Skk, Ckk, J and h_id going back) are done. Both layouts must give
+// identical results.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <random>
+using namespace std;
+using namespace std::chrono;
+
+#include <JANA/JEventProcessor.h>
+#include <JANA/JEventLoop.h>
+using namespace jana;
+
+#include <DANA/DApplication.h>
+#include <TRACKING/DTrackWireBased.h>
+#include <TRACKING/DTrackFitter.h>
+#include <TRACKING/DTrackFitterKalmanSIMD.h>
+#include <particleType.h>
+
+
+void Usage(string mess);
+void ParseCommandLineArguments(int &narg, char *argv[]);
+void CompareTrajectoryLayouts(void);
+
+uint32_t NREPEAT = 10;
+string OUTFILE = "";
+bool COMPARE_LAYOUTS = false;
+uint32_t NSTEPS  = 400;
+uint32_t NTRAJ   = 20000;
+
+//----------------
+// KalmanBenchProcessor
+//----------------
+class KalmanBenchProcessor:public JEventProcessor{
+	public:
+		jerror_t init(void);
+		jerror_t evnt(JEventLoop *loop, uint64_t eventnumber);
+		jerror_t fini(void);
+
+		std::mutex mtx;
+		FILE *fout = NULL;
+
+		uint64_t Nevents = 0;
+		uint64_t Nfits   = 0;
+		uint64_t Nfailed = 0;
+		double   t_fit   = 0.0;
+};
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	if(COMPARE_LAYOUTS){
+		CompareTrajectoryLayouts();
+		return 0;
+	}
+
+	KalmanBenchProcessor proc;
+	DApplication *app = new DApplication(narg, argv);
+	app->Run(&proc);
+
+	delete app;
+
+	return 0;
+}
+
+//----------------
+// init
+//----------------
+jerror_t KalmanBenchProcessor::init(void)
+{
+	if(OUTFILE != ""){
+		fout = fopen(OUTFILE.c_str(), "w");
+		if(!fout) cerr << "Unable to open \"" << OUTFILE << "\" for writing!" << endl;
+	}
+
+	return NOERROR;
+}
+
+//----------------
+// evnt
+//----------------
+jerror_t KalmanBenchProcessor::evnt(JEventLoop *loop, uint64_t eventnumber)
+{
+	vector<const DTrackWireBased*> tracks;
+	loop->Get(tracks);
+
+	vector<const DTrackFitter *> fitters;
+	loop->Get(fitters);
+	if(fitters.empty()) return RESOURCE_UNAVAILABLE;
+	DTrackFitter *fitter = const_cast<DTrackFitter*>(fitters[0]);
+
+	const double masses[] = {ParticleMass(PiPlus), ParticleMass(Proton)};
+
+	double t = 0.0;
+	uint64_t Nfits_evt = 0;
+	uint64_t Nfailed_evt = 0;
+	vector<string> results;
+	for(auto track : tracks){
+		vector<const DFDCPseudo*> fdchits;
+		vector<const DCDCTrackHit*> cdchits;
+		track->GetT(fdchits);
+		track->GetT(cdchits);
+
+		for(double mass : masses){
+			DTrackFitter::fit_status_t status = DTrackFitter::kFitNotDone;
+			for(uint32_t irep=0; irep<NREPEAT; irep++){
+				auto tstart = high_resolution_clock::now();
+				fitter->Reset();
+				fitter->SetFitType(DTrackFitter::kTimeBased);
+				fitter->AddHits(fdchits);
+				fitter->AddHits(cdchits);
+				status = fitter->FitTrack(track->position(), track->momentum(),
+						track->charge(), mass, track->t0(), track->t0_detector());
+				auto tend = high_resolution_clock::now();
+				t += duration_cast<duration<double>>(tend - tstart).count();
+				Nfits_evt++;
+			}
+			if(status!=DTrackFitter::kFitSuccess && status!=DTrackFitter::kFitNoImprovement) Nfailed_evt++;
+
+			if(fout){
+				const DTrackingData &fp = fitter->GetFitParameters();
+				DVector3 mom = fp.momentum();
+				DVector3 pos = fp.position();
+				char str[512];
+				sprintf(str, "%lu %lu %5.3f %d %.9g %d %.9g %.9g %.9g %.9g %.9g %.9g",
+						(unsigned long)eventnumber, (unsigned long)track->candidateid, mass, (int)status,
+						fitter->GetChisq(), fitter->GetNdof(),
+						mom.x(), mom.y(), mom.z(), pos.x(), pos.y(), pos.z());
+				results.push_back(str);
+			}
+		}
+	}
+
+	lock_guard<mutex> lck(mtx);
+	Nevents++;
+	Nfits   += Nfits_evt;
+	Nfailed += Nfailed_evt;
+	t_fit   += t;
+	if(fout) for(auto &s : results) fprintf(fout, "%s\n", s.c_str());
+
+	return NOERROR;
+}
+
+//----------------
+// fini
+//----------------
+jerror_t KalmanBenchProcessor::fini(void)
+{
+	if(fout) fclose(fout);
+	fout = NULL;
+
+	if(Nfits == 0){
+		cout << "No fits done (" << Nevents << " events processed)" << endl;
+		return NOERROR;
+	}
+
+	char str[256];
+	cout << endl;
+	cout << "Fit tracks in " << Nevents << " events " << NREPEAT << " times each (" << Nfits << " fits)" << endl;
+	sprintf(str, "  FitTrack: %8.3f s  %8.2f us/fit  %6.1f fits/s  (%lu hypotheses failed)",
+			t_fit, 1.0E6*t_fit/(double)Nfits, (double)Nfits/t_fit, (unsigned long)Nfailed);
+	cout << str << endl;
+	if(OUTFILE != "") cout << "Fit results written to: " << OUTFILE << endl;
+	cout << endl;
+
+	return NOERROR;
+}
+
+//----------------
+// CentralTrajectorySoA
+//----------------
+// DKalmanSIMDTrajectory<DKalmanCentralTrajectory_t> with each member of
+// the step struct in its own array. Steps are filled from the end of
+// the arrays toward the start in the same way.
+class CentralTrajectorySoA{
+	public:
+		void push_front(const DKalmanCentralTrajectory_t &step){
+			if(head == 0) Grow();
+			--head;
+			J[head] = step.J; Q[head] = step.Q; Ckk[head] = step.Ckk;
+			S[head] = step.S; Skk[head] = step.Skk;
+			xy[head] = step.xy;
+			s[head] = step.s; t[head] = step.t; B[head] = step.B;
+			rho_Z_over_A[head] = step.rho_Z_over_A; K_rho_Z_over_A[head] = step.K_rho_Z_over_A;
+			LnI[head] = step.LnI; Z[head] = step.Z;
+			chi2c_factor[head] = step.chi2c_factor; chi2a_factor[head] = step.chi2a_factor;
+			chi2a_corr[head] = step.chi2a_corr;
+			h_id[head] = step.h_id;
+		}
+		void clear(void){ head = J.size(); }
+		size_t size(void) const { return J.size() - head; }
+		void reserve(size_t n){ while(J.size() < n) Grow(); }
+
+		// Per-step access in the same form as the AoS view below
+		DMatrix5x5& get_J(size_t k){ return J[head+k]; }
+		DMatrix5x5& get_Q(size_t k){ return Q[head+k]; }
+		DMatrix5x5& get_Ckk(size_t k){ return Ckk[head+k]; }
+		DMatrix5x1& get_S(size_t k){ return S[head+k]; }
+		DMatrix5x1& get_Skk(size_t k){ return Skk[head+k]; }
+		DVector2& get_xy(size_t k){ return xy[head+k]; }
+		unsigned int& get_h_id(size_t k){ return h_id[head+k]; }
+
+	protected:
+		template<class V> void GrowVec(V &v, size_t newsize){
+			V newv(newsize);
+			std::copy(v.begin() + head, v.end(), newv.end() - (v.size() - head));
+			v.swap(newv);
+		}
+		void Grow(void){
+			size_t n = size();
+			size_t newsize = J.empty() ? 256:2*J.size();
+			GrowVec(J, newsize); GrowVec(Q, newsize); GrowVec(Ckk, newsize);
+			GrowVec(S, newsize); GrowVec(Skk, newsize);
+			GrowVec(xy, newsize);
+			GrowVec(s, newsize); GrowVec(t, newsize); GrowVec(B, newsize);
+			GrowVec(rho_Z_over_A, newsize); GrowVec(K_rho_Z_over_A, newsize);
+			GrowVec(LnI, newsize); GrowVec(Z, newsize);
+			GrowVec(chi2c_factor, newsize); GrowVec(chi2a_factor, newsize);
+			GrowVec(chi2a_corr, newsize);
+			GrowVec(h_id, newsize);
+			head = newsize - n;
+		}
+
+		vector<DMatrix5x5> J, Q, Ckk;
+		vector<DMatrix5x1> S, Skk;
+		vector<DVector2> xy;
+		vector<double> s, t, B;
+		vector<double> rho_Z_over_A, K_rho_Z_over_A, LnI, Z;
+		vector<double> chi2c_factor, chi2a_factor, chi2a_corr;
+		vector<unsigned int> h_id;
+		size_t head = 0;
+};
+
+//----------------
+// CentralTrajectoryAoS
+//----------------
+// The storage the fitter uses with the same accessors as
+// CentralTrajectorySoA
+class CentralTrajectoryAoS:public DKalmanSIMDTrajectory<DKalmanCentralTrajectory_t>{
+	public:
+		DMatrix5x5& get_J(size_t k){ return (*this)[k].J; }
+		DMatrix5x5& get_Q(size_t k){ return (*this)[k].Q; }
+		DMatrix5x5& get_Ckk(size_t k){ return (*this)[k].Ckk; }
+		DMatrix5x1& get_S(size_t k){ return (*this)[k].S; }
+		DMatrix5x1& get_Skk(size_t k){ return (*this)[k].Skk; }
+		DVector2& get_xy(size_t k){ return (*this)[k].xy; }
+		unsigned int& get_h_id(size_t k){ return (*this)[k].h_id; }
+};
+
+//----------------
+// FilterAndSmooth
+//----------------
+template<class TRAJ>
+double FilterAndSmooth(TRAJ &traj, const vector<DKalmanCentralTrajectory_t> &steps)
+{
+	/// Build the trajectory from steps and run a filter and a smoother
+	/// pass over it using the same members in the same order as
+	/// KalmanCentral and SmoothCentral. Returns a number that depends
+	/// on every value computed so the two layouts can be compared.
+	traj.clear();
+	for(auto &step : steps) traj.push_front(step);
+
+	DMatrix5x1 Sc = traj.get_S(0);
+	DMatrix5x1 S0_ = traj.get_S(0);
+	DMatrix5x5 Cc = traj.get_Q(0);
+	double sum = 0.0;
+	for(size_t k=1; k<traj.size(); k++){
+		DMatrix5x1 S0 = traj.get_S(k);
+		DMatrix5x5 &J = traj.get_J(k);
+		Sc = S0 + J*(Sc - S0_);
+		Cc = traj.get_Q(k).AddSym(J*Cc*J.Transpose());
+		Cc *= 0.5;
+		traj.get_Skk(k) = Sc;
+		traj.get_Ckk(k) = Cc;
+		const DVector2 &xy = traj.get_xy(k);
+		sum += xy.X()*Sc(0) + xy.Y()*Sc(1);
+		if(k%4 == 0) traj.get_h_id(k) = k;
+		S0_ = S0;
+	}
+
+	DMatrix5x1 Ss = traj.get_Skk(traj.size()-1);
+	DMatrix5x5 Cs = traj.get_Ckk(traj.size()-1);
+	for(size_t k=traj.size()-1; k>0; k--){
+		DMatrix5x5 &J = traj.get_J(k);
+		Ss = traj.get_Skk(k-1) + 0.5*(J*(Ss - traj.get_Skk(k)));
+		Cs = traj.get_Ckk(k-1).AddSym(J*Cs*J.Transpose());
+		Cs *= 0.5;
+		if(traj.get_h_id(k) > 0) sum += Ss(2) + Cs(2,2);
+	}
+
+	return sum;
+}
+
+//----------------
+// CompareTrajectoryLayouts
+//----------------
+void CompareTrajectoryLayouts(void)
+{
+	/// Time FilterAndSmooth on NTRAJ synthetic trajectories of NSTEPS
+	/// steps each, with the steps stored as an array of structs and as
+	/// a structure of arrays.
+	mt19937 rng(1234);
+	uniform_real_distribution<double> flat(-1.0, 1.0);
+
+	// A few different trajectories are cycled through so the step
+	// values are not all the same. J is close to the identity and Q is
+	// small and diagonal like in a real fit.
+	const size_t Ndistinct = 8;
+	vector<vector<DKalmanCentralTrajectory_t> > trajs(Ndistinct);
+	for(auto &steps : trajs){
+		steps.resize(NSTEPS);
+		for(auto &step : steps){
+			for(int i=0; i<5; i++){
+				step.S(i) = flat(rng);
+				for(int j=0; j<5; j++){
+					step.J(i,j) = (i==j ? 1.0:0.0) + 0.01*flat(rng);
+					step.Q(i,j) = (i==j ? 1.0E-4*(1.0 + flat(rng)):0.0);
+				}
+			}
+			step.xy.Set(50.0*flat(rng), 50.0*flat(rng));
+		}
+	}
+
+	CentralTrajectoryAoS aos;
+	CentralTrajectorySoA soa;
+	aos.reserve(NSTEPS);
+	soa.reserve(NSTEPS);
+
+	double t[2];
+	double sum[2] = {0.0, 0.0};
+	for(int layout=0; layout<2; layout++){
+		auto tstart = high_resolution_clock::now();
+		for(uint32_t itraj=0; itraj<NTRAJ; itraj++){
+			auto &steps = trajs[itraj%Ndistinct];
+			sum[layout] += layout==0 ? FilterAndSmooth(aos, steps):FilterAndSmooth(soa, steps);
+		}
+		auto tend = high_resolution_clock::now();
+		t[layout] = duration_cast<duration<double>>(tend - tstart).count();
+	}
+
+	cout << endl;
+	cout << NTRAJ << " trajectories of " << NSTEPS << " steps (step struct is "
+	     << sizeof(DKalmanCentralTrajectory_t) << " bytes)" << endl;
+	const char *names[2] = {"AoS", "SoA"};
+	for(int layout=0; layout<2; layout++){
+		char str[256];
+		sprintf(str, "  %s: %8.3f s  %8.2f ns/step  speedup vs. AoS=%5.2f  %s",
+			names[layout], t[layout], 1.0E9*t[layout]/(double)NTRAJ/(double)NSTEPS, t[0]/t[layout],
+			sum[layout]==sum[0] ? "OK":"MISMATCH!");
+		cout << str << endl;
+	}
+	cout << endl;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    kalman_bench [options] file.evio|file.hddm" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -r Nrepeat    Number of times to fit each track per mass hypothesis (default 10)" << endl;
+	cout << "   -o file       Write the fit results to the given text file" << endl;
+	cout << "   -l            Compare trajectory storage layouts (no input file needed)" << endl;
+	cout << "   -n Nsteps     Number of steps per trajectory for -l (default 400)" << endl;
+	cout << "   -N Ntraj      Number of trajectories for -l (default 20000)" << endl;
+	cout << "   -PKEY=VALUE   JANA configuration parameter (e.g. -PEVENTS_TO_KEEP=1000)" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int &narg, char *argv[])
+{
+	/// Handle our own options and remove them from the argument
+	/// list so the rest can be passed to DApplication.
+
+	int nkeep = 1;
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-r"){ NREPEAT = atoi(next.c_str()); i++;}
+		else if(arg == "-o"){ OUTFILE = next; i++;}
+		else if(arg == "-l"){ COMPARE_LAYOUTS = true;}
+		else if(arg == "-n"){ NSTEPS  = atoi(next.c_str()); i++;}
+		else if(arg == "-N"){ NTRAJ   = atoi(next.c_str()); i++;}
+		else argv[nkeep++] = argv[i];
+	}
+	narg = nkeep;
+
+	if(NSTEPS<2) NSTEPS = 2;
+	if(COMPARE_LAYOUTS) return;
+
+	if(narg<2) Usage("You must supply a filename!");
+	if(NREPEAT<1) NREPEAT = 1;
+}
+
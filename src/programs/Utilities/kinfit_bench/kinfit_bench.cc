@@ -0,0 +1,419 @@
+
+// Benchmark for the kinematic fit in DKinFitter.
+//
+// A set of combos is made for each of a few common reactions:
+//
+//    gamma p -> pi+ pi- p                            (p4 + vertex)
+//    gamma p -> pi+ pi- pi0 p, pi0 -> gamma gamma    (p4 + pi0 mass + vertex)
+//    gamma p -> pi+ pi- (p)                          (p4 with a missing proton + vertex)
+//
+// The final state particles are generated with TGenPhaseSpace for an
+// 8.5 GeV beam photon on a proton at rest and then smeared with typical
+// GlueX resolutions, with a covariance matrix to match. Each combo has
+// the same number of measured parameters, unknowns, and constraint
+// equations as the same reaction does in an analysis. The field is off
+// so that the straight tracks agree with the generated vertex.
+//
+// Every combo is fit NREPEAT times with the dense-matrix fit
+// (DKinFitter::Set_UseDenseMatricesFlag(true), same as
+// -PKINFIT:DENSE_MATRICES=1) and with the default fit, which uses the
+// per-particle blocks of the covariance matrix. The time per fit is
+// reported for both. The results of the two are also compared: the
+// largest differences in the chi-squared, the full covariance matrix,
+// and the fitted momenta are printed (the last two relative to the
+// largest element/momentum). These should be at the level of rounding
+// errors since only the order in which the products are summed differs.
+// A combo fails the comparison if the two fits don't agree on whether
+// it converged or if any of the differences is larger than the
+// tolerance (1e-6 by default, see -t; the chi-squared difference is
+// relative to max(1, chi-squared)). The program exits with a non-zero
+// status if any combo fails so it can be used as a check.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+using namespace std;
+using namespace std::chrono;
+
+#include <TRandom.h>
+#include <TGenPhaseSpace.h>
+
+#include <KINFITTER/DKinFitter.h>
+#include <KINFITTER/DKinFitUtils.h>
+
+
+void Usage(string mess);
+void ParseCommandLineArguments(int narg, char *argv[]);
+
+uint32_t NCOMBOS = 1000;
+uint32_t NREPEAT = 20;
+double TOLERANCE = 1.0E-6;
+
+const double BEAM_ENERGY   = 8.5;
+const double MASS_PION     = 0.13957;
+const double MASS_PI0      = 0.134977;
+const double MASS_PROTON   = 0.938272;
+
+// No magnetic field, no beamline in the vertex fit
+class DKinFitUtils_Bench : public DKinFitUtils
+{
+	public:
+		bool Get_IncludeBeamlineInVertexFitFlag(void) const{return false;}
+		TVector3 Get_BField(const TVector3& locPosition) const{return TVector3(0.0, 0.0, 0.0);}
+		bool Get_IsBFieldNearBeamline(void) const{return false;}
+};
+
+struct combo_t{
+	set<shared_ptr<DKinFitConstraint>> constraints;
+};
+
+struct reaction_t{
+	string name;
+	vector<double> masses; // final state masses given to TGenPhaseSpace
+	vector<combo_t> combos;
+};
+
+struct result_t{
+	bool success;
+	double chisq;
+	TMatrixDSym V;
+	map<shared_ptr<DKinFitParticle>, TVector3> momenta; // key is the input particle
+};
+
+void     MakeCombos(DKinFitUtils_Bench &utils, reaction_t &reaction, int ireaction);
+shared_ptr<DKinFitParticle> MakeBeam(DKinFitUtils_Bench &utils, const TVector3 &vertex);
+shared_ptr<DKinFitParticle> MakeTrack(DKinFitUtils_Bench &utils, int pid, int charge, double mass, const TLorentzVector &p4, const TVector3 &vertex);
+shared_ptr<DKinFitParticle> MakeShower(DKinFitUtils_Bench &utils, const TLorentzVector &p4, const TVector3 &vertex);
+shared_ptr<TMatrixFSym> MakeCovariance(const vector<double> &sigmas);
+result_t Fit(DKinFitter &fitter, DKinFitUtils_Bench &utils, const combo_t &combo);
+double   TimeFits(DKinFitter &fitter, const vector<combo_t> &combos);
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	gRandom->SetSeed(12345);
+
+	DKinFitUtils_Bench utils;
+	DKinFitter fitter(&utils);
+
+	vector<reaction_t> reactions(3);
+	reactions[0].name = "gamma p -> pi+ pi- p";
+	reactions[0].masses = {MASS_PION, MASS_PION, MASS_PROTON};
+	reactions[1].name = "gamma p -> pi+ pi- pi0 p";
+	reactions[1].masses = {MASS_PION, MASS_PION, MASS_PI0, MASS_PROTON};
+	reactions[2].name = "gamma p -> pi+ pi- (p)";
+	reactions[2].masses = {MASS_PION, MASS_PION, MASS_PROTON};
+	for(unsigned int i=0; i<reactions.size(); i++) MakeCombos(utils, reactions[i], i);
+
+	cout << "Fitting " << NCOMBOS << " combos per reaction " << NREPEAT << " times each" << endl;
+	cout << endl;
+
+	uint32_t Nfailed_total = 0;
+	for(auto &reaction : reactions){
+
+		// Compare the results of the two fits
+		uint32_t Nsuccess = 0;
+		uint32_t Nmismatch = 0;
+		uint32_t Nfailed = 0;
+		double max_chisq_diff = 0.0;
+		double max_V_diff = 0.0;
+		double max_p_diff = 0.0;
+		for(auto &combo : reaction.combos){
+			fitter.Set_UseDenseMatricesFlag(true);
+			result_t dense = Fit(fitter, utils, combo);
+			fitter.Set_UseDenseMatricesFlag(false);
+			result_t blocks = Fit(fitter, utils, combo);
+
+			if(dense.success != blocks.success){
+				Nmismatch++;
+				continue;
+			}
+			if(!dense.success) continue;
+			Nsuccess++;
+
+			double chisq_diff = fabs(dense.chisq - blocks.chisq)/fmax(1.0, fabs(dense.chisq));
+			max_chisq_diff = fmax(max_chisq_diff, chisq_diff);
+
+			double maxV = 0.0;
+			double maxdiff = 0.0;
+			for(int i=0; i<dense.V.GetNrows(); i++){
+				for(int j=0; j<dense.V.GetNcols(); j++){
+					maxV = fmax(maxV, fabs(dense.V(i,j)));
+					maxdiff = fmax(maxdiff, fabs(dense.V(i,j) - blocks.V(i,j)));
+				}
+			}
+			double V_diff = maxV>0.0 ? maxdiff/maxV:maxdiff;
+			max_V_diff = fmax(max_V_diff, V_diff);
+
+			double p_diff = 0.0;
+			if(dense.momenta.size() != blocks.momenta.size()) p_diff = 1.0;
+			for(auto &p : dense.momenta){
+				auto it = blocks.momenta.find(p.first);
+				if(it == blocks.momenta.end()){
+					p_diff = 1.0;
+					continue;
+				}
+				double mag = p.second.Mag();
+				double diff = (p.second - it->second).Mag();
+				p_diff = fmax(p_diff, mag>0.0 ? diff/mag:diff);
+			}
+			max_p_diff = fmax(max_p_diff, p_diff);
+
+			if(chisq_diff>TOLERANCE || V_diff>TOLERANCE || p_diff>TOLERANCE) Nfailed++;
+		}
+		Nfailed += Nmismatch;
+		Nfailed_total += Nfailed;
+
+		// Time the two fits
+		fitter.Set_UseDenseMatricesFlag(true);
+		double t_dense = TimeFits(fitter, reaction.combos);
+		fitter.Set_UseDenseMatricesFlag(false);
+		double t_blocks = TimeFits(fitter, reaction.combos);
+
+		// Get the matrix sizes from one more fit
+		Fit(fitter, utils, reaction.combos[0]);
+
+		double Nfits = (double)reaction.combos.size()*(double)NREPEAT;
+		char str[256];
+		cout << reaction.name << endl;
+		sprintf(str, "   measurables=%d  unknowns=%d  constraint eqs.=%d  converged: %d/%d  (dense/blocks disagree: %d)",
+			fitter.Get_NumMeasurables(), fitter.Get_NumUnknowns(), fitter.Get_NumConstraintEquations(), Nsuccess, (int)reaction.combos.size(), Nmismatch);
+		cout << str << endl;
+		sprintf(str, "   dense: %8.2f us/fit   blocks: %8.2f us/fit   speedup: %5.2f",
+			1.0E6*t_dense/Nfits, 1.0E6*t_blocks/Nfits, t_blocks>0.0 ? t_dense/t_blocks:0.0);
+		cout << str << endl;
+		sprintf(str, "   max diff.: chisq (rel.)=%8.2e  V (rel.)=%8.2e  p (rel.)=%8.2e   %s (%d combos over tolerance %.1e)",
+			max_chisq_diff, max_V_diff, max_p_diff, Nfailed ? "FAILED":"passed", Nfailed, TOLERANCE);
+		cout << str << endl;
+		cout << endl;
+	}
+
+	if(Nfailed_total){
+		cout << "Dense and block fits disagree for " << Nfailed_total << " combos" << endl;
+		return -1;
+	}
+
+	return 0;
+}
+
+//----------------
+// MakeCombos
+//----------------
+void MakeCombos(DKinFitUtils_Bench &utils, reaction_t &reaction, int ireaction)
+{
+	/// Generate NCOMBOS events for the given reaction and make the
+	/// kinematic fit constraints for each of them. The constraints
+	/// (and the particles in them) are kept for the whole job.
+
+	TLorentzVector W(0.0, 0.0, BEAM_ENERGY, BEAM_ENERGY + MASS_PROTON);
+	TGenPhaseSpace phase_space;
+	phase_space.SetDecay(W, reaction.masses.size(), &reaction.masses[0]);
+	TGenPhaseSpace pi0_decay;
+
+	while(reaction.combos.size() < NCOMBOS){
+		double weight = phase_space.Generate();
+		if(gRandom->Uniform()*phase_space.GetWtMax() > weight) continue;
+
+		TVector3 vertex(gRandom->Gaus(0.0, 0.1), gRandom->Gaus(0.0, 0.1), gRandom->Uniform(52.0, 78.0));
+
+		auto beam   = MakeBeam(utils, vertex);
+		auto target = utils.Make_TargetParticle(2212, 1, MASS_PROTON);
+		auto pip    = MakeTrack(utils,  211,  1, MASS_PION, *phase_space.GetDecay(0), vertex);
+		auto pim    = MakeTrack(utils, -211, -1, MASS_PION, *phase_space.GetDecay(1), vertex);
+		TVector3 vertex_guess = 0.5*(pip->Get_Position() + pim->Get_Position()); // average of the measured pion positions
+
+		combo_t combo;
+		switch(ireaction){
+			case 0:{
+				auto proton = MakeTrack(utils, 2212, 1, MASS_PROTON, *phase_space.GetDecay(2), vertex);
+				combo.constraints.insert(utils.Make_P4Constraint({beam, target}, {pip, pim, proton}));
+				combo.constraints.insert(utils.Make_VertexConstraint({pip, pim, proton}, {beam}, vertex_guess));
+				break;
+			}
+			case 1:{
+				double gamma_masses[2] = {0.0, 0.0};
+				pi0_decay.SetDecay(*phase_space.GetDecay(2), 2, gamma_masses);
+				pi0_decay.Generate();
+				auto gamma1 = MakeShower(utils, *pi0_decay.GetDecay(0), vertex);
+				auto gamma2 = MakeShower(utils, *pi0_decay.GetDecay(1), vertex);
+				auto pi0    = utils.Make_DecayingParticle(111, 0, MASS_PI0, {}, {gamma1, gamma2});
+				auto proton = MakeTrack(utils, 2212, 1, MASS_PROTON, *phase_space.GetDecay(3), vertex);
+				combo.constraints.insert(utils.Make_MassConstraint(pi0));
+				combo.constraints.insert(utils.Make_P4Constraint({beam, target}, {pip, pim, pi0, proton}));
+				combo.constraints.insert(utils.Make_VertexConstraint({pip, pim, proton}, {beam, gamma1, gamma2}, vertex_guess));
+				break;
+			}
+			case 2:{
+				auto proton = utils.Make_MissingParticle(2212, 1, MASS_PROTON);
+				auto p4_constraint = utils.Make_P4Constraint({beam, target}, {pip, pim, proton});
+				p4_constraint->Set_InitP3Guess(beam->Get_Momentum() - pip->Get_Momentum() - pim->Get_Momentum());
+				combo.constraints.insert(p4_constraint);
+				combo.constraints.insert(utils.Make_VertexConstraint({pip, pim}, {beam, proton}, vertex_guess));
+				break;
+			}
+		}
+		reaction.combos.push_back(combo);
+
+		// The constraints are kept in the combos: forget them here so
+		// they aren't found again when the next combo is made.
+		utils.Reset_NewEvent();
+	}
+}
+
+//----------------
+// MakeBeam
+//----------------
+shared_ptr<DKinFitParticle> MakeBeam(DKinFitUtils_Bench &utils, const TVector3 &vertex)
+{
+	/// Tagged beam photon: 0.1% energy resolution
+	double sigma_E = 0.001*BEAM_ENERGY;
+	TVector3 p(0.0, 0.0, BEAM_ENERGY + gRandom->Gaus(0.0, sigma_E));
+	auto cov = MakeCovariance({1.0E-4, 1.0E-4, sigma_E, 0.1, 0.1, 1.0, 0.1});
+	return utils.Make_BeamParticle(22, 0, 0.0, TLorentzVector(vertex, 0.0), p, cov);
+}
+
+//----------------
+// MakeTrack
+//----------------
+shared_ptr<DKinFitParticle> MakeTrack(DKinFitUtils_Bench &utils, int pid, int charge, double mass, const TLorentzVector &p4, const TVector3 &vertex)
+{
+	/// Charged track: 1.5% momentum resolution (per component) and
+	/// a few mm in position
+	double sigma_p = 0.015*p4.P();
+	vector<double> sigmas = {sigma_p, sigma_p, sigma_p, 0.3, 0.3, 0.5, 0.2};
+
+	TVector3 p(p4.Px() + gRandom->Gaus(0.0, sigmas[0]), p4.Py() + gRandom->Gaus(0.0, sigmas[1]), p4.Pz() + gRandom->Gaus(0.0, sigmas[2]));
+	TVector3 x(vertex.X() + gRandom->Gaus(0.0, sigmas[3]), vertex.Y() + gRandom->Gaus(0.0, sigmas[4]), vertex.Z() + gRandom->Gaus(0.0, sigmas[5]));
+	double t = gRandom->Gaus(0.0, sigmas[6]);
+
+	return utils.Make_DetectedParticle(pid, charge, mass, TLorentzVector(x, t), p, 0.0, MakeCovariance(sigmas));
+}
+
+//----------------
+// MakeShower
+//----------------
+shared_ptr<DKinFitParticle> MakeShower(DKinFitUtils_Bench &utils, const TLorentzVector &p4, const TVector3 &vertex)
+{
+	/// Photon shower 2 m from the vertex: 6%/sqrt(E) + 1% energy
+	/// resolution and 1 cm in position
+	double E = p4.E();
+	double sigma_E = E*sqrt(0.06*0.06/E + 0.01*0.01);
+	vector<double> sigmas = {sigma_E, 1.0, 1.0, 1.0, 0.3};
+
+	TVector3 shower_pos = vertex + 200.0*p4.Vect().Unit();
+	TVector3 x(shower_pos.X() + gRandom->Gaus(0.0, sigmas[1]), shower_pos.Y() + gRandom->Gaus(0.0, sigmas[2]), shower_pos.Z() + gRandom->Gaus(0.0, sigmas[3]));
+	double t = 200.0/29.9792458 + gRandom->Gaus(0.0, sigmas[4]);
+	double E_meas = fmax(0.01, E + gRandom->Gaus(0.0, sigma_E));
+
+	return utils.Make_DetectedShower(22, 0.0, TLorentzVector(x, t), E_meas, MakeCovariance(sigmas));
+}
+
+//----------------
+// MakeCovariance
+//----------------
+shared_ptr<TMatrixFSym> MakeCovariance(const vector<double> &sigmas)
+{
+	/// Diagonal covariance matrix with the given uncertainties
+	auto cov = make_shared<TMatrixFSym>(sigmas.size());
+	for(unsigned int i=0; i<sigmas.size(); i++) (*cov)(i,i) = sigmas[i]*sigmas[i];
+	return cov;
+}
+
+//----------------
+// Fit
+//----------------
+result_t Fit(DKinFitter &fitter, DKinFitUtils_Bench &utils, const combo_t &combo)
+{
+	/// Fit the combo once and return the results
+	fitter.Reset_NewEvent();
+	fitter.Add_Constraints(combo.constraints);
+
+	result_t result;
+	result.success = fitter.Fit_Reaction();
+	result.chisq = fitter.Get_ChiSq();
+	if(!result.success) return result;
+
+	result.V.ResizeTo(fitter.Get_V());
+	result.V = fitter.Get_V();
+	for(auto &particle : fitter.Get_KinFitParticles()){
+		result.momenta[utils.Get_InputKinFitParticle(particle)] = particle->Get_Momentum();
+	}
+
+	return result;
+}
+
+//----------------
+// TimeFits
+//----------------
+double TimeFits(DKinFitter &fitter, const vector<combo_t> &combos)
+{
+	/// Fit every combo NREPEAT times and return the time it took
+	/// in seconds.
+
+	auto tstart = high_resolution_clock::now();
+	for(uint32_t irep=0; irep<NREPEAT; irep++){
+		for(auto &combo : combos){
+			fitter.Reset_NewEvent();
+			fitter.Add_Constraints(combo.constraints);
+			fitter.Fit_Reaction();
+		}
+	}
+	auto tend = high_resolution_clock::now();
+
+	return duration_cast<duration<double>>(tend - tstart).count();
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    kinfit_bench [options]" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -n Ncombos    Number of combos to make for each reaction (default 1000)" << endl;
+	cout << "   -r Nrepeat    Number of times to fit each combo (default 20)" << endl;
+	cout << "   -t tol        Largest allowed relative difference between the" << endl;
+	cout << "                 dense and block fits (default 1e-6)" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int narg, char *argv[])
+{
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-n"){ NCOMBOS = atoi(next.c_str()); i++;}
+		else if(arg == "-r"){ NREPEAT = atoi(next.c_str()); i++;}
+		else if(arg == "-t"){ TOLERANCE = atof(next.c_str()); i++;}
+		else Usage("Unknown argument: " + arg);
+	}
+
+	if(NCOMBOS<1) NCOMBOS = 1;
+	if(NREPEAT<1) NREPEAT = 1;
+}
+
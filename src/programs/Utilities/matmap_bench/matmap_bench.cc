@@ -0,0 +1,314 @@
+
+// Benchmark for the material map lookups in DGeometry::FindMatKalman.
+//
+// A set of tracks is swum through the field with DMagneticFieldStepper
+// (or read from a file written by an earlier run using -o) and the
+// position and momentum at every step are recorded. The material and
+// the estimated distance to the next material boundary are then found
+// for every step, in order along each track, using:
+//
+//   old    - a copy of the FindMatKalman code from before the (r,z)
+//            region index was added. It tries each map in turn and
+//            checks every map for the distance to the boundary.
+//   index  - DGeometry::FindMatKalman
+//
+// The results (including last_index after each step) are checked to
+// be identical.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+using namespace std;
+using namespace std::chrono;
+
+#include <DANA/DApplication.h>
+#include <HDGEOMETRY/DGeometry.h>
+#include <HDGEOMETRY/DMaterialMap.h>
+#include <TRACKING/DMagneticFieldStepper.h>
+
+void Usage(string mess);
+void ParseCommandLineArguments(int narg, char *argv[], vector<char*> &unused_args);
+void SwimTrajectories(const DMagneticFieldMap *bfield, vector<uint32_t> &track_start, vector<DVector3> &pos, vector<DVector3> &mom);
+bool ReadTrajectories(string fname, vector<uint32_t> &track_start, vector<DVector3> &pos, vector<DVector3> &mom);
+void WriteTrajectories(string fname, vector<uint32_t> &track_start, vector<DVector3> &pos, vector<DVector3> &mom);
+jerror_t OldFindMatKalman(vector<DMaterialMap*> &materialmaps, const DVector3 &pos, const DVector3 &mom,
+	double &KrhoZ_overA, double &rhoZ_overA, double &LnI, double &Z,
+	double &chi2c_factor, double &chi2a_factor, double &chi2a_corr,
+	unsigned int &last_index, double *s_to_boundary);
+
+int32_t  RUN_NUMBER = 30000;
+uint32_t NTRACKS    = 2000;
+uint32_t NREPEAT    = 20;
+double   STEP_SIZE  = 0.5;
+string   INFILE;
+string   OUTFILE;
+
+// Results for every step from one method
+class MaterialResults{
+	public:
+		MaterialResults(size_t n){ for(auto &v : vals) v.resize(n); last_index.resize(n); err.resize(n); }
+		void Clear(void){
+			for(auto &v : vals) memset(v.data(), 0, v.size()*sizeof(double));
+			memset(last_index.data(), 0, last_index.size()*sizeof(unsigned int));
+		}
+		bool operator==(const MaterialResults &o) const {
+			for(int k=0; k<8; k++){
+				if(memcmp(vals[k].data(), o.vals[k].data(), vals[k].size()*sizeof(double))) return false;
+			}
+			return last_index==o.last_index && err==o.err;
+		}
+		vector<double> vals[8]; // KrhoZ_overA, rhoZ_overA, LnI, Z, chi2c_factor, chi2a_factor, chi2a_corr, s_to_boundary
+		vector<unsigned int> last_index;
+		vector<jerror_t> err;
+};
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	vector<char*> unused_args;
+	ParseCommandLineArguments(narg, argv, unused_args);
+
+	DApplication *dapp = new DApplication(unused_args.size(), unused_args.empty() ? NULL:&unused_args[0]);
+	dapp->Init();
+
+	DGeometry *geom = dapp->GetDGeometry(RUN_NUMBER);
+	vector<DMaterialMap*> materialmaps = geom->GetMaterialMapVector();
+	if(materialmaps.empty()){
+		cout << "No material maps. Nothing to benchmark." << endl;
+		return -1;
+	}
+
+	// Get trajectory points
+	vector<uint32_t> track_start;
+	vector<DVector3> pos, mom;
+	if(!INFILE.empty()){
+		if(!ReadTrajectories(INFILE, track_start, pos, mom)) return -1;
+	}else{
+		SwimTrajectories(dapp->GetBfield(RUN_NUMBER), track_start, pos, mom);
+	}
+	if(!OUTFILE.empty()) WriteTrajectories(OUTFILE, track_start, pos, mom);
+	size_t N = pos.size();
+	if(N == 0){
+		cout << "No trajectory points!" << endl;
+		return -1;
+	}
+	track_start.push_back(N);
+	cout << N << " steps on " << track_start.size()-1 << " tracks using " << materialmaps.size() << " material maps." << endl;
+	cout << "Each track done " << NREPEAT << " times per method" << endl;
+	cout << endl;
+
+	MaterialResults ref(N);
+	MaterialResults out(N);
+
+	const char *names[2] = {"old", "index"};
+	double t[2];
+	string status[2];
+	for(int method=0; method<2; method++){
+
+		MaterialResults &o = method==0 ? ref:out;
+		o.Clear();
+
+		auto tstart = high_resolution_clock::now();
+		for(uint32_t irep=0; irep<NREPEAT; irep++){
+			for(size_t itrk=0; itrk+1<track_start.size(); itrk++){
+				unsigned int last_index = 0;
+				for(size_t i=track_start[itrk]; i<track_start[itrk+1]; i++){
+					if(method == 0){
+						o.err[i] = OldFindMatKalman(materialmaps, pos[i], mom[i], o.vals[0][i], o.vals[1][i], o.vals[2][i], o.vals[3][i],
+							o.vals[4][i], o.vals[5][i], o.vals[6][i], last_index, &o.vals[7][i]);
+					}else{
+						o.err[i] = geom->FindMatKalman(pos[i], mom[i], o.vals[0][i], o.vals[1][i], o.vals[2][i], o.vals[3][i],
+							o.vals[4][i], o.vals[5][i], o.vals[6][i], last_index, &o.vals[7][i]);
+					}
+					o.last_index[i] = last_index;
+				}
+			}
+		}
+		auto tend = high_resolution_clock::now();
+		t[method] = duration_cast<duration<double>>(tend - tstart).count();
+
+		if(method != 0) status[method] = (out == ref) ? "OK":"MISMATCH!";
+	}
+
+	for(int method=0; method<2; method++){
+		char str[256];
+		sprintf(str, "%8s: %8.3f s  %7.2f ns/step  speedup=%5.2f  %s",
+			names[method], t[method], t[method]/(double)N/(double)NREPEAT*1.0E9, t[0]/t[method], status[method].c_str());
+		cout << str << endl;
+	}
+	cout << endl;
+
+	return 0;
+}
+
+//----------------
+// OldFindMatKalman
+//----------------
+jerror_t OldFindMatKalman(vector<DMaterialMap*> &materialmaps, const DVector3 &pos, const DVector3 &mom,
+	double &KrhoZ_overA, double &rhoZ_overA, double &LnI, double &Z,
+	double &chi2c_factor, double &chi2a_factor, double &chi2a_corr,
+	unsigned int &last_index, double *s_to_boundary)
+{
+	/// This is DGeometry::FindMatKalman as it was before the region
+	/// index was added.
+	for(unsigned int i=last_index; i<materialmaps.size(); i++){
+		jerror_t err = materialmaps[i]->FindMatKalman(pos,KrhoZ_overA,
+			rhoZ_overA,LnI,chi2c_factor,
+			chi2a_factor,chi2a_corr,Z);
+		if(err==NOERROR){
+			if(i==materialmaps.size()-1) last_index=0;
+			else last_index=i;
+			if(s_to_boundary==NULL)return NOERROR;
+
+			*s_to_boundary = 1.0E6;
+			if(last_index==0){
+				for(unsigned int j=0; j<materialmaps.size();j++){
+					double s = materialmaps[j]->EstimatedDistanceToBoundary(pos, mom);
+					if(s<*s_to_boundary) *s_to_boundary = s;
+				}
+			}else{
+				double s = materialmaps[last_index]->EstimatedDistanceToBoundary(pos, mom);
+				if(s<*s_to_boundary)*s_to_boundary = s;
+			}
+			return NOERROR;
+		}
+	}
+
+	return RESOURCE_UNAVAILABLE;
+}
+
+//----------------
+// SwimTrajectories
+//----------------
+void SwimTrajectories(const DMagneticFieldMap *bfield, vector<uint32_t> &track_start, vector<DVector3> &pos, vector<DVector3> &mom)
+{
+	/// Swim NTRACKS tracks of random charge and momentum from the
+	/// target and record the position and momentum after every step
+	/// until the track leaves the tracking volume.
+	mt19937 rng(1234);
+	uniform_real_distribution<double> flat(0.0, 1.0);
+
+	DMagneticFieldStepper stepper(bfield);
+	stepper.SetStepSize(STEP_SIZE);
+	for(uint32_t itrk=0; itrk<NTRACKS; itrk++){
+		double q     = flat(rng)<0.5 ? -1.0:+1.0;
+		double p     = 0.2 + 3.8*flat(rng);
+		double theta = (1.0 + 139.0*flat(rng))*M_PI/180.0;
+		double phi   = 2.0*M_PI*flat(rng);
+		DVector3 mypos(0.0, 0.0, 50.0 + 30.0*flat(rng));
+		DVector3 mymom;
+		mymom.SetMagThetaPhi(p, theta, phi);
+		stepper.SetStartingParams(q, &mypos, &mymom);
+		track_start.push_back(pos.size());
+		for(int istep=0; istep<10000; istep++){
+			stepper.Step(&mypos);
+			if(mypos.Perp()>90.0 || mypos.z()<0.0 || mypos.z()>650.0) break;
+			stepper.GetMomentum(mymom);
+			pos.push_back(mypos);
+			mom.push_back(mymom);
+		}
+	}
+	cout << "Swam " << NTRACKS << " tracks with step size " << STEP_SIZE << " cm" << endl;
+}
+
+//----------------
+// ReadTrajectories
+//----------------
+bool ReadTrajectories(string fname, vector<uint32_t> &track_start, vector<DVector3> &pos, vector<DVector3> &mom)
+{
+	/// Read trajectories written by WriteTrajectories. Each track is
+	/// the number of steps followed by x,y,z,px,py,pz (as doubles) for
+	/// each step.
+	ifstream ifs(fname.c_str(), ios::binary);
+	if(!ifs.is_open()){
+		cout << "Unable to open " << fname << " for reading!" << endl;
+		return false;
+	}
+	uint32_t Nsteps;
+	while(ifs.read((char*)&Nsteps, sizeof(Nsteps))){
+		track_start.push_back(pos.size());
+		double v[6];
+		for(uint32_t i=0; i<Nsteps && ifs.read((char*)v, sizeof(v)); i++){
+			pos.push_back(DVector3(v[0], v[1], v[2]));
+			mom.push_back(DVector3(v[3], v[4], v[5]));
+		}
+	}
+	cout << "Read " << track_start.size() << " tracks with " << pos.size() << " steps from " << fname << endl;
+	return true;
+}
+
+//----------------
+// WriteTrajectories
+//----------------
+void WriteTrajectories(string fname, vector<uint32_t> &track_start, vector<DVector3> &pos, vector<DVector3> &mom)
+{
+	ofstream ofs(fname.c_str(), ios::binary);
+	for(size_t itrk=0; itrk<track_start.size(); itrk++){
+		uint32_t istart = track_start[itrk];
+		uint32_t iend = (itrk+1)<track_start.size() ? track_start[itrk+1]:pos.size();
+		uint32_t Nsteps = iend - istart;
+		ofs.write((char*)&Nsteps, sizeof(Nsteps));
+		for(uint32_t i=istart; i<iend; i++){
+			double v[6] = {pos[i].x(), pos[i].y(), pos[i].z(), mom[i].x(), mom[i].y(), mom[i].z()};
+			ofs.write((char*)v, sizeof(v));
+		}
+	}
+	cout << "Wrote " << track_start.size() << " tracks with " << pos.size() << " steps to " << fname << endl;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    matmap_bench [options] [JANA options]" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -R run        Run number used to get material maps and field (default 30000)" << endl;
+	cout << "   -t Ntracks    Number of tracks to swim (default 2000)" << endl;
+	cout << "   -s step       Swim step size in cm (default 0.5)" << endl;
+	cout << "   -r Nrepeat    Number of times to do each track (default 20)" << endl;
+	cout << "   -i file       Read trajectories from file instead of swimming" << endl;
+	cout << "   -o file       Write trajectories to file" << endl;
+	cout << endl;
+	cout << "Any other arguments are passed to DApplication." << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int narg, char *argv[], vector<char*> &unused_args)
+{
+	unused_args.push_back(argv[0]);
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-R"){ RUN_NUMBER = atoi(next.c_str()); i++;}
+		else if(arg == "-t"){ NTRACKS    = atoi(next.c_str()); i++;}
+		else if(arg == "-s"){ STEP_SIZE  = atof(next.c_str()); i++;}
+		else if(arg == "-r"){ NREPEAT    = atoi(next.c_str()); i++;}
+		else if(arg == "-i"){ INFILE     = next; i++;}
+		else if(arg == "-o"){ OUTFILE    = next; i++;}
+		else unused_args.push_back(argv[i]);
+	}
+}
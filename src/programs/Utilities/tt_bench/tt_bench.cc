@@ -0,0 +1,282 @@
+
+// Benchmark for DTranslationTable::ApplyTranslationTable.
+//
+// Events are read from an EVIO file in the usual way. For each event,
+// once the low level objects (Df250PulseData, DF1TDCHit, ...) are in
+// their factories, the event is replayed through ApplyTranslationTable
+// a number of times in each of these ways:
+//
+//     map: hits from JEventLoop, channels found by map search (TT:DENSE_LOOKUP=0)
+//   dense: hits from JEventLoop, channels found with compiled lookup table
+//  parsed: hits taken directly from the DParsedEvent (what JEventSource_EVIOpp does)
+//
+// The time for each is accumulated and the DigiHit objects made are
+// compared to make sure they are identical.
+//
+// Any JANA options (e.g. -PEVENTS_TO_KEEP=1000) may be given on the
+// command line along with the input file(s).
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+using namespace std;
+using namespace std::chrono;
+
+#include <JANA/JEventProcessor.h>
+#include <JANA/JEventLoop.h>
+#include <JANA/JFactory.h>
+using namespace jana;
+
+#include <DANA/DApplication.h>
+#include <TTAB/DTranslationTable.h>
+#include <DAQ/JEventSource_EVIOpp.h>
+#include <DAQ/DParsedEvent.h>
+
+
+void Usage(string mess);
+void ParseCommandLineArguments(int &narg, char *argv[]);
+
+uint32_t NREPEAT = 100;
+
+//----------------
+// TTBenchProcessor
+//----------------
+class TTBenchProcessor:public JEventProcessor{
+	public:
+		jerror_t brun(JEventLoop *loop, int32_t runnumber);
+		jerror_t evnt(JEventLoop *loop, uint64_t eventnumber);
+		jerror_t fini(void);
+
+		double Replay(JEventLoop *loop, DTranslationTable *tt, const DParsedEvent *pe, vector<JFactory_base*> &facs, vector<string> &signature);
+
+		std::mutex mtx;
+		map<JEventLoop*, DTranslationTable*> tts;
+
+		uint64_t Nevents    = 0;
+		uint64_t Nhits      = 0;
+		uint64_t Nmismatch  = 0;
+		double   t_map      = 0.0;
+		double   t_dense    = 0.0;
+		double   t_parsed   = 0.0;
+		uint64_t Nparsed    = 0;
+};
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	TTBenchProcessor proc;
+	DApplication *app = new DApplication(narg, argv);
+	app->Run(&proc);
+
+	delete app;
+
+	return 0;
+}
+
+//----------------
+// brun
+//----------------
+jerror_t TTBenchProcessor::brun(JEventLoop *loop, int32_t runnumber)
+{
+	// Make our own DTranslationTable for each thread so we can switch
+	// between lookup methods without affecting anything else.
+	lock_guard<mutex> lck(mtx);
+	if(tts[loop]) delete tts[loop];
+	tts[loop] = new DTranslationTable(loop);
+
+	return NOERROR;
+}
+
+//----------------
+// evnt
+//----------------
+jerror_t TTBenchProcessor::evnt(JEventLoop *loop, uint64_t eventnumber)
+{
+	// Getting the low level objects makes the event source copy them
+	// into their factories (it will apply the regular TT too).
+	vector<const Df250PulseIntegral*> pulseintegrals250;
+	vector<const Df250PulseData*>     pulsedatas250;
+	vector<const Df125PulseIntegral*> pulseintegrals125;
+	vector<const Df125CDCPulse*>      cdcpulses;
+	vector<const Df125FDCPulse*>      fdcpulses;
+	vector<const DF1TDCHit*>          f1tdchits;
+	vector<const DCAEN1290TDCHit*>    caen1290tdchits;
+	vector<const DDIRCTDCHit*>        dirctdchits;
+	loop->Get(pulseintegrals250);
+	loop->Get(pulsedatas250);
+	loop->Get(pulseintegrals125);
+	loop->Get(cdcpulses);
+	loop->Get(fdcpulses);
+	loop->Get(f1tdchits);
+	loop->Get(caen1290tdchits);
+	loop->Get(dirctdchits);
+	uint64_t N = pulseintegrals250.size() + pulsedatas250.size() + pulseintegrals125.size()
+	           + cdcpulses.size() + fdcpulses.size() + f1tdchits.size()
+	           + caen1290tdchits.size() + dirctdchits.size();
+
+	lock_guard<mutex> lck(mtx);
+	DTranslationTable *tt = tts[loop];
+	if(!tt) return NOERROR;
+
+	// Factories for all DigiHit types the TT makes
+	vector<JFactory_base*> facs;
+	for(auto fac : loop->GetFactories()){
+		string name = fac->GetDataClassName();
+		if(strlen(fac->Tag()) != 0) continue;
+		if(tt->IsSuppliedType(name)) facs.push_back(fac);
+	}
+
+	vector<string> sig_map, sig_dense, sig_parsed;
+	tt->SetDenseLookup(false);
+	t_map   += Replay(loop, tt, NULL, facs, sig_map);
+	tt->SetDenseLookup(true);
+	t_dense += Replay(loop, tt, NULL, facs, sig_dense);
+
+	// The DParsedEvent is only available from JEventSource_EVIOpp
+	JEventSource *source = loop->GetJEvent().GetJEventSource();
+	if(dynamic_cast<JEventSource_EVIOpp*>(source)){
+		const DParsedEvent *pe = (const DParsedEvent*)loop->GetJEvent().GetRef();
+		t_parsed += Replay(loop, tt, pe, facs, sig_parsed);
+		Nparsed++;
+	}else{
+		sig_parsed = sig_dense;
+	}
+
+	if(sig_map != sig_dense || sig_map != sig_parsed){
+		Nmismatch++;
+		cout << "Event " << eventnumber << ": DigiHits differ between methods!" << endl;
+	}
+
+	Nevents++;
+	Nhits += N;
+
+	return NOERROR;
+}
+
+//----------------
+// Replay
+//----------------
+double TTBenchProcessor::Replay(JEventLoop *loop, DTranslationTable *tt, const DParsedEvent *pe, vector<JFactory_base*> &facs, vector<string> &signature)
+{
+	/// Apply the TT to the current event NREPEAT times and return the
+	/// time taken. If pe is not NULL, the hits are taken from it rather
+	/// than the JEventLoop. The contents of all DigiHit objects made on
+	/// the last pass are written into signature.
+
+	double t = 0.0;
+	for(uint32_t irep=0; irep<NREPEAT; irep++){
+		// Empty the factories. The objects from the previous pass belong to
+		// the TT's arenas (the factories are marked NOT_OBJECT_OWNER) so this
+		// only drops the pointers. The TT reuses the objects in the next pass.
+		for(auto fac : facs) fac->Reset();
+
+		auto tstart = high_resolution_clock::now();
+		if(pe)
+			tt->ApplyTranslationTable(loop, pe);
+		else
+			tt->ApplyTranslationTable(loop);
+		auto tend = high_resolution_clock::now();
+		t += duration_cast<duration<double>>(tend - tstart).count();
+	}
+
+	for(auto fac : facs){
+		vector<void*> vobjs = fac->Get();
+		for(auto vobj : vobjs){
+			vector<pair<string,string> > items;
+			((JObject*)vobj)->toStrings(items);
+			string s = fac->GetDataClassName();
+			for(auto &p : items) s += " " + p.first + "=" + p.second;
+			signature.push_back(s);
+		}
+	}
+
+	return t;
+}
+
+//----------------
+// fini
+//----------------
+jerror_t TTBenchProcessor::fini(void)
+{
+	for(auto p : tts) delete p.second;
+	tts.clear();
+
+	if(Nevents == 0){
+		cout << "No events processed" << endl;
+		return NOERROR;
+	}
+
+	double Ncalls = (double)Nevents*NREPEAT;
+	char str[256];
+	cout << endl;
+	cout << "Replayed " << Nevents << " events (" << Nhits << " hits) " << NREPEAT << " times each" << endl;
+	sprintf(str, "     map: %8.3f s  %8.2f us/event  %6.1f ns/hit", t_map, 1.0E6*t_map/Ncalls, 1.0E9*t_map/((double)Nhits*NREPEAT));
+	cout << str << endl;
+	sprintf(str, "   dense: %8.3f s  %8.2f us/event  %6.1f ns/hit  speedup=%5.2f", t_dense, 1.0E6*t_dense/Ncalls, 1.0E9*t_dense/((double)Nhits*NREPEAT), t_map/t_dense);
+	cout << str << endl;
+	if(Nparsed == Nevents){
+		sprintf(str, "  parsed: %8.3f s  %8.2f us/event  %6.1f ns/hit  speedup=%5.2f", t_parsed, 1.0E6*t_parsed/Ncalls, 1.0E9*t_parsed/((double)Nhits*NREPEAT), t_map/t_parsed);
+		cout << str << endl;
+	}
+	cout << (Nmismatch==0 ? "DigiHits identical for all events":"DigiHits DIFFER for some events!") << endl;
+	cout << endl;
+
+	return NOERROR;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout <<"    tt_bench [options] file.evio" << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help    Print this usage statement" << endl;
+	cout << "   -r Nrepeat    Number of times to replay each event per method (default 100)" << endl;
+	cout << "   -PKEY=VALUE   JANA configuration parameter (e.g. -PEVENTS_TO_KEEP=1000)" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int &narg, char *argv[])
+{
+	/// Handle our own options and remove them from the argument
+	/// list so the rest can be passed to DApplication.
+
+	if(narg<2) Usage("You must supply a filename!");
+
+	int nkeep = 1;
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-r"){ NREPEAT = atoi(next.c_str()); i++;}
+		else argv[nkeep++] = argv[i];
+	}
+	narg = nkeep;
+
+	if(narg<2) Usage("You must supply a filename!");
+	if(NREPEAT<1) NREPEAT = 1;
+}